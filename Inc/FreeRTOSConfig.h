@@ -58,17 +58,21 @@
 #define configUSE_PREEMPTION                     1
 #define configSUPPORT_DYNAMIC_ALLOCATION         1
 #define configUSE_IDLE_HOOK                      0
-#define configUSE_TICK_HOOK                      0
+#define configUSE_TICK_HOOK                      1
 #define configCPU_CLOCK_HZ                       ( SystemCoreClock )
 #define configTICK_RATE_HZ                       ((TickType_t)1000)
 #define configMAX_PRIORITIES                     ( 56 )
 #define configMINIMAL_STACK_SIZE                 ((uint16_t)512)
-#define configTOTAL_HEAP_SIZE                    ((size_t)80*1024)
+/* Stacks of all tasks are taken from it, heap is in DTCM (ucHeap in main.c) */
+#define configTOTAL_HEAP_SIZE                    ((size_t)40*1024)
+/* Heap (with stacks of all tasks) is defined in main.c and placed in DTCM */
+#define configAPPLICATION_ALLOCATED_HEAP         1
 #define configMAX_TASK_NAME_LEN                  ( 16 )
 #define configUSE_TRACE_FACILITY                 1
 #define configUSE_16_BIT_TICKS                   0
 #define configUSE_MUTEXES                        1
-#define configQUEUE_REGISTRY_SIZE                8
+/* Queues named in main.c (10 now), with room for queues of later tasks */
+#define configQUEUE_REGISTRY_SIZE                16
 #define configUSE_RECURSIVE_MUTEXES              1
 #define configUSE_COUNTING_SEMAPHORES            1
 #define configUSE_PORT_OPTIMISED_TASK_SELECTION  0
@@ -152,6 +156,30 @@ standard names. */
 
 /* USER CODE BEGIN Defines */
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
+/* Slot 0 holds scratch arena of the task (see arena.h) */
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS  1
+/* Run time statistics are counted with DWT cycle counter (see runtime.h) */
+#define configGENERATE_RUN_TIME_STATS            1
+#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+  extern void RUNTIME_CounterInit(void);
+  extern uint32_t RUNTIME_GetCounter(void);
+#endif
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() RUNTIME_CounterInit()
+#define portGET_RUN_TIME_COUNTER_VALUE()         RUNTIME_GetCounter()
+/* Event trace recorder (see driver_trace.h), 0 removes all trace hooks */
+#define DRIVER_TRACE_ENABLE                      1
+#if DRIVER_TRACE_ENABLE
+#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+  extern void DRIVER_TRACE_TaskSwitchedIn(uint32_t taskNumber, const char *taskName);
+  extern void DRIVER_TRACE_QueueSend(void *queue, uint32_t waiting);
+  extern void DRIVER_TRACE_QueueReceive(void *queue, uint32_t waiting);
+#endif
+#define traceTASK_SWITCHED_IN()                  DRIVER_TRACE_TaskSwitchedIn(pxCurrentTCB->uxTCBNumber, pxCurrentTCB->pcTaskName)
+#define traceQUEUE_SEND(pxQueue)                 DRIVER_TRACE_QueueSend(pxQueue, pxQueue->uxMessagesWaiting)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue)        DRIVER_TRACE_QueueSend(pxQueue, pxQueue->uxMessagesWaiting)
+#define traceQUEUE_RECEIVE(pxQueue)              DRIVER_TRACE_QueueReceive(pxQueue, pxQueue->uxMessagesWaiting)
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue)     DRIVER_TRACE_QueueReceive(pxQueue, pxQueue->uxMessagesWaiting)
+#endif
 /* USER CODE END Defines */
 
 #endif /* FREERTOS_CONFIG_H */
@@ -20,6 +20,8 @@
     (#) Set state of client using MQTT_CLIENT_SetState() function
     	-State can be either BLOCK STATE or LISTEN STATE. Using MQTTClientState_t enum, you
     	 can set desirable state.
+    (#) While client listens, data from server comes from at engine (AT_URC_DATA), so it
+        doesn't take answers of commands from receive buffer of gsm
 
   @endverbatim
   *
@@ -57,6 +59,21 @@ MQTTClientType_t MQTT_CLIENT_Init(MQTTClientHandler_t *handler, MQTTClientConfig
 		return MQTT_CLIENT_ERROR;
 	}
 
+	handler->dataQueue = xQueueCreate( MQTT_CLIENT_DATA_QUEUE_LENGTH, sizeof(ATUrcEvent_t) );
+	if( handler->dataQueue == NULL )
+	{
+		/* The queue could not be created. */
+		return MQTT_CLIENT_ERROR;
+	}
+
+	/* Subscriber gets data only while client listens */
+	handler->urc.mask 		= 0;
+	handler->urc.Handle 	= NULL;
+	handler->urc.context 	= handler;
+	handler->urc.queue 		= handler->dataQueue;
+	if(AT_URC_Subscribe(&handler->urc) != DRIVER_OK)
+		return MQTT_CLIENT_ERROR;
+
 	if(xTaskCreate(WaitMessageTask,"WaitMessageTask", 2048,( void *) handler,2,NULL) == errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY)
 	{
 		/* The task could not be created. */
@@ -87,6 +104,10 @@ MQTTClientType_t MQTT_CLIENT_SetState(MQTTClientHandler_t *handler, MQTTClientSt
 
 	queueState.state = state;
 
+	/* At engine checks data without end of line only while somebody wants it */
+	handler->urc.mask = state == MQTT_CLIENT_LISTEN ? AT_URC_MASK(AT_URC_DATA) : 0;
+	DRIVER_GSM_Wake(handler->gsm);
+
 	xQueueSend(handler->mqttClientQueue,(void*) &queueState, 0);
 
 	return DRIVER_OK;
@@ -107,14 +128,20 @@ void WaitMessageTask(void* pvParameters)
 	MQTTClientMsg_t msg;
 	uint32_t sizeMsg = 0;
 	uint8_t firstTimeTopicFlag = 0;
+	ATUrcEvent_t event;
 	for(;;)
 	{
 		xQueueReceive(mqttClientQueue, &msg, blockPeriod);
 		switch(msg.state){
 		case MQTT_CLIENT_LISTEN:
 			blockPeriod = MQTT_CLIENT_NO_BLOCK;
-			/* Read what is in buffer */
-			DRIVER_GSM_Read(handler->gsm,buffer, &size);
+			/* Wait for next part of data from server, it is added to what is in buffer */
+			if(xQueueReceive(handler->dataQueue, &event, pdMS_TO_TICKS(MQTT_CLIENT_DATA_WAIT)) == pdTRUE &&
+			   size + event.length < sizeof(buffer))
+			{
+				memcpy(buffer + size, event.text, event.length + 1);
+				size += event.length;
+			}
 			/* If topic name occurs in buffer, we have to set size of message that is sent from broker */
 			if(strstr((char*)buffer,(const char*)handler->mqtt->mqttPacket.payload.topicName) != NULL)
 			{
@@ -137,6 +164,7 @@ void WaitMessageTask(void* pvParameters)
 				uint8_t *endMsg = (uint8_t*)strchr((char*)buffer,'\0');
 				if(endMsg - startMsg == sizeMsg)
 				{
+					DRIVER_TRACE(TRACE_MQTT_RECEIVE, sizeMsg, handler->mqtt->mqttPacket.payload.topicLen);
 					DRIVER_CONSOLE_Put(handler->console, startMsg);
 					DRIVER_CONSOLE_Put(handler->console, (const uint8_t*)"\r\n");
 					firstTimeTopicFlag = 0;
@@ -151,6 +179,7 @@ void WaitMessageTask(void* pvParameters)
 			blockPeriod = MQTT_CLIENT_BLOCK_INFINITY;
 			memset(buffer,0,sizeof(buffer));
 			size = 0;
+			xQueueReset(handler->dataQueue);
 			break;
 		}
 	}
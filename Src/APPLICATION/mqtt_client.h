@@ -11,6 +11,10 @@
 #define	MQTT_CLIENT_NO_BLOCK 		 (uint32_t) 0x00000000U
 #define	MQTT_CLIENT_BLOCK_INFINITY   (uint32_t) 0xFFFFFFFFU
 
+/* Number of parts of data from server that wait for client and longest wait for them (in miliseconds) */
+#define MQTT_CLIENT_DATA_QUEUE_LENGTH	16U
+#define MQTT_CLIENT_DATA_WAIT			100U
+
 #include <driver_console.h>
 #include <driver_common.h>
 #include <driver_gsm.h>
@@ -66,6 +70,10 @@ typedef struct __MQTTClientHandler_t
 	MQTTClientState_t state;					/*!< Running communication parameters   			 	 				*/
 
 	QueueHandle_t mqttClientQueue;				/*!< Queue for receiving command(listen or close) from responsibe task	*/
+
+	ATUrcSubscriber_t urc;						/*!< Subscriber of data from server, active only while listening		*/
+
+	QueueHandle_t dataQueue;					/*!< Queue of data from server (ATUrcEvent_t)							*/
 }MQTTClientHandler_t;
 
 /**
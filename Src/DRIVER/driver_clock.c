@@ -0,0 +1,428 @@
+/**
+//  *******************************************************************************************************************
+  * @file    driver_clock.c
+  * @author  Valentina Denic
+  * @brief   CLOCK module driver.
+  *          This file provides firmware functions to manage the following
+  *          functionalities of the clock and power profiles.
+  *           + Initialization function
+  *           + Switching between profiles while scheduler is running
+  *           + Burst to full speed with return to base profile
+  *           + Recomputing of uart baud rate and timer prescaler after switch
+  *
+  *
+  @verbatim
+ ======================================================================================================================
+                        ##### How to use this driver #####
+ ======================================================================================================================
+  [..]
+    Every profile sets voltage scale of core regulator, PLL, bus dividers and flash wait
+    states. Switch is done with scheduler suspended, interrupts stay enabled: system clock is
+    first moved to HSI, then voltage scale and PLL are changed and at the end system clock is
+    moved to its new source. PLL is started by driver and ready flags of PLL and regulator are
+    polled with DWT cycle counter as bound (DRIVER_CLOCK_READY_TIMEOUT), HAL_RCC_OscConfig()
+    would wait for tick of HAL that never runs, so PLL that doesn't lock fails the switch and
+    core stays on HSI in low power profile instead of hanging. After that SysTick of FreeRTOS, baud rate
+    registers of uarts and prescaler of timer are set for new clocks, so ticks, baud rate
+    and time counting stay the same in every profile. Character that is received while
+    switch is in progress can be lost, so switch between at commands, not during answer.
+    The CLOCK module driver can be used as follows:
+
+    (#) Declare a DRIVERClockHandler_t handle structure and DRIVERClockConfig_t configuration
+        with base profile, initialized uarts and timer, and initialize it with
+        DRIVER_CLOCK_Init() function, base profile is set immediately
+    (#) Change base profile with DRIVER_CLOCK_SetProfile() function
+    (#) Surround processor heavy work (encoding, parsing) with DRIVER_CLOCK_BurstStart() and
+        DRIVER_CLOCK_BurstStop(), bursts can be nested and base profile is set again when
+        last burst is stopped
+    (#) Read running profile with DRIVER_CLOCK_GetProfile(), number of switches and clocks
+        are kept in handle
+
+  @endverbatim
+  *
+  **********************************************************************************************************************
+  */
+
+
+/* Includes -----------------------------------------------------------------------------------------------------------*/
+#include <driver_clock.h>
+#include <driver_trace.h>
+
+/**
+  * @brief  CLOCK settings of one profile
+  */
+typedef struct
+{
+	uint32_t voltageScale;						/*!< Voltage scale of core regulator				 */
+
+	uint32_t pllN;								/*!< Multiplication factor of PLL1, 0 for HSI		 */
+
+	uint32_t pllP;								/*!< Division factor of PLL1 for system clock		 */
+
+	uint32_t ahbDivider;						/*!< Divider of system clock for bus clock			 */
+
+	uint32_t apbHalf;							/*!< 1 when APB buses run on half of bus clock		 */
+
+	uint32_t flashLatency;						/*!< Flash wait states for bus clock				 */
+
+	uint32_t programDelay;						/*!< Flash programming delay for bus clock			 */
+
+}DRIVERClockSetting_t;
+
+/* PLL1 input is HSI 64MHz divided by 4, so VCO is 16MHz * N */
+#define DRIVER_CLOCK_PLL_M			4U
+
+/* Settings of profiles, last one is full speed for revision V of silicon */
+static const DRIVERClockSetting_t clockSettings[] =
+{
+	/* Low power: 64MHz HSI, bus 64MHz, scale 3 needs 1 wait state above 45MHz */
+	{PWR_REGULATOR_VOLTAGE_SCALE3, 0U, 0U, RCC_HCLK_DIV1, 0U, FLASH_LATENCY_1, FLASH_PROGRAMMING_DELAY_0},
+	/* Balanced: 200MHz, bus 100MHz, APB 50MHz */
+	{PWR_REGULATOR_VOLTAGE_SCALE2, 50U, 4U, RCC_HCLK_DIV2, 1U, FLASH_LATENCY_1, FLASH_PROGRAMMING_DELAY_1},
+	/* Full speed on revision Y: 400MHz, bus 200MHz, APB 100MHz */
+	{PWR_REGULATOR_VOLTAGE_SCALE1, 50U, 2U, RCC_HCLK_DIV2, 1U, FLASH_LATENCY_3, FLASH_PROGRAMMING_DELAY_2},
+	/* Full speed on revision V: 480MHz, bus 240MHz, APB 120MHz */
+	{PWR_REGULATOR_VOLTAGE_SCALE0, 60U, 2U, RCC_HCLK_DIV2, 1U, FLASH_LATENCY_4, FLASH_PROGRAMMING_DELAY_2}
+};
+
+/* Names of profiles */
+static const char *clockProfileName[CLOCK_PROFILE_NUMBER] = {"low power", "balanced", "full speed"};
+
+/**
+  * @brief Get settings of profile for this revision of silicon.
+  * @param profile      Clock profile.
+  * @retval const DRIVERClockSetting_t* settings
+  */
+static const DRIVERClockSetting_t *getSetting(DRIVERClockProfile_t profile)
+{
+	if(profile == CLOCK_PROFILE_FULL_SPEED && HAL_GetREVID() >= REV_ID_V) return &clockSettings[3];
+
+	return &clockSettings[profile];
+}
+
+/**
+  * @brief Wait until bits of register have value, wait is bounded by DWT cycle counter.
+  * @param reg          Register with ready flag.
+  * @param mask         Bits that are checked.
+  * @param value        Value of bits that ends the wait.
+  * @retval DRIVERState_t status, DRIVER_TIMEOUT if flag wasn't set in DRIVER_CLOCK_READY_TIMEOUT
+  */
+static DRIVERState_t waitReady(volatile uint32_t *reg, uint32_t mask, uint32_t value)
+{
+	uint32_t start = DWT->CYCCNT;
+	uint32_t limit = (SystemCoreClock / 1000000U) * DRIVER_CLOCK_READY_TIMEOUT;
+
+	while((*reg & mask) != value)
+	{
+		if(DWT->CYCCNT - start > limit) return DRIVER_TIMEOUT;
+	}
+
+	return DRIVER_OK;
+}
+
+/**
+  * @brief Stop PLL1 and start it again with factors of profile, core must run on HSI.
+  * @param setting      Settings of new profile.
+  * @retval DRIVERState_t status
+  */
+static DRIVERState_t startPll(const DRIVERClockSetting_t *setting)
+{
+	__HAL_RCC_PLL_DISABLE();
+	if(waitReady(&RCC->CR, RCC_CR_PLL1RDY, 0U) != DRIVER_OK) return DRIVER_ERROR;
+
+	/* Low power profile runs on HSI alone */
+	if(setting->pllN == 0) return DRIVER_OK;
+
+	/* Input of PLL1 is HSI 64MHz / DRIVER_CLOCK_PLL_M, it is in range 3 (8 to 16MHz) */
+	__HAL_RCC_PLL_CONFIG(RCC_PLLSOURCE_HSI, DRIVER_CLOCK_PLL_M, setting->pllN, setting->pllP, 8U, 8U);
+	__HAL_RCC_PLLFRACN_DISABLE();
+	__HAL_RCC_PLLFRACN_CONFIG(0U);
+	__HAL_RCC_PLL_VCIRANGE(RCC_PLL1VCIRANGE_3);
+	__HAL_RCC_PLL_VCORANGE(RCC_PLL1VCOWIDE);
+	__HAL_RCC_PLLCLKOUT_ENABLE(RCC_PLL1_DIVP);
+	__HAL_RCC_PLLCLKOUT_ENABLE(RCC_PLL1_DIVQ);
+	__HAL_RCC_PLLCLKOUT_ENABLE(RCC_PLL1_DIVR);
+	__HAL_RCC_PLLFRACN_ENABLE();
+	__HAL_RCC_PLL_ENABLE();
+
+	return waitReady(&RCC->CR, RCC_CR_PLL1RDY, RCC_CR_PLL1RDY) == DRIVER_OK ? DRIVER_OK : DRIVER_ERROR;
+}
+
+/**
+  * @brief Set baud rate registers of uarts and prescaler of timer for new clocks.
+  * @param handler      CLOCK handle.
+  * @param setting      Settings of new profile.
+  * @retval DRIVERState_t status
+  */
+static DRIVERState_t setPeripherals(DRIVERClockHandler_t *handler, const DRIVERClockSetting_t *setting)
+{
+	DRIVERState_t state = DRIVER_OK;
+
+	for(uint32_t i = 0; i < handler->uartNumber; i++)
+	{
+		UART_HandleTypeDef *uart = handler->uartBase[i];
+
+		/* UART_SetConfig() clears interrupt routines that drivers have set */
+		void (*rxISR)(UART_HandleTypeDef *huart) = uart->RxISR;
+		void (*txISR)(UART_HandleTypeDef *huart) = uart->TxISR;
+
+		/* Baud rate register can be written only while uart is disabled */
+		__HAL_UART_DISABLE(uart);
+		if(UART_SetConfig(uart) != HAL_OK) state = DRIVER_ERROR;
+		__HAL_UART_ENABLE(uart);
+
+		uart->RxISR = rxISR;
+		uart->TxISR = txISR;
+	}
+
+	if(handler->timerBase != NULL && handler->timerFrequency != 0)
+	{
+		/* Timers on APB1 run on double APB1 clock when APB1 is divided */
+		uint32_t timerClock = HAL_RCC_GetPCLK1Freq() * (setting->apbHalf ? 2U : 1U);
+
+		handler->timerBase->Init.Prescaler 	= timerClock / DRIVER_CLOCK_TIMER_COUNTER - 1U;
+		handler->timerBase->Init.Period 	= DRIVER_CLOCK_TIMER_COUNTER / handler->timerFrequency - 1U;
+
+		/* Prescaler is taken on next update, counter starts again so it can't miss new period */
+		__HAL_TIM_SET_PRESCALER(handler->timerBase, handler->timerBase->Init.Prescaler);
+		__HAL_TIM_SET_AUTORELOAD(handler->timerBase, handler->timerBase->Init.Period);
+		__HAL_TIM_SET_COUNTER(handler->timerBase, 0);
+	}
+
+	return state;
+}
+
+/**
+  * @brief Set clocks of profile, called with scheduler suspended.
+  * @param handler      CLOCK handle.
+  * @param profile      Clock profile.
+  * @retval DRIVERState_t status
+  */
+static DRIVERState_t applyProfile(DRIVERClockHandler_t *handler, DRIVERClockProfile_t profile)
+{
+	RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+	const DRIVERClockSetting_t *setting = getSetting(profile);
+
+	/* Wait until last characters leave uarts */
+	for(uint32_t i = 0; i < handler->uartNumber; i++)
+	{
+		for(uint32_t j = 0; j < DRIVER_CLOCK_UART_WAIT && __HAL_UART_GET_FLAG(handler->uartBase[i], UART_FLAG_TC) == RESET; j++);
+	}
+
+	/* System clock is moved to HSI, 2 wait states are enough for 64MHz in every voltage scale,
+	 * HSI always runs, so switch of HAL_RCC_ClockConfig() ends at once */
+	RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK|RCC_CLOCKTYPE_SYSCLK
+	                            |RCC_CLOCKTYPE_PCLK1|RCC_CLOCKTYPE_PCLK2
+	                            |RCC_CLOCKTYPE_D3PCLK1|RCC_CLOCKTYPE_D1PCLK1;
+	RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_HSI;
+	RCC_ClkInitStruct.SYSCLKDivider = RCC_SYSCLK_DIV1;
+	RCC_ClkInitStruct.AHBCLKDivider = RCC_HCLK_DIV1;
+	RCC_ClkInitStruct.APB3CLKDivider = RCC_APB3_DIV1;
+	RCC_ClkInitStruct.APB1CLKDivider = RCC_APB1_DIV1;
+	RCC_ClkInitStruct.APB2CLKDivider = RCC_APB2_DIV1;
+	RCC_ClkInitStruct.APB4CLKDivider = RCC_APB4_DIV1;
+	if(HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_2) != HAL_OK) return DRIVER_ERROR;
+
+	/* Voltage scale can be changed in both directions while core runs on HSI */
+	__HAL_PWR_VOLTAGESCALING_CONFIG(setting->voltageScale);
+	if(waitReady(&PWR->D3CR, PWR_D3CR_VOSRDY, PWR_D3CR_VOSRDY) != DRIVER_OK) return DRIVER_ERROR;
+
+	/* PLL1 is stopped and started again with new multiplication factor */
+	if(startPll(setting) != DRIVER_OK) return DRIVER_ERROR;
+
+	/* System clock is moved to its source, which is ready now, latency is raised before and
+	 * lowered after switch */
+	RCC_ClkInitStruct.SYSCLKSource = setting->pllN == 0 ? RCC_SYSCLKSOURCE_HSI : RCC_SYSCLKSOURCE_PLLCLK;
+	RCC_ClkInitStruct.AHBCLKDivider = setting->ahbDivider;
+	RCC_ClkInitStruct.APB3CLKDivider = setting->apbHalf ? RCC_APB3_DIV2 : RCC_APB3_DIV1;
+	RCC_ClkInitStruct.APB1CLKDivider = setting->apbHalf ? RCC_APB1_DIV2 : RCC_APB1_DIV1;
+	RCC_ClkInitStruct.APB2CLKDivider = setting->apbHalf ? RCC_APB2_DIV2 : RCC_APB2_DIV1;
+	RCC_ClkInitStruct.APB4CLKDivider = setting->apbHalf ? RCC_APB4_DIV2 : RCC_APB4_DIV1;
+	if(HAL_RCC_ClockConfig(&RCC_ClkInitStruct, setting->flashLatency) != HAL_OK) return DRIVER_ERROR;
+
+	__HAL_FLASH_SET_PROGRAM_DELAY(setting->programDelay);
+
+	/* HAL_RCC_ClockConfig() sets SysTick for HAL with its priority, FreeRTOS needs the lowest one */
+	SysTick->LOAD = (SystemCoreClock / configTICK_RATE_HZ) - 1UL;
+	SysTick->VAL = 0;
+	HAL_NVIC_SetPriority(SysTick_IRQn, configLIBRARY_LOWEST_INTERRUPT_PRIORITY, 0U);
+
+	return setPeripherals(handler, setting);
+}
+
+/**
+  * @brief Switch to profile and count the switch.
+  * @param handler      CLOCK handle.
+  * @param profile      Clock profile.
+  * @retval DRIVERState_t status
+  */
+static DRIVERState_t switchProfile(DRIVERClockHandler_t *handler, DRIVERClockProfile_t profile)
+{
+	DRIVERState_t state;
+	uint32_t previous = SystemCoreClock;
+
+	/* Other tasks can't use uarts or timer while their clocks change, interrupts still run */
+	vTaskSuspendAll();
+
+	state = applyProfile(handler, profile);
+
+	if(state == DRIVER_OK)
+	{
+		handler->profile = profile;
+		handler->switchCount[profile]++;
+	}
+	else
+	{
+		/* Core can be left on HSI, low power profile doesn't need PLL */
+		handler->failCount++;
+		if(applyProfile(handler, CLOCK_PROFILE_LOW_POWER) == DRIVER_OK) handler->profile = CLOCK_PROFILE_LOW_POWER;
+	}
+
+	handler->sysclk = HAL_RCC_GetSysClockFreq();
+	handler->hclk 	= HAL_RCC_GetHCLKFreq();
+
+	/* Cycles in trace before this record are counted with previous clock */
+	if(SystemCoreClock != previous) DRIVER_TRACE(TRACE_CLOCK_CHANGE, SystemCoreClock, previous);
+
+	xTaskResumeAll();
+
+	return state;
+}
+
+/**
+  * @brief Initialize CLOCK handle and set base profile.
+  * @param handler      CLOCK handle.
+  * @param config       Configuration handle.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t DRIVER_CLOCK_Init(DRIVERClockHandler_t *handler, DRIVERClockConfig_t *config)
+{
+	if(handler == NULL) return DRIVER_ERROR;
+
+	/* Check the configuration handle allocation */
+	if(config == NULL || config->profile >= CLOCK_PROFILE_NUMBER)
+	{
+		handler->InitState = CLOCK_NOINIT;
+		return DRIVER_ERROR;
+	}
+
+	memset(handler, 0, sizeof(DRIVERClockHandler_t));
+
+	for(uint32_t i = 0; i < DRIVER_CLOCK_MAX_UARTS; i++)
+	{
+		if(config->uartBase[i] != NULL) handler->uartBase[handler->uartNumber++] = config->uartBase[i];
+	}
+
+	handler->timerBase 		= config->timerBase;
+
+	handler->timerFrequency = config->timerFrequency;
+
+	/* Cycle counter bounds waits for ready flags, it runs before scheduler starts run time stats */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->LAR = 0xC5ACCE55;					/* Unlock DWT registers on Cortex-M7 */
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	/* SystemClock_Config() starts core in low power profile */
+	handler->profile 		= CLOCK_PROFILE_LOW_POWER;
+
+	handler->baseProfile 	= config->profile;
+
+	if(switchProfile(handler, config->profile) != DRIVER_OK)
+	{
+		handler->InitState = CLOCK_NOINIT;
+		return DRIVER_ERROR;
+	}
+
+	handler->InitState 		= CLOCK_INIT;
+
+	return DRIVER_OK;
+}
+
+/**
+  * @brief Set base profile, it is switched at once if no burst is running.
+  * @param handler      CLOCK handle.
+  * @param profile      Clock profile.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t DRIVER_CLOCK_SetProfile(DRIVERClockHandler_t *handler, DRIVERClockProfile_t profile)
+{
+	DRIVERState_t state = DRIVER_OK;
+
+	if(handler == NULL || handler->InitState != CLOCK_INIT || profile >= CLOCK_PROFILE_NUMBER) return DRIVER_ERROR;
+
+	vTaskSuspendAll();
+
+	handler->baseProfile = profile;
+
+	if(handler->burstCount == 0 && handler->profile != profile) state = switchProfile(handler, profile);
+
+	xTaskResumeAll();
+
+	return state;
+}
+
+/**
+  * @brief Get running profile.
+  * @param handler      CLOCK handle.
+  * @retval DRIVERClockProfile_t profile
+  */
+DRIVERClockProfile_t DRIVER_CLOCK_GetProfile(DRIVERClockHandler_t *handler)
+{
+	return handler->profile;
+}
+
+/**
+  * @brief Get name of profile.
+  * @param profile      Clock profile.
+  * @retval const char* name of profile
+  */
+const char *DRIVER_CLOCK_GetProfileName(DRIVERClockProfile_t profile)
+{
+	if(profile >= CLOCK_PROFILE_NUMBER) return "unknown";
+
+	return clockProfileName[profile];
+}
+
+/**
+  * @brief Start burst, core runs in full speed profile until last burst is stopped.
+  * @param handler      CLOCK handle.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t DRIVER_CLOCK_BurstStart(DRIVERClockHandler_t *handler)
+{
+	DRIVERState_t state = DRIVER_OK;
+
+	if(handler == NULL || handler->InitState != CLOCK_INIT) return DRIVER_ERROR;
+
+	vTaskSuspendAll();
+
+	handler->burstCount++;
+
+	if(handler->profile != CLOCK_PROFILE_FULL_SPEED) state = switchProfile(handler, CLOCK_PROFILE_FULL_SPEED);
+
+	xTaskResumeAll();
+
+	return state;
+}
+
+/**
+  * @brief Stop burst, base profile is set again when last burst is stopped.
+  * @param handler      CLOCK handle.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t DRIVER_CLOCK_BurstStop(DRIVERClockHandler_t *handler)
+{
+	DRIVERState_t state = DRIVER_OK;
+
+	if(handler == NULL || handler->InitState != CLOCK_INIT || handler->burstCount == 0) return DRIVER_ERROR;
+
+	vTaskSuspendAll();
+
+	handler->burstCount--;
+
+	if(handler->burstCount == 0 && handler->profile != handler->baseProfile) state = switchProfile(handler, handler->baseProfile);
+
+	xTaskResumeAll();
+
+	return state;
+}
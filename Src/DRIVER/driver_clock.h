@@ -0,0 +1,104 @@
+/**
+  ******************************************************************************************************************************
+  * @file    driver_clock.h
+  * @author  Valentina Denic
+  * @brief   This file contains all the functions prototypes for the CLOCK
+  *          module driver (clock and power profiles).
+  ******************************************************************************************************************************
+  */
+
+#ifndef DRIVER_CLOCK_CLOCK_H_
+#define DRIVER_CLOCK_CLOCK_H_
+
+#include <driver_common.h>
+
+/* Largest number of uarts whose baud rate is kept when clock is changed */
+#define DRIVER_CLOCK_MAX_UARTS			4U
+
+/* Counter clock of timer in all profiles, timer update frequency is divided from it */
+#define DRIVER_CLOCK_TIMER_COUNTER		1000000U
+
+/* Number of checks of transmission complete flag before uart is reconfigured anyway */
+#define DRIVER_CLOCK_UART_WAIT			100000U
+
+/* Longest wait for ready flag of PLL or core regulator (in microseconds), it is counted on DWT
+ * cycle counter because tick of HAL doesn't run and SysTick is reprogrammed during switch */
+#define DRIVER_CLOCK_READY_TIMEOUT		2000U
+
+/**
+  * @brief  CLOCK INIT Status structures definition
+  */
+typedef enum
+{
+  CLOCK_INIT		= 0x00,						/*!< Clock initialization status ok  					 */
+  CLOCK_NOINIT		= 0x01						/*!< Clock initialization status error					 */
+} DRIVERClockInit;
+
+/**
+  * @brief  CLOCK profile definition
+  */
+typedef enum
+{
+  CLOCK_PROFILE_LOW_POWER	= 0x00,				/*!< HSI 64MHz without PLL, voltage scale 3				 */
+  CLOCK_PROFILE_BALANCED	= 0x01,				/*!< PLL 200MHz, bus 100MHz, voltage scale 2			 */
+  CLOCK_PROFILE_FULL_SPEED	= 0x02,				/*!< PLL 480MHz at scale 0 (rev V) or 400MHz at scale 1	 */
+  CLOCK_PROFILE_NUMBER		= 0x03				/*!< Number of profiles									 */
+} DRIVERClockProfile_t;
+
+/**
+  * @brief  DRIVER handle Clock Structure definition
+  */
+typedef struct __DRIVERClockHandler_t
+{
+	DRIVERClockInit InitState;								/*!< Init parameters     								 */
+
+	DRIVERClockProfile_t profile;							/*!< Profile that is running							 */
+
+	DRIVERClockProfile_t baseProfile;						/*!< Profile that runs when no burst is requested		 */
+
+	uint32_t burstCount;									/*!< Number of started bursts that were not stopped		 */
+
+	uint32_t switchCount[CLOCK_PROFILE_NUMBER];				/*!< Number of switches to every profile				 */
+
+	uint32_t failCount;										/*!< Number of switches that failed						 */
+
+	uint32_t sysclk;										/*!< System clock in Hz									 */
+
+	uint32_t hclk;											/*!< Bus clock in Hz									 */
+
+	UART_HandleTypeDef* uartBase[DRIVER_CLOCK_MAX_UARTS];	/*!< UART handles whose baud rate is recomputed			 */
+
+	uint32_t uartNumber;									/*!< Number of valid entries in uartBase				 */
+
+	TIM_HandleTypeDef* timerBase;							/*!< TIMER handle whose prescaler is recomputed			 */
+
+	uint32_t timerFrequency;								/*!< Update frequency of timer in Hz					 */
+
+}DRIVERClockHandler_t;
+
+/**
+  * @brief  DRIVER configuration Structure definition
+  */
+typedef struct __DRIVERClockConfig_t
+{
+	DRIVERClockProfile_t profile;							/*!< Profile that is set at initialization				 */
+
+	UART_HandleTypeDef* uartBase[DRIVER_CLOCK_MAX_UARTS];	/*!< Initialized UART handles, unused entries are NULL	 */
+
+	TIM_HandleTypeDef* timerBase;							/*!< Initialized TIMER handle on APB1, can be NULL		 */
+
+	uint32_t timerFrequency;								/*!< Update frequency of timer in Hz					 */
+
+}DRIVERClockConfig_t;
+
+/* Initialization operation functions ******************************************************************************************/
+DRIVERState_t DRIVER_CLOCK_Init(DRIVERClockHandler_t *handler, DRIVERClockConfig_t *config);
+
+/* IO operation functions ******************************************************************************************************/
+DRIVERState_t DRIVER_CLOCK_SetProfile(DRIVERClockHandler_t *handler, DRIVERClockProfile_t profile);
+DRIVERClockProfile_t DRIVER_CLOCK_GetProfile(DRIVERClockHandler_t *handler);
+const char *DRIVER_CLOCK_GetProfileName(DRIVERClockProfile_t profile);
+DRIVERState_t DRIVER_CLOCK_BurstStart(DRIVERClockHandler_t *handler);
+DRIVERState_t DRIVER_CLOCK_BurstStop(DRIVERClockHandler_t *handler);
+
+#endif /* DRIVER_CLOCK_CLOCK_H_ */
@@ -23,8 +23,11 @@
         (++) Initialize size of buffers to get and put characters.
         (++) Initialize addresses of function for reading character from console and writing character to console.
     (#) Get characters from console using DRIVER_CONSOLE_Get() function
-    (#) Put characters to console using DRIVER_CONSOLE_Put() function
+    (#) Put characters to console using DRIVER_CONSOLE_Put() function, it returns when
+        string is transmitted, so string can be in buffer that caller uses again
         in the huart handle AdvancedInit structure.
+    (#) Received characters and transmission are serviced in io task (driver_io.c),
+        console driver has no tasks of its own
 
   @endverbatim
   *
@@ -34,21 +37,23 @@
 
 /* Includes -----------------------------------------------------------------------------------------------------------*/
 #include <driver_console.h>
+#include <driver_memory.h>
+#include <driver_io.h>
 
 /* Flag that indicates accurency of end character for one message(char '\r') */
-volatile uint32_t msgCount = 0;
+volatile uint32_t msgCount HOT_BSS = 0;
 
 /* Flag that indicates accurency of fullness of console receiving buffer */
-volatile bool buffFullFlag = false;
+volatile bool buffFullFlag HOT_BSS = false;
 
 /* Flag that indicates accurency of backslah character in uart interrupt */
-volatile bool backslashFlag = false;
+volatile bool backslashFlag HOT_BSS = false;
 
 /* handler of circular buffer */
-volatile DRIVERCircularBuffer_t currentCircularBufferConsole;
+volatile DRIVERCircularBuffer_t currentCircularBufferConsole HOT_BSS;
 
-/* Handle of RxTask for notifiying */
-static TaskHandle_t RxTaskHandle;
+/* Channel of console in io task */
+static DRIVERIoChannel_t consoleChannel;
 
 /* Console queue handle for transmiting messages*/
 QueueHandle_t ConsoleQueueTransmit;
@@ -56,8 +61,8 @@ QueueHandle_t ConsoleQueueTransmit;
 /* Console queue handle for receiving messages*/
 QueueHandle_t ConsoleQueueReceive;
 
-void TxTask(void* pvParameters);
-void RxTask(void* pvParameters);
+static void serviceConsole(void *context, uint32_t events);
+static bool nextTxConsole(void *context, uint8_t **data, uint32_t *size);
 
 /* Start variable is for echo character back to console */
 uint8_t start = 0;
@@ -77,7 +82,7 @@ DRIVERConsoleMsg_t msg[10];
 /* Variable for echoing characters back to console when it's received */
 DRIVERConsoleMsg_t msgEcho;
 
-void RxISRCallback(UART_HandleTypeDef *huart)
+HOT_FUNC void RxISRCallback(UART_HandleTypeDef *huart)
 {
 	if(huart->Instance == USART3){
 		if(currentCircularBufferConsole.pointerWrite == (currentCircularBufferConsole.pointerEnd + 1))
@@ -112,8 +117,8 @@ void RxISRCallback(UART_HandleTypeDef *huart)
 		/* Number of received messages */
 		if((uint8_t)(huart->Instance->RDR & 0xFF) == '\r') msgCount++;
 
-		/* Notify rx task about new character received */
-		xTaskNotifyFromISR(RxTaskHandle,0,eNoAction,NULL);
+		/* Notify io task about new character received */
+		DRIVER_IO_SignalFromISR(&consoleChannel, IO_EVENT_RX);
 	}
 }
 
@@ -157,14 +162,11 @@ DRIVERState_t DRIVER_CONSOLE_Init(DRIVERConsoleHandler_t *handler, DRIVERConsole
 		return DRIVER_ERROR;
 	}
 
-	if(xTaskCreate(TxTask,"TxTask", 1024,( void * ) handler,3,NULL) == errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY )
+	DRIVERIoConfig_t ioConfig = {.uartBase = config->uartBase, .Service = serviceConsole,
+								 .TxNext = nextTxConsole, .context = handler};
+	if(DRIVER_IO_Register(&consoleChannel, &ioConfig) != DRIVER_OK)
 	{
-		/* The task could not be created. */
-		return DRIVER_ERROR;
-	}
-	if(xTaskCreate(RxTask,"RxTask", 1024,( void * ) handler,3,&RxTaskHandle) == errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY )
-	{
-		/* The task could not be created. */
+		/* The channel could not be registered. */
 		return DRIVER_ERROR;
 	}
 
@@ -216,9 +218,11 @@ DRIVERState_t DRIVER_CONSOLE_Put(DRIVERConsoleHandler_t *handler, const uint8_t
 	for(;string[i] != 0;i++);
 	msgPut.sizeMsg = i;
 
-	/* Send string via queue to task for transmiting to gsm */
-	xQueueSend(handler->ConsoleQueueTransmit,(void*) &msgPut, 0);
-	return DRIVER_OK;
+	/* Send string via queue to io task and wait until it is transmitted */
+	if(xQueueSend(handler->ConsoleQueueTransmit,(void*) &msgPut, 0) != pdTRUE)
+		return DRIVER_ERROR;
+
+	return DRIVER_IO_Transmit(&consoleChannel, portMAX_DELAY);
 }
 
 /**
@@ -229,7 +233,7 @@ DRIVERState_t DRIVER_CONSOLE_Put(DRIVERConsoleHandler_t *handler, const uint8_t
   * @param timeout 			Timeout duration.
   * @retval DRIVERState_t status
   */
-DRIVERState_t DRIVER_CONSOLE_Get(DRIVERConsoleHandler_t *handler, uint8_t *userBuffer, uint32_t* dataSize, uint32_t timeout)
+HOT_FUNC DRIVERState_t DRIVER_CONSOLE_Get(DRIVERConsoleHandler_t *handler, uint8_t *userBuffer, uint32_t* dataSize, uint32_t timeout)
 {
 	DRIVERConsoleMsg_t msgGet;
 	uint32_t i = 0;
@@ -267,112 +271,116 @@ DRIVERState_t DRIVER_CONSOLE_Get(DRIVERConsoleHandler_t *handler, uint8_t *userB
 }
 
 /**
-  * @brief Task for transmition message to console
+  * @brief Take next message for io task to transmit to console.
+  * @param context      CONSOLE handle.
+  * @param data         Start of message.
+  * @param size         Size of message.
+  * @retval bool true if there is message
   */
-void TxTask(void* pvParameters){
-	DRIVERConsoleHandler_t * handler = pvParameters;
-	uint8_t txBuff[2000] = {0};
+static bool nextTxConsole(void *context, uint8_t **data, uint32_t *size)
+{
+	DRIVERConsoleHandler_t * handler = context;
 	DRIVERConsoleMsg_t msgTx;
-	for(;;){
 
-		/* Wait for message in queue and display it after receiving */
-		xQueueReceive(ConsoleQueueTransmit, &msgTx, portMAX_DELAY);
-		memcpy(txBuff,msgTx.startMsg ,msgTx.sizeMsg);
-		handler->State = COSNOLE_STATE_TRANSMIT;
-		HAL_UART_Transmit(handler->uartBase, msgTx.startMsg, msgTx.sizeMsg, HAL_MAX_DELAY);
+	if(xQueueReceive(ConsoleQueueTransmit, &msgTx, 0) != pdTRUE)
+	{
 		handler->State = COSNOLE_STATE_IDLE;
+		return false;
 	}
+
+	handler->State = COSNOLE_STATE_TRANSMIT;
+	*data = msgTx.startMsg;
+	*size = msgTx.sizeMsg;
+	return true;
 }
 
 /**
-  * @brief Task for receiving characters from console
+  * @brief Service received characters in io task, echo them and pass messages to DRIVER_CONSOLE_Get().
+  * @param context      CONSOLE handle.
+  * @param events       Events of console channel.
+  * @retval void
   */
-void RxTask(void* pvParameters){
-	DRIVERConsoleHandler_t * handler = pvParameters;
+static void serviceConsole(void *context, uint32_t events)
+{
+	DRIVERConsoleHandler_t * handler = context;
 	uint8_t i = 0;
-	for(;;){
 
-		xTaskNotifyWait( 0x00, /* Don't clear any notification bits on entry. */
-		 ULONG_MAX, /* Reset the notification value to 0 on exit. */
-		 NULL, /* Notified value is ommited. */
-		 portMAX_DELAY ); /* Block indefinitely. */
+	if((events & IO_EVENT_RX) == 0) return;
 
-		/* Achive atomic instruction with disabling interrupts */
-		__HAL_UART_DISABLE_IT(handler->uartBase, UART_IT_RXNE);
+	/* Achive atomic instruction with disabling interrupts */
+	__HAL_UART_DISABLE_IT(handler->uartBase, UART_IT_RXNE);
 
-		/* Return character to console(Echo message) */
-		msgEcho.sizeMsg = 0;
-		if(*(currentCircularBufferConsole.pointerWrite - 1) != '\r')
+	/* Return character to console(Echo message) */
+	msgEcho.sizeMsg = 0;
+	if(*(currentCircularBufferConsole.pointerWrite - 1) != '\r')
+	{
+		if(backslashFlag == true)
 		{
-			if(backslashFlag == true)
-			{
-				/* Send backspace echo to console */
-				msgEcho.startMsg = backspaceEcho;
-				msgEcho.sizeMsg = 3;
-				backslashFlag = false;
-			}
-			else
-			{
-				/* Send received character echo to console */
-				start = *(currentCircularBufferConsole.pointerWrite - 1);
-				msgEcho.startMsg = &start;
-				msgEcho.sizeMsg = 1;
-			}
+			/* Send backspace echo to console */
+			msgEcho.startMsg = backspaceEcho;
+			msgEcho.sizeMsg = 3;
+			backslashFlag = false;
 		}
 		else
 		{
-			/* Send backslash echo to console */
-			msgEcho.startMsg = backslashEcho;
-			msgEcho.sizeMsg = 2;
+			/* Send received character echo to console */
+			start = *(currentCircularBufferConsole.pointerWrite - 1);
+			msgEcho.startMsg = &start;
+			msgEcho.sizeMsg = 1;
 		}
+	}
+	else
+	{
+		/* Send backslash echo to console */
+		msgEcho.startMsg = backslashEcho;
+		msgEcho.sizeMsg = 2;
+	}
 
-		/* Write received character to console */
-		handler->State = COSNOLE_STATE_RECEIVE;
-		xQueueSend(handler->ConsoleQueueTransmit,(void*) &msgEcho, 0);
-		handler->State = COSNOLE_STATE_IDLE;
+	/* Write received character to console */
+	handler->State = COSNOLE_STATE_RECEIVE;
+	xQueueSend(handler->ConsoleQueueTransmit,(void*) &msgEcho, 0);
+	handler->State = COSNOLE_STATE_IDLE;
 
-		i = 0;
-		/* If buffer is full and no other messages are in it */
-		if(buffFullFlag == true && msgCount == 0)
+	i = 0;
+	/* If buffer is full and no other messages are in it */
+	if(buffFullFlag == true && msgCount == 0)
+	{
+		msgEcho.startMsg = (uint8_t *)msgOverflow;
+		msgEcho.sizeMsg = sizeof(msgOverflow);
+		/* Reset rx buffer */
+		memset(handler->rxBuffer,0,handler->rxSize);
+		buffFullFlag = false;
+		xQueueSend(ConsoleQueueReceive, (void *) &msg[i], 0);
+	}
+
+	/*  if there is messages to process */
+	while(msgCount > 0)
+	{
+		if(i > 10)
 		{
+			i = 0;
 			msgEcho.startMsg = (uint8_t *)msgOverflow;
 			msgEcho.sizeMsg = sizeof(msgOverflow);
-			/* Reset rx buffer */
-			memset(handler->rxBuffer,0,handler->rxSize);
-			buffFullFlag = false;
-			xQueueSend(ConsoleQueueReceive, (void *) &msg[i], 0);
 		}
-
-		/*  if there is messages to process */
-		while(msgCount > 0)
+		else
 		{
-			if(i > 10)
-			{
-				i = 0;
-				msgEcho.startMsg = (uint8_t *)msgOverflow;
-				msgEcho.sizeMsg = sizeof(msgOverflow);
-			}
+			/* set size of message */
+			if(currentCircularBufferConsole.pointerWrite > currentCircularBufferConsole.pointerRead)
+				msg[i].sizeMsg = currentCircularBufferConsole.pointerWrite - currentCircularBufferConsole.pointerRead;
 			else
-			{
-				/* set size of message */
-				if(currentCircularBufferConsole.pointerWrite > currentCircularBufferConsole.pointerRead)
-					msg[i].sizeMsg = currentCircularBufferConsole.pointerWrite - currentCircularBufferConsole.pointerRead;
-				else
-					msg[i].sizeMsg = (currentCircularBufferConsole.pointerEnd - currentCircularBufferConsole.pointerRead) + 1 +
-					(currentCircularBufferConsole.pointerWrite - currentCircularBufferConsole.pointerStart);
+				msg[i].sizeMsg = (currentCircularBufferConsole.pointerEnd - currentCircularBufferConsole.pointerRead) + 1 +
+				(currentCircularBufferConsole.pointerWrite - currentCircularBufferConsole.pointerStart);
 
-				/* Decrease number of messages */
-				msgCount--;
+			/* Decrease number of messages */
+			msgCount--;
 
-				msg[i].startMsg = currentCircularBufferConsole.pointerRead;
+			msg[i].startMsg = currentCircularBufferConsole.pointerRead;
 
-			}
-			/* Send message to queue */
-			xQueueSend(ConsoleQueueReceive, (void *) &msg[i], 0);
-			i++;
 		}
-
-		__HAL_UART_ENABLE_IT(handler->uartBase, UART_IT_RXNE);
-
+		/* Send message to queue */
+		xQueueSend(ConsoleQueueReceive, (void *) &msg[i], 0);
+		i++;
 	}
+
+	__HAL_UART_ENABLE_IT(handler->uartBase, UART_IT_RXNE);
 }
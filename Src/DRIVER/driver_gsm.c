@@ -10,8 +10,9 @@
   *           + Write message to gsm module function
   *           + Bring receiving buffer for characters from gsm to initial state
   *           + Collect characters in uart interrupt routine
-  *           + Receive message from gsm in receiving task
-  *			  + Transmit message to gsm in transmitting task
+  *           + Copy received characters from ring buffer in reading task
+  *           + Wake reading task when line or prompt is received
+  *			  + Transmit message to gsm in io task
   *
   @verbatim
  ===================================================================================================
@@ -22,11 +23,19 @@
 
     (#) Declare a DRIVERGsmHandler_t handle structure (eg. DRIVERGsmHandler_t gsm).
     (#) Initialize the gsm low level resources by implementing the DRIVER_GSM_Init()
-    (#) Read characters from gsm using DRIVER_GSM_Read() function
-    (#) Put message to gsm using DRIVER_GSM_Write() function
+    (#) Read characters from gsm using DRIVER_GSM_Read() function, it copies them from
+        ring buffer in task that reads, several tasks can read one after another,
+        DRIVER_GSM_ReadLimit() copies only as much as fits in buffer of reader
+    (#) Wait for end of line or for prompt ("> ") with DRIVER_GSM_WaitData() instead of
+        reading again and again, interrupt routine gives signal only for those characters,
+        other task can end waiting with DRIVER_GSM_Wake()
+    (#) Put message to gsm using DRIVER_GSM_Write() function, it returns when message
+        is transmitted
     (#) Flush gsm and bring him to initial state with DRIVER_GSM_Flush() function
     (#) Collect characters from gsm in interrupt routine uart module with
     	IRQ_UART_RX_GSM() function
+    (#) Transmission is serviced in io task (driver_io.c), gsm driver has no tasks
+        of its own
 
   @endverbatim
   *
@@ -35,41 +44,46 @@
 
 /* Includes ---------------------------------------------------------------------------------------*/
 #include <driver_gsm.h>
+#include <driver_memory.h>
+#include <driver_io.h>
 
 /* Current global GSM handle */
 static volatile DRIVERGsmHandler_t *currentGsmHandle;
 
 /* handler of circular buffer */
-volatile DRIVERCircularBuffer_t currentCircularBufferGsm;
+volatile DRIVERCircularBuffer_t currentCircularBufferGsm HOT_BSS;
 
 /* Additional helpful variables for debuging */
 static volatile uint8_t IndexOfLastReceivedCharHLP;
 
 /* Console queue handle for transmiting messages*/
 QueueHandle_t GsmQueueTransmit;
-/* Console queue handle for receiving messages*/
-QueueHandle_t GsmQueueReceive;
 
-/* Handle of RxTaskGsm for notifiying */
-static TaskHandle_t RxTaskHandleGsm;
+/* Mutex of readers, ring has one read pointer */
+static SemaphoreHandle_t GsmReadMutex;
 
-void TxTaskGsm(void* pvParameters);
-void RxTaskGsm(void* pvParameters);
+/* Given in interrupt routine when end of line or prompt is received */
+static SemaphoreHandle_t GsmLineSemaphore;
 
-uint8_t rxStart[2000] = {0};
-DRIVERGsmMsg_t queueMsg = {.startMsg = rxStart,.sizeMsg = 0};
-DRIVERGsmMsg_t queueMsgRead;
+/* Previous received character, prompt "> " ends with space after '>' */
+static uint8_t GsmLastCharacter HOT_BSS;
+
+/* Channel of gsm in io task */
+static DRIVERIoChannel_t gsmChannel;
+
+static bool nextTxGsm(void *context, uint8_t **data, uint32_t *size);
 
 /**
   * @brief Callback function when receiving new character from UART is done.
   * @param huart          UART handle.
   * @retval void
   */
-void IRQ_UART_RX_GSM(UART_HandleTypeDef *huart)
+HOT_FUNC void IRQ_UART_RX_GSM(UART_HandleTypeDef *huart)
 {
 	/* Circular buffer - write characters to buffer */
 	if(huart->Instance == USART6){
-		if((uint8_t)(huart->Instance->RDR & 0xFF) != '\0')
+		uint8_t character = (uint8_t)(huart->Instance->RDR & 0xFF);
+		if(character != '\0')
 		{
 			/* Set console state to receiving */
 			currentGsmHandle->State = GSM_STATE_RECEIVE;
@@ -78,11 +92,20 @@ void IRQ_UART_RX_GSM(UART_HandleTypeDef *huart)
 			{
 				currentCircularBufferGsm.pointerWrite = currentCircularBufferGsm.pointerStart;
 			}
-			*currentCircularBufferGsm.pointerWrite = (uint8_t)(huart->Instance->RDR & 0xFF);
+			*currentCircularBufferGsm.pointerWrite = character;
 			currentCircularBufferGsm.pointerWrite++;
 
 			/* Set console state to idle */
 			currentGsmHandle->State = GSM_STATE_IDLE;
+
+			/* Result codes end with line or with prompt, reader is woken only for them */
+			if(character == '\n' || (character == ' ' && GsmLastCharacter == '>'))
+			{
+				BaseType_t woken = pdFALSE;
+				xSemaphoreGiveFromISR(GsmLineSemaphore, &woken);
+				portYIELD_FROM_ISR(woken);
+			}
+			GsmLastCharacter = character;
 		}
 	}
 }
@@ -120,23 +143,26 @@ DRIVERState_t DRIVER_GSM_Init(DRIVERGsmHandler_t *handler, DRIVERGsmConfig_t *co
 		return DRIVER_ERROR;
 	}
 
-	GsmQueueReceive = xQueueCreate( QUEUELENGTH, sizeof(DRIVERGsmMsg_t) );
-	if( GsmQueueReceive == NULL )
+	GsmReadMutex = xSemaphoreCreateMutex();
+	if( GsmReadMutex == NULL )
 	{
-		/* The queue could not be created. */
+		/* The mutex could not be created. */
 		return DRIVER_ERROR;
 	}
 
-	if(xTaskCreate(TxTaskGsm,"TxTaskGsm", 2048,( void *) handler,3,NULL) == errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY)
+	GsmLineSemaphore = xSemaphoreCreateBinary();
+	if( GsmLineSemaphore == NULL )
 	{
-		/* The task could not be created. */
+		/* The semaphore could not be created. */
 		return DRIVER_ERROR;
 	}
 
-	if(xTaskCreate(RxTaskGsm,"RxTaskGsm", 2048,( void *) handler,3,&RxTaskHandleGsm) == errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY)
+	DRIVERIoConfig_t ioConfig = {.uartBase = config->uartBase, .Service = NULL,
+								 .TxNext = nextTxGsm, .context = handler};
+	if(DRIVER_IO_Register(&gsmChannel, &ioConfig) != DRIVER_OK)
 	{
-		/* The task could not be created. */
-			return DRIVER_ERROR;
+		/* The channel could not be registered. */
+		return DRIVER_ERROR;
 	}
 
 	memset((uint8_t*)handler->rxBuffer,0,handler->rxSize);
@@ -162,7 +188,11 @@ DRIVERState_t DRIVER_GSM_Init(DRIVERGsmHandler_t *handler, DRIVERGsmConfig_t *co
 
 	handler->GsmQueueTransmit = GsmQueueTransmit;
 
-	handler->GsmQueueReceive = GsmQueueReceive;
+	handler->readCount 		= 0;
+
+	handler->readCycles 	= 0;
+
+	handler->readMaxCycles 	= 0;
 
 	currentGsmHandle 	= handler;
 
@@ -170,123 +200,171 @@ DRIVERState_t DRIVER_GSM_Init(DRIVERGsmHandler_t *handler, DRIVERGsmConfig_t *co
 }
 
 /**
-  * @brief Get characters from GSM module.
+  * @brief Get characters from GSM module, caller copies them from ring buffer without waiting for any task.
   * @param handler          GSM handle.
   * @param userBuffer       Buffer to put incoming characters .
-  * @param timeout 			Timeout duration.
-  * @param size 			Number of received characters.
+  * @param size 			Number of characters already in buffer, number of characters after read.
   * @retval DRIVERState_t status
   */
 DRIVERState_t DRIVER_GSM_Read(DRIVERGsmHandler_t *handler, uint8_t* userBuffer, uint32_t* size)
 {
+	return DRIVER_GSM_ReadLimit(handler, userBuffer, size, UINT32_MAX);
+}
 
-	/* Notify Rx task to send received answer from gsm */
-	xTaskNotify(RxTaskHandleGsm,0,eNoAction);
+/**
+  * @brief Get characters from GSM module that fit in buffer, others stay in ring buffer for next read.
+  * @param handler          GSM handle.
+  * @param userBuffer       Buffer to put incoming characters .
+  * @param size 			Number of characters already in buffer, number of characters after read.
+  * @param bufSize 			Size of buffer, with place for terminating '\0'.
+  * @retval DRIVERState_t status
+  */
+HOT_FUNC DRIVERState_t DRIVER_GSM_ReadLimit(DRIVERGsmHandler_t *handler, uint8_t* userBuffer, uint32_t* size, uint32_t bufSize)
+{
+	uint32_t startCycles = DWT->CYCCNT;
+	uint32_t index = *size;
 
-	/* Wait Rx task to send a message that contains answer from gsm */
-	xQueueReceive(handler->GsmQueueReceive, &queueMsgRead, portMAX_DELAY);
+	if(index >= bufSize) return DRIVER_ERROR;
 
-	/* When we aren't receive any character, just finish
-	 * function */
-	if(queueMsgRead.sizeMsg == 0) return DRIVER_OK;
+	/* Readers are serialized, interrupt routine is the only writer and doesn't use read pointer */
+	xSemaphoreTake(GsmReadMutex, portMAX_DELAY);
 
-	/* When answer from gsm is received, copy that messages into user buffer */
-	uint32_t i = 0;
-	uint32_t index = *size;
-	while(i < queueMsgRead.sizeMsg)
+	/* Characters up to write pointer taken now are copied, later ones stay for next read */
+	uint8_t *write = currentCircularBufferGsm.pointerWrite;
+	uint8_t *read = currentCircularBufferGsm.pointerRead;
+	if(write == currentCircularBufferGsm.pointerEnd + 1) write = currentCircularBufferGsm.pointerStart;
+
+	uint32_t room = bufSize - 1 - index;
+	if(write >= read)
+	{
+		uint32_t count = (uint32_t)(write - read) < room ? (uint32_t)(write - read) : room;
+		memcpy(&userBuffer[index], read, count);
+		index += count;
+		read += count;
+	}
+	else
 	{
-		userBuffer[index++] = queueMsgRead.startMsg[i++];
+		/* Answer wraps around end of ring */
+		uint32_t tail = (currentCircularBufferGsm.pointerEnd - read) + 1;
+		if(tail > room) tail = room;
+		memcpy(&userBuffer[index], read, tail);
+		index += tail;
+		room -= tail;
+		read += tail;
+		if(read == currentCircularBufferGsm.pointerEnd + 1)
+		{
+			uint32_t head = (uint32_t)(write - currentCircularBufferGsm.pointerStart) < room ?
+							(uint32_t)(write - currentCircularBufferGsm.pointerStart) : room;
+			memcpy(&userBuffer[index], currentCircularBufferGsm.pointerStart, head);
+			index += head;
+			read = currentCircularBufferGsm.pointerStart + head;
+		}
 	}
+	currentCircularBufferGsm.pointerRead = read;
+
+	/* Terminate answer, user buffer doesn't have to be zero initialized to search it as string */
+	userBuffer[index] = '\0';
 
 	/* Set size of that answer and finish function */
 	*size = index;
 
+	/* Cost of read is kept in handle, it includes waiting for other reader */
+	uint32_t cycles = DWT->CYCCNT - startCycles;
+	handler->readCount++;
+	handler->readCycles += cycles;
+	if(cycles > handler->readMaxCycles) handler->readMaxCycles = cycles;
+
+	xSemaphoreGive(GsmReadMutex);
+
 	return DRIVER_OK;
 
 }
 
 /**
-  * @brief Put message to GSM module.
+  * @brief Wait until end of line or prompt is received from GSM module.
   * @param handler      GSM handle.
-  * @param msg       	Message to send to GSM .
+  * @param timeout      Timeout duration in miliseconds, 0 only drops signal that is already given,
+  *                     portMAX_DELAY waits without timeout.
   * @retval DRIVERState_t status
   */
-DRIVERState_t DRIVER_GSM_Write(DRIVERGsmHandler_t *handler, const uint8_t* msg, uint32_t msgSize)
+DRIVERState_t DRIVER_GSM_WaitData(DRIVERGsmHandler_t *handler, uint32_t timeout)
 {
-	DRIVERGsmMsg_t queueMsg;
+	/* Conversion of portMAX_DELAY to ticks would overflow */
+	TickType_t ticks = timeout == portMAX_DELAY ? portMAX_DELAY : pdMS_TO_TICKS(timeout);
 
-	queueMsg.startMsg = (uint8_t *) msg;
-	queueMsg.sizeMsg = msgSize;
+	if(xSemaphoreTake(GsmLineSemaphore, ticks) != pdTRUE)
+		return DRIVER_TIMEOUT;
 
-	xQueueSend(handler->GsmQueueTransmit,(void*) &queueMsg, 0);
 	return DRIVER_OK;
+}
 
+/**
+  * @brief Wake task that waits in DRIVER_GSM_WaitData() without received line.
+  * @param handler      GSM handle.
+  * @retval void
+  */
+void DRIVER_GSM_Wake(DRIVERGsmHandler_t *handler)
+{
+	xSemaphoreGive(GsmLineSemaphore);
 }
 
 /**
-  * @brief Task for transmition message to gsm module
+  * @brief Put message to GSM module.
+  * @param handler      GSM handle.
+  * @param msg       	Message to send to GSM .
+  * @retval DRIVERState_t status
   */
-void TxTaskGsm(void* pvParameters)
+DRIVERState_t DRIVER_GSM_Write(DRIVERGsmHandler_t *handler, const uint8_t* msg, uint32_t msgSize)
 {
-	DRIVERGsmHandler_t * handler = pvParameters;
-	uint8_t txBuff[2000] = {0};
-	for(;;)
+	DRIVERGsmMsg_t queueMsg;
+
+	queueMsg.startMsg = (uint8_t *) msg;
+	queueMsg.sizeMsg = msgSize;
+
+#if DRIVER_TRACE_ENABLE
+	/* At command is traced with 4 characters after "at", other data only with size */
+	if(msgSize > 2 && (msg[0] == 'a' || msg[0] == 'A') && (msg[1] == 't' || msg[1] == 'T'))
 	{
-		DRIVERGsmMsg_t msg = {.startMsg = txBuff, .sizeMsg = 0};
-		xQueueReceive(GsmQueueTransmit, &msg, portMAX_DELAY);
-		HAL_UART_Transmit(handler->uartBase, msg.startMsg, msg.sizeMsg, HAL_MAX_DELAY);
+		uint32_t command = 0;
+		for(uint32_t i = 2; i < 6 && i < msgSize; i++) command |= (uint32_t)msg[i] << (8 * (i - 2));
+		DRIVER_TRACE(TRACE_AT_START, msgSize, command);
 	}
+	else
+		DRIVER_TRACE(TRACE_GSM_DATA, msgSize, 0);
+#endif
+
+	/* Send message via queue to io task and wait until it is transmitted */
+	if(xQueueSend(handler->GsmQueueTransmit,(void*) &queueMsg, 0) != pdTRUE)
+		return DRIVER_ERROR;
+
+	return DRIVER_IO_Transmit(&gsmChannel, portMAX_DELAY);
+
 }
 
 /**
-  * @brief Task for receiving message from gsm module
+  * @brief Take next message for io task to transmit to gsm module.
+  * @param context      GSM handle.
+  * @param data         Start of message.
+  * @param size         Size of message.
+  * @retval bool true if there is message
   */
-void RxTaskGsm(void* pvParameters)
+static bool nextTxGsm(void *context, uint8_t **data, uint32_t *size)
 {
-	DRIVERGsmHandler_t * handler = pvParameters;
-	uint32_t i = 0;
-	for(;;)
-	{
-		xTaskNotifyWait( 0x00, /* Don't clear any notification bits on entry. */
-		 ULONG_MAX, /* Reset the notification value to 0 on exit. */
-		 NULL, /* Notified value is ommited. */
-		 portMAX_DELAY ); /* Block indefinitely. */
-
-		uint32_t j = 0;
-		for(;j != sizeof(rxStart);j++) queueMsg.startMsg[j] = 0;
-		queueMsg.sizeMsg = 0;
-		i = 0;
-
-		__HAL_UART_DISABLE_IT(handler->uartBase, UART_IT_RXNE);
-
-		/* set size of message */
-		if(currentCircularBufferGsm.pointerWrite >= currentCircularBufferGsm.pointerRead)
-			queueMsg.sizeMsg = currentCircularBufferGsm.pointerWrite - currentCircularBufferGsm.pointerRead;
-		else
-			queueMsg.sizeMsg = (currentCircularBufferGsm.pointerEnd - currentCircularBufferGsm.pointerRead) + 1 +
-			(currentCircularBufferGsm.pointerWrite - currentCircularBufferGsm.pointerStart);
-
-		/* Copy whatever is in receiving buffer */
-		while(currentCircularBufferGsm.pointerRead != currentCircularBufferGsm.pointerWrite)
-		{
-			queueMsg.startMsg[i++] = *currentCircularBufferGsm.pointerRead;
-			*currentCircularBufferGsm.pointerRead = 0;
-			if( currentCircularBufferGsm.pointerRead != currentCircularBufferGsm.pointerEnd)
-			{
-				currentCircularBufferGsm.pointerRead++;
-			}
-			else
-			{
-				currentCircularBufferGsm.pointerRead = currentCircularBufferGsm.pointerStart;
-			}
-
-		}
-		__HAL_UART_ENABLE_IT(handler->uartBase, UART_IT_RXNE);
-		/* Send message to queue */
-		xQueueSend(GsmQueueReceive, (void *) &queueMsg, 0);
+	DRIVERGsmHandler_t * handler = context;
+	DRIVERGsmMsg_t msg;
 
+	if(xQueueReceive(GsmQueueTransmit, &msg, 0) != pdTRUE)
+	{
+		handler->State = GSM_STATE_IDLE;
+		return false;
 	}
+
+	handler->State = GSM_STATE_TRANSMIT;
+	*data = msg.startMsg;
+	*size = msg.sizeMsg;
+	return true;
 }
+
 /**
   * @brief Bring receiving buffer for gsm module to its initial state.
   * @param handler      GSM handle.
@@ -294,10 +372,14 @@ void RxTaskGsm(void* pvParameters)
   */
 DRIVERState_t DRIVER_GSM_Flush(DRIVERGsmHandler_t *handler)
 {
+	xSemaphoreTake(GsmReadMutex, portMAX_DELAY);
+
 	currentCircularBufferGsm.pointerWrite = currentCircularBufferGsm.pointerStart;
 	currentCircularBufferGsm.pointerRead  = currentCircularBufferGsm.pointerStart;
 
 	memset((uint8_t*)currentGsmHandle->rxBuffer,0,currentGsmHandle->rxSize);
 
+	xSemaphoreGive(GsmReadMutex);
+
 	return DRIVER_OK;
 }
@@ -10,6 +10,7 @@
 #define DRIVER_GSM_GSM_H_
 
 #include <driver_common.h>
+#include <driver_trace.h>
 
 /**
   * @brief  GSM INIT Status structures definition
@@ -45,7 +46,11 @@ typedef struct __DRIVERGsmHandler_t
 
 	QueueHandle_t GsmQueueTransmit;				/*!< Queue for transmitting messages to UART  			 */
 
-	QueueHandle_t GsmQueueReceive;				/*!< Queue for receiving messages from UART  			 */
+	uint32_t readCount;							/*!< Number of reads								 	 */
+
+	uint32_t readCycles;						/*!< Sum of core cycles spent in reads				 	 */
+
+	uint32_t readMaxCycles;						/*!< Longest read in core cycles					 	 */
 
 	UART_HandleTypeDef* uartBase;				/*!< UART handle 						   			 	 */
 
@@ -81,6 +86,9 @@ DRIVERState_t DRIVER_GSM_Init(DRIVERGsmHandler_t *handler, DRIVERGsmConfig_t *co
 
 /* IO operation functions ***********************************************************************************/
 DRIVERState_t DRIVER_GSM_Read(DRIVERGsmHandler_t *handler, uint8_t* userBuffer, uint32_t* size);
+DRIVERState_t DRIVER_GSM_ReadLimit(DRIVERGsmHandler_t *handler, uint8_t* userBuffer, uint32_t* size, uint32_t bufSize);
+DRIVERState_t DRIVER_GSM_WaitData(DRIVERGsmHandler_t *handler, uint32_t timeout);
+void DRIVER_GSM_Wake(DRIVERGsmHandler_t *handler);
 DRIVERState_t DRIVER_GSM_Write(DRIVERGsmHandler_t *handler, const uint8_t* msg, uint32_t msgSize);
 DRIVERState_t DRIVER_GSM_Flush(DRIVERGsmHandler_t *handler);
 
@@ -0,0 +1,269 @@
+/**
+//  *******************************************************************************************************************
+  * @file    driver_io.c
+  * @author  Valentina Denic
+  * @brief   IO module driver.
+  *          This file provides firmware functions to manage the following
+  *          functionalities of the io task.
+  *           + Registration of uart channels
+  *           + Signaling of events from interrupt routines and tasks
+  *           + Transmission of messages with uart interrupt
+  *           + Servicing of all channels in one task
+  *
+  *
+  @verbatim
+ ======================================================================================================================
+                        ##### How to use this driver #####
+ ======================================================================================================================
+  [..]
+    One task waits on event bits that uart interrupt routines, transmit complete callback
+    and tasks set in its notification value, every channel has its own byte of bits. When
+    task wakes up it calls service function of every channel that has events and then
+    starts transmission of next message of channel if uart is free. Messages are sent with
+    uart interrupt, so task doesn't wait while characters leave uart and one wakeup can
+    service receive and transmit of several channels. Task that puts message waits until
+    all messages of channel are transmitted, so message can be in its own buffer.
+    The IO module driver is used by console and gsm drivers as follows:
+
+    (#) Declare a DRIVERIoChannel_t for uart and register it with DRIVER_IO_Register()
+        function with service function, function that takes next message from transmit
+        queue and driver handle as context, io task is created with first channel
+    (#) Call DRIVER_IO_SignalFromISR() in uart interrupt with IO_EVENT_RX, service
+        function is then called in io task with same bits
+    (#) Put message to transmit queue of driver and call DRIVER_IO_Transmit(), it
+        returns when channel transmitted all messages
+
+  @endverbatim
+  *
+  **********************************************************************************************************************
+  */
+
+
+/* Includes -----------------------------------------------------------------------------------------------------------*/
+#include <driver_io.h>
+#include <driver_memory.h>
+
+/* Mask of event bits of one channel */
+#define IO_CHANNEL_MASK					((1UL << DRIVER_IO_CHANNEL_BITS) - 1UL)
+
+/* Registered channels, index is number of channel */
+static DRIVERIoChannel_t *ioChannels[DRIVER_IO_MAX_CHANNELS];
+
+/* Number of registered channels */
+static uint32_t ioChannelNumber;
+
+/* Handle of io task for notifying */
+static TaskHandle_t IoTaskHandle;
+
+/* Bit of every channel is set while channel has nothing to transmit */
+static EventGroupHandle_t ioTxIdle;
+
+/* Number of wakeups of io task */
+static volatile uint32_t ioWakeCount;
+
+void IoTask(void* pvParameters);
+
+/**
+  * @brief Start transmission of next message of channel or mark channel as idle.
+  * @param channel      IO channel.
+  * @retval void
+  */
+static void transmitNext(DRIVERIoChannel_t *channel)
+{
+	uint8_t *data;
+	uint32_t size;
+
+	if(channel->TxNext != NULL)
+	{
+		while(channel->TxNext(channel->context, &data, &size))
+		{
+			if(size == 0) continue;
+
+			/* Flag is set before start, transmit complete can come before function returns */
+			channel->txBusy = true;
+			if(HAL_UART_Transmit_IT(channel->uartBase, data, (uint16_t)size) == HAL_OK)
+			{
+				channel->txCount++;
+				return;
+			}
+			channel->txBusy = false;
+			channel->txErrorCount++;
+		}
+	}
+
+	xEventGroupSetBits(ioTxIdle, 1UL << channel->number);
+}
+
+/**
+  * @brief Register channel and create io task with first channel.
+  * @param channel          IO channel.
+  * @param config 			Configuration handle.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t DRIVER_IO_Register(DRIVERIoChannel_t *channel, DRIVERIoConfig_t *config)
+{
+	/* Check the configuration handle allocation */
+	if(channel == NULL || config == NULL || config->uartBase == NULL)
+	{
+		return DRIVER_ERROR;
+	}
+
+	if(ioChannelNumber == DRIVER_IO_MAX_CHANNELS)
+	{
+		return DRIVER_ERROR;
+	}
+
+	if(ioTxIdle == NULL)
+	{
+		ioTxIdle = xEventGroupCreate();
+		if(ioTxIdle == NULL)
+		{
+			/* The event group could not be created. */
+			return DRIVER_ERROR;
+		}
+	}
+
+	if(IoTaskHandle == NULL)
+	{
+		if(xTaskCreate(IoTask,"IoTask", DRIVER_IO_TASK_STACK,NULL,DRIVER_IO_TASK_PRIORITY,&IoTaskHandle) != pdPASS)
+		{
+			/* The task could not be created. */
+			return DRIVER_ERROR;
+		}
+	}
+
+	channel->uartBase 		= config->uartBase;
+
+	channel->Service 		= config->Service;
+
+	channel->TxNext 		= config->TxNext;
+
+	channel->context 		= config->context;
+
+	channel->txBusy 		= false;
+
+	channel->eventCount 	= 0;
+
+	channel->txCount 		= 0;
+
+	channel->txErrorCount 	= 0;
+
+	channel->number 		= ioChannelNumber;
+
+	channel->InitState 		= IO_INIT;
+
+	/* Channel is visible to io task only when it is complete */
+	xEventGroupSetBits(ioTxIdle, 1UL << channel->number);
+	ioChannels[ioChannelNumber++] = channel;
+
+	return DRIVER_OK;
+}
+
+/**
+  * @brief Set events of channel from task.
+  * @param channel      IO channel.
+  * @param events       Bits of DRIVERIoEvent_t.
+  * @retval void
+  */
+void DRIVER_IO_Signal(DRIVERIoChannel_t *channel, uint32_t events)
+{
+	xTaskNotify(IoTaskHandle, (events & IO_CHANNEL_MASK) << (channel->number * DRIVER_IO_CHANNEL_BITS), eSetBits);
+}
+
+/**
+  * @brief Set events of channel from interrupt routine, io task runs right after interrupt.
+  * @param channel      IO channel.
+  * @param events       Bits of DRIVERIoEvent_t.
+  * @retval void
+  */
+HOT_FUNC void DRIVER_IO_SignalFromISR(DRIVERIoChannel_t *channel, uint32_t events)
+{
+	BaseType_t woken = pdFALSE;
+
+	if(IoTaskHandle == NULL) return;
+
+	xTaskNotifyFromISR(IoTaskHandle, (events & IO_CHANNEL_MASK) << (channel->number * DRIVER_IO_CHANNEL_BITS), eSetBits, &woken);
+	portYIELD_FROM_ISR(woken);
+}
+
+/**
+  * @brief Start transmission of messages that are in transmit queue of channel and wait until they are sent.
+  * @param channel      IO channel.
+  * @param timeout      Timeout duration.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t DRIVER_IO_Transmit(DRIVERIoChannel_t *channel, uint32_t timeout)
+{
+	EventBits_t bit = 1UL << channel->number;
+
+	/* Message is already in queue, so io task can't find queue empty before it takes message */
+	xEventGroupClearBits(ioTxIdle, bit);
+	DRIVER_IO_Signal(channel, IO_EVENT_TX);
+
+	if((xEventGroupWaitBits(ioTxIdle, bit, pdFALSE, pdTRUE, timeout) & bit) == 0)
+		return DRIVER_TIMEOUT;
+
+	return DRIVER_OK;
+}
+
+/**
+  * @brief Number of wakeups of io task, every wakeup is one context switch.
+  * @param void
+  * @retval uint32_t number of wakeups
+  */
+uint32_t DRIVER_IO_GetWakeCount(void)
+{
+	return ioWakeCount;
+}
+
+/**
+  * @brief Callback of HAL when interrupt transmission is finished.
+  * @param huart          UART handle.
+  * @retval void
+  */
+HOT_FUNC void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+	for(uint32_t i = 0; i < ioChannelNumber; i++)
+	{
+		if(ioChannels[i]->uartBase == huart)
+		{
+			DRIVER_IO_SignalFromISR(ioChannels[i], IO_EVENT_TX_DONE);
+			return;
+		}
+	}
+}
+
+/**
+  * @brief Task that services events of all channels
+  */
+void IoTask(void* pvParameters)
+{
+	uint32_t events;
+
+	for(;;)
+	{
+		xTaskNotifyWait( 0x00, /* Don't clear any notification bits on entry. */
+		 ULONG_MAX, /* Reset the notification value to 0 on exit. */
+		 &events, /* Events of all channels. */
+		 portMAX_DELAY ); /* Block indefinitely. */
+
+		ioWakeCount++;
+
+		for(uint32_t i = 0; i < ioChannelNumber; i++)
+		{
+			DRIVERIoChannel_t *channel = ioChannels[i];
+			uint32_t channelEvents = (events >> (i * DRIVER_IO_CHANNEL_BITS)) & IO_CHANNEL_MASK;
+
+			if(channelEvents == 0) continue;
+			channel->eventCount++;
+
+			if(channelEvents & IO_EVENT_TX_DONE) channel->txBusy = false;
+
+			/* Receive first, service can put echo to transmit queue */
+			if(channel->Service != NULL && (channelEvents & ~(uint32_t)(IO_EVENT_TX | IO_EVENT_TX_DONE)) != 0)
+				channel->Service(channel->context, channelEvents);
+
+			if(!channel->txBusy) transmitNext(channel);
+		}
+	}
+}
@@ -0,0 +1,96 @@
+/**
+  ******************************************************************************************************************************
+  * @file    driver_io.h
+  * @author  Valentina Denic
+  * @brief   This file contains all the functions prototypes for the IO
+  *          module driver (one task that services all uart channels).
+  ******************************************************************************************************************************
+  */
+
+#ifndef DRIVER_IO_IO_H_
+#define DRIVER_IO_IO_H_
+
+#include <driver_common.h>
+#include "event_groups.h"
+
+/* Largest number of channels that io task services */
+#define DRIVER_IO_MAX_CHANNELS			4U
+
+/* Number of event bits of every channel in notification value of io task */
+#define DRIVER_IO_CHANNEL_BITS			8U
+
+/* Stack (in words) and priority of io task, priority is the same as of driver tasks it replaces */
+#define DRIVER_IO_TASK_STACK			512U
+#define DRIVER_IO_TASK_PRIORITY			3U
+
+/**
+  * @brief  IO INIT Status structures definition
+  */
+typedef enum
+{
+  IO_INIT			= 0x00,						/*!< Io initialization status ok  						 */
+  IO_NOINIT			= 0x01						/*!< Io initialization status error						 */
+} DRIVERIoInit;
+
+/**
+  * @brief  IO event definition, events of one channel are bits of one byte
+  */
+typedef enum
+{
+  IO_EVENT_RX		= 0x01,						/*!< Character received in uart interrupt				 */
+  IO_EVENT_TX		= 0x02,						/*!< Message put to transmit queue of channel			 */
+  IO_EVENT_TX_DONE	= 0x04						/*!< Interrupt or DMA transmission finished				 */
+} DRIVERIoEvent_t;
+
+/**
+  * @brief  DRIVER handle Io channel Structure definition
+  */
+typedef struct __DRIVERIoChannel_t
+{
+	DRIVERIoInit InitState;								/*!< Init parameters     								 */
+
+	uint32_t number;									/*!< Position of channel, its events are in byte number	 */
+
+	UART_HandleTypeDef* uartBase;						/*!< UART handle of channel								 */
+
+	void (*Service)(void *context, uint32_t events);	/*!< Called in io task for events other than transmit	 */
+
+	bool (*TxNext)(void *context, uint8_t **data, uint32_t *size);	/*!< Takes next message to transmit, false if none */
+
+	void *context;										/*!< Argument of Service and TxNext (driver handle)		 */
+
+	volatile bool txBusy;								/*!< Transmission of message is in progress				 */
+
+	uint32_t eventCount;								/*!< Number of wakeups of io task for this channel		 */
+
+	uint32_t txCount;									/*!< Number of transmitted messages						 */
+
+	uint32_t txErrorCount;								/*!< Number of messages that uart didn't accept			 */
+
+}DRIVERIoChannel_t;
+
+/**
+  * @brief  DRIVER configuration Structure definition
+  */
+typedef struct __DRIVERIoConfig_t
+{
+	UART_HandleTypeDef* uartBase;						/*!< Initialized UART handle							 */
+
+	void (*Service)(void *context, uint32_t events);	/*!< Receive service, can be NULL						 */
+
+	bool (*TxNext)(void *context, uint8_t **data, uint32_t *size);	/*!< Transmit queue of driver, can be NULL		 */
+
+	void *context;										/*!< Argument of Service and TxNext						 */
+
+}DRIVERIoConfig_t;
+
+/* Initialization operation functions ******************************************************************************************/
+DRIVERState_t DRIVER_IO_Register(DRIVERIoChannel_t *channel, DRIVERIoConfig_t *config);
+
+/* IO operation functions ******************************************************************************************************/
+void DRIVER_IO_Signal(DRIVERIoChannel_t *channel, uint32_t events);
+void DRIVER_IO_SignalFromISR(DRIVERIoChannel_t *channel, uint32_t events);
+DRIVERState_t DRIVER_IO_Transmit(DRIVERIoChannel_t *channel, uint32_t timeout);
+uint32_t DRIVER_IO_GetWakeCount(void);
+
+#endif /* DRIVER_IO_IO_H_ */
@@ -0,0 +1,149 @@
+/**
+//  *******************************************************************************************************************
+  * @file    driver_memory.c
+  * @author  Valentina Denic
+  * @brief   MEMORY module driver.
+  *          This file provides firmware functions to manage the following
+  *          functionalities of the memory system.
+  *           + Initialization of MPU region for DMA buffers
+  *           + Enabling of instruction and data cache
+  *           + Cache maintenance for buffers that are given to DMA
+  *           + Placement of hot code in ITCM and hot data in DTCM
+  *
+  *
+  @verbatim
+ ======================================================================================================================
+                        ##### How to use this driver #####
+ ======================================================================================================================
+  [..]
+    With data cache enabled, DMA and core can see different content of the same memory:
+    DMA doesn't see data that core left in cache and core reads old cache lines instead
+    of data that DMA wrote. Buffers declared with DRIVER_DMA_BUFFER are placed in first
+    DRIVER_MEMORY_DMA_SIZE bytes of D2 SRAM, which MPU makes non-cacheable, so they need
+    no maintenance. Other data is in cacheable D1 SRAM, except variables declared with
+    HOT_DATA or HOT_BSS, which are in DTCM. DTCM is never cached and DMA1/DMA2 can't reach
+    it, so buffers for DMA must be declared with DRIVER_DMA_BUFFER.
+    Code of functions declared with HOT_FUNC is copied to ITCM by startup code, so it is
+    fetched without wait states in every clock profile. ITCM and DTCM are small (64K and
+    128K with FreeRTOS heap and main stack), so only interrupt handlers and routines that
+    run for every received character or every packet byte are placed there. Host tool
+    Tools/memreport.py lists what linker put in which memory.
+    The MEMORY module driver can be used as follows:
+
+    (#) Call DRIVER_MEMORY_Init() first in main(), before any buffer is used, it sets MPU
+        and enables instruction and data cache
+    (#) Declare every buffer that uart or other peripheral reaches with DMA with
+        DRIVER_DMA_BUFFER, check pointer with DRIVER_MEMORY_IsDmaBuffer() when buffer
+        comes from caller
+    (#) Buffer that must stay cacheable is declared with DRIVER_DMA_CACHED_BUFFER, call
+        DRIVER_MEMORY_Clean() before DMA reads it and DRIVER_MEMORY_Invalidate() after
+        DMA wrote it
+    (#) Declare function with HOT_FUNC and variable with HOT_DATA (initialized) or HOT_BSS
+        (zero) when it must not wait for flash or for cache miss
+
+  @endverbatim
+  *
+  **********************************************************************************************************************
+  */
+
+
+/* Includes -----------------------------------------------------------------------------------------------------------*/
+#include <driver_memory.h>
+
+/* Borders of .dma_buffer section from linker script */
+extern uint8_t _sdma_buffer[];
+extern uint8_t _edma_buffer[];
+
+/**
+  * @brief Set MPU region for DMA buffers, enable caches and zero DMA buffers.
+  * @param void
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t DRIVER_MEMORY_Init(void)
+{
+	MPU_Region_InitTypeDef MPU_InitStruct = {0};
+
+	/* Section must be inside region that MPU makes non-cacheable */
+	if((uint32_t)_sdma_buffer < DRIVER_MEMORY_DMA_BASE ||
+	   (uint32_t)_edma_buffer > DRIVER_MEMORY_DMA_BASE + DRIVER_MEMORY_DMA_SIZE) return DRIVER_ERROR;
+
+	/* D2 SRAM is kept running while core runs */
+	__HAL_RCC_D2SRAM1_CLK_ENABLE();
+	__HAL_RCC_D2SRAM2_CLK_ENABLE();
+	__HAL_RCC_D2SRAM3_CLK_ENABLE();
+
+	HAL_MPU_Disable();
+
+	/* Normal memory, shareable, not cacheable and not bufferable */
+	MPU_InitStruct.Enable = MPU_REGION_ENABLE;
+	MPU_InitStruct.Number = MPU_REGION_NUMBER0;
+	MPU_InitStruct.BaseAddress = DRIVER_MEMORY_DMA_BASE;
+	MPU_InitStruct.Size = DRIVER_MEMORY_DMA_MPU_SIZE;
+	MPU_InitStruct.SubRegionDisable = 0x00;
+	MPU_InitStruct.TypeExtField = MPU_TEX_LEVEL1;
+	MPU_InitStruct.AccessPermission = MPU_REGION_FULL_ACCESS;
+	MPU_InitStruct.DisableExec = MPU_INSTRUCTION_ACCESS_DISABLE;
+	MPU_InitStruct.IsShareable = MPU_ACCESS_SHAREABLE;
+	MPU_InitStruct.IsCacheable = MPU_ACCESS_NOT_CACHEABLE;
+	MPU_InitStruct.IsBufferable = MPU_ACCESS_NOT_BUFFERABLE;
+	HAL_MPU_ConfigRegion(&MPU_InitStruct);
+
+	/* Memory that is not in any region keeps default map */
+	HAL_MPU_Enable(MPU_PRIVILEGED_DEFAULT);
+
+	SCB_EnableICache();
+	SCB_EnableDCache();
+
+	/* Section is not loaded, so startup code doesn't zero it */
+	memset(_sdma_buffer, 0, (uint32_t)(_edma_buffer - _sdma_buffer));
+
+	return DRIVER_OK;
+}
+
+/**
+  * @brief Check if buffer is in non-cacheable region for DMA.
+  * @param address      Start of buffer.
+  * @param size         Size of buffer in bytes.
+  * @retval bool true if DMA can use buffer without cache maintenance
+  */
+bool DRIVER_MEMORY_IsDmaBuffer(const void *address, uint32_t size)
+{
+	uint32_t start = (uint32_t)address;
+
+	return start >= DRIVER_MEMORY_DMA_BASE && size <= DRIVER_MEMORY_DMA_SIZE &&
+		   start - DRIVER_MEMORY_DMA_BASE <= DRIVER_MEMORY_DMA_SIZE - size;
+}
+
+/**
+  * @brief Write cache lines of buffer to memory, called before DMA reads buffer.
+  * @param address      Start of buffer.
+  * @param size         Size of buffer in bytes.
+  * @retval void
+  */
+void DRIVER_MEMORY_Clean(const void *address, uint32_t size)
+{
+	if(size == 0 || DRIVER_MEMORY_IsDmaBuffer(address, size)) return;
+
+	/* Whole lines that hold buffer are cleaned */
+	uint32_t start = (uint32_t)address & ~(DRIVER_MEMORY_CACHE_LINE - 1U);
+	uint32_t end = (uint32_t)address + size;
+
+	SCB_CleanDCache_by_Addr((uint32_t*)start, (int32_t)(end - start));
+}
+
+/**
+  * @brief Drop cache lines of buffer, called after DMA wrote buffer.
+  * @param address      Start of buffer, aligned to cache line.
+  * @param size         Size of buffer in bytes, multiple of cache line.
+  * @retval void
+  */
+void DRIVER_MEMORY_Invalidate(void *address, uint32_t size)
+{
+	if(size == 0 || DRIVER_MEMORY_IsDmaBuffer(address, size)) return;
+
+	/* Whole lines that hold buffer are dropped, so buffer must not share line with other data */
+	uint32_t start = (uint32_t)address & ~(DRIVER_MEMORY_CACHE_LINE - 1U);
+	uint32_t end = (uint32_t)address + size;
+
+	SCB_InvalidateDCache_by_Addr((uint32_t*)start, (int32_t)(end - start));
+}
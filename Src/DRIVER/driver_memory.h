@@ -0,0 +1,53 @@
+/**
+  ******************************************************************************************************************************
+  * @file    driver_memory.h
+  * @author  Valentina Denic
+  * @brief   This file contains all the functions prototypes for the MEMORY
+  *          module driver (caches, MPU regions, DMA buffers and TCM placement).
+  ******************************************************************************************************************************
+  */
+
+#ifndef DRIVER_MEMORY_MEMORY_H_
+#define DRIVER_MEMORY_MEMORY_H_
+
+#include <driver_common.h>
+
+/* Size of data cache line in bytes, cache maintenance works on whole lines */
+#define DRIVER_MEMORY_CACHE_LINE		32U
+
+/* Start and size of non-cacheable region for DMA buffers, it must be the same as .dma_buffer in linker script */
+#define DRIVER_MEMORY_DMA_BASE			0x30000000U
+#define DRIVER_MEMORY_DMA_SIZE			(32U * 1024U)
+#define DRIVER_MEMORY_DMA_MPU_SIZE		MPU_REGION_SIZE_32KB
+
+/* Declare buffer that DMA reads or writes, it is placed in non-cacheable region of D2 SRAM:
+ *     static uint8_t rxBuffer[512] DRIVER_DMA_BUFFER;
+ * Buffers in this region are zeroed by DRIVER_MEMORY_Init(), not by startup code */
+#define DRIVER_DMA_BUFFER				__attribute__((section(".dma_buffer"), aligned(DRIVER_MEMORY_CACHE_LINE)))
+
+/* Declare cacheable buffer that is given to DMA with DRIVER_MEMORY_Clean()/DRIVER_MEMORY_Invalidate(),
+ * its size must be multiple of DRIVER_MEMORY_CACHE_LINE so invalidate doesn't touch neighbours */
+#define DRIVER_DMA_CACHED_BUFFER		__attribute__((aligned(DRIVER_MEMORY_CACHE_LINE)))
+
+/* Function that runs from ITCM without wait states, whatever flash latency is. Startup code copies
+ * it from flash, calls to and from flash go through veneers that linker adds:
+ *     HOT_FUNC void USART3_IRQHandler(void)
+ * It is kept out of line, so compiler doesn't inline copy of it back to flash */
+#define HOT_FUNC						__attribute__((section(".itcm_text"), noinline))
+
+/* Initialized variable that is placed in DTCM, startup code copies its initial value from flash */
+#define HOT_DATA						__attribute__((section(".dtcm_data")))
+
+/* Variable without initial value (or zero) that is placed in DTCM and zeroed by startup code,
+ * initial value other than zero is lost, use HOT_DATA for it */
+#define HOT_BSS							__attribute__((section(".dtcm_bss")))
+
+/* Initialization operation functions ******************************************************************************************/
+DRIVERState_t DRIVER_MEMORY_Init(void);
+
+/* IO operation functions ******************************************************************************************************/
+bool DRIVER_MEMORY_IsDmaBuffer(const void *address, uint32_t size);
+void DRIVER_MEMORY_Clean(const void *address, uint32_t size);
+void DRIVER_MEMORY_Invalidate(void *address, uint32_t size);
+
+#endif /* DRIVER_MEMORY_MEMORY_H_ */
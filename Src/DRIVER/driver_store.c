@@ -0,0 +1,232 @@
+/**
+//  *******************************************************************************************************************
+  * @file    driver_store.c
+  * @author  Valentina Denic
+  * @brief   STORE module driver.
+  *          This file provides firmware functions to manage the following
+  *          functionalities of the store of records in flash.
+  *           + Loading of last valid record of tag
+  *           + Appending of new record and erasing of full sector
+  *
+  *
+  @verbatim
+ ======================================================================================================================
+                        ##### How to use this driver #####
+ ======================================================================================================================
+  [..]
+    Values that firmware learns while it runs (eg. timeouts of at commands) are kept in
+    last flash sector, so they are not lost with reset or power loss. Sector is a log of
+    records: every record is header of one flash word (magic, tag, size and CRC of data)
+    followed by its data rounded up to flash word. New record is appended after the last
+    one and the last valid record of tag is the one that counts, so sector is erased only
+    when it is full (every erase takes about a second and sector can be erased about ten
+    thousand times). Record that was not written to the end because of reset has wrong
+    CRC and is skipped, previous record of tag stays valid.
+    The STORE module driver can be used as follows:
+
+    (#) Take tag for user in DRIVERStoreTag_t
+    (#) Read last record of tag with DRIVER_STORE_Load() function, DRIVER_ERROR means
+        that there is no valid record of that size (defaults are used)
+    (#) Write new record with DRIVER_STORE_Save() function, it blocks calling task while
+        flash is programmed or erased, so it is called rarely and from task with low
+        priority, only one task saves records
+    (#) When sector is full, it is erased and only new record is written, records of
+        other tags are lost, so every user saves its record again after it loads it
+
+  @endverbatim
+  *
+  **********************************************************************************************************************
+  */
+
+
+/* Includes -----------------------------------------------------------------------------------------------------------*/
+#include <driver_store.h>
+#include <driver_memory.h>
+
+/* First word of every record, "STOR" */
+#define STORE_MAGIC				0x53544F52U
+
+/**
+  * @brief  STORE record header Structure definition, it fills one flash word
+  */
+typedef struct
+{
+	uint32_t magic;								/*!< STORE_MAGIC, erased flash has 0xFFFFFFFF	 */
+
+	uint32_t tag;								/*!< DRIVERStoreTag_t of record					 */
+
+	uint32_t size;								/*!< Number of bytes of data					 */
+
+	uint32_t crc;								/*!< CRC-32 of data								 */
+
+	uint32_t reserved[4];						/*!< Rest of flash word, left erased			 */
+
+}StoreHeader_t;
+
+/**
+  * @brief CRC-32 (polynomial 0xEDB88320) of data.
+  * @param data         Data.
+  * @param size         Number of bytes.
+  * @retval uint32_t CRC
+  */
+static uint32_t storeCrc(const uint8_t *data, uint32_t size)
+{
+	uint32_t crc = 0xFFFFFFFFU;
+
+	for(uint32_t i = 0; i < size; i++)
+	{
+		crc ^= data[i];
+		for(uint32_t bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320U & (0U - (crc & 1U)));
+	}
+
+	return ~crc;
+}
+
+/**
+  * @brief Number of bytes of record in flash.
+  * @param size         Number of bytes of data.
+  * @retval uint32_t header and data rounded up to flash word
+  */
+static uint32_t storeRecordSize(uint32_t size)
+{
+	return DRIVER_STORE_WORD + (size + DRIVER_STORE_WORD - 1U) / DRIVER_STORE_WORD * DRIVER_STORE_WORD;
+}
+
+/**
+  * @brief Address after last record, where next record is written.
+  * @param void
+  * @retval uint32_t address
+  */
+static uint32_t storeEnd(void)
+{
+	uint32_t address = DRIVER_STORE_BASE;
+
+	while(address + DRIVER_STORE_WORD <= DRIVER_STORE_BASE + DRIVER_STORE_SIZE)
+	{
+		const StoreHeader_t *header = (const StoreHeader_t*)address;
+
+		/* Erased flash or header that was not written to the end */
+		if(header->magic != STORE_MAGIC || header->size > DRIVER_STORE_MAX_SIZE) break;
+
+		address += storeRecordSize(header->size);
+	}
+
+	return address;
+}
+
+/**
+  * @brief Check if flash is erased, so it can be programmed.
+  * @param address      Start of flash.
+  * @param size         Number of bytes.
+  * @retval bool true if every byte is 0xFF
+  */
+static bool storeErased(uint32_t address, uint32_t size)
+{
+	for(const uint32_t *word = (const uint32_t*)address; word < (const uint32_t*)(address + size); word++)
+	{
+		if(*word != 0xFFFFFFFFU) return false;
+	}
+
+	return true;
+}
+
+/**
+  * @brief Load last valid record of tag.
+  * @param tag          Tag of record.
+  * @param data         Buffer for data.
+  * @param size         Number of bytes of data, record of other size is not valid.
+  * @retval DRIVERState_t DRIVER_ERROR when there is no valid record
+  */
+DRIVERState_t DRIVER_STORE_Load(DRIVERStoreTag_t tag, void *data, uint32_t size)
+{
+	const StoreHeader_t *found = NULL;
+	uint32_t address = DRIVER_STORE_BASE;
+	uint32_t end = storeEnd();
+
+	if(data == NULL || size == 0 || size > DRIVER_STORE_MAX_SIZE) return DRIVER_ERROR;
+
+	for(; address < end; address += storeRecordSize(((const StoreHeader_t*)address)->size))
+	{
+		const StoreHeader_t *header = (const StoreHeader_t*)address;
+
+		if(header->tag == tag && header->size == size &&
+		   storeCrc((const uint8_t*)address + DRIVER_STORE_WORD, size) == header->crc) found = header;
+	}
+
+	if(found == NULL) return DRIVER_ERROR;
+
+	memcpy(data, (const uint8_t*)found + DRIVER_STORE_WORD, size);
+	return DRIVER_OK;
+}
+
+/**
+  * @brief Append record of tag, sector is erased when record doesn't fit.
+  * @param tag          Tag of record.
+  * @param data         Data.
+  * @param size         Number of bytes of data.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t DRIVER_STORE_Save(DRIVERStoreTag_t tag, const void *data, uint32_t size)
+{
+	/* Flash word is programmed from 32-bit aligned buffer */
+	uint32_t word[DRIVER_STORE_WORD / sizeof(uint32_t)] __attribute__((aligned(DRIVER_MEMORY_CACHE_LINE)));
+	StoreHeader_t *header = (StoreHeader_t*)word;
+	HAL_StatusTypeDef status = HAL_OK;
+
+	if(data == NULL || size == 0 || size > DRIVER_STORE_MAX_SIZE) return DRIVER_ERROR;
+
+	uint32_t length = storeRecordSize(size);
+	uint32_t address = storeEnd();
+
+	HAL_FLASH_Unlock();
+
+	/* Full sector or part after last record that is not erased (write was interrupted) */
+	if(address + length > DRIVER_STORE_BASE + DRIVER_STORE_SIZE || !storeErased(address, length))
+	{
+		FLASH_EraseInitTypeDef erase = {.TypeErase = FLASH_TYPEERASE_SECTORS, .Banks = DRIVER_STORE_BANK,
+										.Sector = DRIVER_STORE_SECTOR, .NbSectors = 1,
+										.VoltageRange = FLASH_VOLTAGE_RANGE_3};
+		uint32_t sectorError = 0;
+
+		status = HAL_FLASHEx_Erase(&erase, &sectorError);
+		DRIVER_MEMORY_Invalidate((void*)DRIVER_STORE_BASE, DRIVER_STORE_SIZE);
+		address = DRIVER_STORE_BASE;
+	}
+
+	/* Header is written first, record that is cut by reset fails its CRC */
+	memset(word, 0xFF, sizeof(word));
+	header->magic 	= STORE_MAGIC;
+	header->tag 	= tag;
+	header->size 	= size;
+	header->crc 	= storeCrc(data, size);
+	if(status == HAL_OK) status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_FLASHWORD, address, (uint32_t)word);
+
+	for(uint32_t offset = 0; offset < size && status == HAL_OK; offset += DRIVER_STORE_WORD)
+	{
+		uint32_t part = size - offset < DRIVER_STORE_WORD ? size - offset : DRIVER_STORE_WORD;
+
+		memset(word, 0xFF, sizeof(word));
+		memcpy(word, (const uint8_t*)data + offset, part);
+		status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_FLASHWORD, address + DRIVER_STORE_WORD + offset, (uint32_t)word);
+	}
+
+	HAL_FLASH_Lock();
+
+	/* Core must read new record, not cache lines of erased flash */
+	DRIVER_MEMORY_Invalidate((void*)address, length);
+
+	if(status != HAL_OK || memcmp((const uint8_t*)address + DRIVER_STORE_WORD, data, size) != 0)
+		return DRIVER_ERROR;
+
+	return DRIVER_OK;
+}
+
+/**
+  * @brief Number of bytes that can still be written before sector is erased.
+  * @param void
+  * @retval uint32_t free bytes
+  */
+uint32_t DRIVER_STORE_GetFree(void)
+{
+	return DRIVER_STORE_BASE + DRIVER_STORE_SIZE - storeEnd();
+}
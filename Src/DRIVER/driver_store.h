@@ -0,0 +1,41 @@
+/**
+  ******************************************************************************************************************************
+  * @file    driver_store.h
+  * @author  Valentina Denic
+  * @brief   This file contains all the functions prototypes for the STORE
+  *          module driver (records that are kept in flash over reset and power loss).
+  ******************************************************************************************************************************
+  */
+
+#ifndef DRIVER_STORE_STORE_H_
+#define DRIVER_STORE_STORE_H_
+
+#include <driver_common.h>
+
+/* Flash sector of records, it must be the same as STORE region in linker script. It is last sector
+ * of bank 2 and program runs from bank 1, so fetching of code doesn't stall while sector is written */
+#define DRIVER_STORE_BASE				0x081E0000U
+#define DRIVER_STORE_SIZE				(128U * 1024U)
+#define DRIVER_STORE_BANK				FLASH_BANK_2
+#define DRIVER_STORE_SECTOR				FLASH_SECTOR_7
+
+/* Flash is programmed in words of 32 bytes, every record starts with header of one word */
+#define DRIVER_STORE_WORD				32U
+
+/* Largest data of one record */
+#define DRIVER_STORE_MAX_SIZE			4096U
+
+/**
+  * @brief  STORE tag definition, every user of store has its own record
+  */
+typedef enum
+{
+	STORE_TAG_AT_TIMEOUT	= 0x01				/*!< Learned timeouts of at commands (at_timeout.c)	 */
+} DRIVERStoreTag_t;
+
+/* IO operation functions ******************************************************************************************************/
+DRIVERState_t DRIVER_STORE_Load(DRIVERStoreTag_t tag, void *data, uint32_t size);
+DRIVERState_t DRIVER_STORE_Save(DRIVERStoreTag_t tag, const void *data, uint32_t size);
+uint32_t DRIVER_STORE_GetFree(void);
+
+#endif /* DRIVER_STORE_STORE_H_ */
@@ -0,0 +1,259 @@
+/**
+//  *******************************************************************************************************************
+  * @file    driver_trace.c
+  * @author  Valentina Denic
+  * @brief   TRACE module driver.
+  *          This file provides firmware functions to manage the following
+  *          functionalities of the event trace.
+  *           + Initialization, start and stop of recording
+  *           + Record event in ring function
+  *           + Hooks for FreeRTOS trace macros
+  *           + Dump of ring in text lines function
+  *
+  *
+  @verbatim
+ ======================================================================================================================
+                        ##### How to use this driver #####
+ ======================================================================================================================
+  [..]
+    Every event is one record of 16 bytes (cycle counter of core, event identifier and two
+    arguments) written in ring in RAM, so oldest records are overwritten. Writing is done
+    with interrupts disabled for a few instructions, so it can be called from every task
+    and every interrupt, also from those above configMAX_SYSCALL_INTERRUPT_PRIORITY.
+    Cycle counter runs with core clock, so code that changes clock records every change
+    (TRACE_CLOCK_CHANGE with new and previous clock) and cycles are converted to time
+    piece by piece, with clock that was running when they were counted.
+    The TRACE module driver can be used as follows:
+
+    (#) Set DRIVER_TRACE_ENABLE in FreeRTOSConfig.h to 1, with 0 all hooks are removed
+        by preprocessor, including FreeRTOS trace macros
+    (#) Initialize ring with DRIVER_TRACE_Init() function, recording starts immediately
+    (#) Record event with DRIVER_TRACE() macro
+    (#) Pause and continue recording with DRIVER_TRACE_Stop() and DRIVER_TRACE_Start(),
+        when recording is paused hook only checks one flag
+    (#) Stop recording and call DRIVER_TRACE_Dump() until it returns 0, every call writes
+        as many lines as fit in buffer. Lines are converted to timeline on host with
+        Tools/trace2timeline.py
+
+  @endverbatim
+  *
+  **********************************************************************************************************************
+  */
+
+
+/* Includes -----------------------------------------------------------------------------------------------------------*/
+#include <driver_trace.h>
+#include <driver_memory.h>
+
+/* Ring of records */
+static DRIVERTraceRecord_t traceRing[DRIVER_TRACE_RECORD_NUMBER] HOT_BSS;
+
+/* Number of records written since initialization, index in ring is taken from lower bits */
+static volatile uint32_t traceCount HOT_BSS;
+
+/* Flag that indicates if events are recorded */
+static volatile uint8_t traceRunning HOT_BSS;
+
+/* Number of records at the start of dump */
+static uint32_t traceDumpCount;
+
+/* Names of events used in dump */
+static const char *traceEventName[] =
+{
+	"none", "uart_isr_enter", "uart_isr_exit", "queue_send", "queue_receive", "task_switch",
+	"at_start", "at_complete", "gsm_data", "mqtt_send", "mqtt_receive", "clock_change", "at_urc"
+};
+
+/**
+  * @brief Initialize ring and start recording.
+  * @retval void
+  */
+void DRIVER_TRACE_Init(void)
+{
+	traceRunning 	= 0;
+
+	memset(traceRing, 0, sizeof(traceRing));
+
+	traceCount 		= 0;
+
+	traceDumpCount 	= 0;
+
+	traceRunning 	= 1;
+}
+
+/**
+  * @brief Continue recording events.
+  * @retval void
+  */
+void DRIVER_TRACE_Start(void)
+{
+	traceRunning = 1;
+}
+
+/**
+  * @brief Pause recording events, ring is kept for dump.
+  * @retval void
+  */
+void DRIVER_TRACE_Stop(void)
+{
+	traceRunning = 0;
+}
+
+/**
+  * @brief Write event to ring, can be called from tasks and from every interrupt.
+  * @param event        Event identifier.
+  * @param arg0         First argument of event.
+  * @param arg1         Second argument of event.
+  * @retval void
+  */
+HOT_FUNC void DRIVER_TRACE_Record(DRIVERTraceEvent_t event, uint32_t arg0, uint32_t arg1)
+{
+	if(traceRunning == 0) return;
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	DRIVERTraceRecord_t *record = &traceRing[traceCount & (DRIVER_TRACE_RECORD_NUMBER - 1)];
+	traceCount++;
+
+	record->timestamp 	= DWT->CYCCNT;
+	record->event 		= event;
+	record->arg0 		= arg0;
+	record->arg1 		= arg1;
+
+	__set_PRIMASK(primask);
+}
+
+/**
+  * @brief Hook for traceTASK_SWITCHED_IN() macro of FreeRTOS.
+  * @param taskNumber   Unique number of task.
+  * @param taskName     Name of task, it lives in task control block.
+  * @retval void
+  */
+void DRIVER_TRACE_TaskSwitchedIn(uint32_t taskNumber, const char *taskName)
+{
+	DRIVER_TRACE_Record(TRACE_TASK_SWITCH, taskNumber, (uint32_t)taskName);
+}
+
+/**
+  * @brief Hook for traceQUEUE_SEND() and traceQUEUE_SEND_FROM_ISR() macros of FreeRTOS.
+  * @param queue        Queue handle.
+  * @param waiting      Number of items in queue before send.
+  * @retval void
+  */
+void DRIVER_TRACE_QueueSend(void *queue, uint32_t waiting)
+{
+	DRIVER_TRACE_Record(TRACE_QUEUE_SEND, (uint32_t)queue, waiting);
+}
+
+/**
+  * @brief Hook for traceQUEUE_RECEIVE() and traceQUEUE_RECEIVE_FROM_ISR() macros of FreeRTOS.
+  * @param queue        Queue handle.
+  * @param waiting      Number of items in queue before receive.
+  * @retval void
+  */
+void DRIVER_TRACE_QueueReceive(void *queue, uint32_t waiting)
+{
+	DRIVER_TRACE_Record(TRACE_QUEUE_RECEIVE, (uint32_t)queue, waiting);
+}
+
+/**
+  * @brief Write one record as text line.
+  * @param record       Record from ring.
+  * @param buffer       Buffer for line.
+  * @param size         Size of buffer.
+  * @retval int number of characters that line needs
+  */
+static int formatRecord(const DRIVERTraceRecord_t *record, uint8_t *buffer, uint32_t size)
+{
+	const char *name = record->event < sizeof(traceEventName) / sizeof(traceEventName[0]) ? traceEventName[record->event] : "unknown";
+	const char *label = "";
+	char command[5] = {0};
+
+	switch(record->event){
+	case TRACE_TASK_SWITCH:
+		label = (const char*)record->arg1;
+		break;
+	case TRACE_QUEUE_SEND:
+	case TRACE_QUEUE_RECEIVE:
+		label = pcQueueGetName((QueueHandle_t)record->arg0);
+		if(label == NULL) label = "";
+		break;
+	case TRACE_AT_START:
+		/* First characters of command, packed in second argument */
+		for(uint32_t i = 0; i < 4; i++)
+		{
+			char c = (char)(record->arg1 >> (8 * i));
+			command[i] = (c >= ' ' && c <= '~' && c != ',') ? c : '.';
+		}
+		label = command;
+		break;
+	default:
+		break;
+	}
+
+	return snprintf((char*)buffer, size, "trace,%lu,%s,%lu,%lu,%s\r\n", (unsigned long)record->timestamp, name,
+			(unsigned long)record->arg0, (unsigned long)record->arg1, label);
+}
+
+/**
+  * @brief Find clock of core when oldest record in ring was written.
+  * @param first        Number of oldest record.
+  * @param records      Number of records in ring.
+  * @retval uint32_t clock (in Hz)
+  */
+static uint32_t startClock(uint32_t first, uint32_t records)
+{
+	/* Clock before first change that is still in ring, clock didn't change if there is none */
+	for(uint32_t i = 0; i < records; i++)
+	{
+		const DRIVERTraceRecord_t *record = &traceRing[(first + i) & (DRIVER_TRACE_RECORD_NUMBER - 1)];
+
+		if(record->event == TRACE_CLOCK_CHANGE) return record->arg1;
+	}
+
+	return SystemCoreClock;
+}
+
+/**
+  * @brief Write ring in text lines, recording should be stopped during dump.
+  * @param position     Line where dump continues, set to 0 before first call.
+  * @param buffer       Buffer for lines.
+  * @param size         Size of buffer.
+  * @retval uint32_t number of written characters, 0 when dump is finished
+  */
+uint32_t DRIVER_TRACE_Dump(uint32_t *position, uint8_t *buffer, uint32_t size)
+{
+	uint32_t length = 0;
+
+	if(position == NULL || buffer == NULL || size == 0) return 0;
+
+	if(*position == 0) traceDumpCount = traceCount;
+
+	/* Oldest record that is still in ring */
+	uint32_t records = traceDumpCount < DRIVER_TRACE_RECORD_NUMBER ? traceDumpCount : DRIVER_TRACE_RECORD_NUMBER;
+	uint32_t first = traceDumpCount - records;
+
+	/* Line 0 is header with clock of oldest record, then records, then end line */
+	while(*position <= records + 1)
+	{
+		int written;
+		if(*position == 0)
+			written = snprintf((char*)buffer + length, size - length, "trace,begin,%lu,%lu,%lu\r\n",
+					(unsigned long)startClock(first, records), (unsigned long)records, (unsigned long)first);
+		else if(*position <= records)
+			written = formatRecord(&traceRing[(first + *position - 1) & (DRIVER_TRACE_RECORD_NUMBER - 1)], buffer + length, size - length);
+		else
+			written = snprintf((char*)buffer + length, size - length, "trace,end\r\n");
+
+		/* Line didn't fit, it is written in next call */
+		if(written < 0 || length + written >= size) break;
+
+		length += written;
+		(*position)++;
+	}
+
+	buffer[length] = '\0';
+
+	return length;
+}
@@ -0,0 +1,75 @@
+/**
+  ******************************************************************************************************************************
+  * @file    driver_trace.h
+  * @author  Valentina Denic
+  * @brief   This file contains all the functions prototypes for the TRACE
+  *          module driver (ring of binary event records).
+  ******************************************************************************************************************************
+  */
+
+#ifndef DRIVER_TRACE_TRACE_H_
+#define DRIVER_TRACE_TRACE_H_
+
+#include <driver_common.h>
+#include <queue.h>
+#include <stdio.h>
+
+/* Number of records in ring, must be power of 2 */
+#ifndef DRIVER_TRACE_RECORD_NUMBER
+#define DRIVER_TRACE_RECORD_NUMBER		256U
+#endif
+
+/* Record event only when tracing is compiled in (DRIVER_TRACE_ENABLE in FreeRTOSConfig.h) */
+#if DRIVER_TRACE_ENABLE
+#define DRIVER_TRACE(event, arg0, arg1)	DRIVER_TRACE_Record((event), (uint32_t)(arg0), (uint32_t)(arg1))
+#else
+#define DRIVER_TRACE(event, arg0, arg1)	((void)0)
+#endif
+
+/**
+  * @brief  TRACE event identifiers definition
+  */
+typedef enum
+{
+	TRACE_UART_ISR_ENTER	= 0x01,			/*!< Uart interrupt entered, arg0 is number of uart				 */
+	TRACE_UART_ISR_EXIT		= 0x02,			/*!< Uart interrupt left, arg0 is number of uart				 */
+	TRACE_QUEUE_SEND		= 0x03,			/*!< Item sent to queue, arg0 is queue, arg1 items in queue		 */
+	TRACE_QUEUE_RECEIVE		= 0x04,			/*!< Item taken from queue, arg0 is queue, arg1 items in queue	 */
+	TRACE_TASK_SWITCH		= 0x05,			/*!< Task switched in, arg0 is task number, arg1 its name		 */
+	TRACE_AT_START			= 0x06,			/*!< At command written to gsm, arg0 is size, arg1 4 characters	 */
+	TRACE_AT_COMPLETE		= 0x07,			/*!< Answer on at command, arg0 is DRIVERState_t, arg1 size		 */
+	TRACE_GSM_DATA			= 0x08,			/*!< Data (not at command) written to gsm, arg0 is size			 */
+	TRACE_MQTT_SEND			= 0x09,			/*!< Mqtt packet sent, arg0 is packet type, arg1 size			 */
+	TRACE_MQTT_RECEIVE		= 0x0A,			/*!< Mqtt message received, arg0 is size, arg1 topic length		 */
+	TRACE_CLOCK_CHANGE		= 0x0B,			/*!< Core clock changed, arg0 is new clock, arg1 previous (Hz)	 */
+	TRACE_AT_URC			= 0x0C			/*!< Unsolicited line dispatched, arg0 is ATUrc_t, arg1 size	 */
+} DRIVERTraceEvent_t;
+
+/**
+  * @brief  TRACE record Structure definition
+  */
+typedef struct
+{
+	uint32_t timestamp;							/*!< Cycle counter of core when event occured			 */
+
+	uint32_t event;								/*!< Event identifier (DRIVERTraceEvent_t)				 */
+
+	uint32_t arg0;								/*!< First argument of event							 */
+
+	uint32_t arg1;								/*!< Second argument of event							 */
+
+}DRIVERTraceRecord_t;
+
+/* Initialization operation functions ******************************************************************************************/
+void DRIVER_TRACE_Init(void);
+void DRIVER_TRACE_Start(void);
+void DRIVER_TRACE_Stop(void);
+
+/* IO operation functions ******************************************************************************************************/
+void DRIVER_TRACE_Record(DRIVERTraceEvent_t event, uint32_t arg0, uint32_t arg1);
+void DRIVER_TRACE_TaskSwitchedIn(uint32_t taskNumber, const char *taskName);
+void DRIVER_TRACE_QueueSend(void *queue, uint32_t waiting);
+void DRIVER_TRACE_QueueReceive(void *queue, uint32_t waiting);
+uint32_t DRIVER_TRACE_Dump(uint32_t *position, uint8_t *buffer, uint32_t size);
+
+#endif /* DRIVER_TRACE_TRACE_H_ */
@@ -0,0 +1,167 @@
+/**
+  ********************************************************************************************
+  * @file    arena.c
+  * @author  Valentina Denic
+  * @brief   MIDDLEWARE for temporary buffers of middleware functions.
+  *          This file provides firmware functions to manage the following
+  *          functionalities of the scratch arena.
+  *           + Initialization function
+  *           + Bind arena to the calling task
+  *           + Bump allocation of buffers
+  *           + Release of all buffers allocated after a mark
+  *
+  @verbatim
+ ==============================================================================================
+                        ##### How to use this driver #####
+ ==============================================================================================
+  [..]
+    Middleware functions used to keep response and packet buffers of several kilobytes
+    on the stack of the calling task. Instead, every task that calls middleware owns
+    one arena sized from compile time budget and buffers are taken from it.
+    The arena driver can be used as follows:
+
+    (#) Declare storage with ARENA_STORAGE() and ARENAHandler_t handle structure
+    (#) Initialize arena with ARENA_Init() function
+    (#) Call ARENA_Bind() at the start of the task that owns the arena
+    (#) In middleware take arena of running task with ARENA_Current() function,
+        remember its state with ARENA_Mark() and take buffers with ARENA_Alloc()
+        (memory is not zeroed) or ARENA_Calloc() (memory is zeroed)
+    (#) Give back everything allocated after mark with ARENA_Release() function
+        before returning, or bring whole arena to empty state with ARENA_Reset()
+  @endverbatim
+  *
+  *********************************************************************************************
+  */
+
+/* Includes ----------------------------------------------------------------------------------*/
+#include <arena.h>
+
+/**
+  * @brief Initialize arena over given storage.
+  * @param handler      ARENA handle.
+  * @param config       Configuration handle.
+  * @retval ARENAState_t status
+  */
+ARENAState_t ARENA_Init(ARENAHandler_t *handler, ARENAConfig_t *config)
+{
+	/* Check the configuration handle allocation */
+	if (handler == NULL || config == NULL || config->storage == NULL)
+	{
+		if(handler != NULL) handler->initState = ARENA_NO_INIT;
+		return ARENA_ERROR;
+	}
+
+	/* Set handler fields */
+	handler->storage 	= config->storage;
+
+	handler->size 		= config->size;
+
+	handler->offset 	= 0;
+
+	handler->highWater 	= 0;
+
+	handler->failCount 	= 0;
+
+	handler->initState 	= ARENA_INIT;
+
+	return ARENA_OK;
+}
+
+/**
+  * @brief Bind arena to the calling task, middleware called from that task takes buffers from it.
+  * @param handler      ARENA handle.
+  * @retval void
+  */
+void ARENA_Bind(ARENAHandler_t *handler)
+{
+	vTaskSetThreadLocalStoragePointer(NULL, ARENA_TLS_INDEX, handler);
+}
+
+/**
+  * @brief Get arena of the calling task.
+  * @param void
+  * @retval ARENAHandler_t* arena handle or NULL when task has no arena
+  */
+ARENAHandler_t *ARENA_Current(void)
+{
+	return (ARENAHandler_t*)pvTaskGetThreadLocalStoragePointer(NULL, ARENA_TLS_INDEX);
+}
+
+/**
+  * @brief Take buffer from arena, content of buffer is not initialized.
+  * @param handler      ARENA handle.
+  * @param size         Number of bytes.
+  * @retval void* start of buffer or NULL when budget of arena is exceeded
+  */
+void *ARENA_Alloc(ARENAHandler_t *handler, uint32_t size)
+{
+	if(handler == NULL || handler->initState != ARENA_INIT) return NULL;
+
+	/* Round size so next buffer stays aligned */
+	uint32_t alignedSize = (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+
+	if(alignedSize > handler->size - handler->offset)
+	{
+		handler->failCount++;
+		return NULL;
+	}
+
+	void *buffer = handler->storage + handler->offset;
+	handler->offset += alignedSize;
+
+	if(handler->offset > handler->highWater) handler->highWater = handler->offset;
+
+	return buffer;
+}
+
+/**
+  * @brief Take zero initialized buffer from arena.
+  * @param handler      ARENA handle.
+  * @param size         Number of bytes.
+  * @retval void* start of buffer or NULL when budget of arena is exceeded
+  */
+void *ARENA_Calloc(ARENAHandler_t *handler, uint32_t size)
+{
+	void *buffer = ARENA_Alloc(handler, size);
+
+	if(buffer != NULL) memset(buffer, 0, size);
+
+	return buffer;
+}
+
+/**
+  * @brief Remember current state of arena.
+  * @param handler      ARENA handle.
+  * @retval ARENAMark_t mark to pass to ARENA_Release()
+  */
+ARENAMark_t ARENA_Mark(ARENAHandler_t *handler)
+{
+	if(handler == NULL) return 0;
+
+	return handler->offset;
+}
+
+/**
+  * @brief Give back all buffers taken after mark.
+  * @param handler      ARENA handle.
+  * @param mark         Mark returned from ARENA_Mark().
+  * @retval void
+  */
+void ARENA_Release(ARENAHandler_t *handler, ARENAMark_t mark)
+{
+	if(handler == NULL || mark > handler->offset) return;
+
+	handler->offset = mark;
+}
+
+/**
+  * @brief Give back all buffers taken from arena.
+  * @param handler      ARENA handle.
+  * @retval void
+  */
+void ARENA_Reset(ARENAHandler_t *handler)
+{
+	if(handler == NULL) return;
+
+	handler->offset = 0;
+}
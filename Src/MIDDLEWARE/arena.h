@@ -0,0 +1,104 @@
+/**
+  ***************************************************************************************************
+  * @file    arena.h
+  * @author  Valentina Denic
+  * @brief   This file contains all the functions prototypes for the scratch arena
+  *          operations (per task bump allocation of temporary buffers).
+  ***************************************************************************************************
+  */
+
+#ifndef MIDDLEWARE_ARENA_H_
+#define MIDDLEWARE_ARENA_H_
+
+#include <driver_common.h>
+
+/* Every allocation is rounded up to this number of bytes */
+#define ARENA_ALIGNMENT				8U
+
+/* Index of thread local storage pointer that holds arena of the task */
+#define ARENA_TLS_INDEX				0
+
+/* Scratch budget of the task that runs console commands (in bytes) */
+#ifndef ARENA_DEMO_TASK_BUDGET
+#define ARENA_DEMO_TASK_BUDGET		(16U * 1024U)
+#endif
+
+/* Scratch budget of the task that runs asynchronous operations (in bytes) */
+#ifndef ARENA_ASYNC_TASK_BUDGET
+#define ARENA_ASYNC_TASK_BUDGET		(4U * 1024U)
+#endif
+
+/* Scratch budget of the task that repairs connection with broker (in bytes) */
+#ifndef ARENA_LINK_TASK_BUDGET
+#define ARENA_LINK_TASK_BUDGET		(4U * 1024U)
+#endif
+
+/* Declare storage of an arena with correct alignment */
+#define ARENA_STORAGE(name, budget)	uint8_t name[(budget)] __attribute__((aligned(ARENA_ALIGNMENT)))
+
+/**
+  * @brief  ARENA INIT Status structures definition
+  */
+typedef enum
+{
+  ARENA_INIT		= 0x00,				/*!< Arena initialization status initialization ok		 */
+  ARENA_NO_INIT		= 0x01				/*!< Arena initialization status no initialization		 */
+} ARENAInit_t;
+
+/**
+  * @brief  ARENA Status structures definition
+  */
+typedef enum
+{
+	ARENA_OK     	= 0x00,				/*!< Arena status ok		 */
+	ARENA_ERROR	    = 0x01				/*!< Arena status error		 */
+} ARENAState_t;
+
+/**
+  * @brief  ARENA scope mark, offset to which arena is brought back on release
+  */
+typedef uint32_t ARENAMark_t;
+
+/**
+  * @brief  ARENA handle Structure definition
+  */
+typedef struct __ARENAHandler_t
+{
+	ARENAInit_t initState;					/*!< Initial state parameter						 */
+
+	uint8_t *storage;						/*!< Start of memory that arena hands out			 */
+
+	uint32_t size;							/*!< Budget of arena in bytes						 */
+
+	uint32_t offset;						/*!< First free byte in storage					 */
+
+	uint32_t highWater;						/*!< Largest offset reached since initialization	 */
+
+	uint32_t failCount;						/*!< Number of allocations that didn't fit in budget */
+
+}ARENAHandler_t;
+
+/**
+  * @brief  ARENA configuration Structure definition
+  */
+typedef struct __ARENAConfig_t
+{
+	uint8_t *storage;						/*!< Memory declared with ARENA_STORAGE()	 */
+
+	uint32_t size;							/*!< Size of storage in bytes				 */
+
+}ARENAConfig_t;
+
+/* Initialization operation functions ****************************************************************/
+ARENAState_t ARENA_Init(ARENAHandler_t *handler, ARENAConfig_t *config);
+void ARENA_Bind(ARENAHandler_t *handler);
+
+/* IO operation functions ****************************************************************************/
+ARENAHandler_t *ARENA_Current(void);
+void *ARENA_Alloc(ARENAHandler_t *handler, uint32_t size);
+void *ARENA_Calloc(ARENAHandler_t *handler, uint32_t size);
+ARENAMark_t ARENA_Mark(ARENAHandler_t *handler);
+void ARENA_Release(ARENAHandler_t *handler, ARENAMark_t mark);
+void ARENA_Reset(ARENAHandler_t *handler);
+
+#endif /* MIDDLEWARE_ARENA_H_ */
@@ -0,0 +1,224 @@
+/**
+  ********************************************************************************************
+  * @file    async.c
+  * @author  Valentina Denic
+  * @brief   MIDDLEWARE for asynchronous operations of gsm and mqtt.
+  *          This file provides firmware functions to manage the following
+  *          functionalities of the asynchronous operations.
+  *           + Initialization function that starts async task
+  *           + Queue of operations from several tasks
+  *           + Completion with callback, task notification or polling
+  *           + Waiting for operation with timeout
+  *
+  @verbatim
+ ==============================================================================================
+                        ##### How to use this driver #####
+ ==============================================================================================
+  [..]
+    Functions of gsm.c and mqtt.c block calling task until gsm answers, which can take
+    seconds. Their *_Async variants (GSM_SendToServer_Async(), MQTT_Publish_Async()...)
+    fill ASYNCOperation_t with function, handle and arguments and put it in queue of async
+    task, so caller returns at once and keeps working (eg. sampling sensors). Async task
+    runs operations one by one with the same blocking function, commands still go through
+    queues of at engine, so they can't mix with commands of other tasks. When function
+    returns, its status is in operation, Complete callback is called in async task and
+    task that submitted operation is notified. Async task has its own arena for answers
+    of gsm and priority below at task, so priority ceiling of at engine stays.
+    The async driver can be used as follows:
+
+    (#) Declare a ASYNCHandler_t handle structure and initialize it with ASYNC_Init()
+        after at engine and arena of async task are initialized and before scheduler is
+        started
+    (#) Declare ASYNCOperation_t (it and all arguments of function must live until
+        operation is done), set Complete callback and context if they are needed and
+        start operation with *_Async variant of function
+    (#) Check if operation is done with ASYNC_Poll() function, or wait for it with
+        ASYNC_Wait() function and timeout, status of function is in result
+    (#) Operation can be submitted again only when it is done, new operation has to
+        be taken for every operation that runs at the same time
+    (#) Any blocking function can run in async task with ASYNC_Start() function, it
+        fills function, handle and arguments of operation and submits it, operation that
+        is already filled is submitted again with ASYNC_Submit() function
+  @endverbatim
+  *
+  *********************************************************************************************
+  */
+
+/* Includes ----------------------------------------------------------------------------------*/
+#include <async.h>
+
+/* Current async handle */
+static ASYNCHandler_t *currentAsyncHandle;
+
+/* Async task declaration */
+void AsyncTask(void* pvParameters);
+
+/**
+  * @brief Initialize async handle and create async task.
+  * @param handler      ASYNC handle.
+  * @param config       Configuration handle.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t ASYNC_Init(ASYNCHandler_t *handler, ASYNCConfig_t *config)
+{
+	/* When we don't have any handler to initalize current handle, exit and return error */
+	if(handler == NULL || config == NULL || config->arenaHandler == NULL)
+		return DRIVER_ERROR;
+
+	handler->initState 		= ASYNC_NO_INIT;
+
+	handler->arenaHandler 	= config->arenaHandler;
+
+	handler->submitCount 	= 0;
+
+	handler->doneCount 		= 0;
+
+	handler->rejectCount 	= 0;
+
+	handler->queue = xQueueCreate( ASYNC_QUEUE_LENGTH, sizeof(ASYNCOperation_t*) );
+	if( handler->queue == NULL )
+	{
+		/* The queue could not be created. */
+		return DRIVER_ERROR;
+	}
+
+	if(xTaskCreate(AsyncTask,"AsyncTask", ASYNC_TASK_STACK,( void *) handler,ASYNC_TASK_PRIORITY,&handler->task) != pdPASS)
+		return DRIVER_ERROR;
+
+	currentAsyncHandle = handler;
+
+	handler->initState 		= ASYNC_INIT;
+
+	return DRIVER_OK;
+}
+
+/**
+  * @brief Put operation in queue of async task, caller doesn't wait for it.
+  * @param operation    Operation with Run function, handle and arguments.
+  * @retval DRIVERState_t DRIVER_ERROR when queue is full or operation still runs
+  */
+DRIVERState_t ASYNC_Submit(ASYNCOperation_t *operation)
+{
+	if(currentAsyncHandle == NULL || currentAsyncHandle->initState != ASYNC_INIT || operation == NULL ||
+	   operation->Run == NULL)
+		return DRIVER_ERROR;
+
+	/* Operation that is queued or runs belongs to async task */
+	if(operation->state == ASYNC_PENDING || operation->state == ASYNC_RUNNING)
+		return DRIVER_ERROR;
+
+	operation->notify 		= xTaskGetCurrentTaskHandle();
+	operation->result 		= DRIVER_ERROR;
+	operation->submitTime 	= TIME_GetTick();
+	operation->doneTime 	= 0;
+	operation->state 		= ASYNC_PENDING;
+
+	/* Caller doesn't block, full queue means that too many operations run at the same time */
+	if(xQueueSend(currentAsyncHandle->queue, (void*) &operation, 0) != pdTRUE)
+	{
+		currentAsyncHandle->rejectCount++;
+		operation->state = ASYNC_IDLE;
+		return DRIVER_ERROR;
+	}
+
+	currentAsyncHandle->submitCount++;
+
+	return DRIVER_OK;
+}
+
+/**
+  * @brief Fill operation with function and its arguments and put it in queue of async task.
+  * @param operation    Operation of caller, its Complete and context are kept.
+  * @param run          Blocking function, it reads handle, timeout and arguments from operation.
+  * @param handler      Handle of gsm or mqtt.
+  * @param timeout      Timeout argument of function.
+  * @param first        First pointer argument.
+  * @param second       Second pointer argument.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t ASYNC_Start(ASYNCOperation_t *operation, uint32_t (*run)(ASYNCOperation_t *operation), void *handler,
+						  uint32_t timeout, const void *first, const void *second)
+{
+	if(operation == NULL || handler == NULL) return DRIVER_ERROR;
+
+	operation->Run 			= run;
+	operation->handler 		= handler;
+	operation->timeout 		= timeout;
+	operation->argument[0] 	= first;
+	operation->argument[1] 	= second;
+
+	return ASYNC_Submit(operation);
+}
+
+/**
+  * @brief Wait until operation is done.
+  * @param operation    Submitted operation.
+  * @param timeout      Time to wait (in miliseconds), ASYNC_WAIT_FOREVER never expires.
+  * @retval DRIVERState_t DRIVER_OK when operation is done (status of function is in result),
+  *         DRIVER_TIMEOUT when it still runs, DRIVER_ERROR when it was never submitted
+  */
+DRIVERState_t ASYNC_Wait(ASYNCOperation_t *operation, uint32_t timeout)
+{
+	if(operation == NULL || operation->state == ASYNC_IDLE) return DRIVER_ERROR;
+
+	uint32_t tickstart = TIME_GetTick();
+
+	/* Notification can be left from earlier operation, so state decides when operation is done */
+	while(operation->state != ASYNC_DONE)
+	{
+		uint32_t elapsed = TIME_GetTick() - tickstart;
+		if(timeout != ASYNC_WAIT_FOREVER && elapsed >= timeout) return DRIVER_TIMEOUT;
+
+		ulTaskNotifyTake(pdTRUE, timeout == ASYNC_WAIT_FOREVER ? portMAX_DELAY : pdMS_TO_TICKS(timeout - elapsed));
+	}
+
+	return DRIVER_OK;
+}
+
+/**
+  * @brief Check if operation is done, caller never waits.
+  * @param operation    Submitted operation.
+  * @retval bool true when result is valid
+  */
+bool ASYNC_Poll(ASYNCOperation_t *operation)
+{
+	return operation != NULL && operation->state == ASYNC_DONE;
+}
+
+/**
+  * @brief Current async handle, for counters.
+  * @param void
+  * @retval ASYNCHandler_t* handle or NULL before ASYNC_Init()
+  */
+ASYNCHandler_t *ASYNC_GetHandler(void)
+{
+	return currentAsyncHandle;
+}
+
+/**
+  * @brief Task that runs queued operations
+  */
+void AsyncTask(void* pvParameters)
+{
+	ASYNCHandler_t * handler = pvParameters;
+	ASYNCOperation_t *operation;
+
+	/* Gsm and mqtt functions called from this task take their buffers from its arena */
+	ARENA_Bind(handler->arenaHandler);
+
+	for(;;)
+	{
+		xQueueReceive(handler->queue, &operation, portMAX_DELAY);
+
+		operation->state = ASYNC_RUNNING;
+		operation->result = operation->Run(operation);
+		operation->doneTime = TIME_GetTick();
+		handler->doneCount++;
+
+		/* Caller can reuse operation as soon as it is done, so notify task is taken before */
+		TaskHandle_t notify = operation->notify;
+		if(operation->Complete != NULL) operation->Complete(operation);
+		operation->state = ASYNC_DONE;
+		if(notify != NULL) xTaskNotifyGive(notify);
+	}
+}
@@ -0,0 +1,130 @@
+/**
+  ***************************************************************************************************
+  * @file    async.h
+  * @author  Valentina Denic
+  * @brief   This file contains all the functions prototypes for the asynchronous operations
+  *          (task that runs blocking gsm and mqtt functions while caller does other work).
+  ***************************************************************************************************
+  */
+
+#ifndef MIDDLEWARE_ASYNC_H_
+#define MIDDLEWARE_ASYNC_H_
+
+#include <driver_common.h>
+#include <arena.h>
+#include <time.h>
+
+/* Number of operations that can wait in queue of async task */
+#ifndef ASYNC_QUEUE_LENGTH
+#define ASYNC_QUEUE_LENGTH			8U
+#endif
+
+/* Stack of async task in words and its priority, it is below at task, so priority ceiling of at
+ * engine stays */
+#define ASYNC_TASK_STACK			768U
+#define ASYNC_TASK_PRIORITY			2U
+
+/* Number of pointer arguments of operation */
+#define ASYNC_ARGUMENTS				2U
+
+/* Timeout of ASYNC_Wait() that never expires */
+#define ASYNC_WAIT_FOREVER			0xFFFFFFFFU
+
+/**
+  * @brief  ASYNC INIT Status structures definition
+  */
+typedef enum
+{
+	ASYNC_INIT		= 0x00,				/*!< Async initialization status initialization ok		 */
+	ASYNC_NO_INIT	= 0x01				/*!< Async initialization status no initialization		 */
+} ASYNCInit_t;
+
+/**
+  * @brief  ASYNC operation state definition
+  */
+typedef enum
+{
+	ASYNC_IDLE		= 0x00,				/*!< Operation was never submitted, default of zeroed one */
+	ASYNC_PENDING	= 0x01,				/*!< Operation waits in queue of async task				 */
+	ASYNC_RUNNING	= 0x02,				/*!< Blocking function of operation runs					 */
+	ASYNC_DONE		= 0x03				/*!< Operation finished, result is valid				 */
+} ASYNCState_t;
+
+/**
+  * @brief  ASYNC operation Structure definition, completion handle that belongs to task that
+  *         submitted it until it is done
+  */
+typedef struct __ASYNCOperation_t
+{
+	uint32_t (*Run)(struct __ASYNCOperation_t *operation);	/*!< Blocking function, called in async task,
+															 it returns status of gsm or mqtt function	 */
+
+	void *handler;								/*!< Handle of gsm or mqtt that function uses				 */
+
+	uint32_t timeout;							/*!< Timeout argument of function							 */
+
+	const void *argument[ASYNC_ARGUMENTS];		/*!< Other arguments, they must live until operation is done */
+
+	void (*Complete)(struct __ASYNCOperation_t *operation);	/*!< Called in async task when operation is done,
+															 can be NULL								 */
+
+	void *context;								/*!< Argument of Complete, not used by async task			 */
+
+	TaskHandle_t notify;						/*!< Task notified when operation is done, task that
+													 submitted it											 */
+
+	volatile ASYNCState_t state;				/*!< State of operation										 */
+
+	volatile uint32_t result;					/*!< Status returned by function (DRIVERState_t or
+													 MQTTState_t), valid when state is ASYNC_DONE			 */
+
+	uint32_t submitTime;						/*!< Time when operation was submitted (in miliseconds)		 */
+
+	uint32_t doneTime;							/*!< Time when operation was done (in miliseconds)			 */
+
+}ASYNCOperation_t;
+
+/**
+  * @brief  ASYNC handle Structure definition
+  */
+typedef struct __ASYNCHandler_t
+{
+	ASYNCInit_t initState;						/*!< Initial state parameter								 */
+
+	QueueHandle_t queue;						/*!< Queue of pointers to submitted operations				 */
+
+	TaskHandle_t task;							/*!< Handle of async task									 */
+
+	ARENAHandler_t *arenaHandler;				/*!< Arena of async task, buffers of functions				 */
+
+	uint32_t submitCount;						/*!< Number of submitted operations							 */
+
+	uint32_t doneCount;							/*!< Number of finished operations							 */
+
+	uint32_t rejectCount;						/*!< Number of operations that didn't fit in queue			 */
+
+}ASYNCHandler_t;
+
+/**
+  * @brief  ASYNC configuration Structure definition
+  */
+typedef struct __ASYNCConfig_t
+{
+	ARENAHandler_t *arenaHandler;				/*!< Initialized arena that async task binds	 */
+
+}ASYNCConfig_t;
+
+/* Initialization operation functions ****************************************************************/
+DRIVERState_t ASYNC_Init(ASYNCHandler_t *handler, ASYNCConfig_t *config);
+
+/* IO operation functions ****************************************************************************/
+DRIVERState_t ASYNC_Submit(ASYNCOperation_t *operation);
+DRIVERState_t ASYNC_Start(ASYNCOperation_t *operation, uint32_t (*run)(ASYNCOperation_t *operation), void *handler,
+						  uint32_t timeout, const void *first, const void *second);
+DRIVERState_t ASYNC_Wait(ASYNCOperation_t *operation, uint32_t timeout);
+
+/* State functions ***********************************************************************************/
+bool ASYNC_Poll(ASYNCOperation_t *operation);
+ASYNCHandler_t *ASYNC_GetHandler(void);
+
+#endif /* MIDDLEWARE_ASYNC_H_ */
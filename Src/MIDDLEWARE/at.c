@@ -0,0 +1,616 @@
+/**
+  ********************************************************************************************
+  * @file    at.c
+  * @author  Valentina Denic
+  * @brief   MIDDLEWARE for at commands of gsm module.
+  *          This file provides firmware functions to manage the following
+  *          functionalities of the at engine.
+  *           + Initialization function that starts at task
+  *           + Queues of commands from several tasks, one for every priority
+  *           + Sending of command and incremental reading of its answer
+  *           + Completion with callback or task notification
+  *           + Routing of unsolicited lines to subscribers (at_urc.c)
+  *           + Timeouts learned from latency of answers (at_timeout.c)
+  *           + Latency statistics of every class of commands (at_latency.c)
+  *
+  @verbatim
+ ==============================================================================================
+                        ##### How to use this driver #####
+ ==============================================================================================
+  [..]
+    Only at task writes commands to gsm and reads their answers, so tasks that use gsm
+    don't have to wait for each other to take it. Every request is described with
+    ATCommand_t: characters of command, final result code of success, timeout, buffer for
+    answer and how caller is told that command is done. Commands that must follow each
+    other without anything between them (command and data after prompt '>') are linked
+    with next pointer and submitted as one chain, which owns gsm until its last command is
+    done. Every chain has priority (keep alive, control or bulk) and waits in queue of its
+    priority, at task takes next chain from queue of keep alive first, so PINGREQ isn't
+    stuck behind data, and counts how long chains of every priority waited. At task has
+    priority above all tasks that submit commands, so task that submitted chain can't be
+    kept from gsm by task with middle priority (no priority inversion, as with
+    priority ceiling). While queues are empty at task sleeps
+    until gsm interrupt routine receives end of line and gives unsolicited lines (new
+    sms, CLOSED...) and other characters (data from server) to subscribers of router
+    (at_urc.c), before every chain it gives them everything that is left in receive
+    buffer of gsm. Then it sends command, sleeps until end of line or prompt, copies new
+    characters after answer it already has, takes unsolicited lines out of them and
+    gives only the rest to matcher of final result codes (at_match.c), which reads every
+    character once and finds codes only at start of line. Command ends with its expected
+    code or with error code, other codes are skipped. Answer that doesn't fit in buffer
+    stays in receive buffer of gsm. Command with class waits for timeout learned from
+    latency of earlier answers of its class (at_timeout.c), its own timeout is only bound.
+    Every command is also counted with its latency from first written character to final
+    result code in statistics of its class (at_latency.c). Command with Line callback gets
+    its answer line by line while gsm sends it (eg. list of all messages in storage) and
+    lines that callback and matcher read are dropped from buffer, so buffer has to hold
+    only few lines, not whole answer. Last line that ended is given only after next one
+    ends, so final result code never comes to callback.
+    The at engine can be used as follows:
+
+    (#) Declare a ATHandler_t handle structure and initialize it with AT_Init() after gsm
+        driver is initialized and before scheduler is started
+    (#) Send command and wait for its answer with AT_Command() function, that is how
+        functions of gsm.c and mqtt.c use it
+    (#) Without waiting, fill ATCommand_t (it and its buffers must live until command is
+        done), set Complete callback or notify task and submit it with AT_Submit(), result
+        and answer are in it when state is AT_COMMAND_DONE
+    (#) Submit chain of commands that already has notify task and wait for it with
+        AT_Execute() function, it is not called from Complete callback
+    (#) Receive unsolicited lines with AT_URC_Subscribe() (at_urc.c), they never stay
+        in answer of command
+    (#) Set priority of first command of chain (AT_PRIORITY_CONTROL is default), time
+        that chains waited in queues is in wait statistics of handle
+  @endverbatim
+  *
+  *********************************************************************************************
+  */
+
+/* Includes ----------------------------------------------------------------------------------*/
+#include <at.h>
+#include <driver_memory.h>
+
+/* Current at engine handle */
+static ATHandler_t *currentAtHandle;
+
+/* At task declaration */
+void AtTask(void* pvParameters);
+
+/**
+  * @brief Initialize at engine and create at task.
+  * @param handler      AT handle.
+  * @param config       Configuration handle.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t AT_Init(ATHandler_t *handler, ATConfig_t *config)
+{
+	/* When we don't have any handler to initalize current handle, exit and return error */
+	if(handler == NULL || config == NULL || config->gsm == NULL)
+		return DRIVER_ERROR;
+
+	handler->initState 		= AT_NOINIT;
+
+	handler->gsm 			= config->gsm;
+
+	handler->current 		= NULL;
+
+	handler->commandCount 	= 0;
+
+	handler->errorCount 	= 0;
+
+	handler->timeoutCount 	= 0;
+
+	handler->wakeCount 		= 0;
+
+	handler->urcCount 		= 0;
+
+	handler->urcLength 		= 0;
+
+	handler->urcBuffer[0] 	= '\0';
+
+	handler->skipLine 		= false;
+
+	memset(handler->wait, 0, sizeof(handler->wait));
+
+	/* Learned timeouts are loaded before first command */
+	AT_TIMEOUT_Init();
+
+	/* Automaton of final result codes is built before first command */
+	if(AT_MATCH_Init() != DRIVER_OK)
+		return DRIVER_ERROR;
+
+	for(uint32_t priority = 0; priority < AT_PRIORITY_NUMBER; priority++)
+	{
+		handler->queue[priority] = xQueueCreate( AT_QUEUE_LENGTH, sizeof(ATCommand_t*) );
+		if( handler->queue[priority] == NULL )
+		{
+			/* The queue could not be created. */
+			return DRIVER_ERROR;
+		}
+	}
+
+	if(xTaskCreate(AtTask,"AtTask", AT_TASK_STACK,( void *) handler,AT_TASK_PRIORITY,&handler->task) != pdPASS)
+	{
+		/* The task could not be created. */
+		return DRIVER_ERROR;
+	}
+
+	currentAtHandle 		= handler;
+
+	handler->initState 		= AT_INIT;
+
+	return DRIVER_OK;
+}
+
+/**
+  * @brief Put chain of commands in queue of at engine, caller doesn't wait for answer.
+  * @param command      First command of chain.
+  * @param timeout      Time to wait for free place in queue (in miliseconds),
+  *                     portMAX_DELAY waits without timeout.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t AT_Submit(ATCommand_t *command, uint32_t timeout)
+{
+	if(currentAtHandle == NULL || currentAtHandle->initState != AT_INIT || command == NULL ||
+	   command->priority >= AT_PRIORITY_NUMBER)
+		return DRIVER_ERROR;
+
+	for(ATCommand_t *link = command; link != NULL; link = link->next)
+	{
+		if(link->response == NULL || link->responseSize == 0) return DRIVER_ERROR;
+
+		link->state 	= AT_COMMAND_QUEUED;
+		link->result 	= DRIVER_TIMEOUT;
+		link->length 	= 0;
+	}
+
+	/* Conversion of portMAX_DELAY to ticks would overflow */
+	TickType_t ticks = timeout == portMAX_DELAY ? portMAX_DELAY : pdMS_TO_TICKS(timeout);
+
+	command->submitTime = TIME_GetTick();
+	if(xQueueSend(currentAtHandle->queue[command->priority], (void*) &command, ticks) != pdTRUE)
+		return DRIVER_TIMEOUT;
+
+	/* At task can sleep until next line from gsm */
+	DRIVER_GSM_Wake(currentAtHandle->gsm);
+
+	return DRIVER_OK;
+}
+
+/**
+  * @brief Submit chain of commands and wait until it is done.
+  * @param command      First command of chain.
+  * @retval DRIVERState_t result of chain
+  */
+DRIVERState_t AT_Execute(ATCommand_t *command)
+{
+	command->notify = xTaskGetCurrentTaskHandle();
+
+	DRIVERState_t state = AT_Submit(command, portMAX_DELAY);
+	if(state != DRIVER_OK) return state;
+
+	/* Notification can be left from earlier command, so state decides when command is done */
+	while(command->state != AT_COMMAND_DONE)
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+	/* Chain ends with first command that didn't succeed */
+	for(; command != NULL; command = command->next)
+		if(command->result != DRIVER_OK) return command->result;
+
+	return DRIVER_OK;
+}
+
+/**
+  * @brief Send one command to gsm and wait for its answer.
+  * @param command      Characters of command.
+  * @param commandSize  Number of characters of command.
+  * @param response     Buffer for answer.
+  * @param responseSize Size of buffer for answer.
+  * @param length       Number of characters of answer.
+  * @param timeout      Time for answer (in miliseconds).
+  * @param expect       Final result code of success, NULL to collect answer until timeout.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t AT_Command(const uint8_t *command, uint32_t commandSize, uint8_t *response, uint32_t responseSize,
+						 uint32_t *length, uint32_t timeout, const uint8_t *expect)
+{
+	ATCommand_t request = {.command = command, .commandSize = commandSize, .expect = expect, .timeout = timeout,
+						   .response = response, .responseSize = responseSize};
+
+	DRIVERState_t state = AT_Execute(&request);
+
+	*length = request.length;
+	return state;
+}
+
+/**
+  * @brief Current at engine handle, for counters.
+  * @param void
+  * @retval ATHandler_t* handle or NULL before AT_Init()
+  */
+ATHandler_t *AT_GetHandler(void)
+{
+	return currentAtHandle;
+}
+
+/**
+  * @brief Give new part of answer to matcher until expected or error result code.
+  * @param command      Command whose answer is searched.
+  * @param matcher      Matcher of answer.
+  * @param expected     Result code of success, AT_RESULT_NONE when only error codes end command.
+  * @param scan         First character that wasn't read yet, moved to first unread character.
+  * @param end          End of characters that matcher can read.
+  * @retval DRIVERState_t DRIVER_TIMEOUT while there is no final result code
+  */
+HOT_FUNC static DRIVERState_t searchAnswer(ATCommand_t *command, ATMatcher_t *matcher, ATResult_t expected, uint32_t *scan,
+										   uint32_t end)
+{
+	while(*scan < end)
+	{
+		uint32_t used;
+		ATResult_t code = AT_MATCH_Feed(matcher, command->response + *scan, end - *scan, &used);
+		*scan += used;
+
+		if(code == AT_RESULT_NONE) break;
+
+		/* Successfully received response from gsm */
+		if(code == expected || code == AT_RESULT_EXPECT)
+		{
+			command->code = code;
+			return DRIVER_OK;
+		}
+
+		/* Badly received response from gsm, other codes (eg. "OK" before "CONNECT OK") are skipped */
+		if(AT_MATCH_IsError(code))
+		{
+			command->code = code;
+			return DRIVER_ERROR;
+		}
+	}
+
+	return DRIVER_TIMEOUT;
+}
+
+/**
+  * @brief Take unsolicited lines out of new part of answer and give them to subscribers.
+  * @param handler      AT handle.
+  * @param command      Command whose answer is read.
+  * @param line         Start of first line that didn't end, moved after lines that ended.
+  * @param safe         End of characters that matcher can read, line that can still become
+  *                     unsolicited code is not given to matcher.
+  * @retval ATResult_t result code of unsolicited line that ends command, AT_RESULT_NONE if none
+  */
+HOT_FUNC static ATResult_t routeAnswer(ATHandler_t *handler, ATCommand_t *command, uint32_t *line, uint32_t *safe)
+{
+	ATResult_t code = AT_RESULT_NONE;
+
+	while(*line < command->length)
+	{
+		uint8_t *text = command->response + *line;
+		uint32_t rest = command->length - *line;
+		uint8_t *end = memchr(text, '\n', rest);
+
+		if(end == NULL)
+		{
+			/* Rest of line decides, unless no more characters fit in buffer */
+			if(!AT_URC_Possible(text, rest, command->command) || command->length + 1 >= command->responseSize)
+				*safe = command->length;
+			break;
+		}
+
+		uint32_t size = (uint32_t)(end - text) + 1;
+		ATUrc_t urc = AT_URC_Classify(text, size, command->command);
+		if(urc == AT_URC_NONE)
+		{
+			*line += size;
+			continue;
+		}
+
+		handler->urcCount++;
+		AT_URC_Dispatch(urc, text, size);
+		if(AT_URC_Code(urc) != AT_RESULT_NONE) code = AT_URC_Code(urc);
+
+		/* Rest of answer with its '\0' is moved over unsolicited line */
+		memmove(text, end + 1, rest - size + 1);
+		command->length -= size;
+	}
+
+	if(*safe < *line) *safe = *line;
+	return code;
+}
+
+/**
+  * @brief Give lines of answer to Line callback of command and drop lines that callback and
+  *        matcher already read, so answer of any length needs buffer only for few lines.
+  * @param command      Command with Line callback.
+  * @param state        DRIVER_TIMEOUT while there is no final result code.
+  * @param delivered    First character that callback didn't get yet.
+  * @param scan         First character that matcher didn't read yet.
+  * @param line         Start of first line that didn't end.
+  * @param safe         End of characters that matcher can read.
+  * @retval bool true when characters were dropped from full buffer, rest of answer waits in
+  *         receive buffer of gsm
+  */
+static bool streamAnswer(ATCommand_t *command, DRIVERState_t state, uint32_t *delivered, uint32_t *scan, uint32_t *line, uint32_t *safe)
+{
+	/* Full buffer without final result code can't wait for rest of line */
+	bool full = state == DRIVER_TIMEOUT && command->length + 1 >= command->responseSize;
+
+	/* Last line that ended can be final result code, it is given when next line ends */
+	while(*delivered < *line)
+	{
+		uint8_t *text = command->response + *delivered;
+		uint32_t size = (uint32_t)((uint8_t*)memchr(text, '\n', *line - *delivered) - text) + 1;
+		if(*delivered + size >= *line && !full) break;
+
+		command->Line(command, text, size);
+		*delivered += size;
+	}
+
+	/* Line longer than buffer is given in parts, matcher already read it */
+	if(full && *delivered < command->length)
+	{
+		command->Line(command, command->response + *delivered, command->length - *delivered);
+		*delivered 	= command->length;
+		*line 		= command->length;
+	}
+
+	uint32_t drop = *delivered < *scan ? *delivered : *scan;
+	if(drop == 0) return false;
+
+	memmove(command->response, command->response + drop, command->length - drop + 1);
+	command->length -= drop;
+	*delivered 		-= drop;
+	*scan 			-= drop;
+	*line 			-= drop;
+	*safe 			-= drop;
+
+	return full;
+}
+
+/**
+  * @brief Send command to gsm and read its answer until final result code or timeout.
+  * @param handler      AT handle.
+  * @param command      Command.
+  * @retval DRIVERState_t status
+  */
+static DRIVERState_t executeCommand(ATHandler_t *handler, ATCommand_t *command)
+{
+	DRIVERState_t state = DRIVER_TIMEOUT;
+	uint32_t scan = 0;
+	uint32_t line = 0;
+	uint32_t safe = 0;
+	uint32_t delivered = 0;
+	bool more = false;
+
+	/* Expected answer outside of vocabulary is matched by its characters */
+	ATMatcher_t matcher;
+	ATResult_t expected = AT_MATCH_Code(command->expect);
+	AT_MATCH_Start(&matcher, expected == AT_RESULT_NONE ? command->expect : NULL);
+
+	/* Answer collected until timeout has no latency to learn */
+	ATTimeoutClass_t timeoutClass = command->expect != NULL ? command->timeoutClass : AT_TIMEOUT_FIXED;
+	uint32_t timeout = AT_TIMEOUT_Get(timeoutClass, command->timeout);
+
+	command->state 			= AT_COMMAND_RUNNING;
+	command->code 			= AT_RESULT_NONE;
+	command->length 		= 0;
+	command->response[0] 	= '\0';
+	handler->current 		= command;
+	handler->commandCount++;
+
+	/* Signal of line that belongs to earlier answer is dropped */
+	DRIVER_GSM_WaitData(handler->gsm, 0);
+	uint32_t writeTime = TIME_GetTick();
+	DRIVER_GSM_Write(handler->gsm, command->command, command->commandSize);
+
+	uint32_t tickstart = TIME_GetTick();
+	for(;;)
+	{
+		uint32_t length = command->length;
+		DRIVER_GSM_ReadLimit(handler->gsm, command->response, &command->length, command->responseSize);
+
+		/* Every character of answer is read by matcher only once, after router */
+		if(command->length != length)
+		{
+			ATResult_t urcCode = routeAnswer(handler, command, &line, &safe);
+
+			state = searchAnswer(command, &matcher, expected, &scan, safe);
+
+			/* Lines before final result code are given to callback before command ends */
+			if(command->Line != NULL) more = streamAnswer(command, state, &delivered, &scan, &line, &safe);
+			if(state != DRIVER_TIMEOUT) break;
+
+			/* Server closed connection before command got its answer */
+			if(AT_MATCH_IsError(urcCode))
+			{
+				command->code = urcCode;
+				state = DRIVER_ERROR;
+				break;
+			}
+		}
+
+		uint32_t elapsed = TIME_GetTick() - tickstart;
+		if(elapsed >= timeout)
+		{
+			/* Command without result code to wait for is done when its time expires */
+			if(command->expect == NULL) state = DRIVER_OK;
+			break;
+		}
+
+		/* Streamed answer that filled buffer continues in receive buffer of gsm */
+		if(more)
+		{
+			more = false;
+			continue;
+		}
+
+		/* Task sleeps until next line or prompt is received */
+		uint32_t wait = timeout - elapsed;
+		DRIVER_GSM_WaitData(handler->gsm, wait < AT_IDLE_WAIT ? wait : AT_IDLE_WAIT);
+		handler->wakeCount++;
+	}
+
+	AT_TIMEOUT_Record(timeoutClass, TIME_GetTick() - tickstart, state);
+	AT_LATENCY_Record(command->timeoutClass, TIME_GetTick() - writeTime, state, command->expect != NULL);
+	if(command->Line != NULL) command->Line(command, NULL, 0);
+
+	if(state == DRIVER_ERROR) handler->errorCount++;
+	else if(state == DRIVER_TIMEOUT) handler->timeoutCount++;
+
+	DRIVER_TRACE(TRACE_AT_COMPLETE, state, command->length);
+	command->result = state;
+	return state;
+}
+
+/**
+  * @brief Check if line has only its end.
+  * @param text         Start of line.
+  * @param size         Number of characters of line.
+  * @retval bool true for "\r\n" and its parts
+  */
+static bool blankLine(const uint8_t *text, uint32_t size)
+{
+	for(uint32_t i = 0; i < size; i++)
+	{
+		if(text[i] != '\r' && text[i] != '\n') return false;
+	}
+
+	return true;
+}
+
+/**
+  * @brief Give characters that came while no command runs to subscribers.
+  * @param handler      AT handle.
+  * @param drain        True to give also line that didn't end, false to keep it while it can
+  *                     become unsolicited code.
+  * @retval void
+  */
+static void routeIdle(ATHandler_t *handler, bool drain)
+{
+	uint32_t added;
+
+	do
+	{
+		added = handler->urcLength;
+		DRIVER_GSM_ReadLimit(handler->gsm, handler->urcBuffer, &handler->urcLength, AT_URC_BUFFER_SIZE);
+		added = handler->urcLength - added;
+
+		uint32_t start = 0;
+
+		/* Rest of line of failed answer isn't unsolicited line or data */
+		if(handler->skipLine)
+		{
+			uint8_t *end = memchr(handler->urcBuffer, '\n', handler->urcLength);
+			start = end != NULL ? (uint32_t)(end - handler->urcBuffer) + 1 : handler->urcLength;
+			handler->skipLine = end == NULL;
+		}
+
+		while(start < handler->urcLength)
+		{
+			uint8_t *text = handler->urcBuffer + start;
+			uint32_t rest = handler->urcLength - start;
+			uint8_t *end = memchr(text, '\n', rest);
+			uint32_t size = end != NULL ? (uint32_t)(end - text) + 1 : rest;
+
+			/* Line that can still become unsolicited code waits for its end while it has room */
+			if(end == NULL && !drain && handler->urcLength + 1 < AT_URC_BUFFER_SIZE && AT_URC_Possible(text, size, NULL))
+				break;
+
+			ATUrc_t urc = end != NULL ? AT_URC_Classify(text, size, NULL) : AT_URC_NONE;
+			if(urc != AT_URC_NONE)
+			{
+				handler->urcCount++;
+				AT_URC_Dispatch(urc, text, size);
+			}
+			/* Empty lines around unsolicited codes are not data */
+			else if(!blankLine(text, size))
+				AT_URC_Dispatch(AT_URC_DATA, text, size);
+
+			start += size;
+		}
+
+		memmove(handler->urcBuffer, handler->urcBuffer + start, handler->urcLength - start + 1);
+		handler->urcLength -= start;
+	}
+	while(added != 0);
+}
+
+/**
+  * @brief Take next chain, from queue of the highest priority that isn't empty.
+  * @param handler      AT handle.
+  * @param chain        First command of chain.
+  * @retval bool false when all queues are empty
+  */
+static bool takeChain(ATHandler_t *handler, ATCommand_t **chain)
+{
+	static const ATPriority_t order[AT_PRIORITY_NUMBER] = {AT_PRIORITY_KEEPALIVE, AT_PRIORITY_CONTROL, AT_PRIORITY_BULK};
+
+	for(uint32_t i = 0; i < AT_PRIORITY_NUMBER; i++)
+	{
+		if(xQueueReceive(handler->queue[order[i]], chain, 0) != pdTRUE) continue;
+
+		/* Time from submit until chain owns gsm */
+		ATWaitStats_t *wait = &handler->wait[order[i]];
+		uint32_t waited = TIME_GetTick() - (*chain)->submitTime;
+		wait->count++;
+		wait->totalTime += waited;
+		if(waited > wait->maxTime) wait->maxTime = waited;
+		return true;
+	}
+
+	return false;
+}
+
+/**
+  * @brief Task that sends queued commands to gsm
+  */
+void AtTask(void* pvParameters)
+{
+	ATHandler_t * handler = pvParameters;
+	ATCommand_t *chain;
+
+	for(;;)
+	{
+		if(!takeChain(handler, &chain))
+		{
+			/* Line that didn't end and data without end of line are checked every AT_IDLE_WAIT
+			 * miliseconds, otherwise task sleeps until line is received or command is submitted */
+			uint32_t wait = (handler->urcLength != 0 || AT_URC_Subscribed(AT_URC_DATA)) ? AT_IDLE_WAIT : portMAX_DELAY;
+
+			DRIVERState_t state = DRIVER_GSM_WaitData(handler->gsm, wait);
+			routeIdle(handler, state == DRIVER_TIMEOUT);
+			continue;
+		}
+
+		/* Answer of chain starts in empty receive buffer, nothing that came before is lost */
+		routeIdle(handler, true);
+
+		DRIVERState_t state = DRIVER_OK;
+		ATCommand_t *last = chain;
+		for(ATCommand_t *command = chain; command != NULL; command = command->next)
+		{
+			/* Commands after the one that failed are not sent */
+			if(state == DRIVER_OK)
+			{
+				state = executeCommand(handler, command);
+				last = command;
+			}
+
+			if(command != chain) command->state = AT_COMMAND_DONE;
+		}
+		handler->current = NULL;
+
+		/* Only rest of line of answer after error or timeout is dropped, lines after it
+		 * (unsolicited lines, data from server) still go to subscribers */
+		if(state != DRIVER_OK && last->length != 0 && last->response[last->length - 1] != '\n')
+			handler->skipLine = true;
+		routeIdle(handler, false);
+
+		/* Caller can reuse command as soon as it is done, so notify task is taken before */
+		TaskHandle_t notify = chain->notify;
+		if(chain->Complete != NULL) chain->Complete(chain);
+		chain->state = AT_COMMAND_DONE;
+		if(notify != NULL) xTaskNotifyGive(notify);
+	}
+}
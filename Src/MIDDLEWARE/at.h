@@ -0,0 +1,193 @@
+/**
+  ***************************************************************************************************
+  * @file    at.h
+  * @author  Valentina Denic
+  * @brief   This file contains all the functions prototypes for the at engine
+  *          (one task that sends queued at commands to gsm module and waits for their answers).
+  ***************************************************************************************************
+  */
+
+#ifndef MIDDLEWARE_AT_H_
+#define MIDDLEWARE_AT_H_
+
+#include <driver_gsm.h>
+#include <at_match.h>
+#include <at_urc.h>
+#include <at_timeout.h>
+#include <at_latency.h>
+#include <time.h>
+
+/* Number of command chains that can wait in every queue of at engine (one queue for every priority) */
+#ifndef AT_QUEUE_LENGTH
+#define AT_QUEUE_LENGTH				8U
+#endif
+
+/* Stack of at task in words and its priority, it is above tasks that submit commands */
+#define AT_TASK_STACK				512U
+#define AT_TASK_PRIORITY			3U
+
+/* Longest sleep of at task while it waits for answer (in miliseconds), answer that doesn't end
+ * with line or prompt (data from server) is checked at least this often */
+#ifndef AT_IDLE_WAIT
+#define AT_IDLE_WAIT				50U
+#endif
+
+/* Buffer of at task for characters that come while no command runs (unsolicited lines, data) */
+#define AT_URC_BUFFER_SIZE			128U
+
+/**
+  * @brief  AT INIT Status structures definition
+  */
+typedef enum
+{
+	AT_INIT			= 0x00,				/*!< At engine initialization status ok			 */
+	AT_NOINIT		= 0x01				/*!< At engine initialization status error		 */
+} ATInit_t;
+
+/**
+  * @brief  AT command state definition
+  */
+typedef enum
+{
+	AT_COMMAND_QUEUED	= 0x00,			/*!< Command waits in queue of at engine		 */
+	AT_COMMAND_RUNNING	= 0x01,			/*!< Command is sent, answer is being read		 */
+	AT_COMMAND_DONE		= 0x02			/*!< Command finished, result is valid			 */
+} ATCommandState_t;
+
+/**
+  * @brief  AT priority definition, queue of chain, at task takes chain from queue of keep alive first,
+  *         then control and then bulk
+  */
+typedef enum
+{
+	AT_PRIORITY_CONTROL		= 0x00,		/*!< Commands of user and setup, default of zeroed command	 */
+	AT_PRIORITY_KEEPALIVE	= 0x01,		/*!< Packets that keep connection with broker open (PINGREQ) */
+	AT_PRIORITY_BULK		= 0x02,		/*!< Data to server and sms, they can wait					 */
+	AT_PRIORITY_NUMBER		= 0x03		/*!< Number of priorities									 */
+} ATPriority_t;
+
+/**
+  * @brief  AT wait statistics Structure definition, time that chains of one priority waited in queue
+  */
+typedef struct __ATWaitStats_t
+{
+	uint32_t count;								/*!< Number of chains taken from queue			 */
+
+	uint32_t totalTime;							/*!< Sum of waits (in miliseconds)				 */
+
+	uint32_t maxTime;							/*!< Longest wait (in miliseconds)				 */
+
+}ATWaitStats_t;
+
+/**
+  * @brief  AT command Structure definition, it belongs to task that submitted it until it is done
+  */
+typedef struct __ATCommand_t
+{
+	const uint8_t *command;						/*!< Characters written to gsm (at command or data)			 */
+
+	uint32_t commandSize;						/*!< Number of characters of command						 */
+
+	const uint8_t *expect;						/*!< Final result code of success ("OK", ">", "SEND OK"),
+													 other text is matched at start of line, when it is
+													 NULL answer is collected until timeout					 */
+
+	uint32_t timeout;							/*!< Time for answer (in miliseconds), bound of learned
+													 timeout of its class									 */
+
+	ATTimeoutClass_t timeoutClass;				/*!< Class whose latency is learned (at_timeout.c),
+													 AT_TIMEOUT_FIXED (0) uses timeout as it is				 */
+
+	uint8_t *response;							/*!< Buffer for answer, always terminated with '\0'			 */
+
+	uint32_t responseSize;						/*!< Size of buffer for answer								 */
+
+	uint32_t length;							/*!< Number of characters of answer							 */
+
+	void (*Complete)(struct __ATCommand_t *command);	/*!< Called in at task when chain is done, can be NULL	 */
+
+	void (*Line)(struct __ATCommand_t *command, const uint8_t *text, uint32_t size);
+												/*!< Called in at task for every line of answer (without
+													 final result code) as it comes, text is NULL at end
+													 of answer, lines that it got are dropped from buffer,
+													 so answer of any length fits, can be NULL				 */
+
+	void *context;								/*!< Argument of Complete and Line, not used by at engine	 */
+
+	TaskHandle_t notify;						/*!< Task notified when chain is done, can be NULL			 */
+
+	struct __ATCommand_t *next;					/*!< Command sent after this one succeeds, nothing else is
+													 sent to gsm between them								 */
+
+	volatile ATCommandState_t state;			/*!< State of command										 */
+
+	volatile DRIVERState_t result;				/*!< DRIVER_OK, DRIVER_ERROR or DRIVER_TIMEOUT, commands
+													 after first one that didn't succeed aren't sent		 */
+
+	ATResult_t code;							/*!< Result code that ended command, AT_RESULT_NONE
+													 after timeout											 */
+
+	ATPriority_t priority;						/*!< Queue of chain, only first command of chain sets it	 */
+
+	uint32_t submitTime;						/*!< Time when chain was submitted, for wait statistics		 */
+
+}ATCommand_t;
+
+/**
+  * @brief  AT handle Structure definition
+  */
+typedef struct __ATHandler_t
+{
+	ATInit_t initState;							/*!< Initial state parameter								 */
+
+	DRIVERGsmHandler_t *gsm;					/*!< Gsm to which commands are sent							 */
+
+	QueueHandle_t queue[AT_PRIORITY_NUMBER];	/*!< Queues of pointers to first commands of chains, one
+													 for every priority										 */
+
+	TaskHandle_t task;							/*!< Handle of at task										 */
+
+	ATCommand_t * volatile current;				/*!< Command that is running, NULL when engine waits		 */
+
+	uint32_t commandCount;						/*!< Number of sent commands								 */
+
+	uint32_t errorCount;						/*!< Number of commands that ended with error				 */
+
+	uint32_t timeoutCount;						/*!< Number of commands without final result code			 */
+
+	uint32_t wakeCount;							/*!< Number of wakeups of at task for answer				 */
+
+	uint32_t urcCount;							/*!< Number of dispatched unsolicited lines					 */
+
+	ATWaitStats_t wait[AT_PRIORITY_NUMBER];		/*!< Time that chains waited for gsm, for every priority	 */
+
+	uint8_t urcBuffer[AT_URC_BUFFER_SIZE];		/*!< Characters read while no command runs, line that
+													 didn't end waits here for its rest						 */
+
+	uint32_t urcLength;							/*!< Number of characters in urcBuffer						 */
+
+	bool skipLine;								/*!< Rest of line of failed answer is dropped before next
+													 characters are given to subscribers					 */
+
+}ATHandler_t;
+
+/**
+  * @brief  AT configuration Structure definition
+  */
+typedef struct __ATConfig_t
+{
+	DRIVERGsmHandler_t *gsm;					/*!< Initialized gsm handle					 */
+
+}ATConfig_t;
+
+/* Initialization operation functions ****************************************************************/
+DRIVERState_t AT_Init(ATHandler_t *handler, ATConfig_t *config);
+
+/* IO operation functions ****************************************************************************/
+DRIVERState_t AT_Submit(ATCommand_t *command, uint32_t timeout);
+DRIVERState_t AT_Execute(ATCommand_t *command);
+DRIVERState_t AT_Command(const uint8_t *command, uint32_t commandSize, uint8_t *response, uint32_t responseSize,
+						 uint32_t *length, uint32_t timeout, const uint8_t *expect);
+ATHandler_t *AT_GetHandler(void);
+
+#endif /* MIDDLEWARE_AT_H_ */
@@ -0,0 +1,222 @@
+/**
+  ********************************************************************************************
+  * @file    at_latency.c
+  * @author  Valentina Denic
+  * @brief   MIDDLEWARE for latency statistics of at commands.
+  *          This file provides firmware functions to manage the following
+  *          functionalities of the latency statistics.
+  *           + Counters of commands, errors and timeouts of every class of commands
+  *           + Log bucketed histogram of latency of every class
+  *           + Table for console and comma separated line for broker
+  *
+  @verbatim
+ ==============================================================================================
+                        ##### How to use this driver #####
+ ==============================================================================================
+  [..]
+    At engine counts every command in its class (the same classes as adaptive timeouts,
+    at_timeout.h) and writes time from first character of command written to gsm to its
+    final result code ("OK", "ERROR", "SEND OK"...) in histogram of class. Buckets double
+    from 1 ms, so AT_LATENCY_BUCKETS counters cover everything from answers of local
+    settings to answers of broker. Unlike histograms of adaptive timeouts, these are never
+    halved or saved, they keep everything since reset or AT_LATENCY_Reset(), and error
+    answers are in them too, so the same work can be compared between firmware versions
+    of gsm module and between operators. Commands without final result code are only
+    counted, time they waited is timeout, not latency.
+    The latency statistics can be used as follows:
+
+    (#) AT_LATENCY_Record() is called by at engine after every command
+    (#) Copy statistics of class with AT_LATENCY_Get() function and read percentiles of
+        histogram with AT_LATENCY_Percentile() function
+    (#) Write statistics of class as table or as comma separated line with
+        AT_LATENCY_Format() function
+    (#) Start new measurement (eg. after change of operator) with AT_LATENCY_Reset()
+  @endverbatim
+  *
+  *********************************************************************************************
+  */
+
+/* Includes ----------------------------------------------------------------------------------*/
+#include <at_latency.h>
+
+/* Statistics that at task writes */
+static ATLatency_t latencyStats[AT_TIMEOUT_NUMBER];
+
+/**
+  * @brief Bucket of latency, bucket i has latencies from 2^(i-1) to 2^i ms.
+  * @param latency      Latency (in miliseconds).
+  * @retval uint32_t index of bucket
+  */
+static uint32_t bucketOf(uint32_t latency)
+{
+	if(latency == 0) return 0;
+
+	uint32_t index = 32U - __CLZ(latency);
+
+	return index < AT_LATENCY_BUCKETS ? index : AT_LATENCY_BUCKETS - 1U;
+}
+
+/**
+  * @brief Write command in statistics of its class.
+  * @param timeoutClass Class of command.
+  * @param latency      Time from writing of command to its final result code (in miliseconds).
+  * @param state        Result of command, DRIVER_TIMEOUT when there was no final result code.
+  * @param answered     Command waited for final result code, latency is written in histogram.
+  * @retval void
+  */
+void AT_LATENCY_Record(ATTimeoutClass_t timeoutClass, uint32_t latency, DRIVERState_t state, bool answered)
+{
+	if(timeoutClass >= AT_TIMEOUT_NUMBER) return;
+
+	ATLatency_t *stats = &latencyStats[timeoutClass];
+
+	/* Console task can copy statistics at the same time */
+	taskENTER_CRITICAL();
+
+	stats->count++;
+	if(state == DRIVER_ERROR) stats->errorCount++;
+	else if(state == DRIVER_TIMEOUT) stats->timeoutCount++;
+
+	if(answered && state != DRIVER_TIMEOUT)
+	{
+		stats->bucket[bucketOf(latency)]++;
+		stats->samples++;
+		stats->totalTime += latency;
+		if(latency > stats->maxTime) stats->maxTime = latency;
+	}
+
+	taskEXIT_CRITICAL();
+}
+
+/**
+  * @brief Clear statistics of all classes.
+  * @param void
+  * @retval void
+  */
+void AT_LATENCY_Reset(void)
+{
+	taskENTER_CRITICAL();
+	memset(latencyStats, 0, sizeof(latencyStats));
+	taskEXIT_CRITICAL();
+}
+
+/**
+  * @brief Copy statistics of class.
+  * @param timeoutClass Class of commands.
+  * @param latency      Copy of statistics, zeroed for unknown class.
+  * @retval void
+  */
+void AT_LATENCY_Get(ATTimeoutClass_t timeoutClass, ATLatency_t *latency)
+{
+	if(latency == NULL) return;
+
+	if(timeoutClass >= AT_TIMEOUT_NUMBER)
+	{
+		memset(latency, 0, sizeof(ATLatency_t));
+		return;
+	}
+
+	taskENTER_CRITICAL();
+	*latency = latencyStats[timeoutClass];
+	taskEXIT_CRITICAL();
+}
+
+/**
+  * @brief Upper edge of bucket.
+  * @param index        Index of bucket.
+  * @retval uint32_t latency (in miliseconds), 0xFFFFFFFF for last bucket
+  */
+uint32_t AT_LATENCY_Edge(uint32_t index)
+{
+	return index < AT_LATENCY_BUCKETS - 1U ? 1U << index : 0xFFFFFFFFU;
+}
+
+/**
+  * @brief Latency below which percent of answers came.
+  * @param latency      Statistics of class.
+  * @param percent      Percentile.
+  * @retval uint32_t upper edge of bucket, longest latency for last bucket, 0 without samples
+  */
+uint32_t AT_LATENCY_Percentile(const ATLatency_t *latency, uint32_t percent)
+{
+	uint32_t target = (latency->samples * percent + 99U) / 100U;
+	uint32_t sum = 0;
+
+	if(latency->samples == 0) return 0;
+
+	for(uint32_t i = 0; i < AT_LATENCY_BUCKETS - 1U; i++)
+	{
+		sum += latency->bucket[i];
+		if(sum >= target) return AT_LATENCY_Edge(i);
+	}
+
+	return latency->maxTime;
+}
+
+/**
+  * @brief Write statistics of class in buffer.
+  * @param timeoutClass Class of commands.
+  * @param format       Table for console or comma separated line.
+  * @param buffer       Buffer for text, ends with '\0'.
+  * @param size         Size of buffer (AT_LATENCY_REPORT_SIZE is enough for table).
+  * @retval uint32_t number of written characters, buffer ends after last part that fit
+  */
+uint32_t AT_LATENCY_Format(ATTimeoutClass_t timeoutClass, ATLatencyFormat_t format, uint8_t *buffer, uint32_t size)
+{
+	ATLatency_t stats;
+	uint32_t length = 0;
+	int written = 0;
+
+	if(buffer == NULL || size == 0) return 0;
+
+	AT_LATENCY_Get(timeoutClass, &stats);
+	uint32_t average = stats.samples != 0 ? stats.totalTime / stats.samples : 0;
+
+	if(format == AT_LATENCY_FORMAT_TABLE)
+		written = snprintf((char*)buffer, size, "%-8s %8lu %6lu %8lu %8lu %6lu %6lu %6lu %8lu\r\n        ",
+				AT_TIMEOUT_Name(timeoutClass), (unsigned long)stats.count, (unsigned long)stats.errorCount,
+				(unsigned long)stats.timeoutCount, (unsigned long)stats.samples, (unsigned long)average,
+				(unsigned long)AT_LATENCY_Percentile(&stats, 50), (unsigned long)AT_LATENCY_Percentile(&stats, 99),
+				(unsigned long)stats.maxTime);
+	else
+		written = snprintf((char*)buffer, size, "%s,%lu,%lu,%lu,%lu,%lu,%lu",
+				AT_TIMEOUT_Name(timeoutClass), (unsigned long)stats.count, (unsigned long)stats.errorCount,
+				(unsigned long)stats.timeoutCount, (unsigned long)stats.samples, (unsigned long)average,
+				(unsigned long)stats.maxTime);
+
+	if(written < 0 || (uint32_t)written >= size)
+	{
+		buffer[0] = '\0';
+		return 0;
+	}
+	length = written;
+
+	for(uint32_t i = 0; i < AT_LATENCY_BUCKETS; i++)
+	{
+		/* Table has only buckets with answers, line has all of them, so columns don't move */
+		if(format == AT_LATENCY_FORMAT_TABLE && stats.bucket[i] == 0) continue;
+
+		if(format == AT_LATENCY_FORMAT_MACHINE)
+			written = snprintf((char*)buffer + length, size - length, ",%lu", (unsigned long)stats.bucket[i]);
+		else if(i == AT_LATENCY_BUCKETS - 1U)
+			written = snprintf((char*)buffer + length, size - length, " >%lu:%lu",
+					(unsigned long)AT_LATENCY_Edge(i - 1U), (unsigned long)stats.bucket[i]);
+		else
+			written = snprintf((char*)buffer + length, size - length, " <%lu:%lu",
+					(unsigned long)AT_LATENCY_Edge(i), (unsigned long)stats.bucket[i]);
+
+		if(written < 0 || length + written >= size) break;
+		length += written;
+	}
+
+	if(format == AT_LATENCY_FORMAT_TABLE && length + 2U < size)
+	{
+		buffer[length++] = '\r';
+		buffer[length++] = '\n';
+	}
+
+	/* Last part didn't fit, buffer ends after last complete part */
+	buffer[length] = '\0';
+
+	return length;
+}
@@ -0,0 +1,65 @@
+/**
+  ***************************************************************************************************
+  * @file    at_latency.h
+  * @author  Valentina Denic
+  * @brief   This file contains all the functions prototypes for the latency statistics of at
+  *          commands (counters and log bucketed histogram of every class of commands).
+  ***************************************************************************************************
+  */
+
+#ifndef MIDDLEWARE_AT_LATENCY_H_
+#define MIDDLEWARE_AT_LATENCY_H_
+
+#include <driver_common.h>
+#include <at_timeout.h>
+#include <stdio.h>
+
+/* Number of buckets of histogram, bucket 0 is below 1 ms, bucket i is from 2^(i-1) to 2^i ms and
+ * last one has everything above 65 s */
+#define AT_LATENCY_BUCKETS			18U
+
+/* Size of buffer for table of one class */
+#define AT_LATENCY_REPORT_SIZE		(AT_LATENCY_BUCKETS * 16U + 160U)
+
+/**
+  * @brief  AT latency format definition
+  */
+typedef enum
+{
+	AT_LATENCY_FORMAT_TABLE		= 0x00,		/*!< Counters and nonzero buckets for console		 */
+	AT_LATENCY_FORMAT_MACHINE	= 0x01		/*!< One comma separated line with all buckets,
+												 published to broker							 */
+} ATLatencyFormat_t;
+
+/**
+  * @brief  AT latency Structure definition, statistics of one class of commands
+  */
+typedef struct __ATLatency_t
+{
+	uint32_t count;								/*!< Number of commands							 */
+
+	uint32_t errorCount;						/*!< Commands answered with error code			 */
+
+	uint32_t timeoutCount;						/*!< Commands without final result code			 */
+
+	uint32_t samples;							/*!< Answers in histogram (final result code came) */
+
+	uint32_t totalTime;							/*!< Sum of latencies in histogram (in miliseconds) */
+
+	uint32_t maxTime;							/*!< Longest latency (in miliseconds)			 */
+
+	uint32_t bucket[AT_LATENCY_BUCKETS];		/*!< Number of answers in every bucket			 */
+
+}ATLatency_t;
+
+/* IO operation functions ****************************************************************************/
+void AT_LATENCY_Record(ATTimeoutClass_t timeoutClass, uint32_t latency, DRIVERState_t state, bool answered);
+void AT_LATENCY_Reset(void);
+
+/* State functions ***********************************************************************************/
+void AT_LATENCY_Get(ATTimeoutClass_t timeoutClass, ATLatency_t *latency);
+uint32_t AT_LATENCY_Percentile(const ATLatency_t *latency, uint32_t percent);
+uint32_t AT_LATENCY_Edge(uint32_t index);
+uint32_t AT_LATENCY_Format(ATTimeoutClass_t timeoutClass, ATLatencyFormat_t format, uint8_t *buffer, uint32_t size);
+
+#endif /* MIDDLEWARE_AT_LATENCY_H_ */
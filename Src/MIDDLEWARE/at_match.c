@@ -0,0 +1,271 @@
+/**
+  ********************************************************************************************
+  * @file    at_match.c
+  * @author  Valentina Denic
+  * @brief   MIDDLEWARE for matching of final result codes in answers of gsm module.
+  *          This file provides firmware functions to manage the following
+  *          functionalities of the matcher.
+  *           + Building of automaton from vocabulary of final result codes
+  *           + Incremental reading of answer, every character is read once
+  *           + Conversion of expected answer to result code
+  *
+  @verbatim
+ ==============================================================================================
+                        ##### How to use this driver #####
+ ==============================================================================================
+  [..]
+    Final result codes of gsm module (OK, ERROR, +CME ERROR:, +CMS ERROR:, "> ", SEND OK,
+    SEND FAIL, CONNECT OK, CONNECT FAIL, CLOSED, CLOSE OK, SHUT OK) always start at start
+    of line, so they are matched only there and "OK" inside of sms text or of data from
+    server is not taken as end of answer. All codes are put in one trie (goto function of
+    Aho-Corasick automaton), characters of vocabulary are mapped to classes so table is
+    small. Because codes are anchored to start of line, failure function of every state
+    is the same: state 0 that waits for next line, so automaton is DFA with one table
+    lookup for every character and it never goes back in answer. Code that is whole line
+    is found on '\r' or '\n' after it, error code with text is found when its line ends
+    (so text is in buffer) and prompt is found at once.
+    The matcher can be used as follows:
+
+    (#) Build automaton once with AT_MATCH_Init() function, at engine does it in AT_Init()
+    (#) Start matcher for every answer with AT_MATCH_Start(), answer that is not in
+        vocabulary (eg. first byte of packet from server) can be matched too
+    (#) Give new characters of answer to AT_MATCH_Feed() function, it returns first
+        result code it finds and how many characters it read, rest is given in next call
+    (#) Convert expected answer to result code with AT_MATCH_Code() and check if code
+        ends command with error with AT_MATCH_IsError() function
+  @endverbatim
+  *
+  *********************************************************************************************
+  */
+
+/* Includes ----------------------------------------------------------------------------------*/
+#include <at_match.h>
+#include <driver_memory.h>
+
+/* State that waits for start of next line and state at start of line */
+#define AT_MATCH_STATE_DEAD			0U
+#define AT_MATCH_STATE_START		1U
+
+/* Expected answer can't be in this line anymore */
+#define AT_MATCH_EXPECT_DEAD		0xFFFFFFFFUL
+
+/**
+  * @brief  AT match kind definition, when code of state is found
+  */
+typedef enum
+{
+	AT_MATCH_NONE		= 0x00,				/*!< State is not end of code					 */
+	AT_MATCH_LINE		= 0x01,				/*!< Code is whole line, found on end of line	 */
+	AT_MATCH_TAIL		= 0x02,				/*!< Code has text after it, found on end of line */
+	AT_MATCH_NOW		= 0x03				/*!< Code is found at once (prompt)				 */
+} ATMatchKind_t;
+
+/**
+  * @brief  AT vocabulary entry Structure definition
+  */
+typedef struct __ATMatchCode_t
+{
+	const char *text;							/*!< Characters of result code					 */
+
+	ATResult_t code;							/*!< Result code								 */
+
+	ATMatchKind_t kind;							/*!< When code is found							 */
+
+}ATMatchCode_t;
+
+/* Vocabulary of final result codes */
+static const ATMatchCode_t matchVocabulary[] =
+{
+	{"OK",				AT_RESULT_OK,			AT_MATCH_LINE},
+	{"ERROR",			AT_RESULT_ERROR,		AT_MATCH_LINE},
+	{"+CME ERROR:",		AT_RESULT_CME_ERROR,	AT_MATCH_TAIL},
+	{"+CMS ERROR:",		AT_RESULT_CMS_ERROR,	AT_MATCH_TAIL},
+	{"> ",				AT_RESULT_PROMPT,		AT_MATCH_NOW},
+	{"SEND OK",			AT_RESULT_SEND_OK,		AT_MATCH_LINE},
+	{"SEND FAIL",		AT_RESULT_SEND_FAIL,	AT_MATCH_LINE},
+	{"CONNECT OK",		AT_RESULT_CONNECT_OK,	AT_MATCH_LINE},
+	{"CONNECT FAIL",	AT_RESULT_CONNECT_FAIL,	AT_MATCH_LINE},
+	{"CLOSED",			AT_RESULT_CLOSED,		AT_MATCH_LINE},
+	{"CLOSE OK",		AT_RESULT_CLOSE_OK,		AT_MATCH_LINE},
+	{"SHUT OK",			AT_RESULT_SHUT_OK,		AT_MATCH_LINE}
+};
+
+/* Transition table, class of every character and code of every state of automaton */
+static uint8_t matchNext[AT_MATCH_MAX_STATES][AT_MATCH_MAX_CLASSES] HOT_BSS;
+static uint8_t matchClass[256] HOT_BSS;
+static uint8_t matchCode[AT_MATCH_MAX_STATES] HOT_BSS;
+static uint8_t matchKind[AT_MATCH_MAX_STATES] HOT_BSS;
+
+/* Number of used states and classes, 0 until automaton is built */
+static uint32_t matchStates;
+static uint32_t matchClasses;
+
+/**
+  * @brief Build automaton from vocabulary, called once before matching.
+  * @param void
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t AT_MATCH_Init(void)
+{
+	/* Automaton is already built */
+	if(matchStates != 0) return DRIVER_OK;
+
+	memset(matchNext, 0, sizeof(matchNext));
+	memset(matchClass, 0, sizeof(matchClass));
+	memset(matchCode, 0, sizeof(matchCode));
+	memset(matchKind, 0, sizeof(matchKind));
+
+	/* Class 0 are characters that are not in vocabulary, they lead to state 0 */
+	uint32_t states = AT_MATCH_STATE_START + 1;
+	matchClasses = 1;
+
+	for(uint32_t i = 0; i < sizeof(matchVocabulary) / sizeof(matchVocabulary[0]); i++)
+	{
+		uint32_t state = AT_MATCH_STATE_START;
+
+		for(const uint8_t *character = (const uint8_t*)matchVocabulary[i].text; *character != '\0'; character++)
+		{
+			if(matchClass[*character] == 0)
+			{
+				if(matchClasses == AT_MATCH_MAX_CLASSES) return DRIVER_ERROR;
+				matchClass[*character] = matchClasses++;
+			}
+
+			uint8_t *next = &matchNext[state][matchClass[*character]];
+			if(*next == AT_MATCH_STATE_DEAD)
+			{
+				if(states == AT_MATCH_MAX_STATES) return DRIVER_ERROR;
+				*next = states++;
+			}
+			state = *next;
+		}
+
+		matchCode[state] = matchVocabulary[i].code;
+		matchKind[state] = matchVocabulary[i].kind;
+	}
+
+	matchStates = states;
+	return DRIVER_OK;
+}
+
+/**
+  * @brief Prepare matcher for new answer, answer starts at start of line.
+  * @param matcher      AT matcher.
+  * @param expect       Answer outside of vocabulary that is matched at start of line, can be NULL.
+  * @retval void
+  */
+void AT_MATCH_Start(ATMatcher_t *matcher, const uint8_t *expect)
+{
+	matcher->state 			= AT_MATCH_STATE_START;
+
+	matcher->line 			= AT_RESULT_NONE;
+
+	matcher->tail 			= AT_RESULT_NONE;
+
+	matcher->expect 		= (expect != NULL && *expect != '\0') ? expect : NULL;
+
+	matcher->expectPosition = 0;
+}
+
+/**
+  * @brief Read characters of answer until first result code.
+  * @param matcher      AT matcher.
+  * @param data         New characters of answer.
+  * @param size         Number of new characters.
+  * @param used         Number of characters that were read, rest is given in next call.
+  * @retval ATResult_t first result code or AT_RESULT_NONE when all characters were read
+  */
+HOT_FUNC ATResult_t AT_MATCH_Feed(ATMatcher_t *matcher, const uint8_t *data, uint32_t size, uint32_t *used)
+{
+	ATResult_t code = AT_RESULT_NONE;
+	uint32_t i = 0;
+
+	while(i < size && code == AT_RESULT_NONE)
+	{
+		uint8_t character = data[i++];
+
+		if(character == '\r' || character == '\n')
+		{
+			code = matcher->line != AT_RESULT_NONE ? matcher->line : matcher->tail;
+			matcher->line = AT_RESULT_NONE;
+			matcher->tail = AT_RESULT_NONE;
+
+			/* Line starts only after '\n', in "\r\n" '\r' just ends line */
+			matcher->state = character == '\n' ? AT_MATCH_STATE_START : AT_MATCH_STATE_DEAD;
+			matcher->expectPosition = character == '\n' ? 0 : AT_MATCH_EXPECT_DEAD;
+			continue;
+		}
+
+		uint8_t state = matchNext[matcher->state][matchClass[character]];
+		matcher->state = state;
+		matcher->line = AT_RESULT_NONE;
+
+		switch(matchKind[state]){
+		case AT_MATCH_LINE:
+			matcher->line = (ATResult_t)matchCode[state];
+			break;
+		case AT_MATCH_TAIL:
+			matcher->tail = (ATResult_t)matchCode[state];
+			break;
+		case AT_MATCH_NOW:
+			code = (ATResult_t)matchCode[state];
+			break;
+		default:
+			break;
+		}
+
+		if(matcher->expect != NULL && matcher->expectPosition != AT_MATCH_EXPECT_DEAD)
+		{
+			if(matcher->expect[matcher->expectPosition] != character)
+				matcher->expectPosition = AT_MATCH_EXPECT_DEAD;
+			else if(matcher->expect[++matcher->expectPosition] == '\0')
+			{
+				matcher->expectPosition = AT_MATCH_EXPECT_DEAD;
+				code = AT_RESULT_EXPECT;
+			}
+		}
+	}
+
+	*used = i;
+	return code;
+}
+
+/**
+  * @brief Result code of expected answer.
+  * @param text         Expected answer (eg. "OK" or "SEND OK").
+  * @retval ATResult_t code or AT_RESULT_NONE when answer is not in vocabulary
+  */
+ATResult_t AT_MATCH_Code(const uint8_t *text)
+{
+	if(text == NULL) return AT_RESULT_NONE;
+
+	for(uint32_t i = 0; i < sizeof(matchVocabulary) / sizeof(matchVocabulary[0]); i++)
+	{
+		if(strcmp((const char*)text, matchVocabulary[i].text) == 0) return matchVocabulary[i].code;
+	}
+
+	/* Prompt is expected without space after it */
+	if(strcmp((const char*)text, ">") == 0) return AT_RESULT_PROMPT;
+
+	return AT_RESULT_NONE;
+}
+
+/**
+  * @brief Check if result code ends command with error.
+  * @param code         Result code.
+  * @retval bool true for error codes
+  */
+bool AT_MATCH_IsError(ATResult_t code)
+{
+	switch(code){
+	case AT_RESULT_ERROR:
+	case AT_RESULT_CME_ERROR:
+	case AT_RESULT_CMS_ERROR:
+	case AT_RESULT_SEND_FAIL:
+	case AT_RESULT_CONNECT_FAIL:
+	case AT_RESULT_CLOSED:
+		return true;
+	default:
+		return false;
+	}
+}
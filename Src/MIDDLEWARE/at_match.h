@@ -0,0 +1,71 @@
+/**
+  ***************************************************************************************************
+  * @file    at_match.h
+  * @author  Valentina Denic
+  * @brief   This file contains all the functions prototypes for the matcher of final result
+  *          codes (incremental automaton that reads every character of answer once).
+  ***************************************************************************************************
+  */
+
+#ifndef MIDDLEWARE_AT_MATCH_H_
+#define MIDDLEWARE_AT_MATCH_H_
+
+#include <driver_common.h>
+
+/* Largest number of states of automaton, vocabulary needs less than 70 */
+#define AT_MATCH_MAX_STATES			80U
+
+/* Largest number of different characters in vocabulary (plus one class for all others) */
+#define AT_MATCH_MAX_CLASSES		24U
+
+/**
+  * @brief  AT final result code definition
+  */
+typedef enum
+{
+	AT_RESULT_NONE			= 0x00,			/*!< No final result code yet					 */
+	AT_RESULT_OK			= 0x01,			/*!< Line "OK"									 */
+	AT_RESULT_ERROR			= 0x02,			/*!< Line "ERROR"								 */
+	AT_RESULT_CME_ERROR		= 0x03,			/*!< Line that starts with "+CME ERROR:"		 */
+	AT_RESULT_CMS_ERROR		= 0x04,			/*!< Line that starts with "+CMS ERROR:"		 */
+	AT_RESULT_PROMPT		= 0x05,			/*!< Prompt "> " at start of line				 */
+	AT_RESULT_SEND_OK		= 0x06,			/*!< Line "SEND OK"								 */
+	AT_RESULT_SEND_FAIL		= 0x07,			/*!< Line "SEND FAIL"							 */
+	AT_RESULT_CONNECT_OK	= 0x08,			/*!< Line "CONNECT OK"							 */
+	AT_RESULT_CONNECT_FAIL	= 0x09,			/*!< Line "CONNECT FAIL"						 */
+	AT_RESULT_CLOSED		= 0x0A,			/*!< Line "CLOSED" (server closed connection)	 */
+	AT_RESULT_CLOSE_OK		= 0x0B,			/*!< Line "CLOSE OK"							 */
+	AT_RESULT_SHUT_OK		= 0x0C,			/*!< Line "SHUT OK"								 */
+	AT_RESULT_EXPECT		= 0x0D			/*!< Line starts with expected answer that is
+												 not in vocabulary							 */
+} ATResult_t;
+
+/**
+  * @brief  AT matcher Structure definition, one for every answer that is read
+  */
+typedef struct __ATMatcher_t
+{
+	uint8_t state;								/*!< State of automaton, 0 while rest of line
+													 can't be result code						 */
+
+	ATResult_t line;							/*!< Code found if line ends after last character */
+
+	ATResult_t tail;							/*!< Code of line that starts with code (error
+													 codes with text), found when line ends		 */
+
+	const uint8_t *expect;						/*!< Answer outside of vocabulary, NULL if none	 */
+
+	uint32_t expectPosition;					/*!< Matched characters of expect in this line	 */
+
+}ATMatcher_t;
+
+/* Initialization operation functions ****************************************************************/
+DRIVERState_t AT_MATCH_Init(void);
+void AT_MATCH_Start(ATMatcher_t *matcher, const uint8_t *expect);
+
+/* IO operation functions ****************************************************************************/
+ATResult_t AT_MATCH_Feed(ATMatcher_t *matcher, const uint8_t *data, uint32_t size, uint32_t *used);
+ATResult_t AT_MATCH_Code(const uint8_t *text);
+bool AT_MATCH_IsError(ATResult_t code);
+
+#endif /* MIDDLEWARE_AT_MATCH_H_ */
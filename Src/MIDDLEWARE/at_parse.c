@@ -0,0 +1,454 @@
+/**
+  ********************************************************************************************
+  * @file    at_parse.c
+  * @author  Valentina Denic
+  * @brief   MIDDLEWARE for parsing of answers of gsm module.
+  *          This file provides firmware functions to manage the following
+  *          functionalities of the parsers.
+  *           + Tokenizer of lines and fields that reads answer in place
+  *           + Conversion of fields to numbers and IP addresses
+  *           + Typed values of +CREG, +CGREG, +CSQ, +CGDCONT, +CGACT, +CIFSR, STATE: and +COPS
+  *
+  @verbatim
+ ==============================================================================================
+                        ##### How to use this driver #####
+ ==============================================================================================
+  [..]
+    Answer of query command is line "+NAME: <field>,<field>,..." between echo and "OK".
+    Scanner finds line that starts with prefix and gives its fields one after another as
+    tokens: pointer to first character and number of characters, quotes are not part of
+    token and comma inside of quotes doesn't end field. Nothing is copied and nothing is
+    allocated, so tokens are valid only while answer is, numbers and addresses are
+    converted to values right away. Parsers of answers fill small typed structures, so
+    firmware can act on registration state, signal quality and IP address instead of
+    only writing answer to console.
+    The parsers can be used as follows:
+
+    (#) Parse whole answer with AT_PARSE_Registration() (+CREG: or +CGREG:, also line that
+        came without command), AT_PARSE_Signal() (+CSQ:), AT_PARSE_LocalAddress() (answer
+        of at+cifsr), AT_PARSE_IpState() (STATE: of at+cipstatus) or AT_PARSE_Operator()
+        (+COPS:)
+    (#) Start scanner with AT_PARSE_Start() and call AT_PARSE_PdpContext() until it returns
+        false for answers with one line for every context (+CGDCONT:, +CGACT:)
+    (#) Other answers are read with AT_PARSE_Line(), AT_PARSE_Field() and conversions
+        AT_PARSE_Number(), AT_PARSE_Hex(), AT_PARSE_Address() and AT_PARSE_Is()
+  @endverbatim
+  *
+  *********************************************************************************************
+  */
+
+/* Includes ----------------------------------------------------------------------------------*/
+#include <at_parse.h>
+
+/* Largest number of fields of registration line (<n>,<stat>,<lac>,<ci>) */
+#define AT_PARSE_REG_FIELDS			4U
+
+/**
+  * @brief  AT connection state text Structure definition
+  */
+typedef struct __ATIpStateText_t
+{
+	const char *text;							/*!< Text after "STATE: "						 */
+
+	ATIpState_t state;							/*!< Connection state							 */
+
+}ATIpStateText_t;
+
+/* States of at+cipstatus in single connection mode */
+static const ATIpStateText_t ipStateText[] =
+{
+	{"IP INITIAL",		AT_IP_INITIAL},
+	{"IP START",		AT_IP_START},
+	{"IP CONFIG",		AT_IP_CONFIG},
+	{"IP GPRSACT",		AT_IP_GPRSACT},
+	{"IP STATUS",		AT_IP_STATUS},
+	{"TCP CONNECTING",	AT_IP_CONNECTING},
+	{"UDP CONNECTING",	AT_IP_CONNECTING},
+	{"CONNECT OK",		AT_IP_CONNECT_OK},
+	{"TCP CLOSING",		AT_IP_CLOSING},
+	{"UDP CLOSING",		AT_IP_CLOSING},
+	{"TCP CLOSED",		AT_IP_CLOSED},
+	{"UDP CLOSED",		AT_IP_CLOSED},
+	{"PDP DEACT",		AT_IP_PDP_DEACT}
+};
+
+/**
+  * @brief Prepare scanner for answer, first line is searched from start of answer.
+  * @param scanner      AT scanner.
+  * @param answer       Answer from gsm.
+  * @param length       Number of characters of answer.
+  * @retval void
+  */
+void AT_PARSE_Start(ATScanner_t *scanner, const uint8_t *answer, uint32_t length)
+{
+	scanner->position 	= NULL;
+
+	scanner->lineEnd 	= answer;
+
+	scanner->end 		= answer + length;
+}
+
+/**
+  * @brief Move scanner to next line that starts with prefix, its fields are read after prefix.
+  * @param scanner      AT scanner.
+  * @param prefix       Start of line (eg. "+CSQ:"), "" for any line that is not empty.
+  * @retval bool true if line is found
+  */
+bool AT_PARSE_Line(ATScanner_t *scanner, const char *prefix)
+{
+	uint32_t size = strlen(prefix);
+	const uint8_t *line = scanner->lineEnd;
+
+	while(line < scanner->end)
+	{
+		/* Ends of lines are skipped, line ends with '\r', '\n' or with answer */
+		if(*line == '\r' || *line == '\n')
+		{
+			line++;
+			continue;
+		}
+
+		const uint8_t *lineEnd = line;
+		while(lineEnd < scanner->end && *lineEnd != '\r' && *lineEnd != '\n') lineEnd++;
+
+		if((uint32_t)(lineEnd - line) >= size && memcmp(line, prefix, size) == 0)
+		{
+			scanner->position = line + size;
+			scanner->lineEnd = lineEnd;
+			return true;
+		}
+
+		line = lineEnd;
+	}
+
+	scanner->position = NULL;
+	scanner->lineEnd = scanner->end;
+	return false;
+}
+
+/**
+  * @brief Read next field of line, fields are separated with commas.
+  * @param scanner      AT scanner.
+  * @param token        Characters of field, without quotes and spaces around it.
+  * @retval bool false when line has no more fields
+  */
+bool AT_PARSE_Field(ATScanner_t *scanner, ATToken_t *token)
+{
+	const uint8_t *position = scanner->position;
+
+	if(position == NULL) return false;
+
+	while(position < scanner->lineEnd && *position == ' ') position++;
+
+	const uint8_t *start = position;
+	const uint8_t *stop;
+	if(position < scanner->lineEnd && *position == '"')
+	{
+		/* Comma inside of quotes belongs to field */
+		start = ++position;
+		while(position < scanner->lineEnd && *position != '"') position++;
+		stop = position;
+		while(position < scanner->lineEnd && *position != ',') position++;
+	}
+	else
+	{
+		while(position < scanner->lineEnd && *position != ',') position++;
+		stop = position;
+		while(stop > start && stop[-1] == ' ') stop--;
+	}
+
+	token->text = start;
+	token->length = (uint32_t)(stop - start);
+
+	/* After last field of line there is nothing more to read */
+	scanner->position = position < scanner->lineEnd ? position + 1 : NULL;
+	return true;
+}
+
+/**
+  * @brief Convert field with decimal number.
+  * @param token        Field.
+  * @param value        Number.
+  * @retval bool false if field is empty or has other characters
+  */
+bool AT_PARSE_Number(const ATToken_t *token, uint32_t *value)
+{
+	uint32_t number = 0;
+
+	if(token->length == 0 || token->length > 9) return false;
+
+	for(uint32_t i = 0; i < token->length; i++)
+	{
+		if(token->text[i] < '0' || token->text[i] > '9') return false;
+		number = number * 10 + (token->text[i] - '0');
+	}
+
+	*value = number;
+	return true;
+}
+
+/**
+  * @brief Convert field with hexadecimal number (eg. location area code "1A2B").
+  * @param token        Field.
+  * @param value        Number.
+  * @retval bool false if field is empty or has other characters
+  */
+bool AT_PARSE_Hex(const ATToken_t *token, uint32_t *value)
+{
+	uint32_t number = 0;
+
+	if(token->length == 0 || token->length > 8) return false;
+
+	for(uint32_t i = 0; i < token->length; i++)
+	{
+		uint8_t character = token->text[i];
+
+		if(character >= '0' && character <= '9') number = (number << 4) | (character - '0');
+		else if(character >= 'A' && character <= 'F') number = (number << 4) | (character - 'A' + 10);
+		else if(character >= 'a' && character <= 'f') number = (number << 4) | (character - 'a' + 10);
+		else return false;
+	}
+
+	*value = number;
+	return true;
+}
+
+/**
+  * @brief Convert field with IPv4 address.
+  * @param token        Field (eg. "10.0.0.1").
+  * @param address      Address, first number is in highest byte.
+  * @retval bool false if field is not address
+  */
+bool AT_PARSE_Address(const ATToken_t *token, uint32_t *address)
+{
+	uint32_t value = 0;
+	uint32_t part = 0;
+	uint32_t digits = 0;
+	uint32_t dots = 0;
+
+	for(uint32_t i = 0; i <= token->length; i++)
+	{
+		/* End of field ends last number */
+		if(i == token->length || token->text[i] == '.')
+		{
+			if(digits == 0 || part > 255) return false;
+			value = (value << 8) | part;
+			if(i < token->length) dots++;
+			part = 0;
+			digits = 0;
+		}
+		else if(token->text[i] >= '0' && token->text[i] <= '9' && digits < 3)
+		{
+			part = part * 10 + (token->text[i] - '0');
+			digits++;
+		}
+		else return false;
+	}
+
+	if(dots != 3) return false;
+
+	*address = value;
+	return true;
+}
+
+/**
+  * @brief Compare field with text.
+  * @param token        Field.
+  * @param text         Text.
+  * @retval bool true if field has exactly characters of text
+  */
+bool AT_PARSE_Is(const ATToken_t *token, const char *text)
+{
+	return strlen(text) == token->length && memcmp(token->text, text, token->length) == 0;
+}
+
+/**
+  * @brief Parse registration line, answer of at+creg? (at+cgreg?) or line that came without command.
+  * @param answer       Answer from gsm.
+  * @param length       Number of characters of answer.
+  * @param prefix       "+CREG:" or "+CGREG:".
+  * @param registration Registration.
+  * @retval bool false if answer has no valid line
+  */
+bool AT_PARSE_Registration(const uint8_t *answer, uint32_t length, const char *prefix, ATRegistration_t *registration)
+{
+	ATScanner_t scanner;
+	ATToken_t fields[AT_PARSE_REG_FIELDS];
+	uint32_t count = 0;
+	uint32_t value;
+
+	AT_PARSE_Start(&scanner, answer, length);
+	if(!AT_PARSE_Line(&scanner, prefix)) return false;
+
+	while(count < AT_PARSE_REG_FIELDS && AT_PARSE_Field(&scanner, &fields[count])) count++;
+
+	/* Answer has <n> before <stat> (2 or 4 fields), line without command doesn't (1 or 3 fields) */
+	uint32_t first = (count == 2 || count == 4) ? 1 : 0;
+
+	if(count == 0 || !AT_PARSE_Number(&fields[first], &value) || value > AT_REG_ROAMING) return false;
+	registration->state = (ATRegState_t)value;
+
+	registration->mode = AT_PARSE_NONE;
+	if(first == 1 && AT_PARSE_Number(&fields[0], &value)) registration->mode = (uint8_t)value;
+
+	registration->area = 0;
+	registration->cell = 0;
+	if(count == first + 3)
+	{
+		if(AT_PARSE_Hex(&fields[first + 1], &value)) registration->area = (uint16_t)value;
+		if(AT_PARSE_Hex(&fields[first + 2], &value)) registration->cell = (uint16_t)value;
+	}
+
+	return true;
+}
+
+/**
+  * @brief Parse answer of at+csq.
+  * @param answer       Answer from gsm.
+  * @param length       Number of characters of answer.
+  * @param signal       Signal quality.
+  * @retval bool false if answer has no valid line
+  */
+bool AT_PARSE_Signal(const uint8_t *answer, uint32_t length, ATSignal_t *signal)
+{
+	ATScanner_t scanner;
+	ATToken_t token;
+	uint32_t rssi;
+	uint32_t ber;
+
+	AT_PARSE_Start(&scanner, answer, length);
+	if(!AT_PARSE_Line(&scanner, "+CSQ:")) return false;
+
+	if(!AT_PARSE_Field(&scanner, &token) || !AT_PARSE_Number(&token, &rssi)) return false;
+	if(!AT_PARSE_Field(&scanner, &token) || !AT_PARSE_Number(&token, &ber)) return false;
+
+	signal->rssi = (uint8_t)rssi;
+	signal->ber = (uint8_t)ber;
+
+	/* 0 is -113 dBm or less, 31 is -51 dBm or more */
+	signal->dbm = rssi <= 31 ? (int16_t)(-113 + 2 * (int32_t)rssi) : 0;
+
+	return true;
+}
+
+/**
+  * @brief Parse next line of answer of at+cgdcont? or at+cgact?.
+  * @param scanner      AT scanner started on answer.
+  * @param prefix       "+CGDCONT:" or "+CGACT:".
+  * @param context      PDP context.
+  * @retval bool false when there are no more lines
+  */
+bool AT_PARSE_PdpContext(ATScanner_t *scanner, const char *prefix, ATPdpContext_t *context)
+{
+	ATToken_t token;
+	uint32_t value;
+
+	while(AT_PARSE_Line(scanner, prefix))
+	{
+		if(!AT_PARSE_Field(scanner, &token) || !AT_PARSE_Number(&token, &value)) continue;
+
+		context->cid 			= (uint8_t)value;
+		context->active 		= false;
+		context->type.length 	= 0;
+		context->apn.length 	= 0;
+		context->address 		= 0;
+
+		if(!AT_PARSE_Field(scanner, &token)) return true;
+
+		/* +CGACT: <cid>,<state> */
+		if(AT_PARSE_Number(&token, &value))
+		{
+			context->active = value == 1;
+			return true;
+		}
+
+		/* +CGDCONT: <cid>,<type>,<apn>,<address>,... */
+		context->type = token;
+		if(AT_PARSE_Field(scanner, &token)) context->apn = token;
+		if(AT_PARSE_Field(scanner, &token)) AT_PARSE_Address(&token, &context->address);
+		return true;
+	}
+
+	return false;
+}
+
+/**
+  * @brief Parse answer of at+cifsr, address is alone in its line.
+  * @param answer       Answer from gsm.
+  * @param length       Number of characters of answer.
+  * @param address      Local IP address.
+  * @retval bool false if answer has no address
+  */
+bool AT_PARSE_LocalAddress(const uint8_t *answer, uint32_t length, uint32_t *address)
+{
+	ATScanner_t scanner;
+	ATToken_t token;
+
+	AT_PARSE_Start(&scanner, answer, length);
+
+	/* Echo of command and other lines are skipped */
+	while(AT_PARSE_Line(&scanner, ""))
+	{
+		if(AT_PARSE_Field(&scanner, &token) && scanner.position == NULL && AT_PARSE_Address(&token, address))
+			return true;
+	}
+
+	return false;
+}
+
+/**
+  * @brief Parse state of connection in answer of at+cipstatus.
+  * @param answer       Answer from gsm.
+  * @param length       Number of characters of answer.
+  * @param state        Connection state, AT_IP_UNKNOWN for state that is not in table.
+  * @retval bool false if answer has no state
+  */
+bool AT_PARSE_IpState(const uint8_t *answer, uint32_t length, ATIpState_t *state)
+{
+	ATScanner_t scanner;
+	ATToken_t token;
+
+	AT_PARSE_Start(&scanner, answer, length);
+	if(!AT_PARSE_Line(&scanner, "STATE:") || !AT_PARSE_Field(&scanner, &token)) return false;
+
+	*state = AT_IP_UNKNOWN;
+	for(uint32_t i = 0; i < sizeof(ipStateText) / sizeof(ipStateText[0]); i++)
+	{
+		if(AT_PARSE_Is(&token, ipStateText[i].text))
+		{
+			*state = ipStateText[i].state;
+			break;
+		}
+	}
+
+	return true;
+}
+
+/**
+  * @brief Parse answer of at+cops?.
+  * @param answer       Answer from gsm.
+  * @param length       Number of characters of answer.
+  * @param operator     Operator, name points into answer.
+  * @retval bool false if answer has no valid line
+  */
+bool AT_PARSE_Operator(const uint8_t *answer, uint32_t length, ATOperator_t *operator)
+{
+	ATScanner_t scanner;
+	ATToken_t token;
+	uint32_t value;
+
+	AT_PARSE_Start(&scanner, answer, length);
+	if(!AT_PARSE_Line(&scanner, "+COPS:")) return false;
+
+	if(!AT_PARSE_Field(&scanner, &token) || !AT_PARSE_Number(&token, &value)) return false;
+	operator->mode = (uint8_t)value;
+
+	/* Without operator answer has only mode */
+	operator->format = AT_PARSE_NONE;
+	operator->name.text = NULL;
+	operator->name.length = 0;
+	if(AT_PARSE_Field(&scanner, &token) && AT_PARSE_Number(&token, &value) && AT_PARSE_Field(&scanner, &operator->name))
+		operator->format = (uint8_t)value;
+
+	return true;
+}
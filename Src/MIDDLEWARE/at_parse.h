@@ -0,0 +1,154 @@
+/**
+  ***************************************************************************************************
+  * @file    at_parse.h
+  * @author  Valentina Denic
+  * @brief   This file contains all the functions prototypes for the parsers of answers of gsm
+  *          module (tokenizer that reads answer in place and typed values of query commands).
+  ***************************************************************************************************
+  */
+
+#ifndef MIDDLEWARE_AT_PARSE_H_
+#define MIDDLEWARE_AT_PARSE_H_
+
+#include <driver_common.h>
+
+/* Value of field that is not in answer */
+#define AT_PARSE_NONE				0xFFU
+
+/* Signal strength of +CSQ that is not known (rssi 99) */
+#define AT_PARSE_RSSI_UNKNOWN		99U
+
+/**
+  * @brief  AT token Structure definition, characters of one field inside of answer (not copied,
+  *         valid while answer is)
+  */
+typedef struct __ATToken_t
+{
+	const uint8_t *text;						/*!< First character of field, without quotes	 */
+
+	uint32_t length;							/*!< Number of characters of field				 */
+
+}ATToken_t;
+
+/**
+  * @brief  AT scanner Structure definition, position of tokenizer in answer
+  */
+typedef struct __ATScanner_t
+{
+	const uint8_t *position;					/*!< Next character that is read				 */
+
+	const uint8_t *lineEnd;						/*!< End of line whose fields are read			 */
+
+	const uint8_t *end;							/*!< End of answer								 */
+
+}ATScanner_t;
+
+/**
+  * @brief  AT registration state definition (<stat> of +CREG and +CGREG)
+  */
+typedef enum
+{
+	AT_REG_NOT_SEARCHING	= 0x00,			/*!< Not registered, not searching				 */
+	AT_REG_HOME				= 0x01,			/*!< Registered in home network					 */
+	AT_REG_SEARCHING		= 0x02,			/*!< Not registered, searching operator			 */
+	AT_REG_DENIED			= 0x03,			/*!< Registration denied						 */
+	AT_REG_UNKNOWN			= 0x04,			/*!< Unknown									 */
+	AT_REG_ROAMING			= 0x05			/*!< Registered in roaming						 */
+} ATRegState_t;
+
+/**
+  * @brief  AT connection state definition (STATE: of at+cipstatus)
+  */
+typedef enum
+{
+	AT_IP_UNKNOWN			= 0x00,			/*!< State is not read yet or not known			 */
+	AT_IP_INITIAL			= 0x01,			/*!< "IP INITIAL"								 */
+	AT_IP_START				= 0x02,			/*!< "IP START", apn is set						 */
+	AT_IP_CONFIG			= 0x03,			/*!< "IP CONFIG", wireless connection starts	 */
+	AT_IP_GPRSACT			= 0x04,			/*!< "IP GPRSACT", wireless connection is up	 */
+	AT_IP_STATUS			= 0x05,			/*!< "IP STATUS", local address is known		 */
+	AT_IP_CONNECTING		= 0x06,			/*!< "TCP CONNECTING" or "UDP CONNECTING"		 */
+	AT_IP_CONNECT_OK		= 0x07,			/*!< "CONNECT OK"								 */
+	AT_IP_CLOSING			= 0x08,			/*!< "TCP CLOSING" or "UDP CLOSING"				 */
+	AT_IP_CLOSED			= 0x09,			/*!< "TCP CLOSED" or "UDP CLOSED"				 */
+	AT_IP_PDP_DEACT			= 0x0A			/*!< "PDP DEACT"								 */
+} ATIpState_t;
+
+/**
+  * @brief  AT registration Structure definition (+CREG and +CGREG)
+  */
+typedef struct __ATRegistration_t
+{
+	uint8_t mode;								/*!< <n> of at+creg=<n>, AT_PARSE_NONE in line
+													 that came without command				 */
+
+	ATRegState_t state;							/*!< Registration state							 */
+
+	uint16_t area;								/*!< Location area code, 0 if not in answer		 */
+
+	uint16_t cell;								/*!< Cell id, 0 if not in answer				 */
+
+}ATRegistration_t;
+
+/**
+  * @brief  AT signal quality Structure definition (+CSQ)
+  */
+typedef struct __ATSignal_t
+{
+	uint8_t rssi;								/*!< 0 - 31, AT_PARSE_RSSI_UNKNOWN if not known	 */
+
+	uint8_t ber;								/*!< Bit error rate 0 - 7, 99 if not known		 */
+
+	int16_t dbm;								/*!< Signal strength in dBm, 0 if not known		 */
+
+}ATSignal_t;
+
+/**
+  * @brief  AT PDP context Structure definition (one line of +CGDCONT and +CGACT)
+  */
+typedef struct __ATPdpContext_t
+{
+	uint8_t cid;								/*!< Number of context							 */
+
+	bool active;								/*!< Context is active (+CGACT)					 */
+
+	ATToken_t type;								/*!< PDP type ("IP"), empty in +CGACT			 */
+
+	ATToken_t apn;								/*!< Access point name, empty in +CGACT			 */
+
+	uint32_t address;							/*!< PDP address, 0 if none						 */
+
+}ATPdpContext_t;
+
+/**
+  * @brief  AT operator Structure definition (+COPS)
+  */
+typedef struct __ATOperator_t
+{
+	uint8_t mode;								/*!< Selection mode (0 automatic, 1 manual)		 */
+
+	uint8_t format;								/*!< Format of name, AT_PARSE_NONE without
+													 operator									 */
+
+	ATToken_t name;								/*!< Name of operator or numeric code			 */
+
+}ATOperator_t;
+
+/* Tokenizer functions *******************************************************************************/
+void AT_PARSE_Start(ATScanner_t *scanner, const uint8_t *answer, uint32_t length);
+bool AT_PARSE_Line(ATScanner_t *scanner, const char *prefix);
+bool AT_PARSE_Field(ATScanner_t *scanner, ATToken_t *token);
+bool AT_PARSE_Number(const ATToken_t *token, uint32_t *value);
+bool AT_PARSE_Hex(const ATToken_t *token, uint32_t *value);
+bool AT_PARSE_Address(const ATToken_t *token, uint32_t *address);
+bool AT_PARSE_Is(const ATToken_t *token, const char *text);
+
+/* Parsers of answers ********************************************************************************/
+bool AT_PARSE_Registration(const uint8_t *answer, uint32_t length, const char *prefix, ATRegistration_t *registration);
+bool AT_PARSE_Signal(const uint8_t *answer, uint32_t length, ATSignal_t *signal);
+bool AT_PARSE_PdpContext(ATScanner_t *scanner, const char *prefix, ATPdpContext_t *context);
+bool AT_PARSE_LocalAddress(const uint8_t *answer, uint32_t length, uint32_t *address);
+bool AT_PARSE_IpState(const uint8_t *answer, uint32_t length, ATIpState_t *state);
+bool AT_PARSE_Operator(const uint8_t *answer, uint32_t length, ATOperator_t *operator);
+
+#endif /* MIDDLEWARE_AT_PARSE_H_ */
@@ -0,0 +1,312 @@
+/**
+  ********************************************************************************************
+  * @file    at_timeout.c
+  * @author  Valentina Denic
+  * @brief   MIDDLEWARE for timeouts of at commands.
+  *          This file provides firmware functions to manage the following
+  *          functionalities of the adaptive timeouts.
+  *           + Latency histogram of every class of commands
+  *           + Timeout from percentile and margin, limited by timeout of command
+  *           + Saving and loading of learned timeouts (driver_store.c)
+  *
+  @verbatim
+ ==============================================================================================
+                        ##### How to use this driver #####
+ ==============================================================================================
+  [..]
+    Timeout of every command in gsm.c and mqtt.c is the longest time that answer can take
+    and is kept as hard bound. Commands are grouped in classes whose answers take similar
+    time (local settings, sms storage, network, connection, prompt, send, broker) and at
+    engine writes latency of every answer with final result code in histogram of its class.
+    Buckets are four per octave from 16 ms, so histogram has only AT_TIMEOUT_BUCKETS
+    counters and error of bucket is below 25%. When class has AT_TIMEOUT_MIN_SAMPLES
+    answers, its timeout is upper edge of bucket of AT_TIMEOUT_PERCENTILE plus margin,
+    never less than AT_TIMEOUT_FLOOR and never more than bound of command. Command that
+    times out with learned timeout puts class in backoff: next commands of class use their
+    bounds until one of them gets its answer, whose latency is learned (lost answer is not
+    a latency, so it is not in histogram). Histogram is halved every AT_TIMEOUT_WINDOW
+    answers, so old network conditions fade out. Learned timeouts are saved in flash at
+    most every AT_TIMEOUT_SAVE_PERIOD and loaded after reset.
+    The adaptive timeouts can be used as follows:
+
+    (#) Set timeoutClass of ATCommand_t (or of gsm command table), AT_TIMEOUT_FIXED keeps
+        timeout of command as it is, commands without expected result code are always fixed
+    (#) AT_TIMEOUT_Init() is called from AT_Init(), at engine calls AT_TIMEOUT_Get() before
+        command and AT_TIMEOUT_Record() after it
+    (#) Call AT_TIMEOUT_Process() from task with low priority (health task), it saves
+        learned timeouts when they changed and period expired, erase of flash blocks it
+    (#) Save learned timeouts at once with AT_TIMEOUT_Save() function
+  @endverbatim
+  *
+  *********************************************************************************************
+  */
+
+/* Includes ----------------------------------------------------------------------------------*/
+#include <at_timeout.h>
+#include <driver_store.h>
+#include <time.h>
+
+/**
+  * @brief  AT timeout record Structure definition, what is saved in flash
+  */
+typedef struct __ATTimeoutRecord_t
+{
+	uint32_t version;							/*!< AT_TIMEOUT_VERSION							 */
+
+	ATTimeoutLearn_t learn[AT_TIMEOUT_NUMBER];	/*!< Histograms of classes						 */
+
+}ATTimeoutRecord_t;
+
+/* Names of classes for console */
+static const char *timeoutName[AT_TIMEOUT_NUMBER] = {"fixed", "local", "storage", "network", "connect", "prompt",
+													 "send", "broker"};
+
+/* Histograms that at task writes, health task copies them when it saves */
+static ATTimeoutRecord_t timeoutRecord;
+
+/* Copy that is written in flash */
+static ATTimeoutRecord_t timeoutSaved;
+
+/* Classes in backoff, bit for every class */
+static volatile uint32_t timeoutBackoff;
+
+/* Learned timeout changed after last save */
+static volatile bool timeoutDirty;
+
+/* Time of last save and number of saves */
+static uint32_t timeoutLastSave;
+static uint32_t timeoutSaveCount;
+
+/**
+  * @brief Bucket of latency, four buckets in every octave from 16 ms.
+  * @param latency      Latency (in miliseconds).
+  * @retval uint32_t index of bucket
+  */
+static uint32_t bucketOf(uint32_t latency)
+{
+	if(latency < 16U) return 0;
+
+	uint32_t octave = 31U - __CLZ(latency);
+	uint32_t index = (octave - 4U) * 4U + ((latency >> (octave - 2U)) & 3U);
+
+	return index < AT_TIMEOUT_BUCKETS ? index : AT_TIMEOUT_BUCKETS - 1U;
+}
+
+/**
+  * @brief Upper edge of bucket.
+  * @param index        Index of bucket.
+  * @retval uint32_t latency (in miliseconds)
+  */
+static uint32_t bucketEdge(uint32_t index)
+{
+	return (5U + index % 4U) << (index / 4U + 2U);
+}
+
+/**
+  * @brief Latency below which percent of answers of histogram came.
+  * @param learn        Histogram.
+  * @param percent      Percentile.
+  * @retval uint32_t upper edge of bucket, 0 for empty histogram
+  */
+static uint32_t percentileOf(const ATTimeoutLearn_t *learn, uint32_t percent)
+{
+	uint32_t target = (learn->samples * percent + 99U) / 100U;
+	uint32_t sum = 0;
+
+	if(learn->samples == 0) return 0;
+
+	for(uint32_t i = 0; i < AT_TIMEOUT_BUCKETS; i++)
+	{
+		sum += learn->bucket[i];
+		if(sum >= target) return bucketEdge(i);
+	}
+
+	return bucketEdge(AT_TIMEOUT_BUCKETS - 1U);
+}
+
+/**
+  * @brief Load learned timeouts, histograms are empty without valid record.
+  * @param void
+  * @retval void
+  */
+void AT_TIMEOUT_Init(void)
+{
+	if(DRIVER_STORE_Load(STORE_TAG_AT_TIMEOUT, &timeoutRecord, sizeof(timeoutRecord)) != DRIVER_OK ||
+	   timeoutRecord.version != AT_TIMEOUT_VERSION)
+	{
+		memset(&timeoutRecord, 0, sizeof(timeoutRecord));
+		timeoutRecord.version = AT_TIMEOUT_VERSION;
+	}
+
+	timeoutBackoff 		= 0;
+	timeoutDirty 		= false;
+	timeoutLastSave 	= TIME_GetTick();
+	timeoutSaveCount 	= 0;
+}
+
+/**
+  * @brief Timeout of command.
+  * @param timeoutClass Class of command.
+  * @param bound        Timeout of command, learned timeout is never longer.
+  * @retval uint32_t timeout (in miliseconds)
+  */
+uint32_t AT_TIMEOUT_Get(ATTimeoutClass_t timeoutClass, uint32_t bound)
+{
+	if(timeoutClass == AT_TIMEOUT_FIXED || timeoutClass >= AT_TIMEOUT_NUMBER) return bound;
+
+	/* Class that lost answer with learned timeout waits for bound until it gets answer */
+	if(timeoutBackoff & (1U << timeoutClass)) return bound;
+
+	uint32_t learned = timeoutRecord.learn[timeoutClass].timeout;
+	if(learned == 0) return bound;
+
+	return learned < bound ? learned : bound;
+}
+
+/**
+  * @brief Write latency of answer in histogram of class.
+  * @param timeoutClass Class of command.
+  * @param latency      Time from sending of command to its final result code (in miliseconds).
+  * @param state        Result of command, DRIVER_TIMEOUT when there was no final result code.
+  * @retval void
+  */
+void AT_TIMEOUT_Record(ATTimeoutClass_t timeoutClass, uint32_t latency, DRIVERState_t state)
+{
+	if(timeoutClass == AT_TIMEOUT_FIXED || timeoutClass >= AT_TIMEOUT_NUMBER) return;
+
+	if(state == DRIVER_TIMEOUT)
+	{
+		timeoutBackoff |= 1U << timeoutClass;
+		return;
+	}
+
+	ATTimeoutLearn_t *learn = &timeoutRecord.learn[timeoutClass];
+	uint32_t timeout = 0;
+
+	/* Health task can copy histogram at the same time */
+	taskENTER_CRITICAL();
+
+	timeoutBackoff &= ~(1U << timeoutClass);
+
+	if(learn->samples >= AT_TIMEOUT_WINDOW)
+	{
+		learn->samples = 0;
+		for(uint32_t i = 0; i < AT_TIMEOUT_BUCKETS; i++)
+		{
+			learn->bucket[i] /= 2U;
+			learn->samples += learn->bucket[i];
+		}
+	}
+
+	learn->bucket[bucketOf(latency)]++;
+	learn->samples++;
+
+	if(learn->samples >= AT_TIMEOUT_MIN_SAMPLES)
+	{
+		uint32_t edge = percentileOf(learn, AT_TIMEOUT_PERCENTILE);
+		uint32_t margin = edge * AT_TIMEOUT_MARGIN / 100U;
+
+		timeout = edge + (margin > AT_TIMEOUT_MARGIN_MIN ? margin : AT_TIMEOUT_MARGIN_MIN);
+		if(timeout < AT_TIMEOUT_FLOOR) timeout = AT_TIMEOUT_FLOOR;
+	}
+
+	if(timeout != learn->timeout)
+	{
+		learn->timeout = timeout;
+		timeoutDirty = true;
+	}
+
+	taskEXIT_CRITICAL();
+}
+
+/**
+  * @brief Save learned timeouts in flash, caller is blocked while flash is written.
+  * @param void
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t AT_TIMEOUT_Save(void)
+{
+	taskENTER_CRITICAL();
+	timeoutSaved = timeoutRecord;
+	timeoutDirty = false;
+	taskEXIT_CRITICAL();
+
+	timeoutLastSave = TIME_GetTick();
+
+	DRIVERState_t state = DRIVER_STORE_Save(STORE_TAG_AT_TIMEOUT, &timeoutSaved, sizeof(timeoutSaved));
+
+	/* Record that is not saved is tried again after next period */
+	if(state != DRIVER_OK) timeoutDirty = true;
+	else timeoutSaveCount++;
+
+	return state;
+}
+
+/**
+  * @brief Save learned timeouts when they changed and period expired.
+  * @param void
+  * @retval void
+  */
+void AT_TIMEOUT_Process(void)
+{
+	if(timeoutDirty && TIME_GetTick() - timeoutLastSave >= AT_TIMEOUT_SAVE_PERIOD) AT_TIMEOUT_Save();
+}
+
+/**
+  * @brief Name of class.
+  * @param timeoutClass Class of command.
+  * @retval const char* name
+  */
+const char *AT_TIMEOUT_Name(ATTimeoutClass_t timeoutClass)
+{
+	return timeoutClass < AT_TIMEOUT_NUMBER ? timeoutName[timeoutClass] : "";
+}
+
+/**
+  * @brief Number of answers in histogram of class.
+  * @param timeoutClass Class of command.
+  * @retval uint32_t samples
+  */
+uint32_t AT_TIMEOUT_Samples(ATTimeoutClass_t timeoutClass)
+{
+	return timeoutClass < AT_TIMEOUT_NUMBER ? timeoutRecord.learn[timeoutClass].samples : 0;
+}
+
+/**
+  * @brief Learned timeout of class.
+  * @param timeoutClass Class of command.
+  * @retval uint32_t timeout (in miliseconds), 0 while there are not enough samples
+  */
+uint32_t AT_TIMEOUT_Learned(ATTimeoutClass_t timeoutClass)
+{
+	return timeoutClass < AT_TIMEOUT_NUMBER ? timeoutRecord.learn[timeoutClass].timeout : 0;
+}
+
+/**
+  * @brief Latency below which percent of answers of class came.
+  * @param timeoutClass Class of command.
+  * @param percent      Percentile.
+  * @retval uint32_t latency (in miliseconds), 0 without samples
+  */
+uint32_t AT_TIMEOUT_Percentile(ATTimeoutClass_t timeoutClass, uint32_t percent)
+{
+	ATTimeoutLearn_t learn;
+
+	if(timeoutClass >= AT_TIMEOUT_NUMBER) return 0;
+
+	taskENTER_CRITICAL();
+	learn = timeoutRecord.learn[timeoutClass];
+	taskEXIT_CRITICAL();
+
+	return percentileOf(&learn, percent);
+}
+
+/**
+  * @brief Number of saves of learned timeouts after reset.
+  * @param void
+  * @retval uint32_t saves
+  */
+uint32_t AT_TIMEOUT_SaveCount(void)
+{
+	return timeoutSaveCount;
+}
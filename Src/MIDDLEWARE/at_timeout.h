@@ -0,0 +1,103 @@
+/**
+  ***************************************************************************************************
+  * @file    at_timeout.h
+  * @author  Valentina Denic
+  * @brief   This file contains all the functions prototypes for the timeouts of at commands
+  *          (latency histogram of every class of commands and timeout learned from it).
+  ***************************************************************************************************
+  */
+
+#ifndef MIDDLEWARE_AT_TIMEOUT_H_
+#define MIDDLEWARE_AT_TIMEOUT_H_
+
+#include <driver_common.h>
+
+/* Percentile of latency (in percents) that is covered by learned timeout */
+#ifndef AT_TIMEOUT_PERCENTILE
+#define AT_TIMEOUT_PERCENTILE		99U
+#endif
+
+/* Margin that is added to percentile (in percents of it), but at least AT_TIMEOUT_MARGIN_MIN
+ * miliseconds */
+#ifndef AT_TIMEOUT_MARGIN
+#define AT_TIMEOUT_MARGIN			50U
+#endif
+#ifndef AT_TIMEOUT_MARGIN_MIN
+#define AT_TIMEOUT_MARGIN_MIN		200U
+#endif
+
+/* Number of answers of class before its learned timeout is used */
+#ifndef AT_TIMEOUT_MIN_SAMPLES
+#define AT_TIMEOUT_MIN_SAMPLES		16U
+#endif
+
+/* Shortest learned timeout (in miliseconds), gsm module can stall for a moment at any command */
+#ifndef AT_TIMEOUT_FLOOR
+#define AT_TIMEOUT_FLOOR			300U
+#endif
+
+/* When class has this many samples, all its buckets are halved, so histogram follows network */
+#ifndef AT_TIMEOUT_WINDOW
+#define AT_TIMEOUT_WINDOW			256U
+#endif
+
+/* Shortest time between two saves of learned timeouts in flash (in miliseconds) */
+#ifndef AT_TIMEOUT_SAVE_PERIOD
+#define AT_TIMEOUT_SAVE_PERIOD		3600000U
+#endif
+
+/* Number of buckets of histogram, four in every octave from 16 ms (last one ends above 65 s) */
+#define AT_TIMEOUT_BUCKETS			40U
+
+/* Version of saved record, record of other version is not loaded */
+#define AT_TIMEOUT_VERSION			1U
+
+/**
+  * @brief  AT timeout class definition, commands whose answers take similar time share one
+  *         histogram
+  */
+typedef enum
+{
+	AT_TIMEOUT_FIXED		= 0x00,			/*!< Timeout of command is used as it is, nothing
+												 is learned									 */
+	AT_TIMEOUT_LOCAL		= 0x01,			/*!< Settings and queries answered by module	 */
+	AT_TIMEOUT_STORAGE		= 0x02,			/*!< Reading and deleting of sms				 */
+	AT_TIMEOUT_NETWORK		= 0x03,			/*!< Operator, gprs attach and pdp context		 */
+	AT_TIMEOUT_CONNECT		= 0x04,			/*!< Opening and closing of connection to server */
+	AT_TIMEOUT_PROMPT		= 0x05,			/*!< Prompt '>' for data or sms text			 */
+	AT_TIMEOUT_SEND			= 0x06,			/*!< "SEND OK" of data or sms that is sent		 */
+	AT_TIMEOUT_BROKER		= 0x07,			/*!< Answer of mqtt broker						 */
+	AT_TIMEOUT_NUMBER		= 0x08			/*!< Number of classes							 */
+} ATTimeoutClass_t;
+
+/**
+  * @brief  AT timeout learning Structure definition, histogram of one class
+  */
+typedef struct __ATTimeoutLearn_t
+{
+	uint16_t bucket[AT_TIMEOUT_BUCKETS];		/*!< Number of answers in every bucket of latency	 */
+
+	uint16_t samples;							/*!< Sum of buckets								 */
+
+	uint32_t timeout;							/*!< Learned timeout (in miliseconds), 0 while
+													 there are not enough samples					 */
+
+}ATTimeoutLearn_t;
+
+/* Initialization operation functions ****************************************************************/
+void AT_TIMEOUT_Init(void);
+
+/* IO operation functions ****************************************************************************/
+uint32_t AT_TIMEOUT_Get(ATTimeoutClass_t timeoutClass, uint32_t bound);
+void AT_TIMEOUT_Record(ATTimeoutClass_t timeoutClass, uint32_t latency, DRIVERState_t state);
+DRIVERState_t AT_TIMEOUT_Save(void);
+void AT_TIMEOUT_Process(void);
+
+/* State functions ***********************************************************************************/
+const char *AT_TIMEOUT_Name(ATTimeoutClass_t timeoutClass);
+uint32_t AT_TIMEOUT_Samples(ATTimeoutClass_t timeoutClass);
+uint32_t AT_TIMEOUT_Learned(ATTimeoutClass_t timeoutClass);
+uint32_t AT_TIMEOUT_Percentile(ATTimeoutClass_t timeoutClass, uint32_t percent);
+uint32_t AT_TIMEOUT_SaveCount(void);
+
+#endif /* MIDDLEWARE_AT_TIMEOUT_H_ */
@@ -0,0 +1,215 @@
+/**
+  ********************************************************************************************
+  * @file    at_urc.c
+  * @author  Valentina Denic
+  * @brief   MIDDLEWARE for unsolicited result codes of gsm module.
+  *          This file provides firmware functions to manage the following
+  *          functionalities of the router.
+  *           + Registration of subscribers (callbacks and queues)
+  *           + Classification of received line as answer or unsolicited code
+  *           + Dispatching of unsolicited codes to subscribers
+  *
+  @verbatim
+ ==============================================================================================
+                        ##### How to use this driver #####
+ ==============================================================================================
+  [..]
+    Gsm module sends some lines without command (+CMTI: new sms, CLOSED, +PDP: DEACT,
+    +CREG:, +CGREG:, RING) and they come between lines of answer of command that runs.
+    At engine (at.c) gives every line that it reads to router: line that starts with
+    code from vocabulary is taken out of answer and given to subscribers, so command
+    sees only its own lines and nothing is lost when engine waits for next command.
+    +CREG: and +CGREG: are answers too, so they stay in answer of at+creg and at+cgreg.
+    Characters that come while no command runs and are not unsolicited code (data from
+    server) are given as AT_URC_DATA.
+    The router can be used as follows:
+
+    (#) Declare a ATUrcSubscriber_t, set mask of codes with AT_URC_MASK() and Handle
+        callback (called in at task, it can't send commands) or queue of ATUrcEvent_t
+        (it is not blocked, event that doesn't fit is counted) and register it with
+        AT_URC_Subscribe() function, mask can be changed later (0 stops events)
+    (#) At engine calls AT_URC_Classify(), AT_URC_Possible() and AT_URC_Dispatch() for
+        every line it reads, AT_URC_Code() gives result code that ends command which
+        runs when code comes (CLOSED)
+  @endverbatim
+  *
+  *********************************************************************************************
+  */
+
+/* Includes ----------------------------------------------------------------------------------*/
+#include <at_urc.h>
+#include <driver_trace.h>
+#include <ctype.h>
+
+/**
+  * @brief  AT unsolicited vocabulary entry Structure definition
+  */
+typedef struct __ATUrcCode_t
+{
+	const char *text;							/*!< Characters at start of line				 */
+
+	ATUrc_t urc;								/*!< Unsolicited code							 */
+
+	const char *owner;							/*!< Start of command whose answer has the same
+													 line, NULL if there is none				 */
+
+	ATResult_t code;							/*!< Result code that ends command which runs	 */
+
+}ATUrcCode_t;
+
+/* Vocabulary of unsolicited result codes */
+static const ATUrcCode_t urcVocabulary[] =
+{
+	{"+CMTI:",			AT_URC_NEW_SMS,		NULL,			AT_RESULT_NONE},
+	{"CLOSED\r",		AT_URC_CLOSED,		NULL,			AT_RESULT_CLOSED},
+	{"+PDP: DEACT",		AT_URC_PDP_DEACT,	NULL,			AT_RESULT_NONE},
+	{"+CREG:",			AT_URC_CREG,		"at+creg",		AT_RESULT_NONE},
+	{"+CGREG:",			AT_URC_CGREG,		"at+cgreg",		AT_RESULT_NONE},
+	{"RING\r",			AT_URC_RING,		NULL,			AT_RESULT_NONE}
+};
+
+/* Registered subscribers */
+static ATUrcSubscriber_t *urcSubscribers;
+
+/**
+  * @brief Register subscriber of unsolicited codes.
+  * @param subscriber   AT subscriber.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t AT_URC_Subscribe(ATUrcSubscriber_t *subscriber)
+{
+	if(subscriber == NULL || (subscriber->Handle == NULL && subscriber->queue == NULL))
+		return DRIVER_ERROR;
+
+	subscriber->dropCount = 0;
+
+	/* At task can walk list at the same time */
+	taskENTER_CRITICAL();
+	subscriber->next = urcSubscribers;
+	urcSubscribers = subscriber;
+	taskEXIT_CRITICAL();
+
+	return DRIVER_OK;
+}
+
+/**
+  * @brief Check if command is the one whose answer has line of vocabulary entry.
+  * @param entry        Vocabulary entry.
+  * @param command      Characters of command that runs, NULL when no command runs.
+  * @retval bool true if line belongs to answer
+  */
+static bool ownedBy(const ATUrcCode_t *entry, const uint8_t *command)
+{
+	if(entry->owner == NULL || command == NULL) return false;
+
+	for(const char *character = entry->owner; *character != '\0'; character++, command++)
+	{
+		if(tolower(*command) != *character) return false;
+	}
+
+	return true;
+}
+
+/**
+  * @brief Unsolicited code of one received line.
+  * @param text         Start of line.
+  * @param length       Number of characters of line with its end.
+  * @param command      Characters of command that runs, NULL when no command runs.
+  * @retval ATUrc_t code or AT_URC_NONE when line is not unsolicited
+  */
+ATUrc_t AT_URC_Classify(const uint8_t *text, uint32_t length, const uint8_t *command)
+{
+	for(uint32_t i = 0; i < sizeof(urcVocabulary) / sizeof(urcVocabulary[0]); i++)
+	{
+		uint32_t size = strlen(urcVocabulary[i].text);
+
+		if(length >= size && memcmp(text, urcVocabulary[i].text, size) == 0 && !ownedBy(&urcVocabulary[i], command))
+			return urcVocabulary[i].urc;
+	}
+
+	return AT_URC_NONE;
+}
+
+/**
+  * @brief Check if line that didn't end yet can still be unsolicited code.
+  * @param text         Start of line.
+  * @param length       Number of received characters of line.
+  * @param command      Characters of command that runs, NULL when no command runs.
+  * @retval bool true while end of line decides
+  */
+bool AT_URC_Possible(const uint8_t *text, uint32_t length, const uint8_t *command)
+{
+	for(uint32_t i = 0; i < sizeof(urcVocabulary) / sizeof(urcVocabulary[0]); i++)
+	{
+		uint32_t size = strlen(urcVocabulary[i].text);
+
+		if(memcmp(text, urcVocabulary[i].text, length < size ? length : size) == 0 && !ownedBy(&urcVocabulary[i], command))
+			return true;
+	}
+
+	return false;
+}
+
+/**
+  * @brief Check if any subscriber wants unsolicited code.
+  * @param urc          Unsolicited code.
+  * @retval bool true if there is subscriber
+  */
+bool AT_URC_Subscribed(ATUrc_t urc)
+{
+	for(ATUrcSubscriber_t *subscriber = urcSubscribers; subscriber != NULL; subscriber = subscriber->next)
+	{
+		if(subscriber->mask & AT_URC_MASK(urc)) return true;
+	}
+
+	return false;
+}
+
+/**
+  * @brief Result code that ends command which runs when unsolicited code comes.
+  * @param urc          Unsolicited code.
+  * @retval ATResult_t code or AT_RESULT_NONE when command continues
+  */
+ATResult_t AT_URC_Code(ATUrc_t urc)
+{
+	for(uint32_t i = 0; i < sizeof(urcVocabulary) / sizeof(urcVocabulary[0]); i++)
+	{
+		if(urcVocabulary[i].urc == urc) return urcVocabulary[i].code;
+	}
+
+	return AT_RESULT_NONE;
+}
+
+/**
+  * @brief Give unsolicited code to every subscriber that wants it.
+  * @param urc          Unsolicited code.
+  * @param text         Line (or data) with its end.
+  * @param length       Number of characters.
+  * @retval void
+  */
+void AT_URC_Dispatch(ATUrc_t urc, const uint8_t *text, uint32_t length)
+{
+	ATUrcEvent_t event;
+
+	DRIVER_TRACE(TRACE_AT_URC, urc, length);
+
+	for(ATUrcSubscriber_t *subscriber = urcSubscribers; subscriber != NULL; subscriber = subscriber->next)
+	{
+		if((subscriber->mask & AT_URC_MASK(urc)) == 0) continue;
+
+		if(subscriber->Handle != NULL) subscriber->Handle(urc, text, length, subscriber->context);
+
+		if(subscriber->queue == NULL) continue;
+
+		/* Queue is never blocked, at task must read next line */
+		for(uint32_t sent = 0; sent < length; sent += event.length)
+		{
+			event.urc = urc;
+			event.length = length - sent < AT_URC_LINE_SIZE - 1 ? length - sent : AT_URC_LINE_SIZE - 1;
+			memcpy(event.text, text + sent, event.length);
+			event.text[event.length] = '\0';
+
+			if(xQueueSend(subscriber->queue, (void*) &event, 0) != pdTRUE) subscriber->dropCount++;
+		}
+	}
+}
@@ -0,0 +1,83 @@
+/**
+  ***************************************************************************************************
+  * @file    at_urc.h
+  * @author  Valentina Denic
+  * @brief   This file contains all the functions prototypes for the router of unsolicited
+  *          result codes (lines that gsm module sends without command, eg. new sms).
+  ***************************************************************************************************
+  */
+
+#ifndef MIDDLEWARE_AT_URC_H_
+#define MIDDLEWARE_AT_URC_H_
+
+#include <driver_common.h>
+#include <at_match.h>
+
+/* Largest number of characters of one event that is put in queue of subscriber */
+#define AT_URC_LINE_SIZE			64U
+
+/* Mask of subscriber for one unsolicited code */
+#define AT_URC_MASK(urc)			(1UL << (urc))
+
+/**
+  * @brief  AT unsolicited result code definition
+  */
+typedef enum
+{
+	AT_URC_NONE			= 0x00,				/*!< Line belongs to answer of command			 */
+	AT_URC_NEW_SMS		= 0x01,				/*!< Line "+CMTI: <mem>,<index>"				 */
+	AT_URC_CLOSED		= 0x02,				/*!< Line "CLOSED", server closed connection	 */
+	AT_URC_PDP_DEACT	= 0x03,				/*!< Line "+PDP: DEACT", network dropped context */
+	AT_URC_CREG			= 0x04,				/*!< Line "+CREG: <stat>" without at+creg		 */
+	AT_URC_CGREG		= 0x05,				/*!< Line "+CGREG: <stat>" without at+cgreg		 */
+	AT_URC_RING			= 0x06,				/*!< Line "RING", incoming call					 */
+	AT_URC_DATA			= 0x07,				/*!< Characters received while no command runs
+												 (data from server)							 */
+	AT_URC_NUMBER		= 0x08				/*!< Number of codes							 */
+} ATUrc_t;
+
+/**
+  * @brief  AT unsolicited event Structure definition, element of queue of subscriber
+  */
+typedef struct __ATUrcEvent_t
+{
+	ATUrc_t urc;								/*!< Unsolicited code							 */
+
+	uint32_t length;							/*!< Number of characters of text				 */
+
+	uint8_t text[AT_URC_LINE_SIZE];				/*!< Line with its end, terminated with '\0',
+													 longer data is split in several events	 */
+
+}ATUrcEvent_t;
+
+/**
+  * @brief  AT subscriber Structure definition, it must live as long as at engine
+  */
+typedef struct __ATUrcSubscriber_t
+{
+	uint32_t mask;								/*!< AT_URC_MASK() of codes that subscriber wants	 */
+
+	void (*Handle)(ATUrc_t urc, const uint8_t *text, uint32_t length, void *context);	/*!< Called in
+													 at task, it doesn't send commands, can be NULL	 */
+
+	void *context;								/*!< Argument of Handle, not used by router			 */
+
+	QueueHandle_t queue;						/*!< Queue of ATUrcEvent_t, can be NULL				 */
+
+	uint32_t dropCount;							/*!< Number of events that didn't fit in queue		 */
+
+	struct __ATUrcSubscriber_t *next;			/*!< Next subscriber, set by AT_URC_Subscribe()		 */
+
+}ATUrcSubscriber_t;
+
+/* Initialization operation functions ****************************************************************/
+DRIVERState_t AT_URC_Subscribe(ATUrcSubscriber_t *subscriber);
+
+/* IO operation functions ****************************************************************************/
+ATUrc_t AT_URC_Classify(const uint8_t *text, uint32_t length, const uint8_t *command);
+bool AT_URC_Possible(const uint8_t *text, uint32_t length, const uint8_t *command);
+bool AT_URC_Subscribed(ATUrc_t urc);
+ATResult_t AT_URC_Code(ATUrc_t urc);
+void AT_URC_Dispatch(ATUrc_t urc, const uint8_t *text, uint32_t length);
+
+#endif /* MIDDLEWARE_AT_URC_H_ */
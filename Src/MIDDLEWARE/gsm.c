@@ -32,6 +32,7 @@
 	(#) Registers gsm module to mobile network station in Serbia region
 	(#) Deregisters gsm module from mobile network
 	(#) Check if it is gsm module registered on the network
+	(#) Check registration to GPRS service, signal quality and selected operator
 	(#) Set Access Point Name (APN) for current region (Serbia)
 	(#) Check setted Access Point Name
 	(#) Set wireless connection to GPRS service
@@ -50,18 +51,147 @@
 	(#) Establish TCP\IP connection(calling 4 function for this implementation)
 
 	(#) onlyPutNumber() is function that checks users input and demanding only to put number
-	(#) waitUntil() function is used to wait response from gsm by using TIME_Delay() function
-	 	which uses timer for timing
+	(#) Every command is sent with AT_Command() (at.c), at task sends it and waits for its answer,
+		so functions can be called from several tasks at once, command and data after prompt
+		('>') are sent as one chain with AT_Execute()
+	(#) Commands are described in table of gsm commands (GSMCommand_t: template, expected final
+		result code, timeout, size of answer, parser), GSM_Execute() formats arguments in
+		template and runs any of them, GSM_* functions only give it arguments
+	(#) Timeout of command in table is its longest time, at engine waits for timeout that is
+		learned from latency of its class (at_timeout.c) when it is shorter
+	(#) EstablishTCPClientConnection() runs state machine of bring up (GSM_BringUpStart(),
+		GSM_BringUpStep() or GSM_BringUp()): settings and registration query in one command
+		line (at+creg=2;+cgreg=2;+cipsendhex=1;+creg?, commands one by one when gsm refuses it), wait
+		for registration, then at+cgact=1 and at+cipstart as one chain of at engine, steps
+		whose state is already reached are skipped
+	(#) GSM_Init() subscribes handle to unsolicited lines of at engine (at_urc.c), so new
+		messages are counted and state of network and sockets follows "+CREG:", "+CGREG:",
+		"CLOSED" and "+PDP: DEACT" without polling
+	(#) GSM_NetworkRegistered() turns on reports of registration with area and cell (at+creg=2,
+		at+cgreg=2), every change of registration is sent as GSMRegEvent_t to queues that are
+		subscribed with GSM_RegistrationSubscribe(), so tasks wake when network comes up or
+		is lost instead of polling at+creg?
+	(#) Answers of query commands (+CREG, +CGREG, +CSQ, +CGDCONT, +CGACT, +CIFSR, STATE: and
+		+COPS) are parsed in place with at_parse.c, typed values are kept in network structure
+		of handle and are copied to output of GSM_Execute() when it isn't NULL
+	(#) GSM_ListMsg() parses every +CMGL: message while gsm lists it and gives it to callback
+		of GSMSmsList_t, answer buffer holds only few lines (GSM_LIST_RESPONSE_SIZE) and one
+		record is kept, so any number of stored messages can be listed
+	(#) In pdu mode (GSM_MsgFormat() with GSM_PDU_MODE) GSM_SendStoreMsg() encodes message as
+		SMS-SUBMIT (sms_pdu.c, 7 bit alphabet when text fits in it, UCS2 otherwise) and sends
+		at+cmgs=<length> or at+cmgw=<length> with pdu after prompt, GSM_ReadMsg() and
+		GSM_ListMsg() decode pdu of message in the same record as text mode fills
+	(#) Answers and unsolicited lines keep cached state of modem (registration, GPRS attach,
+		state of IP connection and active PDP contexts) as bits of event group of handle, tasks
+		read it with GSM_GetState() and wait for it with GSM_WaitState() (eg. GSM_STATE_ONLINE),
+		functions whose state is already reached return DRIVER_OK without sending command
+	(#) Sending to server, sending of sms, connecting and bring up have *_Async variants
+		(GSM_SendToServer_Async()...) that return at once, the same function runs in async
+		task (async.c) and caller polls or waits for completion handle or gets callback
   @endverbatim
   *
   **********************************************************************************************************************
   */
 
 #include <gsm.h>
+#include <driver_memory.h>
+#include <stdarg.h>
+#include <stdio.h>
 
 /* Set default format of messages */
 GSMMsgFormat_t formatOfMsg = GSM_TEXT_MODE;
 
+/* Parsers of answers of commands from table of gsm commands */
+static DRIVERState_t parseCopy(gsmHandler_t *gsmHandler, uint8_t *answer, uint32_t length, void *output);
+static DRIVERState_t parseStorage(gsmHandler_t *gsmHandler, uint8_t *answer, uint32_t length, void *output);
+static DRIVERState_t parseStorageTest(gsmHandler_t *gsmHandler, uint8_t *answer, uint32_t length, void *output);
+static DRIVERState_t parseListMsg(gsmHandler_t *gsmHandler, uint8_t *answer, uint32_t length, void *output);
+static DRIVERState_t parseReadMsg(gsmHandler_t *gsmHandler, uint8_t *answer, uint32_t length, void *output);
+static DRIVERState_t parseRegistration(gsmHandler_t *gsmHandler, uint8_t *answer, uint32_t length, void *output);
+static DRIVERState_t parseLocalIP(gsmHandler_t *gsmHandler, uint8_t *answer, uint32_t length, void *output);
+static DRIVERState_t parseGprsRegistration(gsmHandler_t *gsmHandler, uint8_t *answer, uint32_t length, void *output);
+static DRIVERState_t parseSignal(gsmHandler_t *gsmHandler, uint8_t *answer, uint32_t length, void *output);
+static DRIVERState_t parseOperator(gsmHandler_t *gsmHandler, uint8_t *answer, uint32_t length, void *output);
+static DRIVERState_t parseDefinedContexts(gsmHandler_t *gsmHandler, uint8_t *answer, uint32_t length, void *output);
+static DRIVERState_t parseActiveContexts(gsmHandler_t *gsmHandler, uint8_t *answer, uint32_t length, void *output);
+static DRIVERState_t parseIpState(gsmHandler_t *gsmHandler, uint8_t *answer, uint32_t length, void *output);
+
+/* Parsers of lines of answers that are given while they come */
+static void listLine(ATCommand_t *command, const uint8_t *text, uint32_t size);
+
+/* Subscriber of unsolicited lines */
+static void gsmUnsolicited(ATUrc_t urc, const uint8_t *text, uint32_t length, void *context);
+
+/**
+  * @brief  GSM STEP Structure definition, command from table that is sent in chain
+  */
+typedef struct __GSMStep_t
+{
+	GSMCommandId_t id;					/*!< Command from table								*/
+
+	uint8_t *line;						/*!< Formatted command, block from pool				*/
+
+	int size;							/*!< Number of characters of command				*/
+
+	DRIVERState_t result;				/*!< Result of command after chain is done			*/
+
+}GSMStep_t;
+
+/* Table of gsm commands, order of entries is order of GSMCommandId_t */
+static const GSMCommand_t gsmCommands[GSM_CMD_NUMBER] =
+{
+	[GSM_CMD_ECHO] 			= {"ate",			"ate%c\r",								"OK",			3000,	AT_TIMEOUT_LOCAL,		GSM_RESPONSE_SIZE,		NULL,			parseCopy,			NULL},
+	[GSM_CMD_MSG_FORMAT] 	= {"cmgf",			"at+cmgf=%c\r",							"OK",			1000,	AT_TIMEOUT_LOCAL,		GSM_RESPONSE_SIZE,		NULL,			parseCopy,			NULL},
+	[GSM_CMD_SET_STORAGE] 	= {"cpms",			"at+cpms=\"%s\",\"%s\",\"%s\"\r",		"OK",			2000,	AT_TIMEOUT_LOCAL,		GSM_RESPONSE_SIZE,		NULL,			parseStorage,		NULL},
+	[GSM_CMD_TEST_STORAGE] 	= {"cpms=?",		"at+cpms=?\r",							"OK",			1000,	AT_TIMEOUT_LOCAL,		GSM_RESPONSE_SIZE,		NULL,			parseStorageTest,	NULL},
+	[GSM_CMD_LIST_TEXT] 	= {"cmgl",			"at+cmgl=\"%.*s\"\r",					"OK",			20000,	AT_TIMEOUT_STORAGE,		GSM_LIST_RESPONSE_SIZE,	NULL,			parseListMsg,		NULL,	listLine},
+	[GSM_CMD_LIST_PDU] 		= {"cmgl pdu",		"at+cmgl=%c\r",							"OK",			20000,	AT_TIMEOUT_STORAGE,		GSM_LIST_RESPONSE_SIZE,	NULL,			parseListMsg,		NULL,	listLine},
+	[GSM_CMD_READ] 			= {"cmgr",			"at+cmgr=%.*s\r",						"OK",			2000,	AT_TIMEOUT_STORAGE,		GSM_LONG_RESPONSE_SIZE,	NULL,			parseReadMsg,		NULL},
+	[GSM_CMD_DELETE] 		= {"cmgd",			"at+cmgd=%s%.*s\r",						"OK",			5000,	AT_TIMEOUT_STORAGE,		GSM_RESPONSE_SIZE,		NULL,			parseCopy,
+							   "\r\n Message(s) are deleted correctly!\r\n"},
+	[GSM_CMD_NETWORK_ON] 	= {"creg=2",		"at+creg=2\r",							"OK",			2000,	AT_TIMEOUT_LOCAL,		GSM_RESPONSE_SIZE,		NULL,			NULL,
+							   "\r\n Network is now on!\r\n"},
+	[GSM_CMD_NETWORK_OFF] 	= {"creg=0",		"at+creg=0\r",							"OK",			2000,	AT_TIMEOUT_LOCAL,		GSM_RESPONSE_SIZE,		NULL,			NULL,
+							   "\r\n Network is now off!\r\n"},
+	[GSM_CMD_NETWORK_CHECK] = {"creg?",			"at+creg?\r",							"OK",			2000,	AT_TIMEOUT_LOCAL,		GSM_RESPONSE_SIZE,		NULL,			parseRegistration,	NULL},
+	[GSM_CMD_SET_APN] 		= {"cstt",			"at+cstt=\"%s\"\r",						"OK",			15000,	AT_TIMEOUT_LOCAL,		GSM_RESPONSE_SIZE,		NULL,			NULL,
+							   "\r\n APN is setted for Serbia, B&H and Montenegro regions!\r\n"},
+	[GSM_CMD_CHECK_APN] 	= {"cstt?",			"at+cstt?\r",							"OK",			4000,	AT_TIMEOUT_LOCAL,		GSM_RESPONSE_SIZE,		"+CSTT",		NULL,				NULL},
+	[GSM_CMD_GPRS] 			= {"ciicr",			"at+ciicr\r",							"OK",			3000,	AT_TIMEOUT_NETWORK,		GSM_RESPONSE_SIZE,		NULL,			NULL,
+							   "\r\n Wireless connection with GPRS service established!\r\n"},
+	[GSM_CMD_LOCAL_IP] 		= {"cifsr",			"at+cifsr\r",							NULL,			3000,	AT_TIMEOUT_FIXED,		GSM_RESPONSE_SIZE,		NULL,			parseLocalIP,		NULL},
+	[GSM_CMD_ATTACH] 		= {"cgatt=1",		"at+cgatt=1\r",							"OK",			7000,	AT_TIMEOUT_NETWORK,		GSM_RESPONSE_SIZE,		NULL,			NULL,
+							   "\r\n Network attached!\r\n"},
+	[GSM_CMD_DETACH] 		= {"cgatt=0",		"at+cgatt=0\r",							"OK",			7000,	AT_TIMEOUT_NETWORK,		GSM_RESPONSE_SIZE,		NULL,			NULL,
+							   "\r\n Network detached!\r\n"},
+	[GSM_CMD_SET_PDP] 		= {"cgdcont",		"at+cgdcont=%.*s,\"%s\",\"%.*s\"\r",	"OK",			2000,	AT_TIMEOUT_LOCAL,		GSM_RESPONSE_SIZE,		NULL,			NULL,
+							   "\r\n Packet Data Protocol(PDP) is now setted!\r\n"},
+	[GSM_CMD_CHECK_PDP] 	= {"cgdcont?",		"at+cgdcont?\r",						"OK",			4000,	AT_TIMEOUT_LOCAL,		GSM_LONG_RESPONSE_SIZE,	"+CGDCONT",		parseDefinedContexts,	NULL},
+	[GSM_CMD_ACTIVE_PDP] 	= {"cgact?",		"at+cgact?\r",							"OK",			4000,	AT_TIMEOUT_LOCAL,		GSM_RESPONSE_SIZE,		"+CGACT",		parseActiveContexts,	NULL},
+	[GSM_CMD_PDP_IP] 		= {"cgpaddr",		"at+cgpaddr\r",							"OK",			4000,	AT_TIMEOUT_LOCAL,		GSM_LONG_RESPONSE_SIZE,	"+CGPADDR",		NULL,				NULL},
+	[GSM_CMD_PDP_ON] 		= {"cgact=1",		"at+cgact=1,%.*s\r",					"OK",			7000,	AT_TIMEOUT_NETWORK,		GSM_RESPONSE_SIZE,		NULL,			NULL,
+							   "\r\n Packet Data Protocol(PDP) is activated!\r\n"},
+	[GSM_CMD_PDP_OFF] 		= {"cgact=0",		"at+cgact=0,%.*s\r",					"OK",			6000,	AT_TIMEOUT_NETWORK,		GSM_RESPONSE_SIZE,		NULL,			NULL,
+							   "\r\n Packet Data Protocol(PDP) is deactivated!\r\n"},
+	[GSM_CMD_SHUT] 			= {"cipshut",		"at+cipshut\r",							"SHUT OK",		4000,	AT_TIMEOUT_NETWORK,		GSM_RESPONSE_SIZE,		NULL,			NULL,
+							   "\r\n Packet Data Protocol(PDP) is deactivated!\r\n"},
+	[GSM_CMD_AUTO_TIMER] 	= {"cipats",		"at+cipats=%s%.*s\r",					"OK",			4000,	AT_TIMEOUT_LOCAL,		GSM_RESPONSE_SIZE,		NULL,			NULL,				NULL},
+	[GSM_CMD_SEND_FORMAT] 	= {"cipsendhex",	"at+cipsendhex=%c\r",					"OK",			3000,	AT_TIMEOUT_LOCAL,		GSM_RESPONSE_SIZE,		NULL,			NULL,				NULL},
+	[GSM_CMD_CONNECT] 		= {"cipstart",		"at+cipstart=\"%s\",\"%s\",\"%s\"\r",	"CONNECT OK",	7000,	AT_TIMEOUT_CONNECT,		GSM_RESPONSE_SIZE,		NULL,			NULL,
+							   "\r\n Connection with server started!\r\n"},
+	[GSM_CMD_CLOSE] 		= {"cipclose",		"at+cipclose\r",						"CLOSE OK",		5000,	AT_TIMEOUT_CONNECT,		GSM_RESPONSE_SIZE,		NULL,			NULL,
+							   "\r\n Connection with server ended!\r\n"},
+	[GSM_CMD_STATUS] 		= {"cipstatus",		"at+cipstatus\r",						NULL,			2000,	AT_TIMEOUT_FIXED,		GSM_RESPONSE_SIZE,		"STATE:",		parseIpState,		NULL},
+	[GSM_CMD_GPRS_CHECK] 	= {"cgreg?",		"at+cgreg?\r",							"OK",			2000,	AT_TIMEOUT_LOCAL,		GSM_RESPONSE_SIZE,		NULL,			parseGprsRegistration,	NULL},
+	[GSM_CMD_SIGNAL] 		= {"csq",			"at+csq\r",							"OK",			2000,	AT_TIMEOUT_LOCAL,		GSM_RESPONSE_SIZE,		NULL,			parseSignal,		NULL},
+	[GSM_CMD_OPERATOR] 		= {"cops?",			"at+cops?\r",							"OK",			5000,	AT_TIMEOUT_NETWORK,		GSM_RESPONSE_SIZE,		NULL,			parseOperator,		NULL},
+	[GSM_CMD_BRINGUP] 		= {"bringup",		"at+creg=2;+cgreg=2;+cipsendhex=%c;+creg?\r",	"OK",	3000,	AT_TIMEOUT_LOCAL,		GSM_RESPONSE_SIZE,		NULL,			parseRegistration,	NULL},
+	[GSM_CMD_GPRS_REPORT] 	= {"cgreg=2",		"at+cgreg=2\r",							"OK",			2000,	AT_TIMEOUT_LOCAL,		GSM_RESPONSE_SIZE,		NULL,			NULL,				NULL}
+};
+
+/* Statistics of every command from table */
+static GSMCommandStats_t gsmCommandStats[GSM_CMD_NUMBER];
+
 /**
   * @brief Demand input to be only number.
   * @param console      Console handle.
@@ -115,36 +245,6 @@ DRIVERState_t onlyPutNumber(DRIVERConsoleHandler_t *console, uint8_t *buffer, ui
 	return DRIVER_TIMEOUT;
 }
 
-/**
-  * @brief Wait response from gsm until timeout.
-  * @param gsm          GSM handle.
-  * @param buffer       Storage of received characters.
-  * @param size         Number of characters readed.
-  * @param timeout      Function timeout.
-  * @param string       Required string in buffer.
-  * @retval DRIVERState_t status
-  */
-DRIVERState_t waitUntil(DRIVERGsmHandler_t *gsm,uint8_t *buffer,uint32_t *size, uint32_t timeout, const uint8_t *string)
-{
-	/* Take current time and check if timeout occured */
-	uint32_t tickstart = TIME_GetTick();
-	while(TIME_GetTick() - tickstart < timeout)
-	{
-		DRIVER_GSM_Read(gsm, buffer, size);
-
-		/* Badly received response from gsm */
-		if(strstr((const char*)buffer,(const char*)"ERROR") != NULL)
-			return DRIVER_ERROR;
-		else if(strstr((const char*)buffer,(const char*)string) != NULL)
-		{
-			/* Successfully received response from gsm */
-			return DRIVER_OK;
-		}
-	}
-	/* Haven't received response from gsm */
-	return DRIVER_TIMEOUT;
-}
-
 DRIVERState_t GSM_Init(gsmHandler_t *handler, gsmConfig_t *config)
 {
 	/* When i don't have any handler to initalize current handle, exit and return error */
@@ -173,114 +273,386 @@ DRIVERState_t GSM_Init(gsmHandler_t *handler, gsmConfig_t *config)
 
 	handler->network.status = NETWORK_DISCONNECTED;
 
+	handler->newMsgCount 	= 0;
+
+	/* Values from answers of query commands are not known yet */
+	handler->network.address 					= 0;
+	handler->network.registration.mode 			= AT_PARSE_NONE;
+	handler->network.registration.state 		= AT_REG_UNKNOWN;
+	handler->network.registration.area 			= 0;
+	handler->network.registration.cell 			= 0;
+	handler->network.gprsRegistration 			= handler->network.registration;
+	handler->network.signal.rssi 				= AT_PARSE_RSSI_UNKNOWN;
+	handler->network.signal.ber 				= AT_PARSE_RSSI_UNKNOWN;
+	handler->network.signal.dbm 				= 0;
+	handler->network.ipState 					= AT_IP_UNKNOWN;
+	handler->network.definedContexts 			= 0;
+	handler->network.activeContexts 			= 0;
+	handler->network.operatorName[0] 			= '\0';
+
+	/* Nothing is known about modem until first answer */
+	if(handler->state == NULL) handler->state = xEventGroupCreate();
+	if(handler->state == NULL)
+		return DRIVER_ERROR;
+	xEventGroupClearBits(handler->state, GSM_STATE_CONNECTION | GSM_STATE_ONLINE | GSM_STATE_REPORTING | GSM_STATE_HEX_FORMAT |
+						 GSM_STATE_GPRS_REPORTING);
+
+	/* First answer or report of every domain is an event */
+	handler->regSubscribers 	= 0;
+	handler->regEventCount 		= 0;
+	handler->regDropCount 		= 0;
+	for(uint32_t domain = 0; domain < GSM_REG_NUMBER; domain++)
+	{
+		memset(&handler->regLast[domain], 0, sizeof(GSMRegEvent_t));
+		handler->regLast[domain].domain = (GSMRegDomain_t)domain;
+		handler->regLast[domain].state 	= AT_REG_UNKNOWN;
+	}
+
+	/* State of network and sockets follows unsolicited lines too, not only answers */
+	handler->urc.mask 		= AT_URC_MASK(AT_URC_NEW_SMS) | AT_URC_MASK(AT_URC_CLOSED) |
+							  AT_URC_MASK(AT_URC_PDP_DEACT) | AT_URC_MASK(AT_URC_CREG) | AT_URC_MASK(AT_URC_CGREG);
+	handler->urc.Handle 	= gsmUnsolicited;
+	handler->urc.context 	= handler;
+	handler->urc.queue 		= NULL;
+	if(AT_URC_Subscribe(&handler->urc) != DRIVER_OK)
+		return DRIVER_ERROR;
+
 	memset(handler->network.IPaddress,0,sizeof(handler->socket[i].IPaddress));
 
 	return DRIVER_OK;
 }
 
+
 /**
-  * @brief Set echo using AT command.
+  * @brief Number of characters of argument that user ended with '\r' (or '\0').
+  * @param argument     Characters of argument.
+  * @retval int number of characters before end, for "%.*s" in template of command
+  */
+static int argumentLength(const uint8_t *argument)
+{
+	int length = 0;
+
+	while(argument[length] != '\r' && argument[length] != '\0') length++;
+
+	return length;
+}
+
+/**
+  * @brief Write number of message in international format, national number gets country code.
+  * @param number       Number from user, ends with '\r' or '\0'.
+  * @param output       Number with '+', ends with '\0'.
+  * @param size         Size of output.
+  * @retval void
+  */
+static void internationalNumber(const uint8_t *number, uint8_t *output, uint32_t size)
+{
+	int length = argumentLength(number);
+
+	if(*number == '+') snprintf((char*)output, size, "%.*s", length, number);
+	else if(*number == '0') snprintf((char*)output, size, GSM_COUNTRY_CODE "%.*s", length - 1, number + 1);
+	else snprintf((char*)output, size, GSM_COUNTRY_CODE "%.*s", length, number);
+}
+
+/**
+  * @brief Format command from table of gsm commands in block from pool.
   * @param gsmHandler   GSM handle that contains everything about gsm module.
-  * @param timeout      Timeout period for console.
-  * @retval DRIVERState_t status
+  * @param command      Entry of table.
+  * @param msgSize      Number of characters of formatted command.
+  * @param arguments    Arguments for template of command.
+  * @retval uint8_t* block with command or NULL, caller frees it with POOL_Free()
   */
-DRIVERState_t GSM_SetEcho(gsmHandler_t *gsmHandler, uint32_t timeout, GSMEcho_t echoOnOFF, OutputStruct_t *outputStruct)
+static uint8_t *formatCommand(gsmHandler_t *gsmHandler, const GSMCommand_t *command, int *msgSize, va_list arguments)
 {
-	/* Buffer for putting answer from gsm */
-	uint8_t buffer[100] = {0};
+	va_list copy;
+	va_copy(copy, arguments);
+	*msgSize = vsnprintf(NULL, 0, command->format, copy);
+	va_end(copy);
 
-	/* How many characters are received from gsm-it's importent to be zero initialize */
-	uint32_t size = 0;
+	if(*msgSize <= 0 || *msgSize >= GSM_LONG_COMMAND_SIZE)
+	{
+		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: arguments of gsm command are too long!\r\n");
+		return NULL;
+	}
 
-	/* Checking if user send correct gsm and console */
-	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
+	/* Short commands take blocks of at class, so they don't wait for blocks that sms records use,
+	 * only commands with long arguments (server, apn, http and mqtt) take long blocks */
+	uint32_t size = *msgSize < GSM_COMMAND_SIZE ? GSM_COMMAND_SIZE : GSM_LONG_COMMAND_SIZE;
+	uint8_t *msgToSend = POOL_Alloc(size);
+	if(msgToSend == NULL)
 	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError: incorrect console and gsm module!\r\n");
-		return DRIVER_ERROR;
+		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: no free block for gsm command!\r\n");
+		return NULL;
 	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
 
-	/* Reset buffer and his size */
-	memset(buffer,0,sizeof(buffer));
-	size = 0;
+	vsnprintf((char*)msgToSend, size, command->format, arguments);
 
-	/* Set command for echo mode */
-	uint8_t echo[5] = {'A','T','E',echoOnOFF == GSM_ECHO_ON? '1':'0','\r'};
+	return msgToSend;
+}
+
+/**
+  * @brief Count command and parse its answer, the same for every command from table.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param id           Command from table.
+  * @param state        Result of command from at engine.
+  * @param buffer       Answer from gsm.
+  * @param size         Number of characters of answer.
+  * @param output       Output of parser of command, NULL when parser doesn't have output.
+  * @param elapsed      Time of command (in miliseconds), 0 when it isn't known.
+  * @retval DRIVERState_t status
+  */
+static DRIVERState_t finishCommand(gsmHandler_t *gsmHandler, GSMCommandId_t id, DRIVERState_t state, uint8_t *buffer,
+								   uint32_t size, void *output, uint32_t elapsed)
+{
+	const GSMCommand_t *command = &gsmCommands[id];
 
-	/* Send command to gsm */
-	DRIVER_GSM_Write(gsmHandler->gsm, echo,sizeof(echo));
+	/* Statistics of command */
+	GSMCommandStats_t *stats = &gsmCommandStats[id];
+	stats->count++;
+	if(elapsed > stats->maxTime) stats->maxTime = elapsed;
 
-	/* Read response from gsm  and set response for user*/
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 3000, (const uint8_t*)"OK\r\n")){
+	/* Read response from gsm and set response for user */
+	switch(state){
 	case DRIVER_TIMEOUT:
+		stats->timeoutCount++;
 		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_TIMEOUT;
+		break;
 	case DRIVER_ERROR:
+		stats->errorCount++;
 		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_ERROR;
+		break;
 	case DRIVER_OK:
-		strcpy((char*)outputStruct->gsmRsp,(const char*)buffer);
-		if(echoOnOFF == GSM_ECHO_ON) DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\nEcho is now ON!\r\n");
-		else DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\nEcho is now OFF!\r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_OK;
-
+		if(command->show != NULL)
+		{
+			/* Display part of answer directly from buffer, until final result code */
+			uint8_t *startStr = (uint8_t*)strstr((char*)buffer, command->show);
+			DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n");
+			if(startStr != NULL)
+			{
+				uint8_t *endStr = (uint8_t*)strstr((char*)startStr, "\r\nOK\r");
+				if(endStr != NULL) *endStr = '\0';
+				DRIVER_CONSOLE_Put(gsmHandler->console, startStr);
+				DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n");
+			}
+		}
+		if(command->Parse != NULL) state = command->Parse(gsmHandler, buffer, size, output);
+		if(state == DRIVER_OK && command->done != NULL) DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)command->done);
+		break;
 	}
-	return DRIVER_OK;
+
+	return state;
 }
 
 /**
-  * @brief Set message format, for sending and receiving message, using AT command.
+  * @brief Send command from table of gsm commands and parse its answer.
   * @param gsmHandler   GSM handle that contains everything about gsm module.
-  * @param timeout      Timeout period for console.
+  * @param id           Command from table.
+  * @param output       Output of parser of command, NULL when parser doesn't have output.
+  * @param ...          Arguments for template of command.
   * @retval DRIVERState_t status
   */
-DRIVERState_t GSM_MsgFormat(gsmHandler_t *gsmHandler, uint32_t timeout, GSMMsgFormat_t format,OutputStruct_t *outputStruct)
+DRIVERState_t GSM_Execute(gsmHandler_t *gsmHandler, GSMCommandId_t id, void *output, ...)
 {
-	/* Buffer for putting answer from gsm */
-	uint8_t buffer[100] = {0};
-
-	/* How many characters are received from gsm */
-	uint32_t size = 0;
-
 	/* Checking if user send correct gsm and console */
 	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
 	{
 		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
 		return DRIVER_ERROR;
 	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
 
-	/* Set command for formating message */
-	uint8_t msgFormat[] = {'a','t','+','c','m','g','f','=', format == GSM_TEXT_MODE? '1':'0','\r'};
+	if(id >= GSM_CMD_NUMBER) return DRIVER_ERROR;
+	const GSMCommand_t *command = &gsmCommands[id];
 
-	/* Send command to gsm */
-	DRIVER_GSM_Write(gsmHandler->gsm, msgFormat,sizeof(msgFormat));
+	/* Format command with its arguments */
+	int msgSize = 0;
+	va_list arguments;
+	va_start(arguments, output);
+	uint8_t *msgToSend = formatCommand(gsmHandler, command, &msgSize, arguments);
+	va_end(arguments);
+	if(msgToSend == NULL) return DRIVER_ERROR;
 
-	/* Read response from gsm  and set response for user*/
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 1000,(const uint8_t*)"OK\r\n")){
-	case DRIVER_TIMEOUT:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_TIMEOUT;
-	case DRIVER_ERROR:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
+	/* Answer from gsm is taken from arena of calling task */
+	ARENAHandler_t *arena 	= ARENA_Current();
+	ARENAMark_t scope 		= ARENA_Mark(arena);
+	uint8_t *buffer 		= ARENA_Alloc(arena, command->responseSize);
+	if(buffer == NULL)
+	{
+		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: not enough scratch memory for answer from gsm!\r\n");
+		POOL_Free(msgToSend);
 		return DRIVER_ERROR;
-	case DRIVER_OK:
-		strcpy((char*)outputStruct->gsmRsp,(const char*)buffer);
+	}
+	buffer[0] = '\0';
+
+	/* Class of command is given to at engine, so its timeout can be learned */
+	ATCommand_t request = {.command = msgToSend, .commandSize = msgSize, .expect = (const uint8_t*)command->expect,
+						   .timeout = command->timeout, .timeoutClass = command->timeoutClass, .response = buffer,
+						   .responseSize = command->responseSize, .Line = command->Line, .context = output};
+	uint32_t tickstart = TIME_GetTick();
+	DRIVERState_t state = AT_Execute(&request);
+	uint32_t elapsed = TIME_GetTick() - tickstart;
+	POOL_Free(msgToSend);
+
+	state = finishCommand(gsmHandler, id, state, buffer, request.length, output, elapsed);
+
+	ARENA_Release(arena, scope);
+	return state;
+}
+
+/**
+  * @brief Format step of chain of commands from table.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param step         Step of chain.
+  * @param id           Command from table.
+  * @param ...          Arguments for template of command.
+  * @retval DRIVERState_t status
+  */
+static DRIVERState_t formatStep(gsmHandler_t *gsmHandler, GSMStep_t *step, GSMCommandId_t id, ...)
+{
+	va_list arguments;
+	va_start(arguments, id);
+	step->id = id;
+	step->line = formatCommand(gsmHandler, &gsmCommands[id], &step->size, arguments);
+	va_end(arguments);
+
+	return step->line != NULL ? DRIVER_OK : DRIVER_ERROR;
+}
+
+/**
+  * @brief Send formatted commands from table as one chain of at engine, so gsm gets next command
+  *        as soon as previous one succeeds, without return to calling task and its console.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param steps        Steps of chain, their lines are freed and results are set.
+  * @param number       Number of steps, at most GSM_CHAIN_LENGTH.
+  * @retval DRIVERState_t result of first step that didn't succeed, DRIVER_OK if none
+  */
+static DRIVERState_t executeChain(gsmHandler_t *gsmHandler, GSMStep_t *steps, uint32_t number)
+{
+	ATCommand_t request[GSM_CHAIN_LENGTH] = {0};
+	DRIVERState_t state = DRIVER_OK;
+
+	/* Answers from gsm are taken from arena of calling task */
+	ARENAHandler_t *arena 	= ARENA_Current();
+	ARENAMark_t scope 		= ARENA_Mark(arena);
+
+	for(uint32_t i = 0; i < number; i++)
+	{
+		const GSMCommand_t *command = &gsmCommands[steps[i].id];
+
+		request[i].command 		= steps[i].line;
+		request[i].commandSize 	= steps[i].size;
+		request[i].expect 		= (const uint8_t*)command->expect;
+		request[i].timeout 		= command->timeout;
+		request[i].timeoutClass = command->timeoutClass;
+		request[i].responseSize = command->responseSize;
+		request[i].response 	= ARENA_Alloc(arena, command->responseSize);
+		request[i].next 		= i + 1 < number ? &request[i + 1] : NULL;
+		if(request[i].response == NULL) state = DRIVER_ERROR;
+	}
+
+	if(number == 0 || number > GSM_CHAIN_LENGTH || state != DRIVER_OK)
+	{
+		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: not enough scratch memory for answer from gsm!\r\n");
+		state = DRIVER_ERROR;
+	}
+	else AT_Execute(&request[0]);
+
+	/* Commands after the one that didn't succeed were not sent, they are not counted */
+	bool sent = state == DRIVER_OK;
+	for(uint32_t i = 0; i < number; i++)
+	{
+		POOL_Free(steps[i].line);
+		steps[i].line = NULL;
+
+		if(!sent)
+		{
+			steps[i].result = DRIVER_ERROR;
+			continue;
+		}
+		sent = request[i].result == DRIVER_OK;
+
+		/* Time of one command of chain isn't known, at engine learns it (at_timeout.c) */
+		steps[i].result = finishCommand(gsmHandler, steps[i].id, request[i].result, request[i].response,
+										request[i].length, NULL, 0);
+		if(state == DRIVER_OK) state = steps[i].result;
+	}
+
+	ARENA_Release(arena, scope);
+	return state;
+}
+
+/**
+  * @brief Entry of table of gsm commands.
+  * @param id           Command from table.
+  * @retval const GSMCommand_t* entry or NULL for unknown command
+  */
+const GSMCommand_t *GSM_GetCommand(GSMCommandId_t id)
+{
+	return id < GSM_CMD_NUMBER ? &gsmCommands[id] : NULL;
+}
+
+/**
+  * @brief Statistics of command from table of gsm commands.
+  * @param id           Command from table.
+  * @retval const GSMCommandStats_t* statistics or NULL for unknown command
+  */
+const GSMCommandStats_t *GSM_GetCommandStats(GSMCommandId_t id)
+{
+	return id < GSM_CMD_NUMBER ? &gsmCommandStats[id] : NULL;
+}
+
+/**
+  * @brief Copy answer of gsm to universal output structure.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param answer       Answer from gsm.
+  * @param length       Number of characters of answer.
+  * @param output       OutputStruct_t or NULL.
+  * @retval DRIVERState_t status
+  */
+static DRIVERState_t parseCopy(gsmHandler_t *gsmHandler, uint8_t *answer, uint32_t length, void *output)
+{
+	OutputStruct_t *outputStruct = output;
+
+	if(outputStruct != NULL && outputStruct->gsmRsp != NULL) strcpy((char*)outputStruct->gsmRsp,(const char*)answer);
+
+	return DRIVER_OK;
+}
+
+/**
+  * @brief Set echo using AT command.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param timeout      Timeout period for console.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t GSM_SetEcho(gsmHandler_t *gsmHandler, uint32_t timeout, GSMEcho_t echoOnOFF, OutputStruct_t *outputStruct)
+{
+	DRIVERState_t state = GSM_Execute(gsmHandler, GSM_CMD_ECHO, outputStruct, echoOnOFF == GSM_ECHO_ON ? '1':'0');
+
+	if(state == DRIVER_OK)
+	{
+		if(echoOnOFF == GSM_ECHO_ON) DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\nEcho is now ON!\r\n");
+		else DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\nEcho is now OFF!\r\n");
+	}
+	return state;
+}
+
+/**
+  * @brief Set message format, for sending and receiving message, using AT command.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param timeout      Timeout period for console.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t GSM_MsgFormat(gsmHandler_t *gsmHandler, uint32_t timeout, GSMMsgFormat_t format,OutputStruct_t *outputStruct)
+{
+	DRIVERState_t state = GSM_Execute(gsmHandler, GSM_CMD_MSG_FORMAT, outputStruct, format == GSM_TEXT_MODE ? '1':'0');
+
+	if(state == DRIVER_OK)
+	{
 		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n");
 		if(format == GSM_TEXT_MODE) DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"SMS text mode now is set!");
 		else DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"SMS pdu mode now is set!");
 		formatOfMsg = format;
 		DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_OK;
-
 	}
-	return DRIVER_OK;
+	return state;
 }
 
 /**
@@ -293,19 +665,34 @@ DRIVERState_t GSM_MsgFormat(gsmHandler_t *gsmHandler, uint32_t timeout, GSMMsgFo
   */
 DRIVERState_t GSM_SetMsgStorage(gsmHandler_t *gsmHandler, uint32_t timeout, const SetMsgStrgInputStruct_t inputStruct,OutputStruct_t *outputStruct)
 {
-
 	/* the phone message storage area,"ME" = 1 */
 	/* the SIM message storage area,"SM" = 2 */
-	/* the phone message storage area and SIM message storage area,"MT" = 3 */
+	const char *storage[3] = {NULL, "ME", "SM"};
 
-	/* Buffer for putting answer from gsm */
-	uint8_t buffer[100] = {0};
+	if(inputStruct.memMsgReadDelate < 1 || inputStruct.memMsgReadDelate > 2 ||
+	   inputStruct.memMsgWriteSend < 1 || inputStruct.memMsgWriteSend > 2 ||
+	   inputStruct.memMsgReceive < 1 || inputStruct.memMsgReceive > 2)
+	{
+		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect type of storage!\r\n");
+		return DRIVER_ERROR;
+	}
 
-	/* How many characters are received from gsm */
-	uint32_t size = 0;
+	return GSM_Execute(gsmHandler, GSM_CMD_SET_STORAGE, outputStruct, storage[inputStruct.memMsgReadDelate],
+					   storage[inputStruct.memMsgWriteSend], storage[inputStruct.memMsgReceive]);
+}
 
+/**
+  * @brief Show used and available space of every storage from answer to at+cpms.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param answer       Answer from gsm.
+  * @param length       Number of characters of answer.
+  * @param output       OutputStruct_t or NULL.
+  * @retval DRIVERState_t status
+  */
+static DRIVERState_t parseStorage(gsmHandler_t *gsmHandler, uint8_t *answer, uint32_t length, void *output)
+{
 	/* Iterators for copying */
-	uint8_t i = 0;
+	uint32_t i = 0;
 	uint8_t j = 0;
 
 	/* Reading answer correctly */
@@ -317,88 +704,50 @@ DRIVERState_t GSM_SetMsgStorage(gsmHandler_t *gsmHandler, uint32_t timeout, cons
 	/* How many times I have to copy to buffer for each memory */
 	uint8_t circle = 0;
 
-	/* Checking if user send correct gsm and console */
-	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
+	parseCopy(gsmHandler, answer, length, output);
+
+	while(answer[i] != ':' && i < length) {i++;}
+	if(i == length) return DRIVER_OK;
+
+	while(circle != 3)
 	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
-		return DRIVER_ERROR;
+		circle++;
+		switch(circle){
+		case 1:
+			i = i + 2;
+			DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"Memory for reading and deleting messages: \r\n used space : aviable space\r\n");
+			break;
+		case 2:
+			DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"Memory for writing and sending messages: \r\n used space : aviable space\r\n");
+			break;
+		case 3:
+			DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"Memory for receiving messages: \r\n used space : aviable space \r\n");
+			break;
+		}
+		twoSlesh = 0;
+		j = 0;
+		while(twoSlesh != 2 && i < length && j < sizeof(usedAndStorableMem) - 4)
+		{
+			if(answer[i] != ',' && answer[i] != '\r') usedAndStorableMem[j++] = answer[i++];
+			else
+			{
+				if(twoSlesh == 0)
+				{
+					usedAndStorableMem[j++] = ' ';
+					usedAndStorableMem[j++] = ':';
+					usedAndStorableMem[j++] = ' ';
+				}
+				i++;
+				twoSlesh++;
+			}
+		}
+		usedAndStorableMem[j]= '\0';
+		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*) "          ");
+		DRIVER_CONSOLE_Put(gsmHandler->console, usedAndStorableMem);
+		DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n");
 	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
-
-	/* Possible set of command for the type of storage */
-	if(inputStruct.memMsgReadDelate == 2 && inputStruct.memMsgWriteSend == 2 && inputStruct.memMsgReceive == 2)
-		DRIVER_GSM_Write(gsmHandler->gsm, (const uint8_t*)"at+cpms=\"SM\",\"SM\",\"SM\"\r",sizeof("at+cpms=\"SM\",\"SM\",\"SM\"\r"));
-	else if(inputStruct.memMsgReadDelate == 2 && inputStruct.memMsgWriteSend == 2 && inputStruct.memMsgReceive == 1)
-		DRIVER_GSM_Write(gsmHandler->gsm, (const uint8_t*)"at+cpms=\"SM\",\"SM\",\"ME\"\r",sizeof("at+cpms=\"SM\",\"SM\",\"ME\"\r"));
-	else if(inputStruct.memMsgReadDelate == 2 && inputStruct.memMsgWriteSend == 1 && inputStruct.memMsgReceive == 2)
-		DRIVER_GSM_Write(gsmHandler->gsm, (const uint8_t*)"at+cpms=\"SM\",\"ME\",\"SM\"\r",sizeof("at+cpms=\"SM\",\"ME\",\"SM\"\r"));
-	else if(inputStruct.memMsgReadDelate == 2 && inputStruct.memMsgWriteSend == 1 && inputStruct.memMsgReceive == 1)
-		DRIVER_GSM_Write(gsmHandler->gsm, (const uint8_t*)"at+cpms=\"SM\",\"ME\",\"ME\"\r",sizeof("at+cpms=\"SM\",\"ME\",\"ME\"\r"));
-	else if(inputStruct.memMsgReadDelate == 1 && inputStruct.memMsgWriteSend == 2 && inputStruct.memMsgReceive == 2)
-		DRIVER_GSM_Write(gsmHandler->gsm, (const uint8_t*)"at+cpms=\"ME\",\"SM\",\"SM\"\r",sizeof("at+cpms=\"ME\",\"SM\",\"SM\"\r"));
-	else if(inputStruct.memMsgReadDelate == 1 && inputStruct.memMsgWriteSend == 2 && inputStruct.memMsgReceive == 1)
-		DRIVER_GSM_Write(gsmHandler->gsm, (const uint8_t*)"at+cpms=\"ME\",\"SM\",\"ME\"\r",sizeof("at+cpms=\"ME\",\"SM\",\"ME\"\r"));
-	else if(inputStruct.memMsgReadDelate == 1 && inputStruct.memMsgWriteSend == 1 && inputStruct.memMsgReceive == 2)
-		DRIVER_GSM_Write(gsmHandler->gsm, (const uint8_t*)"at+cpms=\"ME\",\"ME\",\"SM\"\r",sizeof("at+cpms=\"ME\",\"ME\",\"SM\"\r"));
-	else if(inputStruct.memMsgReadDelate == 1 && inputStruct.memMsgWriteSend == 1 && inputStruct.memMsgReceive == 1)
-		DRIVER_GSM_Write(gsmHandler->gsm, (const uint8_t*)"at+cpms=\"ME\",\"ME\",\"ME\"\r",sizeof("at+cpms=\"ME\",\"ME\",\"ME\"\r"));
-
-	/* Read response from gsm  and set response for user*/
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 2000, (const uint8_t*)"OK\r\n")){
-	case DRIVER_TIMEOUT:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_TIMEOUT;
-	case DRIVER_ERROR:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_ERROR;
-	case DRIVER_OK:
-		strcpy((char*)outputStruct->gsmRsp,(const char*)buffer);
-		while(buffer[i] != ':') {i++;}
-					while(circle != 3)
-					{
-						circle++;
-						switch(circle){
-						case 1:
-							i = i + 2;
-							DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"Memory for reading and deleting messages: \r\n used space : aviable space\r\n");
-							break;
-						case 2:
-							DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"Memory for writing and sending messages: \r\n used space : aviable space\r\n");
-							break;
-						case 3:
-							DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"Memory for receiving messages: \r\n used space : aviable space \r\n");
-							break;
-						}
-						twoSlesh = 0;
-						j = 0;
-						while(twoSlesh != 2)
-						{
-							if(buffer[i] != ',' && buffer[i] != '\r') usedAndStorableMem[j++] = buffer[i++];
-							else
-							{
-								if(twoSlesh == 0)
-								{
-									usedAndStorableMem[j++] = ' ';
-									usedAndStorableMem[j++] = ':';
-									usedAndStorableMem[j++] = ' ';
-								}
-								i++;
-								twoSlesh++;
-							}
-						}
-						usedAndStorableMem[j]= '\0';
-						DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*) "          ");
-						DRIVER_CONSOLE_Put(gsmHandler->console, usedAndStorableMem);
-						DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n");
-					}
-
-					DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n");
-					DRIVER_GSM_Flush(gsmHandler->gsm);
-					return DRIVER_OK;
 
-	}
+	DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n");
 	return DRIVER_OK;
 }
 
@@ -410,258 +759,264 @@ DRIVERState_t GSM_SetMsgStorage(gsmHandler_t *gsmHandler, uint32_t timeout, cons
   */
 DRIVERState_t GSM_TestMsgStorage(gsmHandler_t *gsmHandler, uint32_t timeout)
 {
-	/* Buffer for reading message */
-	uint8_t buffer[100] = {0};
-
-	/* How many characters were received */
-	uint32_t size = 0;
+	return GSM_Execute(gsmHandler, GSM_CMD_TEST_STORAGE, NULL);
+}
 
+/**
+  * @brief Show which storages gsm has from answer to at+cpms=?.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param answer       Answer from gsm.
+  * @param length       Number of characters of answer.
+  * @param output       Not used.
+  * @retval DRIVERState_t status
+  */
+static DRIVERState_t parseStorageTest(gsmHandler_t *gsmHandler, uint8_t *answer, uint32_t length, void *output)
+{
 	/* Buffer for sending  appropriate response to console*/
 	char possibleStorages[200] = {0};
 
-	/* Pointers of found types of memory */
-	char* foundSM;
-	char* foundME;
-
 	char phoneStrg[] = "The phone message storage area"; // "ME"
 	char simStrg[] 	 = "The SIM message storage area"; 	// "SM"
 	/* char bothStrg[]  = "3 :both the phone message storage area and SIM message storage area"; //"MT" */
 	char newLineStr[] = "\r\n";
 
-	/* Checking if user send correct gsm and console */
-	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
+	/* Pointers of found types of memory */
+	char* foundSM = strstr((const char*)answer,(const char*)"SM");
+	char* foundME = strstr((const char*)answer,(const char*)"ME");
+
+	if(foundSM != NULL && foundME != NULL)
 	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
-		return DRIVER_ERROR;
+		strcat(possibleStorages,phoneStrg);
+		strcat(possibleStorages,newLineStr);
+		strcat(possibleStorages,simStrg);
 	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
-
-	/* Send command to gsm */
-	DRIVER_GSM_Write(gsmHandler->gsm, (const uint8_t*)"at+cpms=?\r",sizeof("at+cpms=?\r"));
+	else if(foundSM != NULL &&  foundME == NULL ) strcat(possibleStorages,simStrg);
+	else if(foundSM == NULL &&  foundME != NULL ) strcat(possibleStorages,phoneStrg);
+	else strcat(possibleStorages,(const char*)"Error: reading a command. Please try again!");
 
-	/* Read response from gsm  and set response for user*/
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 1000, (const uint8_t*)"OK\r\n")){
-	case DRIVER_TIMEOUT:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_TIMEOUT;
-	case DRIVER_ERROR:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_ERROR;
-	case DRIVER_OK:
-		foundSM = strstr((const char*)buffer,(const char*)"SM");
-		foundME = strstr((const char*)buffer,(const char*)"ME");
-
-		if(foundSM != NULL && foundME != NULL)
-		{
-			strcat(possibleStorages,phoneStrg);
-			strcat(possibleStorages,newLineStr);
-			strcat(possibleStorages,simStrg);
-		}
-		else if(foundSM != NULL &&  foundME == NULL ) strcat(possibleStorages,simStrg);
-		else if(foundSM == NULL &&  foundME != NULL ) strcat(possibleStorages,phoneStrg);
-		else strcat(possibleStorages,(const char*)"Error: reading a command. Please try again!");
-
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*) "\r\n");
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*) possibleStorages);
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*) "\r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_OK;
-
-	}
+	DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*) "\r\n");
+	DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*) possibleStorages);
+	DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*) "\r\n");
 	return DRIVER_OK;
 }
 
 /**
-  * @brief List messages using at command.
+  * @brief List messages using at command, every message is given to callback of list while gsm
+  *        lists it.
   * @param gsmHandler   GSM handle that contains everything about gsm module.
   * @param timeout      Timeout period for console.
   * @param inputStruct  Structure that contains needed variables to list messages.
-  * @param outputStruct Structure that contains answer from gsm module.
+  * @param list         Iterator with callback, its counters are cleared.
   * @retval DRIVERState_t status
   */
-DRIVERState_t GSM_ListMsg(gsmHandler_t *gsmHandler, uint32_t timeout, const ListMsgInputStruct_t inputStruct, ListMsgOutputStruct_t *outputStruct)
+DRIVERState_t GSM_ListMsg(gsmHandler_t *gsmHandler, uint32_t timeout, const ListMsgInputStruct_t inputStruct, GSMSmsList_t *list)
 {
-	/* Buffer for reading message */
-	uint8_t buffer[1000] = {0};
+	/* Set structure for response from gsm when using msg format function*/
+	uint8_t buffFormat[GSM_RESPONSE_SIZE] = {0};
+	OutputStruct_t outputStructMsgFormat ={.gsmRsp = buffFormat};
 
-	/* How many characters were received */
-	uint32_t size = 0;
+	if(list == NULL) return DRIVER_ERROR;
 
-	/* Set structure for response from gsm when using msg format function*/
-	uint8_t buffFormat[100] = {0};
-	OutputStruct_t outputStructMsgFormat ={.gsmRsp = buffFormat};
+	/* Set format of message */
+	DRIVERState_t state = GSM_MsgFormat(gsmHandler, timeout, formatOfMsg, &outputStructMsgFormat);
+	if(state != DRIVER_OK) return state;
 
-	/* Checking if user send correct gsm and console */
-	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
+	list->count 			= 0;
+	list->truncatedCount 	= 0;
+	list->pending 			= false;
+	list->newline 			= true;
+
+	if(formatOfMsg == GSM_TEXT_MODE)
+		return GSM_Execute(gsmHandler, GSM_CMD_LIST_TEXT, list, (int)inputStruct.sizeOfTypeOfMsgStr, inputStruct.typeOfMsgStr);
+
+	return GSM_Execute(gsmHandler, GSM_CMD_LIST_PDU, list, inputStruct.typeOfMsgChar);
+}
+
+/**
+  * @brief Copy field of answer in record, it is cut to size of field.
+  * @param field        Field of record, ends with '\0'.
+  * @param size         Size of field.
+  * @param token        Field of answer.
+  * @retval void
+  */
+static void copyField(uint8_t *field, uint32_t size, const ATToken_t *token)
+{
+	uint32_t length = token->length < size - 1U ? token->length : size - 1U;
+
+	memcpy(field, token->text, length);
+	field[length] = '\0';
+}
+
+/**
+  * @brief Write <stat> of pdu mode as text mode writes it ("REC UNREAD", "REC READ"...).
+  * @param token        Field with number of status.
+  * @param typeOfMsg    Type of message, ends with '\0'.
+  * @param size         Size of type of message.
+  * @retval void
+  */
+static void pduStatus(const ATToken_t *token, uint8_t *typeOfMsg, uint32_t size)
+{
+	static const char *status[] = {"REC UNREAD", "REC READ", "STO UNSENT", "STO SENT"};
+	ATToken_t name = *token;
+	uint32_t value;
+
+	if(AT_PARSE_Number(token, &value) && value < sizeof(status) / sizeof(status[0]))
 	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
-		return DRIVER_ERROR;
+		name.text 	= (const uint8_t*)status[value];
+		name.length = strlen(status[value]);
 	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
+	copyField(typeOfMsg, size, &name);
+}
 
-	/* Set format of message */
-	switch(GSM_MsgFormat(gsmHandler, timeout, formatOfMsg, &outputStructMsgFormat)){
-	case DRIVER_TIMEOUT:
-		return DRIVER_TIMEOUT;
-	case DRIVER_ERROR:
-		return DRIVER_ERROR;
-	case DRIVER_OK:
-		break;
-	}
+/**
+  * @brief Decode pdu of message in sms record.
+  * @param record       Sms record, text of message is cut to its size.
+  * @param pdu          Pdu in hexadecimal.
+  * @param length       Number of characters of pdu.
+  * @param textLength   Number of characters of text.
+  * @param truncated    Text didn't fit in record.
+  * @retval bool false if pdu can't be decoded
+  */
+static bool decodeRecord(GSMSmsRecord_t *record, const uint8_t *pdu, uint32_t length, uint32_t *textLength, bool *truncated)
+{
+	SMSPduMessage_t message;
 
-	/* Set command about formating command for gsm */
-	uint8_t msgToSend[50] 	= {0};
-	uint8_t msgSize 		= 8;
-	strcat((char*)msgToSend,(const char*)"at+cmgl=");
-	if(formatOfMsg == GSM_TEXT_MODE)
+	/* Called also in at task, so fields are copied without printf */
+	if(SMS_PDU_Decode(pdu, length, &message, record->message, sizeof(record->message)) != DRIVER_OK) return false;
+
+	ATToken_t number = {.text = message.number, .length = strlen((const char*)message.number)};
+	ATToken_t time = {.text = message.time, .length = strlen((const char*)message.time)};
+	copyField(record->number, sizeof(record->number), &number);
+	copyField(record->timeReceived, sizeof(record->timeReceived), &time);
+	*textLength = message.length;
+	*truncated = message.truncated;
+
+	return true;
+}
+
+/**
+  * @brief Give collected message to callback of list.
+  * @param list         Iterator of messages.
+  * @retval void
+  */
+static void listMessage(GSMSmsList_t *list)
+{
+	GSMSmsRecord_t *record = &list->record;
+
+	/* Empty line before next message or final result code is not part of text */
+	while(list->length > 0 && record->message[list->length - 1U] == '\n') list->length--;
+	record->message[list->length] = '\0';
+
+	list->pending = false;
+	list->count++;
+	if(list->truncated) list->truncatedCount++;
+
+	if(list->Message != NULL) list->Message(list);
+}
+
+/**
+  * @brief Parse line of +CMGL answer while it comes, header starts new message and lines after
+  *        it are its text (hexadecimal pdu in pdu mode).
+  * @param command      Command whose context is GSMSmsList_t.
+  * @param text         Line with its end, part of line longer than answer buffer, NULL at end
+  *                     of answer.
+  * @param size         Number of characters.
+  * @retval void
+  */
+static void listLine(ATCommand_t *command, const uint8_t *text, uint32_t size)
+{
+	GSMSmsList_t *list = command->context;
+	GSMSmsRecord_t *record = &list->record;
+
+	/* Message before final result code is complete */
+	if(text == NULL)
 	{
-		msgToSend[8]= '\"';
-		strcat((char*)msgToSend,(const char*)inputStruct.typeOfMsgStr);
-		msgToSend[8 + inputStruct.sizeOfTypeOfMsgStr + 1] = '\"';
-		msgToSend[8 + inputStruct.sizeOfTypeOfMsgStr + 2]= '\r';
-		msgSize = 8 + 3 + inputStruct.sizeOfTypeOfMsgStr;
+		if(list->pending) listMessage(list);
+		return;
 	}
-	else
+
+	bool start = list->newline;
+	list->newline = text[size - 1U] == '\n';
+
+	uint32_t length = size;
+	while(length > 0 && (text[length - 1U] == '\r' || text[length - 1U] == '\n')) length--;
+
+	if(start && length >= 6U && memcmp(text, "+CMGL:", 6) == 0)
 	{
-		msgToSend[msgSize++] = inputStruct.typeOfMsgChar;
-		msgToSend[msgSize++]= '\r';
-	}
+		ATScanner_t scanner;
+		ATToken_t token;
+
+		if(list->pending) listMessage(list);
+		memset(record, 0, sizeof(GSMSmsRecord_t));
+		list->index 	= 0;
+		list->length 	= 0;
+		list->truncated = false;
+		list->pending 	= true;
+
+		/* +CMGL: <index>,<stat>,<oa>,<alpha>,<scts> in text mode, +CMGL: <index>,<stat>,<alpha>,<length> in pdu mode */
+		AT_PARSE_Start(&scanner, text, length);
+		AT_PARSE_Line(&scanner, "+CMGL:");
+		if(AT_PARSE_Field(&scanner, &token)) AT_PARSE_Number(&token, &list->index);
+		if(formatOfMsg != GSM_TEXT_MODE)
+		{
+			if(AT_PARSE_Field(&scanner, &token)) pduStatus(&token, record->typeOfMsg, sizeof(record->typeOfMsg));
+			return;
+		}
 
-	/*** Wait to respond to command for listing messages! ***/
+		if(AT_PARSE_Field(&scanner, &token)) copyField(record->typeOfMsg, sizeof(record->typeOfMsg), &token);
 
-	/* Reset buffer and his size */
-	memset(buffer,0,sizeof(buffer));
-	size = 0;
+		if(AT_PARSE_Field(&scanner, &token)) copyField(record->number, sizeof(record->number), &token);
+		AT_PARSE_Field(&scanner, &token);
+		if(AT_PARSE_Field(&scanner, &token)) copyField(record->timeReceived, sizeof(record->timeReceived), &token);
+		return;
+	}
 
-	/* Send command to gsm about list of messages*/
-	DRIVER_GSM_Write(gsmHandler->gsm, msgToSend, msgSize);
+	/* Empty lines before first message */
+	if(!list->pending) return;
 
-	uint8_t *startOK;
-	uint8_t *startCMGL;
-	uint8_t *startOfMsg;
-    uint32_t endofMsg = 0;
-    uint32_t startofMsg = 0;
-    uint32_t msgNo = 0;
-    uint8_t firstCopy = 0;
-	/* Read response from gsm  and set response for user*/
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 20000, (const uint8_t*)"OK\r\n")){
-	case DRIVER_TIMEOUT:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_TIMEOUT;
-	case DRIVER_ERROR:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_ERROR;
-	case DRIVER_OK:
-		startOK = (uint8_t*)strstr((const char*)buffer,(const char*)"OK\r\n");
-		startCMGL =  (uint8_t*)strstr((char*)buffer,(const char*)"+CMGL:");
-		if(startOK != NULL && startCMGL != NULL)
-		{
-			startofMsg = startCMGL - buffer;
-			endofMsg = startOK - buffer;
-			uint8_t msgtoDisplay[1000] = {0};
-			uint32_t i = 0;
-			for(i = startofMsg; i < endofMsg; i++)
-			{
-				msgtoDisplay[i - startofMsg] = buffer[i];
-			}
-			i -= startofMsg;
-			DRIVER_CONSOLE_Put(gsmHandler->console, msgtoDisplay);
+	/* Pdu is one line after header, hexadecimal text stays when it can't be decoded */
+	if(formatOfMsg != GSM_TEXT_MODE && start && list->newline && list->length == 0 && length > 0)
+	{
+		if(decodeRecord(record, text, length, &list->length, &list->truncated)) return;
+	}
 
-			while(1)
-			{
-				if(firstCopy == 0)
-				{
-					/* Point to first index of message */
-					startOfMsg =  (uint8_t*)strstr((char*)buffer,(const char*)"+CMGL:");
-					firstCopy = 1;
-				}
-				else
-					startOfMsg =  (uint8_t*)strstr((char*)startOfMsg,(const char*)"+CMGL:");
-				if(startOfMsg != NULL)
-				{
-					/* Find start of index */
-					startOfMsg = startOfMsg + 7;
-
-					/* Set index of message */
-					if(*(startOfMsg + 1) == ',')
-						outputStruct->index[msgNo] = *startOfMsg - '0';
-					else
-					{
-						startOfMsg++;
-						outputStruct->index[msgNo] = 10 + (*startOfMsg - '0');
-					}
-
-					/* Find first '\"' for begining of type of msg  */
-					startOfMsg += 2;
-
-					/* Set type of message */
-					for(uint8_t i = 0; *startOfMsg != ','; i++)
-					{
-						outputStruct->typeOfMsg[msgNo][i] = *startOfMsg;
-						startOfMsg++;
-					}
-
-					/* Find '\"' for begining of number of msg */
-					startOfMsg = startOfMsg + 1;
-
-					/* Set number */
-					for(uint8_t i = 0; *startOfMsg != ','; i++)
-					{
-						(outputStruct->number[msgNo])[i] = *startOfMsg;
-						startOfMsg++;
-					}
-
-					/* If we have '\"' char we have time to copy, otherwise we are switching to copy message */
-					startOfMsg += 2;
-					if(*startOfMsg != '"')
-					{
-						while(*startOfMsg != '\n') startOfMsg++;
-					}
-					else
-					{
-						/* Set time if we have it */
-						for(uint8_t i = 0; *startOfMsg != '\r'; i++)
-						{
-							(outputStruct->timeReceived[msgNo])[i] = *startOfMsg;
-							startOfMsg++;
-						}
-
-						/* Set pointer to '\n' char */
-						startOfMsg++;
-					}
-
-					/* Point to first character of message */
-					startOfMsg++;
-
-					/* Set message */
-					for(uint8_t i = 0; *startOfMsg != '\r'; i++)
-					{
-						(outputStruct->message[msgNo])[i] = *startOfMsg;
-						startOfMsg++;
-					}
-
-					/*Go to next message */
-					msgNo++;
-				}
-				else
-				{	/* We copied all messages */
-					*outputStruct->msgNoStruct = msgNo;
-					break;
-				}
-			}
-			DRIVER_GSM_Flush(gsmHandler->gsm);
-		}
-		else if(startOK != NULL && startCMGL == NULL )
+	/* Lines of text are joined with '\n', parts of long line are joined without it */
+	uint32_t space = sizeof(record->message) - 1U - list->length;
+	if(start && list->length > 0)
+	{
+		if(space == 0)
 		{
-			DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"Storage empty, no messages of this type!\r\n");
-			DRIVER_GSM_Flush(gsmHandler->gsm);
+			list->truncated = true;
+			return;
 		}
-		return DRIVER_OK;
+		record->message[list->length++] = '\n';
+		space--;
 	}
+
+	if(length > space)
+	{
+		length = space;
+		list->truncated = true;
+	}
+	memcpy(record->message + list->length, text, length);
+	list->length += length;
+}
+
+/**
+  * @brief Tell that storage is empty, messages are given to callback while they come.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param answer       Answer from gsm (only its last lines).
+  * @param length       Number of characters of answer.
+  * @param output       GSMSmsList_t.
+  * @retval DRIVERState_t status
+  */
+static DRIVERState_t parseListMsg(gsmHandler_t *gsmHandler, uint8_t *answer, uint32_t length, void *output)
+{
+	GSMSmsList_t *list = output;
+
+	if(list->count == 0)
+		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"Storage empty, no messages of this type!\r\n");
+
 	return DRIVER_OK;
 }
 
@@ -675,131 +1030,136 @@ DRIVERState_t GSM_ListMsg(gsmHandler_t *gsmHandler, uint32_t timeout, const List
   */
 DRIVERState_t GSM_ReadMsg(gsmHandler_t *gsmHandler, uint32_t timeout, const ReadMsgInputStruct_t inputStruct, ReadMsgOutputStruct_t *outputStruct)
 {
-	/* Buffer for reading message */
-	uint8_t buffer[1000] = {0};
-
-	/* How many characters were received */
-	uint32_t size = 0;
+	return GSM_Execute(gsmHandler, GSM_CMD_READ, outputStruct, argumentLength(inputStruct.msgIndex), inputStruct.msgIndex);
+}
 
-	/* Checking if user send correct gsm and console */
-	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
+/**
+  * @brief Decode read message of pdu mode (+CMGR: <stat>,[<alpha>],<length> and pdu in next
+  *        line), show it and copy it to ReadMsgOutputStruct_t.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param answer       Answer from gsm.
+  * @param length       Number of characters of answer.
+  * @param outputStruct Output, its fields are fields of sms record.
+  * @retval DRIVERState_t status
+  */
+static DRIVERState_t parseReadPdu(gsmHandler_t *gsmHandler, const uint8_t *answer, uint32_t length, ReadMsgOutputStruct_t *outputStruct)
+{
+	GSMSmsRecord_t record = {0};
+	ATScanner_t scanner;
+	ATToken_t token;
+	uint32_t textLength;
+	bool truncated;
+
+	AT_PARSE_Start(&scanner, answer, length);
+	if(!AT_PARSE_Line(&scanner, "+CMGR:") || !AT_PARSE_Field(&scanner, &token)) return DRIVER_ERROR;
+	pduStatus(&token, record.typeOfMsg, sizeof(record.typeOfMsg));
+
+	if(!AT_PARSE_Line(&scanner, "") ||
+	   !decodeRecord(&record, scanner.position, (uint32_t)(scanner.lineEnd - scanner.position), &textLength, &truncated))
 	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
+		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError: pdu of message can't be decoded!\r\n");
 		return DRIVER_ERROR;
 	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
 
-	/* Set command reading message from gsm */
-	uint8_t msgToSend[50] = {0};
-	strcat((char*)msgToSend,(const char*)"at+cmgr=");
-	uint8_t msgSize = 8;
-	uint8_t i = 0;
-	for(i = 0; inputStruct.msgIndex[i] != '\r';i++)
-	{
-		msgToSend[8 + i] = inputStruct.msgIndex[i];
-	}
-	msgToSend[8 + i] = '\r';
-	msgSize += i + 1;
+	memcpy(outputStruct->typeOfMsg, record.typeOfMsg, sizeof(record.typeOfMsg));
+	memcpy(outputStruct->number, record.number, sizeof(record.number));
+	memcpy(outputStruct->timeReceived, record.timeReceived, sizeof(record.timeReceived));
+	memcpy(outputStruct->message, record.message, sizeof(record.message));
 
-	/* Reset buffer and his size */
-	memset(buffer,0,sizeof(buffer));
-	size = 0;
+	/* Decoded message is shown as text mode shows it */
+	DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"+CMGR: ");
+	DRIVER_CONSOLE_Put(gsmHandler->console, record.typeOfMsg);
+	DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)" ");
+	DRIVER_CONSOLE_Put(gsmHandler->console, record.number);
+	DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)" ");
+	DRIVER_CONSOLE_Put(gsmHandler->console, record.timeReceived);
+	DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n");
+	DRIVER_CONSOLE_Put(gsmHandler->console, record.message);
+	DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n");
+	if(truncated) DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"(text is cut)\r\n");
 
-	/* Send command to gsm to read message at entered index */
-	DRIVER_GSM_Write(gsmHandler->gsm, msgToSend, msgSize);
+	return DRIVER_OK;
+}
 
-	uint8_t *startOK;
-	uint8_t *startCMGR;
+/**
+  * @brief Show read message and copy it to ReadMsgOutputStruct_t.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param answer       Answer from gsm.
+  * @param length       Number of characters of answer.
+  * @param output       ReadMsgOutputStruct_t.
+  * @retval DRIVERState_t status
+  */
+static DRIVERState_t parseReadMsg(gsmHandler_t *gsmHandler, uint8_t *answer, uint32_t length, void *output)
+{
+	ReadMsgOutputStruct_t *outputStruct = output;
+	uint8_t *startOK =  (uint8_t*)strstr((const char*)answer,"OK\r\n");
+	uint8_t *startCMGR =  (uint8_t*)strstr((const char*)answer,"+CMGR:");
 	uint8_t *startOfMsg;
-    uint32_t endofMsg = 0;
-    uint32_t startofMsg = 0;
-	/* Read response from gsm  and set response for user*/
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 2000, (const uint8_t*)"OK\r\n")){
-	case DRIVER_TIMEOUT:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_TIMEOUT;
-	case DRIVER_ERROR:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_ERROR;
-	case DRIVER_OK:
-		startOK =  (uint8_t*)strstr((const char*)buffer,"OK\r\n");
-		startCMGR =  (uint8_t*)strstr((const char*)buffer,"+CMGR:");
-	    if(startCMGR != NULL)
-		{
-			startofMsg = startCMGR - buffer;
-			endofMsg = startOK - buffer;
-			uint8_t msgtoDisplay[1000] = {0};
-			uint32_t i = 0;
-			for(i = startofMsg; i < endofMsg; i++)
-			{
-				msgtoDisplay[i - startofMsg] = buffer[i];
-			}
-			DRIVER_CONSOLE_Put(gsmHandler->console, msgtoDisplay);
-			DRIVER_GSM_Flush(gsmHandler->gsm);
 
-			/* Set output structure */
-
-			startOfMsg =  (uint8_t*)strstr((char*)buffer,(const char*)"+CMGR:");
-			/* Find first '\"' for begining of type of msg  */
-			startOfMsg = startOfMsg + 7;
+	if(startCMGR == NULL)
+	{
+		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nStorage empty, no messages!\r\n");
+		return DRIVER_OK;
+	}
 
-			/* Set type of message */
-			for(uint8_t i = 0; *startOfMsg != ','; i++)
-			{
-				outputStruct->typeOfMsg[i] = *startOfMsg;
-				startOfMsg++;
-			}
+	/* In pdu mode message is decoded from line after +CMGR: */
+	if(formatOfMsg != GSM_TEXT_MODE) return parseReadPdu(gsmHandler, answer, length, outputStruct);
 
-			/* Find '\"' for begining of number of msg */
-			startOfMsg = startOfMsg + 1;
+	/* Display answer directly from buffer, nothing after "OK" is needed anymore */
+	if(startOK != NULL) *startOK = '\0';
+	DRIVER_CONSOLE_Put(gsmHandler->console, startCMGR);
 
-			/* Set number */
-			for(uint8_t i = 0; *startOfMsg != ','; i++)
-			{
-				outputStruct->number[i] = *startOfMsg;
-				startOfMsg++;
-			}
+	/* Set output structure */
 
-			/* If we have '\"' char we have time to copy, otherwise we are switching to copy message */
-			startOfMsg += 2;
-			if(*startOfMsg != '"')
-			{
-				while(*startOfMsg != '\n') startOfMsg++;
-			}
-			else
-			{
-				/* Set time if we have it */
-				for(uint8_t i = 0; *startOfMsg != '\r'; i++)
-				{
-					outputStruct->timeReceived[i] = *startOfMsg;
-					startOfMsg++;
-				}
+	/* Find first '\"' for begining of type of msg  */
+	startOfMsg = startCMGR + 7;
 
-				/* Set pointer to '\n' char */
-				startOfMsg++;
-			}
+	/* Set type of message */
+	for(uint8_t i = 0; *startOfMsg != ','; i++)
+	{
+		outputStruct->typeOfMsg[i] = *startOfMsg;
+		startOfMsg++;
+	}
 
-			/* Point to first character of message */
-			startOfMsg++;
+	/* Find '\"' for begining of number of msg */
+	startOfMsg = startOfMsg + 1;
 
-			/* Set message */
-			for(uint8_t i = 0; *startOfMsg != '\r'; i++)
-			{
-				outputStruct->message[i] = *startOfMsg;
-				startOfMsg++;
-			}
+	/* Set number */
+	for(uint8_t i = 0; *startOfMsg != ','; i++)
+	{
+		outputStruct->number[i] = *startOfMsg;
+		startOfMsg++;
+	}
 
-			return DRIVER_OK;
-		}
-		else if(startCMGR == NULL)
+	/* If we have '\"' char we have time to copy, otherwise we are switching to copy message */
+	startOfMsg += 2;
+	if(*startOfMsg != '"')
+	{
+		while(*startOfMsg != '\n') startOfMsg++;
+	}
+	else
+	{
+		/* Set time if we have it */
+		for(uint8_t i = 0; *startOfMsg != '\r'; i++)
 		{
-			DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nStorage empty, no messages!\r\n");
-			DRIVER_GSM_Flush(gsmHandler->gsm);
-			return DRIVER_OK;
+			outputStruct->timeReceived[i] = *startOfMsg;
+			startOfMsg++;
 		}
+
+		/* Set pointer to '\n' char */
+		startOfMsg++;
+	}
+
+	/* Point to first character of message */
+	startOfMsg++;
+
+	/* Set message */
+	for(uint8_t i = 0; *startOfMsg != '\r'; i++)
+	{
+		outputStruct->message[i] = *startOfMsg;
+		startOfMsg++;
 	}
+
 	return DRIVER_OK;
 }
 
@@ -813,65 +1173,9 @@ DRIVERState_t GSM_ReadMsg(gsmHandler_t *gsmHandler, uint32_t timeout, const Read
   */
 DRIVERState_t GSM_DeleteMsg(gsmHandler_t *gsmHandler, uint32_t timeout, DeleteMsgInputStruct_t inputStruct, OutputStruct_t *outputStruct)
 {
-	/* Buffer for reading message */
-	uint8_t buffer[500] = {0};
-
-	/* How many characters were received */
-	uint32_t size = 0;
-
-	/* Checking if user send correct gsm and console */
-	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
-	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
-		return DRIVER_ERROR;
-	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
-
-	/* Set gsm command for deleting message*/
-	uint8_t msgToSend[50] = {0};
-	strcat((char*)msgToSend,"at+cmgd=");
-	uint32_t msgSize = 8;
-
-	if(inputStruct.deleteType == '1')
-	{
-		strcat((char*)msgToSend,(const char*)inputStruct.userRsp);
-		msgSize += size;
-	}
-	else
-	{
-		/* It's necessary to put index in first place, then to put flag(buffer) on second*/
-		msgToSend[msgSize] = '1';
-		msgSize++;
-		msgToSend[msgSize] = ',';
-		msgSize++;
-		strcat((char*)msgToSend,(const char*)inputStruct.userRsp);
-		msgSize += 2;
-	}
-
-	/* Reset bufer and his size */
-	memset(buffer,0,sizeof(buffer));
-	size = 0;
-
-	/* Send command to gsm to read message at entered index */
-	DRIVER_GSM_Write(gsmHandler->gsm, msgToSend, msgSize);
-
-	/* Read response from gsm  and set response for user*/
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 5000, (const uint8_t*)"OK")){
-	case DRIVER_TIMEOUT:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_TIMEOUT;
-	case DRIVER_ERROR:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_ERROR;
-	case DRIVER_OK:
-		strcpy((char*)outputStruct,(const char*)buffer);
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Message(s) are deleted correctly!\r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_OK;
-	}
-	return DRIVER_OK;
+	/* Certain message is deleted with its index, otherwise index is 1 and flag says which messages are deleted */
+	return GSM_Execute(gsmHandler, GSM_CMD_DELETE, outputStruct, inputStruct.deleteType == '1' ? "" : "1,",
+					   argumentLength(inputStruct.userRsp), inputStruct.userRsp);
 }
 
 /**
@@ -884,165 +1188,168 @@ DRIVERState_t GSM_DeleteMsg(gsmHandler_t *gsmHandler, uint32_t timeout, DeleteMs
   */
 DRIVERState_t GSM_SendStoreMsg(gsmHandler_t *gsmHandler, uint32_t timeout,const SendOrStoreInputStruct_t inputStruct,OutputStruct_t *outputStruct)
 {
-	/* Buffer for reading message */
-	uint8_t buffer[500] = {0};
-
 	/* How many characters were received */
 	uint32_t size = 0;
 
-	/* Set structure for response from gsm when using msg format function*/
-	uint8_t buffFormat[100] = {0};
-	OutputStruct_t outputStructMsgFormat ={.gsmRsp = buffFormat};
-
 	/* Checking if user send correct gsm and console */
 	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
 	{
 		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
 		return DRIVER_ERROR;
 	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
 
-	/* Set format of message */
-	switch(GSM_MsgFormat(gsmHandler, timeout, formatOfMsg,&outputStructMsgFormat)){
-	case DRIVER_TIMEOUT:
-		return DRIVER_TIMEOUT;
-	case DRIVER_ERROR:
+	/* Answers from gsm, pdu (or text with <CTRL-Z> in text mode) are taken from arena of calling task */
+	ARENAHandler_t *arena 	= ARENA_Current();
+	ARENAMark_t scope 		= ARENA_Mark(arena);
+	uint8_t *buffer 		= ARENA_Calloc(arena, GSM_SMS_RESPONSE_SIZE);
+	uint8_t *buffFormat 	= ARENA_Calloc(arena, GSM_RESPONSE_SIZE);
+	if(buffer == NULL || buffFormat == NULL)
+	{
+		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: not enough scratch memory for answer!\r\n");
+		ARENA_Release(arena, scope);
 		return DRIVER_ERROR;
-	case DRIVER_OK:
-		break;
+	}
+
+	/* Set structure for response from gsm when using msg format function*/
+	OutputStruct_t outputStructMsgFormat ={.gsmRsp = buffFormat};
+
+	/* Set format of message */
+	DRIVERState_t state = GSM_MsgFormat(gsmHandler, timeout, formatOfMsg,&outputStructMsgFormat);
+	if(state != DRIVER_OK)
+	{
+		ARENA_Release(arena, scope);
+		return state;
 	}
 
 	/* Message to send to gsm */
-	uint8_t msgToSend[50] = {0};
+	uint8_t *msgToSend = POOL_Calloc(GSM_SMS_COMMAND_SIZE);
+	if(msgToSend == NULL)
+	{
+		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: no free block for gsm command!\r\n");
+		ARENA_Release(arena, scope);
+		return DRIVER_ERROR;
+	}
 	uint8_t sendOrStore[1] = {inputStruct.sendOrStoreFlag}; /* Variable for writing on the end of function if message is sent or stored to console */
-	uint8_t msgSize = 0;
+	bool fromStorage = *sendOrStore == '1' && inputStruct.storeOrSendDirectFlag == '1';
+	int msgSize = 0;
 
-	/* Ask if user want to send message from storage or directly send message we have to ask user that
-	 * and set command from gsm according to his response */
-	if(*sendOrStore == '1')
+	/* Number in international format */
+	uint8_t destination[SMS_PDU_NUMBER_SIZE] = {0};
+	internationalNumber(inputStruct.number, destination, sizeof(destination));
+
+	uint8_t *pdu 			= NULL;
+	uint32_t pduLength 		= 0;
+
+	/* In pdu mode number and text are in pdu and command has only its length */
+	if(formatOfMsg == GSM_PDU_MODE && !fromStorage)
 	{
-		if(inputStruct.storeOrSendDirectFlag == '1')
-		{
-			strcat((char*)msgToSend,"at+cmss=");	/* Send message from storage 	*/
-			msgSize = 8;
-			uint32_t i = 0;
-			strcat((char*)msgToSend,(const char*)inputStruct.index);
-			for(; inputStruct.index[i] != '\r';i++);
-			msgSize += i;
-			msgToSend[msgSize++] = ',';
-			msgToSend[msgSize++] = '\"';
-		}
-		else if(inputStruct.storeOrSendDirectFlag == '2')
+		SMSPduSubmit_t submit = {.number = destination, .text = inputStruct.message,
+								 .length = (uint32_t)argumentLength(inputStruct.message), .coding = SMS_PDU_AUTO};
+
+		pdu = ARENA_Alloc(arena, SMS_PDU_HEX_SIZE);
+		if(pdu == NULL || SMS_PDU_EncodeSubmit(&submit, pdu, SMS_PDU_HEX_SIZE - 1U, &pduLength) != DRIVER_OK)
 		{
-			strcat((char*)msgToSend,"at+cmgs=\"");	/* Send message directly		*/
-			msgSize = 9;
+			DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: message can't be encoded in one pdu!\r\n");
+			ARENA_Release(arena, scope);
+			POOL_Free(msgToSend);
+			return DRIVER_ERROR;
 		}
 	}
-	/* If we had users response to store message we have to set that command */
-	else if(*sendOrStore == '2')
-	{
-		strcat((char*)msgToSend,"at+cmgw=\"");		/* Store message 				*/
-		msgSize = 9;
-	}
 
-	/** We need set size of message **/
-	for(size = 0; inputStruct.number[size] != '\r';size++);
-	size++;
+	/* Ask if user want to send message from storage or directly send message we have to ask user that
+	 * and set command from gsm according to his response, message is stored otherwise */
+	if(fromStorage)
+		msgSize = snprintf((char*)msgToSend, GSM_SMS_COMMAND_SIZE, "at+cmss=%.*s,\"%s\"\r",
+						   argumentLength(inputStruct.index), inputStruct.index, destination);
+	else if(pdu != NULL)
+		msgSize = snprintf((char*)msgToSend, GSM_SMS_COMMAND_SIZE, "at+cmg%c=%lu\r",
+						   *sendOrStore == '1' ? 's' : 'w', (unsigned long)pduLength);
+	else
+		msgSize = snprintf((char*)msgToSend, GSM_SMS_COMMAND_SIZE, "at+cmg%c=\"%s\"\r",
+						   *sendOrStore == '1' ? 's' : 'w', destination);
 
-	/* Set number in buffer(msgToSend) for seding number to gsm  */
-	uint8_t countryCode[] = "+381";
-	switch(*inputStruct.number){
-	case '+':
-		strcat((char*)msgToSend,(const char*)inputStruct.number);
-		msgSize += size;
-		break;
-	case '0':
-		strcat((char*)msgToSend,(const char*)countryCode);
-		msgSize += sizeof(countryCode) - 1;
-		uint8_t strNum[20] = {0};
-		uint8_t i = 1;
-		for(i = 1;i < size; i++) strNum[i - 1] = inputStruct.number[i];
-		strcat((char*)msgToSend, (const char*)strNum);
-		msgSize += i - 1;
-		break;
-	default:
-		strcat((char*)msgToSend, (const char*)countryCode);
-		strcat((char*)msgToSend, (const char*)inputStruct.number);
-		msgSize += sizeof(countryCode) + size - 1;
-		break;
-	}
-	msgToSend[msgSize - 1] = '\"';
-	/* Set last character '\r' 'cause gsm command needs it */
-	msgToSend[msgSize] = '\r';
-	msgSize++;
+	/* Set command to gsm to send written message or
+	 * to send a message from the storage */
+	ATCommand_t text = {.command = msgToSend, .commandSize = msgSize, .expect = (const uint8_t*)"OK", .timeout = 6000,
+						.timeoutClass = AT_TIMEOUT_SEND, .response = buffer, .responseSize = GSM_SMS_RESPONSE_SIZE,
+						.priority = AT_PRIORITY_BULK};
+
+	/* Command with number waits for ">", text of message is sent right after it */
+	ATCommand_t number = {.command = msgToSend, .commandSize = msgSize, .expect = (const uint8_t*)">", .timeout = 10000,
+						  .timeoutClass = AT_TIMEOUT_PROMPT, .response = buffer, .responseSize = GSM_SMS_RESPONSE_SIZE,
+						  .priority = AT_PRIORITY_BULK, .next = &text};
+
+	/* Text of message with <CTRL-Z> at its end */
+	uint8_t *textToSend = NULL;
 
 	/** If we don't have to send from storage we must first write number to gsm
 	 * and wait for his response witch is going to be character ">" that mean
-	 * we have to set him message that we want to send **/
-	if(inputStruct.storeOrSendDirectFlag != '1')
+	 * we have to set him message that we want to send, both are one chain for
+	 * at engine, so no other command can come between them **/
+	if(!fromStorage)
 	{
+		if(pdu != NULL)
+		{
+			/* Pdu in hexadecimal is sent after prompt */
+			size = strlen((const char*)pdu);
+			textToSend = pdu;
+		}
+		else
+		{
+			textToSend = ARENA_Calloc(arena, GSM_SMS_COMMAND_SIZE);
+			if(textToSend == NULL)
+			{
+				DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: not enough scratch memory for message!\r\n");
+				ARENA_Release(arena, scope);
+				POOL_Free(msgToSend);
+				return DRIVER_ERROR;
+			}
+			for(size = 0; inputStruct.message[size] != '\r' && size < GSM_SMS_COMMAND_SIZE - 1U;size++);
+			memcpy(textToSend, inputStruct.message, size);
+		}
+		textToSend[size] = 26; /* <CTRL-Z> character */
+		text.command = textToSend;
+		text.commandSize = size + 1;
 
-		/* Reset buffer and his size */
-		memset(buffer,0,sizeof(buffer));
-		size = 0;
-
-		/* Send command to gsm to accept number for sending message */
-		DRIVER_GSM_Write(gsmHandler->gsm, msgToSend, msgSize);
+		AT_Execute(&number);
 
 		/* Read response from gsm  and set response for user*/
-		switch(waitUntil(gsmHandler->gsm, buffer, &size, 10000, (const uint8_t*)">")){
+		switch(number.result){
 		case DRIVER_TIMEOUT:
 			DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for input has expired! Please try again comand! \r\n");
-			DRIVER_GSM_Flush(gsmHandler->gsm);
+			ARENA_Release(arena, scope);
+			POOL_Free(msgToSend);
 			return DRIVER_TIMEOUT;
 		case DRIVER_ERROR:
 			DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-			DRIVER_GSM_Flush(gsmHandler->gsm);
+			ARENA_Release(arena, scope);
+			POOL_Free(msgToSend);
 			return DRIVER_ERROR;
 		case DRIVER_OK:
-			if( strstr((char*)buffer,(const char*)">") == NULL)
-			{
-				DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\nError: reading a command. Please try again!\r\n");
-				DRIVER_GSM_Flush(gsmHandler->gsm);
-				return DRIVER_ERROR;
-			}
-			else break;
+			break;
 		}
-
-		memset(msgToSend,0, sizeof(msgToSend));
-		msgSize = 0;
-		for(size = 0; inputStruct.message[size] != '\r';size++);
-		strcat((char*)msgToSend,(const char*)inputStruct.message);
-		msgToSend[size] = 26; /* <CTRL-Z> character */
-		msgSize = size + 1;
 	}
+	else
+		AT_Execute(&text);
 
-	/* Reset buffer and hos size */
-	memset(buffer,0,sizeof(buffer));
-	size = 0;
+	POOL_Free(msgToSend);
 
-	/* Set command to gsm to send written message or
-	 * to send a message from the storage */
-	DRIVER_GSM_Write(gsmHandler->gsm, msgToSend, msgSize);
-
-	/* Read response from gsm  and set response for user*/
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 6000, (const uint8_t*)"OK")){
+	/* Read response from gsm  and set response for user, answer is in arena until its release */
+	switch(text.result){
 	case DRIVER_TIMEOUT:
 		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_TIMEOUT;
+		break;
 	case DRIVER_ERROR:
 		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_ERROR;
+		break;
 	case DRIVER_OK:
 		strcpy((char*)outputStruct,(const char*)buffer);
 		if(*sendOrStore == '1') DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n Message sent!\r\n");
 		else DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n Message stored!\r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_OK;
+		break;
 	}
-	return DRIVER_OK;
+	ARENA_Release(arena, scope);
+	return text.result;
 }
 
 /***************************************************************************************************************************************************/
@@ -1132,423 +1439,529 @@ SocketStatus_t GSM_CheckOpenSocketNo(gsmHandler_t *gsmHandler)
 }
 
 /**
-  * @brief Turn on network connection.
-  * @param gsmHandler   GSM handle that contains everything about gsm module.
-  * @retval DRIVERState_t status
+  * @brief Check if registration state means that gsm can use network.
+  * @param registration Registration from +CREG or +CGREG.
+  * @retval bool true in home network and in roaming
   */
-DRIVERState_t GSM_NetworkRegistered(gsmHandler_t *gsmHandler)
+static bool registered(const ATRegistration_t *registration)
 {
-	uint8_t buffer[100];
-	uint32_t size = 0;
-
-	/* Reset buffer */
-	memset(buffer,0,sizeof(buffer));
+	return registration->state == AT_REG_HOME || registration->state == AT_REG_ROAMING;
+}
 
-	/* Checking if user send correct gsm and console */
-	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
+/**
+  * @brief Set or clear bit of cached state from registration and send event to subscribed queues
+  *        when state, area or cell changed.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param bit          GSM_STATE_REGISTERED or GSM_STATE_ATTACHED.
+  * @param registration Registration from +CREG or +CGREG.
+  * @retval void
+  */
+static void stateRegistration(gsmHandler_t *gsmHandler, uint32_t bit, const ATRegistration_t *registration)
+{
+	GSMRegEvent_t *last = &gsmHandler->regLast[bit == GSM_STATE_REGISTERED ? GSM_REG_NETWORK : GSM_REG_GPRS];
+	GSMRegEvent_t event;
+	bool changed;
+
+	/* Bit is set before event, so subscriber that wakes on it reads new state */
+	if(registered(registration)) xEventGroupSetBits(gsmHandler->state, bit);
+	else xEventGroupClearBits(gsmHandler->state, bit);
+
+	/* Answers come in calling tasks and reports in at task, answer without area and cell keeps them */
+	taskENTER_CRITICAL();
+	changed = registration->state != last->state ||
+			  (registration->area != 0 && (registration->area != last->area || registration->cell != last->cell));
+	if(changed)
 	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
-		return DRIVER_ERROR;
+		last->state 		= registration->state;
+		last->registered 	= registered(registration);
+		last->time 			= TIME_GetTick();
+		if(registration->area != 0)
+		{
+			last->area 		= registration->area;
+			last->cell 		= registration->cell;
+		}
+		gsmHandler->regEventCount++;
 	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
+	event = *last;
+	taskEXIT_CRITICAL();
 
-	/* Set command checking network connection */
-	DRIVER_GSM_Write(gsmHandler->gsm,(const uint8_t*) "at+creg=1\r", sizeof("at+creg=1\r"));
+	if(!changed) return;
 
-	/* Read response from gsm  and set response for user*/
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 2000, (const uint8_t*)"OK")){
-	case DRIVER_TIMEOUT:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_TIMEOUT;
-	case DRIVER_ERROR:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_ERROR;
-	case DRIVER_OK:
-		gsmHandler->network.status = NETWORK_CONNECTED;
-		DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n Network is now on!\r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_OK;
-	}
-	return DRIVER_OK;
+	/* Subscriber that doesn't read its queue loses events, sender never waits */
+	for(uint32_t i = 0; i < gsmHandler->regSubscribers; i++)
+		if(xQueueSend(gsmHandler->regQueue[i], &event, 0) != pdTRUE) gsmHandler->regDropCount++;
 }
 
 /**
-  * @brief Turn off network connection.
+  * @brief Set bits of cached state that follow state of IP connection and active PDP contexts.
   * @param gsmHandler   GSM handle that contains everything about gsm module.
-  * @retval DRIVERState_t status
+  * @retval void
   */
-DRIVERState_t GSM_NetworkDeregistered(gsmHandler_t *gsmHandler)
+static void stateConnection(gsmHandler_t *gsmHandler)
 {
-	uint8_t buffer[100];
-	uint32_t size = 0;
+	ATIpState_t ipState = gsmHandler->network.ipState;
+	uint32_t bits = 0;
+
+	/* States of IP connection come one after another until connection is closed */
+	if(ipState >= AT_IP_START && ipState <= AT_IP_CLOSED) bits |= GSM_STATE_APN;
+	if((ipState >= AT_IP_GPRSACT && ipState <= AT_IP_CLOSED) || gsmHandler->network.activeContexts != 0)
+		bits |= GSM_STATE_PDP_ACTIVE;
+	if(ipState >= AT_IP_STATUS && ipState <= AT_IP_CLOSED) bits |= GSM_STATE_IP;
+	if(ipState == AT_IP_CONNECT_OK) bits |= GSM_STATE_CONNECTED;
+
+	xEventGroupClearBits(gsmHandler->state, GSM_STATE_CONNECTION & ~bits);
+	xEventGroupSetBits(gsmHandler->state, bits);
+}
 
-	/* Reset buffer */
-	memset(buffer,0,sizeof(buffer));
+/**
+  * @brief Keep state of IP connection that gsm reached and bits of cached state that follow it.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param ipState      State of IP connection.
+  * @retval void
+  */
+static void stateIp(gsmHandler_t *gsmHandler, ATIpState_t ipState)
+{
+	gsmHandler->network.ipState = ipState;
+	stateConnection(gsmHandler);
+}
 
-	/* Checking if user send correct gsm and console */
-	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
-	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
-		return DRIVER_ERROR;
-	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
+/**
+  * @brief Check if wireless connection is up (at+ciicr succeeded and context wasn't deactivated).
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @retval bool true from IP GPRSACT until connection is shut
+  */
+static bool wirelessUp(gsmHandler_t *gsmHandler)
+{
+	return gsmHandler->network.ipState >= AT_IP_GPRSACT && gsmHandler->network.ipState <= AT_IP_CLOSED;
+}
 
-	/* Set command checking network connection */
-	DRIVER_GSM_Write(gsmHandler->gsm,(const uint8_t*) "at+creg=0\r", sizeof("at+creg=0\r"));
+/**
+  * @brief Skip command whose state is already reached, so it makes no round trip to gsm.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param id           Command from table.
+  * @param reached      True when cached state says that command isn't needed.
+  * @retval bool true if command is skipped
+  */
+static bool alreadyReached(gsmHandler_t *gsmHandler, GSMCommandId_t id, bool reached)
+{
+	if(!reached) return false;
 
-	/* Read response from gsm  and set response for user*/
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 2000, (const uint8_t*)"OK")){
-	case DRIVER_TIMEOUT:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
+	gsmCommandStats[id].skipCount++;
+	DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n Already done, not sent: ");
+	DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)gsmCommands[id].name);
+	DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n");
+	return true;
+}
+
+/**
+  * @brief Cached state of modem.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @retval uint32_t GSM_STATE_* bits
+  */
+uint32_t GSM_GetState(gsmHandler_t *gsmHandler)
+{
+	return xEventGroupGetBits(gsmHandler->state);
+}
+
+/**
+  * @brief Block calling task until all bits of cached state are set.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param bits         GSM_STATE_* bits (eg. GSM_STATE_ONLINE).
+  * @param timeout      Timeout duration (in miliseconds), portMAX_DELAY waits without timeout.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t GSM_WaitState(gsmHandler_t *gsmHandler, uint32_t bits, uint32_t timeout)
+{
+	/* Conversion of portMAX_DELAY to ticks would overflow */
+	TickType_t ticks = timeout == portMAX_DELAY ? portMAX_DELAY : pdMS_TO_TICKS(timeout);
+
+	if((xEventGroupWaitBits(gsmHandler->state, bits, pdFALSE, pdTRUE, ticks) & bits) != bits)
 		return DRIVER_TIMEOUT;
-	case DRIVER_ERROR:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_ERROR;
-	case DRIVER_OK:
-		gsmHandler->network.status = NETWORK_DISCONNECTED;
-		DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n Network is now off!\r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_OK;
-	}
+
 	return DRIVER_OK;
 }
 
 /**
-  * @brief Check network connection.
+  * @brief Subscribe queue to registration events, every change of state, area or cell of
+  *        registration to network or GPRS service is sent to it as GSMRegEvent_t.
   * @param gsmHandler   GSM handle that contains everything about gsm module.
-  * @retval DRIVERState_t status
+  * @param queue        Queue whose items are GSMRegEvent_t.
+  * @retval DRIVERState_t DRIVER_ERROR when all GSM_REG_SUBSCRIBERS places are taken
   */
-DRIVERState_t GSM_CheckNetworkRegistered(gsmHandler_t *gsmHandler)
+DRIVERState_t GSM_RegistrationSubscribe(gsmHandler_t *gsmHandler, QueueHandle_t queue)
 {
-	uint8_t buffer[100];
-	uint32_t size = 0;
+	DRIVERState_t state = DRIVER_ERROR;
 
-	/* Reset buffer */
-	memset(buffer,0,sizeof(buffer));
+	if(gsmHandler == NULL || queue == NULL) return DRIVER_ERROR;
 
-	/* Checking if user send correct gsm and console */
-	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
+	taskENTER_CRITICAL();
+	if(gsmHandler->regSubscribers < GSM_REG_SUBSCRIBERS)
 	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
-		return DRIVER_ERROR;
+		gsmHandler->regQueue[gsmHandler->regSubscribers] = queue;
+		gsmHandler->regSubscribers++;
+		state = DRIVER_OK;
 	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
+	taskEXIT_CRITICAL();
 
-	/* Set command checking network connection */
-	DRIVER_GSM_Write(gsmHandler->gsm,(const uint8_t*) "at+creg?\r", sizeof("at+creg?\r"));
+	return state;
+}
 
-	/* Read response from gsm  and set response for user*/
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 2000, (const uint8_t*)"OK")){
-	case DRIVER_TIMEOUT:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_TIMEOUT;
-	case DRIVER_ERROR:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_ERROR;
-	case DRIVER_OK:
-		if(strchr((char*)buffer,'0') != NULL)
+/**
+  * @brief Keep state of network and sockets after unsolicited line, called in at task.
+  * @param urc          Unsolicited code.
+  * @param text         Line from gsm.
+  * @param length       Number of characters of line.
+  * @param context      GSM handle.
+  * @retval void
+  */
+static void gsmUnsolicited(ATUrc_t urc, const uint8_t *text, uint32_t length, void *context)
+{
+	gsmHandler_t *gsmHandler = context;
+	Socket_t socket;
+
+	switch(urc){
+	case AT_URC_NEW_SMS:
+		gsmHandler->newMsgCount++;
+		break;
+	case AT_URC_CLOSED:
+		/* Server closed connection, PDP context stays active */
+		if(gsmHandler->activeSocketNo != 0)
 		{
-			gsmHandler->network.status = NETWORK_DISCONNECTED;
-			DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n Mobile isn't registered to network! Please try to set network connection first!\r\n");
+			memset(gsmHandler->socket[gsmHandler->activeSocketNo].IPaddress,0,16);
+			gsmHandler->socket[gsmHandler->activeSocketNo].port = PORT_NON;
 		}
-		else
+		stateIp(gsmHandler, AT_IP_CLOSED);
+		break;
+	case AT_URC_PDP_DEACT:
+		/* Network deactivated context, as after GSM_DeactivePDPContext() */
+		if(gsmHandler->activeSocketNo != 0)
 		{
-			gsmHandler->network.status = NETWORK_CONNECTED;
-			DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n Mobile is network registered!\r\n");
+			socket.PDPcontextNo = gsmHandler->activeSocketNo;
+			GSM_CloseSocket(gsmHandler, &socket);
+			gsmHandler->activeSocketNo = 0;
 		}
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_OK;
+		gsmHandler->network.activeContexts = 0;
+		stateIp(gsmHandler, AT_IP_PDP_DEACT);
+		break;
+	case AT_URC_CREG:
+		/* "+CREG: <stat>[,<lac>,<ci>]", it comes only while reporting is on, area and cell
+		 * come with at+creg=2 */
+		if(AT_PARSE_Registration(text, length, "+CREG:", &gsmHandler->network.registration))
+		{
+			gsmHandler->network.status = registered(&gsmHandler->network.registration) ?
+										 NETWORK_CONNECTED : NETWORK_DISCONNECTED;
+			stateRegistration(gsmHandler, GSM_STATE_REGISTERED, &gsmHandler->network.registration);
+			if(gsmHandler->network.registration.area != 0) xEventGroupSetBits(gsmHandler->state, GSM_STATE_REPORTING);
+		}
+		break;
+	case AT_URC_CGREG:
+		if(AT_PARSE_Registration(text, length, "+CGREG:", &gsmHandler->network.gprsRegistration))
+		{
+			stateRegistration(gsmHandler, GSM_STATE_ATTACHED, &gsmHandler->network.gprsRegistration);
+			if(gsmHandler->network.gprsRegistration.area != 0) xEventGroupSetBits(gsmHandler->state, GSM_STATE_GPRS_REPORTING);
+		}
+		break;
+	default:
+		break;
 	}
-	return DRIVER_OK;
 }
 
 /**
-  * @brief Set APN for current region.
+  * @brief Turn on network connection, gsm reports every change of registration to network and
+  *        GPRS service with area and cell (+CREG: and +CGREG: lines).
   * @param gsmHandler   GSM handle that contains everything about gsm module.
   * @retval DRIVERState_t status
   */
-DRIVERState_t GSM_SetAPN(gsmHandler_t *gsmHandler)
+DRIVERState_t GSM_NetworkRegistered(gsmHandler_t *gsmHandler)
 {
-	uint8_t buffer[100];
-	uint32_t size = 0;
+	DRIVERState_t state = DRIVER_OK;
 
-	/* Reset buffer */
-	memset(buffer,0,sizeof(buffer));
-
-	/* Checking if user send correct gsm and console */
-	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
+	if(!alreadyReached(gsmHandler, GSM_CMD_NETWORK_ON, (GSM_GetState(gsmHandler) & GSM_STATE_REPORTING) != 0))
 	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
-		return DRIVER_ERROR;
-	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
+		state = GSM_Execute(gsmHandler, GSM_CMD_NETWORK_ON, NULL);
+		if(state != DRIVER_OK) return state;
 
-	/* Send command for setting Access Point Names(APN's) */
-	DRIVER_GSM_Write(gsmHandler->gsm,(const uint8_t*) "at+cstt=\"gprsinternet\"\r", sizeof("at+cstt=\"gprsinternet\"\r"));
-
-	/* Read response from gsm  and set response for user*/
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 15000, (const uint8_t*)"OK")){
-	case DRIVER_TIMEOUT:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_TIMEOUT;
-	case DRIVER_ERROR:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_ERROR;
-	case DRIVER_OK:
-		DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n APN is setted for Serbia, B&H and Montenegro regions!\r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_OK;
+		gsmHandler->network.status = NETWORK_CONNECTED;
+		xEventGroupSetBits(gsmHandler->state, GSM_STATE_REPORTING);
 	}
-	return DRIVER_OK;
 
+	if(!alreadyReached(gsmHandler, GSM_CMD_GPRS_REPORT, (GSM_GetState(gsmHandler) & GSM_STATE_GPRS_REPORTING) != 0))
+	{
+		state = GSM_Execute(gsmHandler, GSM_CMD_GPRS_REPORT, NULL);
+		if(state == DRIVER_OK) xEventGroupSetBits(gsmHandler->state, GSM_STATE_GPRS_REPORTING);
+	}
+	return state;
 }
 
 /**
-  * @brief Check registed APN.
+  * @brief Turn off network connection.
   * @param gsmHandler   GSM handle that contains everything about gsm module.
   * @retval DRIVERState_t status
   */
-DRIVERState_t GSM_CheckAPN(gsmHandler_t *gsmHandler)
+DRIVERState_t GSM_NetworkDeregistered(gsmHandler_t *gsmHandler)
 {
-	uint8_t buffer[100];
-	uint32_t size = 0;
+	DRIVERState_t state = GSM_Execute(gsmHandler, GSM_CMD_NETWORK_OFF, NULL);
 
-	/* Reset buffer */
-	memset(buffer,0,sizeof(buffer));
-
-	/* Checking if user send correct gsm and console */
-	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
+	if(state == DRIVER_OK)
 	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
-		return DRIVER_ERROR;
-	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
-
-	/* Send command for setting Access Point Names(APN's) */
-	DRIVER_GSM_Write(gsmHandler->gsm,(const uint8_t*) "at+cstt?\r", sizeof("at+cstt?r"));
-
-	/* Read response from gsm  and set response for user*/
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 4000, (const uint8_t*)"OK")){
-	case DRIVER_TIMEOUT:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_TIMEOUT;
-	case DRIVER_ERROR:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_ERROR;
-	case DRIVER_OK:
-		DRIVER_CONSOLE_Put(gsmHandler->console, buffer);
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_OK;
+		gsmHandler->network.status = NETWORK_DISCONNECTED;
+		xEventGroupClearBits(gsmHandler->state, GSM_STATE_REPORTING);
 	}
-	return DRIVER_OK;
-
+	return state;
 }
 
-
 /**
-  * @brief Set wireless connection with GPRS. Before this function, function for setting APN should be called.
+  * @brief Check network connection.
   * @param gsmHandler   GSM handle that contains everything about gsm module.
   * @retval DRIVERState_t status
   */
-DRIVERState_t GSM_SetWirelessConnectionGPRS(gsmHandler_t *gsmHandler)
+DRIVERState_t GSM_CheckNetworkRegistered(gsmHandler_t *gsmHandler)
 {
-	uint8_t buffer[100];
-	uint32_t size = 0;
-
-	/* Reset buffer */
-	memset(buffer,0,sizeof(buffer));
-
-	/* Checking if user send correct gsm and console */
-	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
-	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
-		return DRIVER_ERROR;
-	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
-
-	/* Send command for setting Access Point Names(APN's) */
-	DRIVER_GSM_Write(gsmHandler->gsm,(const uint8_t*) "at+ciicr\r", sizeof("at+ciicr\r"));
-
-	/* Read response from gsm  and set response for user*/
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 3000, (const uint8_t*)"OK")){
-	case DRIVER_TIMEOUT:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_TIMEOUT;
-	case DRIVER_ERROR:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_ERROR;
-	case DRIVER_OK:
-		gsmHandler->network.status = NETWORK_CONNECTED;
-		DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n Wireless connection with GPRS service established!\r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_OK;
-	}
-	return DRIVER_OK;
-
+	return GSM_Execute(gsmHandler, GSM_CMD_NETWORK_CHECK, NULL);
 }
 
 /**
-  * @brief Get local IP adress from provider server.
+  * @brief Set network status from answer to at+creg?.
   * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param answer       Answer from gsm.
+  * @param length       Number of characters of answer.
+  * @param output       ATRegistration_t or NULL.
   * @retval DRIVERState_t status
   */
-DRIVERState_t GSM_GetLocalIPAddress(gsmHandler_t *gsmHandler)
+static DRIVERState_t parseRegistration(gsmHandler_t *gsmHandler, uint8_t *answer, uint32_t length, void *output)
 {
-	uint8_t buffer[100];
-	uint32_t size = 0;
+	if(!AT_PARSE_Registration(answer, length, "+CREG:", &gsmHandler->network.registration)) return DRIVER_ERROR;
+	if(output != NULL) *(ATRegistration_t*)output = gsmHandler->network.registration;
 
-	/* Reset buffer */
-	memset(buffer,0,sizeof(buffer));
+	stateRegistration(gsmHandler, GSM_STATE_REGISTERED, &gsmHandler->network.registration);
+	/* Reports without area and cell (at+creg=1) are turned to at+creg=2 again */
+	if(gsmHandler->network.registration.mode == 2) xEventGroupSetBits(gsmHandler->state, GSM_STATE_REPORTING);
+	else if(gsmHandler->network.registration.mode != AT_PARSE_NONE) xEventGroupClearBits(gsmHandler->state, GSM_STATE_REPORTING);
 
-	/* Checking if user send correct gsm and console */
-	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
+	if(!registered(&gsmHandler->network.registration))
 	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
-		return DRIVER_ERROR;
+		gsmHandler->network.status = NETWORK_DISCONNECTED;
+		DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n Mobile isn't registered to network! Please try to set network connection first!\r\n");
 	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
-
-	/* Send command for setting Access Point Names(APN's) */
-	DRIVER_GSM_Write(gsmHandler->gsm,(const uint8_t*) "at+cifsr\r", sizeof("at+cifsr\r"));
-
-	uint32_t i = 0;
-	uint32_t startMsg = 0;
-
-	/* Read response from gsm  and set response for user*/
-
-	/* Take current time and check if timeout occured */
-	uint32_t tickstart = TIME_GetTick();
-	DRIVERState_t StateReadCmd = DRIVER_OK;
-	while(TIME_GetTick() - tickstart < 3000)
+	else
 	{
-		DRIVER_GSM_Read(gsmHandler->gsm, buffer, &size);
-	}
-
-	/* Badly received response from gsm */
-	if(strstr((const char*)buffer,(const char*)"ERROR") != NULL)
-		StateReadCmd = DRIVER_ERROR;
-
-	switch(StateReadCmd){
-	case DRIVER_ERROR:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_ERROR;
-	case DRIVER_OK:
-		if(strstr((char*)buffer,(const char*)"at+cifsr\r") != NULL)
-		{
-			startMsg = 11;
-		}
-		else
-		{
-			startMsg = 2;
-		}
-
-		for(;buffer[i + startMsg] != '\r';i++) gsmHandler->network.IPaddress[i] = buffer[i + startMsg];
-		DRIVER_CONSOLE_Put(gsmHandler->console, gsmHandler->network.IPaddress);
-		DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_OK;
-	default:
-		break;
+		gsmHandler->network.status = NETWORK_CONNECTED;
+		DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n Mobile is network registered!\r\n");
 	}
 	return DRIVER_OK;
 }
+
 /**
-  * @brief Attach to Packet Domain service.
+  * @brief Check registration to GPRS service.
   * @param gsmHandler   GSM handle that contains everything about gsm module.
   * @retval DRIVERState_t status
   */
-DRIVERState_t GSM_AttachToGPRSService(gsmHandler_t *gsmHandler)
+DRIVERState_t GSM_CheckGPRSRegistered(gsmHandler_t *gsmHandler)
 {
-	uint8_t buffer[100];
-	uint32_t size = 0;
-
-	/* Reset buffer */
-	memset(buffer,0,sizeof(buffer));
+	return GSM_Execute(gsmHandler, GSM_CMD_GPRS_CHECK, NULL);
+}
 
-	/* Checking if user send correct gsm and console */
-	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
-	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
-		return DRIVER_ERROR;
-	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
+/**
+  * @brief Set GPRS registration from answer to at+cgreg?.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param answer       Answer from gsm.
+  * @param length       Number of characters of answer.
+  * @param output       ATRegistration_t or NULL.
+  * @retval DRIVERState_t status
+  */
+static DRIVERState_t parseGprsRegistration(gsmHandler_t *gsmHandler, uint8_t *answer, uint32_t length, void *output)
+{
+	if(!AT_PARSE_Registration(answer, length, "+CGREG:", &gsmHandler->network.gprsRegistration)) return DRIVER_ERROR;
+	if(output != NULL) *(ATRegistration_t*)output = gsmHandler->network.gprsRegistration;
 
-	/* Set command for network activation */
-	DRIVER_GSM_Write(gsmHandler->gsm, (const uint8_t*) "at+cgatt=1\r", sizeof("at+cgatt=1\r"));
+	stateRegistration(gsmHandler, GSM_STATE_ATTACHED, &gsmHandler->network.gprsRegistration);
+	if(gsmHandler->network.gprsRegistration.mode == 2) xEventGroupSetBits(gsmHandler->state, GSM_STATE_GPRS_REPORTING);
+	else if(gsmHandler->network.gprsRegistration.mode != AT_PARSE_NONE) xEventGroupClearBits(gsmHandler->state, GSM_STATE_GPRS_REPORTING);
 
-	/* Read response from gsm  and set response for user*/
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 7000, (const uint8_t*)"OK")){
-	case DRIVER_TIMEOUT:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_TIMEOUT;
-	case DRIVER_ERROR:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_ERROR;
-	case DRIVER_OK:
-		DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n Network attached!\r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_OK;
-	}
+	if(registered(&gsmHandler->network.gprsRegistration))
+		DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n Mobile is registered to GPRS service!\r\n");
+	else
+		DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n Mobile isn't registered to GPRS service!\r\n");
 	return DRIVER_OK;
-
 }
 
 /**
-  * @brief Detach from Packet Domain service.
+  * @brief Read signal quality.
   * @param gsmHandler   GSM handle that contains everything about gsm module.
   * @retval DRIVERState_t status
   */
-DRIVERState_t GSM_DetachFromGPRSService(gsmHandler_t *gsmHandler)
+DRIVERState_t GSM_GetSignalQuality(gsmHandler_t *gsmHandler)
 {
-	uint8_t buffer[100];
-	uint32_t size = 0;
+	return GSM_Execute(gsmHandler, GSM_CMD_SIGNAL, NULL);
+}
 
-	/* Reset buffer */
-	memset(buffer,0,sizeof(buffer));
+/**
+  * @brief Set signal quality from answer to at+csq.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param answer       Answer from gsm.
+  * @param length       Number of characters of answer.
+  * @param output       ATSignal_t or NULL.
+  * @retval DRIVERState_t status
+  */
+static DRIVERState_t parseSignal(gsmHandler_t *gsmHandler, uint8_t *answer, uint32_t length, void *output)
+{
+	if(!AT_PARSE_Signal(answer, length, &gsmHandler->network.signal)) return DRIVER_ERROR;
+	if(output != NULL) *(ATSignal_t*)output = gsmHandler->network.signal;
 
-	/* Checking if user send correct gsm and console */
-	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
-	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
-		return DRIVER_ERROR;
-	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
+	return DRIVER_OK;
+}
 
-	/* Set command for network deactivation */
-	DRIVER_GSM_Write(gsmHandler->gsm, (const uint8_t*) "at+cgatt=0\r", sizeof("at+cgatt=0\r"));
+/**
+  * @brief Read name of selected operator.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t GSM_GetOperator(gsmHandler_t *gsmHandler)
+{
+	return GSM_Execute(gsmHandler, GSM_CMD_OPERATOR, NULL);
+}
 
-	/* Read response from gsm  and set response for user*/
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 7000, (const uint8_t*)"OK")){
-	case DRIVER_TIMEOUT:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_TIMEOUT;
-	case DRIVER_ERROR:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_ERROR;
-	case DRIVER_OK:
-		DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n Network detached!\r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
+/**
+  * @brief Set name of operator from answer to at+cops?.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param answer       Answer from gsm.
+  * @param length       Number of characters of answer.
+  * @param output       ATOperator_t or NULL, its name points into answer that is released after parser.
+  * @retval DRIVERState_t status
+  */
+static DRIVERState_t parseOperator(gsmHandler_t *gsmHandler, uint8_t *answer, uint32_t length, void *output)
+{
+	ATOperator_t operator;
+
+	if(!AT_PARSE_Operator(answer, length, &operator)) return DRIVER_ERROR;
+	if(output != NULL) *(ATOperator_t*)output = operator;
+
+	/* Only name outlives answer */
+	uint32_t size = operator.name.length < GSM_OPERATOR_SIZE - 1 ? operator.name.length : GSM_OPERATOR_SIZE - 1;
+	if(size != 0) memcpy(gsmHandler->network.operatorName, operator.name.text, size);
+	gsmHandler->network.operatorName[size] = '\0';
+	return DRIVER_OK;
+}
+
+/**
+  * @brief Set APN for current region.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t GSM_SetAPN(gsmHandler_t *gsmHandler)
+{
+	if(alreadyReached(gsmHandler, GSM_CMD_SET_APN, (GSM_GetState(gsmHandler) & GSM_STATE_APN) != 0))
+		return DRIVER_OK;
+
+	DRIVERState_t state = GSM_Execute(gsmHandler, GSM_CMD_SET_APN, NULL, "gprsinternet");
+
+	if(state == DRIVER_OK) stateIp(gsmHandler, AT_IP_START);
+	return state;
+}
+
+/**
+  * @brief Check registed APN.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t GSM_CheckAPN(gsmHandler_t *gsmHandler)
+{
+	return GSM_Execute(gsmHandler, GSM_CMD_CHECK_APN, NULL);
+}
+
+
+/**
+  * @brief Set wireless connection with GPRS. Before this function, function for setting APN should be called.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t GSM_SetWirelessConnectionGPRS(gsmHandler_t *gsmHandler)
+{
+	/* Gsm answers "ERROR" to at+ciicr when connection is already up */
+	if(alreadyReached(gsmHandler, GSM_CMD_GPRS, wirelessUp(gsmHandler)))
 		return DRIVER_OK;
+
+	DRIVERState_t state = GSM_Execute(gsmHandler, GSM_CMD_GPRS, NULL);
+
+	if(state == DRIVER_OK)
+	{
+		gsmHandler->network.status = NETWORK_CONNECTED;
+		stateIp(gsmHandler, AT_IP_GPRSACT);
 	}
+	return state;
+}
+
+/**
+  * @brief Get local IP adress from provider server.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t GSM_GetLocalIPAddress(gsmHandler_t *gsmHandler)
+{
+	/* Answer has no final result code, so it is collected until time expires */
+	return GSM_Execute(gsmHandler, GSM_CMD_LOCAL_IP, NULL);
+}
+
+/**
+  * @brief Set and show local IP address from answer to at+cifsr.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param answer       Answer from gsm.
+  * @param length       Number of characters of answer.
+  * @param output       uint32_t for address or NULL.
+  * @retval DRIVERState_t status
+  */
+static DRIVERState_t parseLocalIP(gsmHandler_t *gsmHandler, uint8_t *answer, uint32_t length, void *output)
+{
+	uint32_t address;
+
+	/* Echo of command and "ERROR" are not address */
+	if(!AT_PARSE_LocalAddress(answer, length, &address)) return DRIVER_ERROR;
+	if(output != NULL) *(uint32_t*)output = address;
+
+	gsmHandler->network.address = address;
+	if(gsmHandler->network.ipState < AT_IP_STATUS) stateIp(gsmHandler, AT_IP_STATUS);
+	snprintf((char*)gsmHandler->network.IPaddress, sizeof(gsmHandler->network.IPaddress), "%lu.%lu.%lu.%lu",
+			 (unsigned long)(address >> 24), (unsigned long)((address >> 16) & 0xFF),
+			 (unsigned long)((address >> 8) & 0xFF), (unsigned long)(address & 0xFF));
+
+	DRIVER_CONSOLE_Put(gsmHandler->console, gsmHandler->network.IPaddress);
+	DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n");
 	return DRIVER_OK;
+}
+
+/**
+  * @brief Attach to Packet Domain service.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t GSM_AttachToGPRSService(gsmHandler_t *gsmHandler)
+{
+	if(alreadyReached(gsmHandler, GSM_CMD_ATTACH, (GSM_GetState(gsmHandler) & GSM_STATE_ATTACHED) != 0))
+		return DRIVER_OK;
+
+	DRIVERState_t state = GSM_Execute(gsmHandler, GSM_CMD_ATTACH, NULL);
 
+	if(state == DRIVER_OK) xEventGroupSetBits(gsmHandler->state, GSM_STATE_ATTACHED);
+	return state;
+}
+
+/**
+  * @brief Detach from Packet Domain service.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t GSM_DetachFromGPRSService(gsmHandler_t *gsmHandler)
+{
+	DRIVERState_t state = GSM_Execute(gsmHandler, GSM_CMD_DETACH, NULL);
+
+	if(state == DRIVER_OK)
+	{
+		/* Contexts don't stay active without GPRS service */
+		xEventGroupClearBits(gsmHandler->state, GSM_STATE_ATTACHED);
+		gsmHandler->network.activeContexts = 0;
+		stateIp(gsmHandler, wirelessUp(gsmHandler) ? AT_IP_PDP_DEACT : gsmHandler->network.ipState);
+	}
+	return state;
 }
 
 /**
@@ -1556,14 +1969,10 @@ DRIVERState_t GSM_DetachFromGPRSService(gsmHandler_t *gsmHandler)
   * @param gsmHandler   GSM handle that contains everything about gsm module.
   * @param timeout      Timeout period for console.
   * @param inputStruct  Structure that contains needed variables to set PDP context.
-  * @param outputStruct Structure that contains answer from gsm module.
   * @retval DRIVERState_t status
   */
 DRIVERState_t GSM_SetPDPContext(gsmHandler_t *gsmHandler, uint32_t timeout, SetPDPInputStruct_t inputStruct)
 {
-	uint8_t buffer[100] = {0};
-	uint32_t size = 0;
-
 	/* Check if we have space to open new socket */
 	if(GSM_CheckOpenSocketNo(gsmHandler) == SOCKET_FULL)
 	{
@@ -1571,83 +1980,19 @@ DRIVERState_t GSM_SetPDPContext(gsmHandler_t *gsmHandler, uint32_t timeout, SetP
 		return DRIVER_ERROR;
 	}
 
-	/* Checking if user send correct gsm and console */
-	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
-	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
-		return DRIVER_ERROR;
-	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
-
-	/* set message that  will be sent to gsm */
-	uint8_t msgToSend[200] = {0};
-	uint32_t msgSize = 0;
-
-	/* Set command for seting pdp context on gsm module */
-	uint8_t PDPContextID[14];
-	memset(PDPContextID,0,sizeof(PDPContextID));
-	strcat((char*)PDPContextID,(const char*)"at+cgdcont=");
-	PDPContextID[11] = *inputStruct.PDPNo;
-	if(inputStruct.PDPNo[1] == '\r')
-	{
-		PDPContextID[12] = ',';
-		PDPContextID[13] = '\0';
-		msgSize = 13;
-	}
+	/* Set Packet Data Protocol type */
+	const char *PDPType = NULL;
+	if( *inputStruct.PDPTypeFlag == '1') PDPType = "IP";
+	else if(*inputStruct.PDPTypeFlag == '2') PDPType = "IPV6";
+	else if(*inputStruct.PDPTypeFlag == '3') PDPType = "PPP";
 	else
 	{
-		PDPContextID[12] = inputStruct.PDPNo[1];
-		PDPContextID[13] = ',';
-		PDPContextID[14] = '\0';
-		msgSize = 14;
-	}
-
-	/* Set Packet Data Protocol type and
-	 * set size of message for sending command to gsm module */
-	uint8_t PDPType[10] = {0};
-	if( *inputStruct.PDPTypeFlag == '1') {strcpy((char*)PDPType,(const char*)"\"IP\","); msgSize += 5;}
-	else if(*inputStruct.PDPTypeFlag == '2') {strcpy((char*)PDPType,(const char*)"\"IPV6\","); msgSize += 7;}
-	else if(*inputStruct.PDPTypeFlag == '3') {strcpy((char*)PDPType,(const char*)"\"PPP\","); msgSize += 6;}
-
-	/* Find size of APNType */
-	uint32_t i = 0;
-	for(; inputStruct.APNType[i] != '\r';i++);
-	msgSize += i;
-
-	/* Set buffer for sending command to gsm module to contains message  */
-	memset(msgToSend,0, msgSize);
-	strcat((char*)msgToSend,(const char*)PDPContextID);
-	strcat((char*)msgToSend,(const char*)PDPType);
-	strcat((char*)msgToSend,(const char*)"\"");
-	strcat((char*)msgToSend,(const char*)inputStruct.APNType);
-	msgSize++;
-	msgToSend[msgSize++] = '\"';
-	msgToSend[msgSize++] = '\r';
-
-	/* Reset buffer and his size */
-	memset(buffer,0,sizeof(buffer));
-	size = 0;
-
-	/* Set command for setting PDP context */
-	DRIVER_GSM_Write(gsmHandler->gsm, msgToSend, msgSize);
-
-	/* Read response from gsm  and set response for user*/
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 2000, (const uint8_t*)"OK")){
-	case DRIVER_TIMEOUT:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_TIMEOUT;
-	case DRIVER_ERROR:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
+		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect type of PDP!\r\n");
 		return DRIVER_ERROR;
-	case DRIVER_OK:
-		DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n Packet Data Protocol(PDP) is now setted!\r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_OK;
 	}
-	return DRIVER_OK;
 
+	return GSM_Execute(gsmHandler, GSM_CMD_SET_PDP, NULL, argumentLength(inputStruct.PDPNo), inputStruct.PDPNo, PDPType,
+					   argumentLength(inputStruct.APNType), inputStruct.APNType);
 }
 
 /**
@@ -1657,106 +2002,73 @@ DRIVERState_t GSM_SetPDPContext(gsmHandler_t *gsmHandler, uint32_t timeout, SetP
   */
 DRIVERState_t GSM_CheckSettedPDPContext(gsmHandler_t *gsmHandler)
 {
-	uint8_t buffer[1000];
+	return GSM_Execute(gsmHandler, GSM_CMD_CHECK_PDP, NULL);
+}
 
-	/* Reset buffer and his size */
-	memset(buffer,0,sizeof(buffer));
-	uint32_t size = 0;
+/**
+  * @brief Check active Packet Data Protocol context for gsm module.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t GSM_CheckActivePDPContext(gsmHandler_t *gsmHandler)
+{
+	return GSM_Execute(gsmHandler, GSM_CMD_ACTIVE_PDP, NULL);
+}
 
-	/* Checking if user send correct gsm and console */
-	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
+/**
+  * @brief Bits of contexts that are listed in answer with one line for every PDP context.
+  * @param answer       Answer from gsm.
+  * @param length       Number of characters of answer.
+  * @param prefix       "+CGDCONT:" or "+CGACT:".
+  * @param active       True to set bits only of active contexts.
+  * @retval uint32_t bit of every context
+  */
+static uint32_t contextBits(uint8_t *answer, uint32_t length, const char *prefix, bool active)
+{
+	ATScanner_t scanner;
+	ATPdpContext_t context;
+	uint32_t bits = 0;
+
+	AT_PARSE_Start(&scanner, answer, length);
+	while(AT_PARSE_PdpContext(&scanner, prefix, &context))
 	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
-		return DRIVER_ERROR;
+		if(context.cid < 32 && (context.active || !active)) bits |= 1UL << context.cid;
 	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
-
-	/* Send command to dissconnect from server */
-	DRIVER_GSM_Write(gsmHandler->gsm, (const uint8_t*)"at+cgdcont?\r", sizeof("at+cgdcont?\r"));
 
-	uint8_t *startStr;
-	uint8_t *endStr;
-	uint8_t consoleMsg[1000];
-	uint32_t i = 0;
-	/* Read response from gsm  and set response for user */
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 4000, (const uint8_t*)"OK")){
-	case DRIVER_TIMEOUT:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_TIMEOUT;
-	case DRIVER_ERROR:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_ERROR;
-	case DRIVER_OK:
-		startStr = (uint8_t *)strstr((char *)buffer,(const char *)"+CGDCONT");
-		endStr = (uint8_t *)strstr((char *)buffer,(const char *)"OK");
-		memset(consoleMsg,0,sizeof(consoleMsg));
-		for(;startStr != endStr; i++)
-		{
-			consoleMsg[i] = *startStr;
-			startStr++;
-		}
-		DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n");
-		DRIVER_CONSOLE_Put(gsmHandler->console, consoleMsg);
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_OK;
-	}
-	return DRIVER_OK;
+	return bits;
 }
 
 /**
-  * @brief Check active Packet Data Protocol context for gsm module.
+  * @brief Set bits of setted PDP contexts from answer to at+cgdcont?.
   * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param answer       Answer from gsm.
+  * @param length       Number of characters of answer.
+  * @param output       uint32_t for bits of contexts or NULL.
   * @retval DRIVERState_t status
   */
-DRIVERState_t GSM_CheckActivePDPContext(gsmHandler_t *gsmHandler)
+static DRIVERState_t parseDefinedContexts(gsmHandler_t *gsmHandler, uint8_t *answer, uint32_t length, void *output)
 {
-	uint8_t buffer[100];
+	gsmHandler->network.definedContexts = contextBits(answer, length, "+CGDCONT:", false);
+	if(output != NULL) *(uint32_t*)output = gsmHandler->network.definedContexts;
 
-	/* Reset buffer and his size */
-	memset(buffer,0,sizeof(buffer));
-	uint32_t size = 0;
+	return DRIVER_OK;
+}
 
-	/* Checking if user send correct gsm and console */
-	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
-	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
-		return DRIVER_ERROR;
-	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
+/**
+  * @brief Set bits of active PDP contexts from answer to at+cgact?.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param answer       Answer from gsm.
+  * @param length       Number of characters of answer.
+  * @param output       uint32_t for bits of contexts or NULL.
+  * @retval DRIVERState_t status
+  */
+static DRIVERState_t parseActiveContexts(gsmHandler_t *gsmHandler, uint8_t *answer, uint32_t length, void *output)
+{
+	gsmHandler->network.activeContexts = contextBits(answer, length, "+CGACT:", true);
+	if(output != NULL) *(uint32_t*)output = gsmHandler->network.activeContexts;
 
-	/* Send command to check activation type of defined PDP contexts */
-	DRIVER_GSM_Write(gsmHandler->gsm, (const uint8_t*)"at+cgact?\r", sizeof("at+cgact?\r"));
+	stateConnection(gsmHandler);
 
-	uint8_t *startStr;
-	uint8_t *endStr;
-	uint8_t consoleMsg[1000];
-	uint32_t i = 0;
-	/* Read response from gsm  and set response for user */
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 4000, (const uint8_t*)"OK")){
-	case DRIVER_TIMEOUT:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_TIMEOUT;
-	case DRIVER_ERROR:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_ERROR;
-	case DRIVER_OK:
-		startStr = (uint8_t *)strstr((char *)buffer,(const char *)"+CGACT");
-		endStr = (uint8_t *)strstr((char *)buffer,(const char *)"OK");
-		memset(consoleMsg,0,sizeof(consoleMsg));
-		for(;startStr != endStr; i++)
-		{
-			consoleMsg[i] = *startStr;
-			startStr++;
-		}
-		DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n");
-		DRIVER_CONSOLE_Put(gsmHandler->console, consoleMsg);
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_OK;
-	}
 	return DRIVER_OK;
 }
 
@@ -1767,54 +2079,68 @@ DRIVERState_t GSM_CheckActivePDPContext(gsmHandler_t *gsmHandler)
   */
 DRIVERState_t GSM_ShowPDPIP(gsmHandler_t *gsmHandler)
 {
-	uint8_t buffer[1000];
+	return GSM_Execute(gsmHandler, GSM_CMD_PDP_IP, NULL);
+}
 
-	/* Reset buffer and his size */
-	memset(buffer,0,sizeof(buffer));
-	uint32_t size = 0;
+/**
+  * @brief Check PDP argument and fill socket of context that is activated.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param PDP 			Index of Packet Data Protocol format that will be activated
+  * @param socketInit   Socket of context.
+  * @retval DRIVERState_t DRIVER_ERROR for wrong argument or without free socket
+  */
+static DRIVERState_t prepareContext(gsmHandler_t *gsmHandler, const uint8_t *PDP, Socket_t *socketInit)
+{
+	if(strchr((char*)PDP,'\r') == NULL) {
+		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: Set correct format of PDP argument!\r\n "
+				"Paramater PDP needs to finish with '\r' char! \r\n");
+		return DRIVER_ERROR;
+	}
 
-	/* Checking if user send correct gsm and console */
-	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
+	/* Check if we have space to open new socket */
+	if(GSM_CheckOpenSocketNo(gsmHandler) == SOCKET_FULL)
 	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
+		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: No available sockets for opening! Try closing some socket!\r\n");
 		return DRIVER_ERROR;
 	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
 
-	/* Send command to check activation type of defined PDP contexts */
-	DRIVER_GSM_Write(gsmHandler->gsm, (const uint8_t*)"at+cgpaddr\r", sizeof("at+cgpaddr\r"));
+	/* Set which one PDP context will be open (only set PDPcontextNO)! When
+	 * connecting with server set other parameters */
+	if(PDP[1] == '\r') socketInit->PDPcontextNo = *PDP - '0';
+	else socketInit->PDPcontextNo = 10 + (PDP[1] - '0');
+
+	memset(socketInit->IPaddress,0, sizeof(socketInit->IPaddress));
+	socketInit->port = PORT_NON;
+	socketInit->status = SOCKET_SET;
+	memset(socketInit->type,0, sizeof(socketInit->type));
 
-	uint8_t *startStr;
-	uint8_t *endStr;
-	uint8_t consoleMsg[1000];
-	uint32_t i = 0;
-	/* Read response from gsm  and set response for user */
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 4000, (const uint8_t*)"OK")){
-	case DRIVER_TIMEOUT:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_TIMEOUT;
-	case DRIVER_ERROR:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_ERROR;
-	case DRIVER_OK:
-		startStr = (uint8_t *)strstr((char *)buffer,(const char *)"+CGPADDR");
-		endStr = (uint8_t *)strstr((char *)buffer,(const char *)"OK");
-		memset(consoleMsg,0,sizeof(consoleMsg));
-		for(;startStr != endStr; i++)
-		{
-			consoleMsg[i] = *startStr;
-			startStr++;
-		}
-		DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n");
-		DRIVER_CONSOLE_Put(gsmHandler->console, consoleMsg);
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_OK;
-	}
 	return DRIVER_OK;
 }
 
+/**
+  * @brief Bit of context in active contexts of network structure.
+  * @param PDPcontextNo Number of context.
+  * @retval uint32_t bit, 0 for context that has no bit
+  */
+static uint32_t contextBit(uint8_t PDPcontextNo)
+{
+	return PDPcontextNo < 32 ? 1UL << PDPcontextNo : 0;
+}
+
+/**
+  * @brief Keep context that gsm activated as active socket.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param socketInit   Socket of context.
+  * @retval void
+  */
+static void contextActivated(gsmHandler_t *gsmHandler, Socket_t *socketInit)
+{
+	gsmHandler->network.activeContexts |= contextBit(socketInit->PDPcontextNo);
+	stateConnection(gsmHandler);
+	gsmHandler->activeSocketNo = socketInit->PDPcontextNo; /* set active PDP context in gsm handler */
+	GSM_SetSocket(gsmHandler, socketInit);
+}
+
 /**
   * @brief Active Packet Data Protocol context for gsm module.
   * @param gsmHandler   GSM handle that contains everything about gsm module.
@@ -1824,220 +2150,272 @@ DRIVERState_t GSM_ShowPDPIP(gsmHandler_t *gsmHandler)
   */
 DRIVERState_t GSM_ActivePDPContext(gsmHandler_t *gsmHandler, uint32_t timeout, const uint8_t *PDP)
 {
-	uint8_t buffer[100];
-	uint32_t size = 0;
 	Socket_t socketInit;
 
-	/* Reset buffer */
-	memset(buffer,0,sizeof(buffer));
+	if(prepareContext(gsmHandler, PDP, &socketInit) != DRIVER_OK) return DRIVER_ERROR;
 
-	if(strchr((char*)PDP,'\r') == NULL) {
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: Set correct format of PDP argument!\r\n "
-				"Paramater PDP needs to finish with '\r' char! \r\n");
-		return DRIVER_ERROR;
-	}
+	/* Context that is already active only becomes active socket again */
+	DRIVERState_t state = DRIVER_OK;
+	if(!alreadyReached(gsmHandler, GSM_CMD_PDP_ON, (gsmHandler->network.activeContexts & contextBit(socketInit.PDPcontextNo)) != 0))
+		state = GSM_Execute(gsmHandler, GSM_CMD_PDP_ON, NULL, argumentLength(PDP), PDP);
 
-	/* Check if we have space to open new socket */
-	if(GSM_CheckOpenSocketNo(gsmHandler) == SOCKET_FULL)
-	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: No available sockets for opening! Try closing some socket!\r\n");
-		return DRIVER_ERROR;
-	}
+	/* Set number of opened socket context and set currently opened socket! */
+	if(state == DRIVER_OK) contextActivated(gsmHandler, &socketInit);
+	return state;
+}
 
-	/* Checking if user send correct gsm and console */
-	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
+/**
+  * @brief Deactive Packet Data Protocol context for GPRS connection.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t GSM_DeactiveGPRSPDPContext(gsmHandler_t *gsmHandler)
+{
+	DRIVERState_t state = GSM_Execute(gsmHandler, GSM_CMD_SHUT, NULL);
+
+	if(state == DRIVER_OK)
 	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
-		return DRIVER_ERROR;
+		gsmHandler->network.activeContexts = 0;
+		stateIp(gsmHandler, AT_IP_INITIAL);
 	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
-
-	/* Make pointer for storing message to send to gsm module */
-	uint32_t msgSize = 0;
+	return state;
+}
 
-	/* Set command for activating PDP context */
+/**
+  * @brief Deactive Packet Data Protocol context for gsm module.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param PDP 			Index of Packet Data Protocol format that will be deactivated
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t GSM_DeactivePDPContext(gsmHandler_t *gsmHandler, uint32_t timeout, const uint8_t *PDP)
+{
+	Socket_t socketInit;
 
-	/* Set which one PDP context will be open (only set PDPcontextNO)! When
+	/* Set which one PDP context will be closed (only set PDPcontextNO)! When
 	 * connecting with server set other parameters */
-	uint8_t activePDP[14];
-	memset(activePDP,0,sizeof(activePDP));
-	strcat((char*)activePDP,(const char*)"at+cgact=1,");
-	activePDP[11] = *PDP;
-	if(PDP[1] == '\r')
-	{
-		activePDP[12] = '\r';
-		msgSize = 13;
-		socketInit.PDPcontextNo = *PDP - '0';
-	}
-	else
-	{
-		activePDP[12] = PDP[1];
-		activePDP[13] = '\r';
-		msgSize = 14;
-		socketInit.PDPcontextNo = 10 + (PDP[1] - '0');
-	}
+	if(PDP[1] == '\r' || PDP[1] == '\0') socketInit.PDPcontextNo = *PDP - '0';
+	else socketInit.PDPcontextNo = 10 + (PDP[1] - '0');
 
 	memset(socketInit.IPaddress,0, sizeof(socketInit.IPaddress));
 	socketInit.port = PORT_NON;
-	socketInit.status = SOCKET_SET;
+	socketInit.status = SOCKET_CLOSE;
 	memset(socketInit.type,0, sizeof(socketInit.type));
 
-	/* Set command for activation PDP context */
-	DRIVER_GSM_Write(gsmHandler->gsm, activePDP, msgSize);
+	DRIVERState_t state = GSM_Execute(gsmHandler, GSM_CMD_PDP_OFF, NULL, argumentLength(PDP), PDP);
+	if(state == DRIVER_OK)
+	{
+		if(socketInit.PDPcontextNo < 32) gsmHandler->network.activeContexts &= ~(1UL << socketInit.PDPcontextNo);
+		stateConnection(gsmHandler);
+		gsmHandler->activeSocketNo = 0; /* set parameter to "non of sockets are active" */
+		GSM_CloseSocket(gsmHandler,&socketInit);
+	}
+	return state;
+}
 
-	/* Read response from gsm  and set response for user*/
-	/* Set number of opened socket context and set currently opened socket! */
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 7000, (const uint8_t*)"OK")){
-	case DRIVER_TIMEOUT:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_TIMEOUT;
-	case DRIVER_ERROR:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_ERROR;
-	case DRIVER_OK:
-		DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n Packet Data Protocol(PDP) is activated!\r\n");
-		gsmHandler->activeSocketNo = socketInit.PDPcontextNo; /* set active PDP context in gsm handler */
-		GSM_SetSocket(gsmHandler, &socketInit);
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_OK;
+/**
+  * @brief Set auto sending timer - the seconds after which the data will be sent to server
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param timeout      Timeout period for console.
+  * @param status  		Hexadecimal or decimal choice (can be only '1' or '2' character!).
+  * @param time			Can be parameter in range from 1 to 101.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t GSM_SetAutoSendingTimerIP(gsmHandler_t *gsmHandler, uint32_t timeout, uint8_t status, uint8_t *time)
+{
+	/* Timer is turned on with its time, turned off without it */
+	DRIVERState_t state = status == '2' ?
+			GSM_Execute(gsmHandler, GSM_CMD_AUTO_TIMER, NULL, "1,", argumentLength(time), time) :
+			GSM_Execute(gsmHandler, GSM_CMD_AUTO_TIMER, NULL, "0", 0, "");
+
+	if(state == DRIVER_OK)
+	{
+		if(status == '2') DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\nTimer is now ON!\r\n");
+		else DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\nTimer is now OFF!\r\n");
 	}
-	return DRIVER_OK;
+	return state;
 }
 
+
 /**
-  * @brief Deactive Packet Data Protocol context for GPRS connection.
+  * @brief Set format of sending packets in TCPIP protocol (hexadecimal or decimal format).
   * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param timeout      Timeout period for console.
+  * @param format		Format of sending packet via TCPIP(hexadecimal-'1' or decimal-'2').
   * @retval DRIVERState_t status
   */
-DRIVERState_t GSM_DeactiveGPRSPDPContext(gsmHandler_t *gsmHandler)
+DRIVERState_t GSM_SetSendingIPFormat(gsmHandler_t *gsmHandler, uint32_t timeout, uint8_t format)
 {
-	uint8_t buffer[100];
-	uint32_t size = 0;
+	if(alreadyReached(gsmHandler, GSM_CMD_SEND_FORMAT, format == '1' && (GSM_GetState(gsmHandler) & GSM_STATE_HEX_FORMAT) != 0))
+		return DRIVER_OK;
 
-	/* Reset buffer */
-	memset(buffer,0,sizeof(buffer));
+	DRIVERState_t state = GSM_Execute(gsmHandler, GSM_CMD_SEND_FORMAT, NULL, format == '1' ? '1':'0');
 
-	/* Checking if user send correct gsm and console */
-	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
+	if(state == DRIVER_OK)
 	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
+		if(format == '1')
+		{
+			xEventGroupSetBits(gsmHandler->state, GSM_STATE_HEX_FORMAT);
+			DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\nHexadecimal format is now ON!\r\n");
+		}
+		else
+		{
+			xEventGroupClearBits(gsmHandler->state, GSM_STATE_HEX_FORMAT);
+			DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\nDecimal format is now ON!\r\n");
+		}
+	}
+	return state;
+}
+
+/**
+  * @brief Check server arguments and fill socket of connection.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param inputStruct  Type of connection, IP address and port of server.
+  * @param PDPcontextNo Context of connection.
+  * @param socketInit   Socket of connection.
+  * @param portChar     Port in characters, for command (6 characters).
+  * @retval DRIVERState_t DRIVER_ERROR for wrong argument
+  */
+static DRIVERState_t prepareServer(gsmHandler_t *gsmHandler, ConnectSrvrInputStruct_t inputStruct, uint8_t PDPcontextNo,
+								   Socket_t *socketInit, uint8_t *portChar)
+{
+	/** Set type of connection **/
+
+    /* Set socket for initialization with his type */
+	memset(socketInit->type,0, sizeof(socketInit->type));
+	if(inputStruct.connectType == '1') strcpy((char*)socketInit->type,(const char*)"TCP" );
+	else if(inputStruct.connectType == '2') strcpy((char*)socketInit->type,(const char*)"UDP" );
+
+	/** Set IP address **/
+
+	/* Set socket for initialization with his IP address, without '\r' */
+	int i = argumentLength(inputStruct.ipAddr);
+	if(i >= (int)sizeof(socketInit->IPaddress))
+	{
+		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect IP address of server!\r\n");
 		return DRIVER_ERROR;
 	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
+	memcpy(socketInit->IPaddress, inputStruct.ipAddr, i);
+	socketInit->IPaddress[i] = '\0';
 
-	/* Set command for deactivating PDP context */
-	DRIVER_GSM_Write(gsmHandler->gsm,(const uint8_t*) "at+cipshut\r", sizeof("at+cipshut\r"));
+	/** Set port **/
 
-	/* Read response from gsm  and set response for user*/
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 4000, (const uint8_t*)"OK")){
-	case DRIVER_TIMEOUT:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_TIMEOUT;
-	case DRIVER_ERROR:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
+	/* Save port number in characters and set socket port */
+	memset(portChar, 0, 6);
+	i = argumentLength(inputStruct.port);
+	if(i >= 6)
+	{
+		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect port of server!\r\n");
 		return DRIVER_ERROR;
-	case DRIVER_OK:
-		DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n Packet Data Protocol(PDP) is deactivated!\r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_OK;
 	}
+	memcpy(portChar, inputStruct.port, i);
+	socketInit->port = atoi((const char*)portChar);
+
+	socketInit->PDPcontextNo = PDPcontextNo;
+	socketInit->status = SOCKET_SET;
+
 	return DRIVER_OK;
 }
 
 /**
-  * @brief Deactive Packet Data Protocol context for gsm module.
+  * @brief Check if connection with the same server on the same context is open.
   * @param gsmHandler   GSM handle that contains everything about gsm module.
-  * @param PDP 			Index of Packet Data Protocol format that will be deactivated
+  * @param socketInit   Socket of connection.
+  * @retval bool true if connection doesn't have to be opened
+  */
+static bool serverConnected(gsmHandler_t *gsmHandler, const Socket_t *socketInit)
+{
+	Socket_t *socket = &gsmHandler->socket[socketInit->PDPcontextNo <= MAX_SOCKET_NUMBER ? socketInit->PDPcontextNo : 0];
+
+	return (GSM_GetState(gsmHandler) & GSM_STATE_CONNECTED) != 0 && gsmHandler->activeSocketNo == socketInit->PDPcontextNo &&
+		   socket->port == socketInit->port && strcmp((char*)socket->IPaddress, (char*)socketInit->IPaddress) == 0 &&
+		   strcmp((char*)socket->type, (char*)socketInit->type) == 0;
+}
+
+/**
+  * @brief Connect gsm module to specified server.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param timeout      Timeout period for console.
+  * @param inputStruct  Structure that contains needed variables to set PDP context:
+  * connectType- type of connection(it can be TCP-'1' or UDP-'2'),
+  * ipAddr - IP address of server, port - Port number of server.
   * @retval DRIVERState_t status
   */
-DRIVERState_t GSM_DeactivePDPContext(gsmHandler_t *gsmHandler, uint32_t timeout, const uint8_t *PDP)
+DRIVERState_t GSM_ConnectToServer(gsmHandler_t *gsmHandler, uint32_t timeout,ConnectSrvrInputStruct_t inputStruct)
 {
-	uint8_t buffer[100];
-	uint32_t size = 0;
 	Socket_t socketInit;
+	uint8_t portChar[6];
 
-	/* Reset buffer */
-	memset(buffer,0,sizeof(buffer));
+	if(prepareServer(gsmHandler, inputStruct, gsmHandler->activeSocketNo, &socketInit, portChar) != DRIVER_OK)
+		return DRIVER_ERROR;
 
-	/* Checking if user send correct gsm and console */
-	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
+	/* Connection with the same server on active context stays open */
+	if(alreadyReached(gsmHandler, GSM_CMD_CONNECT, serverConnected(gsmHandler, &socketInit)))
+		return DRIVER_OK;
+
+	DRIVERState_t state = GSM_Execute(gsmHandler, GSM_CMD_CONNECT, NULL, socketInit.type, socketInit.IPaddress, portChar);
+	if(state == DRIVER_OK)
 	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
-		return DRIVER_ERROR;
+		GSM_SetSocket(gsmHandler,&socketInit);
+		stateIp(gsmHandler, AT_IP_CONNECT_OK);
 	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
+	return state;
+}
 
-	/* Make pointer for storing message to send to gsm module */
-	uint32_t msgSize = 0;
+/**
+  * @brief Disonnect gsm module to specified server.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t GSM_DisconnectFromServer(gsmHandler_t *gsmHandler)
+{
+	DRIVERState_t state = GSM_Execute(gsmHandler, GSM_CMD_CLOSE, NULL);
 
-	/* Set command for activating PDP context */
+	if(state == DRIVER_OK) stateIp(gsmHandler, AT_IP_CLOSED);
+	return state;
+}
 
-	/* Set which one PDP context will be closed (only set PDPcontextNO)! When
-	 * connecting with server set other parameters */
-	uint8_t activePDP[14];
-	memset(activePDP,0,sizeof(activePDP));
-	strcat((char*)activePDP,(const char*)"at+cgact=0,");
-	activePDP[11] = *PDP;
-	if(PDP[1] == '\r')
-	{
-		activePDP[12] = '\r';
-		msgSize = 13;
-		socketInit.PDPcontextNo = *PDP - '0';
-	}
-	else
-	{
-		activePDP[12] = buffer[1];
-		activePDP[13] = '\r';
-		msgSize = 14;
-		socketInit.PDPcontextNo = 10 + (PDP[1] - '0');
-	}
+/**
+  * @brief Check IP connection for all channels(number of channels is preveously defined with macro MAX_SOCKET_NUMBER).
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t GSM_CheckConnection(gsmHandler_t *gsmHandler)
+{
+	/* State comes after "OK", so answer is collected until time expires */
+	return GSM_Execute(gsmHandler, GSM_CMD_STATUS, NULL);
+}
 
-	memset(socketInit.IPaddress,0, sizeof(socketInit.IPaddress));
-	socketInit.port = PORT_NON;
-	socketInit.status = SOCKET_CLOSE;
-	memset(socketInit.type,0, sizeof(socketInit.type));
+/**
+  * @brief Set state of IP connection from answer to at+cipstatus.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param answer       Answer from gsm.
+  * @param length       Number of characters of answer.
+  * @param output       ATIpState_t or NULL.
+  * @retval DRIVERState_t status
+  */
+static DRIVERState_t parseIpState(gsmHandler_t *gsmHandler, uint8_t *answer, uint32_t length, void *output)
+{
+	ATIpState_t ipState;
 
-	/* Set command for deactivating PDP context */
-	DRIVER_GSM_Write(gsmHandler->gsm, activePDP, msgSize);
+	if(!AT_PARSE_IpState(answer, length, &ipState)) return DRIVER_ERROR;
+	if(output != NULL) *(ATIpState_t*)output = ipState;
+
+	stateIp(gsmHandler, ipState);
 
-	/* Read response from gsm  and set response for user*/
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 6000, (const uint8_t*)"OK")){
-	case DRIVER_TIMEOUT:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_TIMEOUT;
-	case DRIVER_ERROR:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_ERROR;
-	case DRIVER_OK:
-		DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n Packet Data Protocol(PDP) is deactivated!\r\n");
-		gsmHandler->activeSocketNo = 0; /* set parameter to "non of sockets are active" */
-		GSM_CloseSocket(gsmHandler,&socketInit);
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_OK;
-	}
 	return DRIVER_OK;
 }
 
 /**
-  * @brief Set auto sending timer - the seconds after which the data will be sent to server
+  * @brief Send data to server.
   * @param gsmHandler   GSM handle that contains everything about gsm module.
   * @param timeout      Timeout period for console.
-  * @param status  		Hexadecimal or decimal choice (can be only '1' or '2' character!).
-  * @param time			Can be parameter in range from 1 to 101.
+  * @param message 		String that contains message that will be sent.
   * @retval DRIVERState_t status
   */
-DRIVERState_t GSM_SetAutoSendingTimerIP(gsmHandler_t *gsmHandler, uint32_t timeout, uint8_t status, uint8_t *time)
+DRIVERState_t GSM_SendToServer(gsmHandler_t *gsmHandler, uint32_t timeout, uint8_t *message)
 {
-	uint8_t buffer[100];
+	uint8_t buffer[100] = {0};
 
-	/* Reset buffer and his size */
-	memset(buffer,0,sizeof(buffer));
 	uint32_t size = 0;
 
 	/* Checking if user send correct gsm and console */
@@ -2046,436 +2424,390 @@ DRIVERState_t GSM_SetAutoSendingTimerIP(gsmHandler_t *gsmHandler, uint32_t timeo
 		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
 		return DRIVER_ERROR;
 	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
 
-	/* Set command for setting timer mode */
-	uint8_t timer[12] = {'a','t','+','c','i','p','a','t','s','=',status == '2' ? '1':'0','\0'};
-	uint8_t msgToSend[20] = {0};
-	uint8_t msgSize = 11;
-	strcat((char*)msgToSend,(const char*)timer);
-
-	if(status == '2')
+	/* Message is copied into arena of calling task to put <CTRL-Z> at its end */
+	size = strlen((const char*)message);
+	ARENAHandler_t *arena 	= ARENA_Current();
+	ARENAMark_t scope 		= ARENA_Mark(arena);
+	uint8_t *msgToSend 		= ARENA_Alloc(arena, size + 1);
+	if(msgToSend == NULL)
+	{
+		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: not enough scratch memory for message!\r\n");
+		return DRIVER_ERROR;
+	}
+	uint32_t msgSize = 0;
+	memcpy(msgToSend, message, size);
+	msgSize = size;
+	/* If we send message with \r endning character, then we need to set control-z in that place */
+	if(strchr((char*)message,'\r') != NULL )
 	{
-		strcat((char*)msgToSend,(const char*)",");
-		strcat((char*)msgToSend,(const char*)time);
-		msgSize += strlen((const char*)time) + 1;
+		msgToSend[size -1] = 26; /* <CTRL-Z> character */
 	}
 	else
 	{
-		strcat((char*)msgToSend,(const char*)"\r");
+		msgToSend[size] = 26; /* <CTRL-Z> character */
 		msgSize++;
 	}
 
-	/* Reset buffer and his size */
-	memset(buffer,0,sizeof(buffer));
-	size = 0;
-
-	/* Send command to gsm */
-	DRIVER_GSM_Write(gsmHandler->gsm, msgToSend, msgSize);
+	/* Send message to server right after ">", command and message are one chain for at engine */
+	ATCommand_t data = {.command = msgToSend, .commandSize = msgSize, .expect = (const uint8_t*)"SEND OK", .timeout = 6000,
+						.timeoutClass = AT_TIMEOUT_SEND, .response = buffer, .responseSize = sizeof(buffer)};
+	ATCommand_t send = {.command = (const uint8_t*)"at+cipsend\r", .commandSize = sizeof("at+cipsend\r") - 1,
+						.expect = (const uint8_t*)">", .timeout = 6000, .timeoutClass = AT_TIMEOUT_PROMPT, .response = buffer,
+						.responseSize = sizeof(buffer), .priority = AT_PRIORITY_BULK, .next = &data};
+	AT_Execute(&send);
 
-	/* Read response from gsm  and set response for user*/
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 4000, (const uint8_t*)"OK\r\n")){
+	/* Read response from gsm  and set response for user */
+	switch(send.result){
 	case DRIVER_TIMEOUT:
 		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
+		ARENA_Release(arena, scope);
 		return DRIVER_TIMEOUT;
 	case DRIVER_ERROR:
 		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
+		ARENA_Release(arena, scope);
 		return DRIVER_ERROR;
 	case DRIVER_OK:
-		if(timer[10] == '1') DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\nTimer is now ON!\r\n");
-		else DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\nTimer is now OFF!\r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_OK;
-
-	}
-	return DRIVER_OK;
-}
-
-
-/**
-  * @brief Set format of sending packets in TCPIP protocol (hexadecimal or decimal format).
-  * @param gsmHandler   GSM handle that contains everything about gsm module.
-  * @param timeout      Timeout period for console.
-  * @param format		Format of sending packet via TCPIP(hexadecimal-'1' or decimal-'2').
-  * @retval DRIVERState_t status
-  */
-DRIVERState_t GSM_SetSendingIPFormat(gsmHandler_t *gsmHandler, uint32_t timeout, uint8_t format)
-{
-	/* Buffer for putting answer from gsm */
-	uint8_t buffer[100] = {0};
-
-	/* How many characters are received from gsm-it's importent to be zero initialize */
-	uint32_t size = 0;
-
-	/* Checking if user send correct gsm and console */
-	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
-	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError: incorrect console and gsm module!\r\n");
-		return DRIVER_ERROR;
+		break;
 	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
-
-	/* Set command for type of sending format */
-	uint8_t msgToSend[20] = {0};
-	uint8_t msgSize = 14;
-	strcat((char*)msgToSend, "at+cipsendhex=");
-
-	if(format == '1') strcat((char*)msgToSend,"1\r");
-	else if(format == '2') strcat((char*)msgToSend,"0\r");
-	msgSize += 2;
-
-	/* Send command to gsm */
-	DRIVER_GSM_Write(gsmHandler->gsm, msgToSend,msgSize);
 
 	/* Read response from gsm  and set response for user */
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 3000, (const uint8_t*)"OK\r\n")){
+	switch(data.result){
 	case DRIVER_TIMEOUT:
 		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
+		ARENA_Release(arena, scope);
 		return DRIVER_TIMEOUT;
 	case DRIVER_ERROR:
 		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
+		ARENA_Release(arena, scope);
 		return DRIVER_ERROR;
 	case DRIVER_OK:
-		if(msgToSend[14] == '1') DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\nHexadecimal format is now ON!\r\n");
-		else DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\nDecimal format is now ON!\r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
+		DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n Data sent to server!\r\n");
+		ARENA_Release(arena, scope);
 		return DRIVER_OK;
-
 	}
+	ARENA_Release(arena, scope);
 	return DRIVER_OK;
 }
 
+
 /**
-  * @brief Connect gsm module to specified server.
+  * @brief Establish TCP client connection with broker, from cold boot or from any state that
+  *        gsm already reached (see GSM_BringUp()).
   * @param gsmHandler   GSM handle that contains everything about gsm module.
-  * @param timeout      Timeout period for console.
-  * @param inputStruct  Structure that contains needed variables to set PDP context:
-  * connectType- type of connection(it can be TCP-'1' or UDP-'2'),
-  * ipAddr - IP address of server, port - Port number of server.
+  * @param timeout      Time for whole bring up (in miliseconds).
   * @retval DRIVERState_t status
   */
-DRIVERState_t GSM_ConnectToServer(gsmHandler_t *gsmHandler, uint32_t timeout,ConnectSrvrInputStruct_t inputStruct)
+DRIVERState_t EstablishTCPClientConnection(gsmHandler_t *gsmHandler, uint32_t timeout)
 {
-	uint8_t buffer[100] = {0};
-	uint32_t size = 0;
-	Socket_t socketInit;
-
 	/* Checking if user send correct gsm and console */
 	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
 	{
 		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
 		return DRIVER_ERROR;
 	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
 
-	/** Set type of connection **/
+	/* Set mobile network, active pdp context, connect to server and set sending format of TCPIP protocol */
+	ConnectSrvrInputStruct_t inputStruct;
+	GSMBringUp_t bringUp;
 
-    /* Set socket for initialization with his type */
-	if(inputStruct.connectType == '1') strcpy((char*)socketInit.type,(const char*)"TCP\0" );
-	else if(inputStruct.connectType == '2') strcpy((char*)socketInit.type,(const char*)"UDP\0" );
+	inputStruct.connectType = '1';
+	inputStruct.ipAddr = (uint8_t*)"5.196.95.208";
+	inputStruct.port = (uint8_t*)"1883";
 
-	/** Set IP address **/
+	GSM_BringUpStart(&bringUp, (const uint8_t*)"1\r", inputStruct, timeout);
+	return GSM_BringUp(gsmHandler, &bringUp);
+}
 
-	/* Set socket for initialization with his IP address */
-	uint8_t i = strlen((const char*)inputStruct.ipAddr);
-	if(strchr((char*)inputStruct.ipAddr,'\r') != NULL )
-	{	/* Length of IP address characters without '\r' */
-		i--;
-	}
-	strcpy((char*)socketInit.IPaddress,(const char*)inputStruct.ipAddr);
-	socketInit.IPaddress[i] = '\0';
+/**
+  * @brief Prepare state machine of bring up, it starts with configuration step.
+  * @param bringUp      GSM bring up handle.
+  * @param PDP 			PDP context that is activated, ends with '\r'.
+  * @param server       Server to which connection is opened.
+  * @param timeout      Time for whole bring up (in miliseconds).
+  * @retval void
+  */
+void GSM_BringUpStart(GSMBringUp_t *bringUp, const uint8_t *PDP, ConnectSrvrInputStruct_t server, uint32_t timeout)
+{
+	bringUp->state 			= GSM_BRINGUP_CONFIG;
 
-	/** Set port **/
+	bringUp->PDP 			= PDP;
 
-	uint32_t portNum = 0;
-	uint32_t weight = 1;
-	i = strlen((const char*)inputStruct.port);
-	if(strchr((char*)inputStruct.port,'\r') != NULL )
-	{	/* Length of port characters without '\r' */
-		i--;
-	}
+	bringUp->server 		= server;
 
-	/* Save port number in characters and set socket port */
-	uint8_t portChar[6] = {0};
-	strcpy((char*)portChar,(const char*)inputStruct.port);
-	portChar[i] = '\0';
-
-	/* Convert port number from characters value stored in buffer
-	 * to be integer type, base 16 */
-	while(i>0)
-	{
-		i--;
-		portNum += (inputStruct.port[i] - '0')*weight;
-		weight *= 10;
-	}
-	socketInit.port = portNum;
-
-
-	/* Set message for activating connection with server for gsm module */
-	uint8_t msgToSend[100];
-	uint8_t msgSize = 0;
-	memset(msgToSend,0, sizeof(msgToSend));
-	strcat((char*) msgToSend,(const char*) "at+cipstart=");
-	strcat((char*) msgToSend,(const char*) "\"");
-	strcat((char*) msgToSend,(const char*) socketInit.type);
-	strcat((char*) msgToSend,(const char*) "\"");
-	strcat((char*) msgToSend,(const char*) ",");
-	strcat((char*) msgToSend,(const char*) "\"");
-	strcat((char*) msgToSend,(const char*) socketInit.IPaddress);
-	strcat((char*) msgToSend,(const char*) "\"");
-	strcat((char*) msgToSend,(const char*) ",");
-	strcat((char*) msgToSend,(const char*) portChar);
-	strcat((char*) msgToSend,(const char*) "\r");
-
-	socketInit.PDPcontextNo = gsmHandler->activeSocketNo;
-
-	/* Set size of message to send to gsm module */
-	while(msgToSend[msgSize] != '\r') msgSize++;
-	msgSize++;
-
-	/* Send command to gsm module for connecting to server */
-	DRIVER_GSM_Write(gsmHandler->gsm, msgToSend, msgSize);
+	bringUp->timeout 		= timeout;
 
-	/* Read response from gsm  and set response for user */
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 7000, (const uint8_t*)"OK")){
-	case DRIVER_TIMEOUT:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_TIMEOUT;
-	case DRIVER_ERROR:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_ERROR;
-	case DRIVER_OK:
-		DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n Connection with server started!\r\n");
-		GSM_SetSocket(gsmHandler,&socketInit);
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_OK;
-	}
-	return DRIVER_OK;
+	bringUp->startTime 		= TIME_GetTick();
+
+	bringUp->commandCount 	= 0;
+
+	bringUp->separate 		= false;
+
+	memset(bringUp->stepTime, 0, sizeof(bringUp->stepTime));
 }
 
 /**
-  * @brief Disonnect gsm module to specified server.
+  * @brief Turn on registration reports and hexadecimal format and read registration.
   * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param bringUp      GSM bring up handle.
   * @retval DRIVERState_t status
   */
-DRIVERState_t GSM_DisconnectFromServer(gsmHandler_t *gsmHandler)
+static DRIVERState_t bringUpConfig(gsmHandler_t *gsmHandler, GSMBringUp_t *bringUp)
 {
-	uint8_t buffer[100];
+	uint32_t bits = GSM_STATE_REPORTING | GSM_STATE_GPRS_REPORTING | GSM_STATE_HEX_FORMAT;
 
-	/* Reset buffer and his size */
-	memset(buffer,0,sizeof(buffer));
-	uint32_t size = 0;
+	if(alreadyReached(gsmHandler, GSM_CMD_BRINGUP, (GSM_GetState(gsmHandler) & bits) == bits))
+		return DRIVER_OK;
 
-	/* Checking if user send correct gsm and console */
-	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
+	/* Settings and query in one command line, gsm answers them with one "OK" */
+	if(!bringUp->separate)
 	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
-		return DRIVER_ERROR;
-	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
+		DRIVERState_t state = GSM_Execute(gsmHandler, GSM_CMD_BRINGUP, NULL, '1');
+		if(state == DRIVER_OK)
+		{
+			xEventGroupSetBits(gsmHandler->state, bits);
+			return DRIVER_OK;
+		}
 
-	/* Send command to dissconnect from server */
-	DRIVER_GSM_Write(gsmHandler->gsm, (const uint8_t*)"at+cipclose\r", sizeof("at+cipclose\r"));
+		/* Gsm that doesn't take several commands in one line answers with error */
+		if(state != DRIVER_ERROR) return state;
+		bringUp->separate = true;
+	}
 
-	/* Read response from gsm  and set response for user */
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 5000, (const uint8_t*)"OK")){
-	case DRIVER_TIMEOUT:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_TIMEOUT;
-	case DRIVER_ERROR:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
+	if(GSM_NetworkRegistered(gsmHandler) != DRIVER_OK || GSM_SetSendingIPFormat(gsmHandler, 0, '1') != DRIVER_OK)
 		return DRIVER_ERROR;
-	case DRIVER_OK:
-		DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n Connection with server ended!\r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_OK;
-	}
-	return DRIVER_OK;
+
+	return GSM_CheckNetworkRegistered(gsmHandler);
 }
 
 /**
-  * @brief Check IP connection for all channels(number of channels is preveously defined with macro MAX_SOCKET_NUMBER).
+  * @brief Wait for registration to network, +CREG: comes without command.
   * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param bringUp      GSM bring up handle.
   * @retval DRIVERState_t status
   */
-DRIVERState_t GSM_CheckConnection(gsmHandler_t *gsmHandler)
+static DRIVERState_t bringUpRegister(gsmHandler_t *gsmHandler, GSMBringUp_t *bringUp)
 {
-	uint8_t buffer[100];
+	uint32_t elapsed = TIME_GetTick() - bringUp->startTime;
 
-	/* Reset buffer and his size */
-	memset(buffer,0,sizeof(buffer));
-	uint32_t size = 0;
+	if((GSM_GetState(gsmHandler) & GSM_STATE_REGISTERED) != 0) return DRIVER_OK;
+	if(elapsed >= bringUp->timeout) return DRIVER_TIMEOUT;
 
-	/* Checking if user send correct gsm and console */
-	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
-	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
+	DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n Waiting for registration to network...\r\n");
+	return GSM_WaitState(gsmHandler, GSM_STATE_REGISTERED, bringUp->timeout - elapsed);
+}
+
+/**
+  * @brief Activate PDP context and connect to server, both commands are one chain of at engine.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param bringUp      GSM bring up handle.
+  * @retval DRIVERState_t status
+  */
+static DRIVERState_t bringUpConnect(gsmHandler_t *gsmHandler, GSMBringUp_t *bringUp)
+{
+	Socket_t context;
+	Socket_t connection;
+	uint8_t portChar[6];
+	GSMStep_t steps[2];
+	uint32_t number = 0;
+
+	if(prepareContext(gsmHandler, bringUp->PDP, &context) != DRIVER_OK ||
+	   prepareServer(gsmHandler, bringUp->server, context.PDPcontextNo, &connection, portChar) != DRIVER_OK)
 		return DRIVER_ERROR;
+
+	/* Only commands whose state isn't reached are in chain */
+	if(!alreadyReached(gsmHandler, GSM_CMD_PDP_ON, (gsmHandler->network.activeContexts & contextBit(context.PDPcontextNo)) != 0))
+	{
+		if(formatStep(gsmHandler, &steps[number], GSM_CMD_PDP_ON, argumentLength(bringUp->PDP), bringUp->PDP) != DRIVER_OK)
+			return DRIVER_ERROR;
+		number++;
+	}
+	else contextActivated(gsmHandler, &context);
+
+	if(!alreadyReached(gsmHandler, GSM_CMD_CONNECT, serverConnected(gsmHandler, &connection)))
+	{
+		if(formatStep(gsmHandler, &steps[number], GSM_CMD_CONNECT, connection.type, connection.IPaddress, portChar) != DRIVER_OK)
+		{
+			if(number != 0) POOL_Free(steps[0].line);
+			return DRIVER_ERROR;
+		}
+		number++;
 	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
 
-	/* Send command check connection with server */
-	DRIVER_GSM_Write(gsmHandler->gsm, (const uint8_t*)"at+cipstatus\r", sizeof("at+cipstatus\r"));
+	if(number == 0) return DRIVER_OK;
 
-	/* Take current time and check if timeout occured */
-	uint32_t tickstart = TIME_GetTick();
-	DRIVERState_t StateReadCmd = DRIVER_OK;
-	while(TIME_GetTick() - tickstart < 2000)
+	/* Gsm gets at+cipstart as soon as context is active */
+	DRIVERState_t state = executeChain(gsmHandler, steps, number);
+
+	for(uint32_t i = 0; i < number; i++)
 	{
-		DRIVER_GSM_Read(gsmHandler->gsm, buffer, &size);
+		if(steps[i].result != DRIVER_OK) break;
+
+		if(steps[i].id == GSM_CMD_PDP_ON) contextActivated(gsmHandler, &context);
+		else
+		{
+			GSM_SetSocket(gsmHandler, &connection);
+			stateIp(gsmHandler, AT_IP_CONNECT_OK);
+		}
 	}
+	return state;
+}
 
-	/* Badly received response from gsm */
-	if(strstr((const char*)buffer,(const char*)"ERROR") != NULL)
-		StateReadCmd = DRIVER_ERROR;
+/**
+  * @brief Run one step of bring up and move state machine to next step.
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param bringUp      GSM bring up handle.
+  * @retval DRIVERState_t result of step
+  */
+DRIVERState_t GSM_BringUpStep(gsmHandler_t *gsmHandler, GSMBringUp_t *bringUp)
+{
+	ATHandler_t *at = AT_GetHandler();
+	uint32_t commands = at != NULL ? at->commandCount : 0;
+	uint32_t tickstart = TIME_GetTick();
+	GSMBringUpState_t next;
+	DRIVERState_t state;
 
-	uint8_t * startMsg = (uint8_t*)strstr((char*)buffer,"STATE:");
-	switch(StateReadCmd){
-	case DRIVER_ERROR:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_ERROR;
-	case DRIVER_OK:
-		DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n");
-		DRIVER_CONSOLE_Put(gsmHandler->console, startMsg);
-		DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_OK;
-	default:
+	switch(bringUp->state){
+	case GSM_BRINGUP_CONFIG:
+		state = bringUpConfig(gsmHandler, bringUp);
+		next = GSM_BRINGUP_REGISTER;
+		break;
+	case GSM_BRINGUP_REGISTER:
+		state = bringUpRegister(gsmHandler, bringUp);
+		next = GSM_BRINGUP_CONNECT;
+		break;
+	case GSM_BRINGUP_CONNECT:
+		state = bringUpConnect(gsmHandler, bringUp);
+		next = GSM_BRINGUP_ONLINE;
 		break;
+	default:
+		return bringUp->state == GSM_BRINGUP_ONLINE ? DRIVER_OK : DRIVER_ERROR;
 	}
-	return DRIVER_OK;
+
+	/* Commands of other tasks that run at the same time are counted too */
+	bringUp->stepTime[bringUp->state] += TIME_GetTick() - tickstart;
+	if(at != NULL) bringUp->commandCount += at->commandCount - commands;
+
+	if(state == DRIVER_OK && next != GSM_BRINGUP_ONLINE && TIME_GetTick() - bringUp->startTime >= bringUp->timeout)
+		state = DRIVER_TIMEOUT;
+
+	bringUp->state = state == DRIVER_OK ? next : GSM_BRINGUP_FAILED;
+	return state;
 }
 
 /**
-  * @brief Send data to server.
+  * @brief Run state machine of bring up until connection with server is open or step fails.
   * @param gsmHandler   GSM handle that contains everything about gsm module.
-  * @param timeout      Timeout period for console.
-  * @param message 		String that contains message that will be sent.
+  * @param bringUp      GSM bring up handle, prepared with GSM_BringUpStart().
   * @retval DRIVERState_t status
   */
-DRIVERState_t GSM_SendToServer(gsmHandler_t *gsmHandler, uint32_t timeout, uint8_t *message)
+DRIVERState_t GSM_BringUp(gsmHandler_t *gsmHandler, GSMBringUp_t *bringUp)
 {
-	uint8_t buffer[100] = {0};
-
-	uint32_t size = 0;
+	DRIVERState_t state = DRIVER_OK;
 
-	/* Checking if user send correct gsm and console */
-	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
-	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
-		return DRIVER_ERROR;
-	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
+	while(bringUp->state != GSM_BRINGUP_ONLINE && bringUp->state != GSM_BRINGUP_FAILED)
+		state = GSM_BringUpStep(gsmHandler, bringUp);
 
-	/* Send command to send data to server */
-	DRIVER_GSM_Write(gsmHandler->gsm, (const uint8_t*)"at+cipsend\r", sizeof("at+cipsend\r"));
+	return bringUp->state == GSM_BRINGUP_ONLINE ? DRIVER_OK : (state != DRIVER_OK ? state : DRIVER_ERROR);
+}
 
-	/* Read response from gsm  and set response for user */
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 6000, (const uint8_t*)">")){
-	case DRIVER_TIMEOUT:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_TIMEOUT;
-	case DRIVER_ERROR:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_ERROR;
-	case DRIVER_OK:
-		break;
-	}
+/**
+  * @brief Run GSM_SendToServer() in async task.
+  * @param operation    Operation prepared by GSM_SendToServer_Async().
+  * @retval uint32_t DRIVERState_t of function
+  */
+static uint32_t runSendToServer(ASYNCOperation_t *operation)
+{
+	return GSM_SendToServer(operation->handler, operation->timeout, (uint8_t*)operation->argument[0]);
+}
 
-	/* Reset buffer and his size */
-	memset(buffer,0,sizeof(buffer));
-	size = 0;
+/**
+  * @brief Run GSM_SendStoreMsg() in async task.
+  * @param operation    Operation prepared by GSM_SendStoreMsg_Async().
+  * @retval uint32_t DRIVERState_t of function
+  */
+static uint32_t runSendStoreMsg(ASYNCOperation_t *operation)
+{
+	return GSM_SendStoreMsg(operation->handler, operation->timeout, *(const SendOrStoreInputStruct_t*)operation->argument[0],
+							(OutputStruct_t*)operation->argument[1]);
+}
 
-	uint8_t msgToSend[1000] = {0};
-	uint32_t msgSize = 0;
-	size = strlen((const char*)message);
-	strcat((char*)msgToSend,(const char*)message);
-	msgSize = size;
-	/* If we send message with \r endning character, then we need to set control-z in that place */
-	if(strchr((char*)message,'\r') != NULL )
-	{
-		msgToSend[size -1] = 26; /* <CTRL-Z> character */
-	}
-	else
-	{
-		msgToSend[size] = 26; /* <CTRL-Z> character */
-		msgSize++;
-	}
-	/* Reset buffer and hos size */
-	memset(buffer,0,sizeof(buffer));
-	size = 0;
+/**
+  * @brief Run GSM_ConnectToServer() in async task.
+  * @param operation    Operation prepared by GSM_ConnectToServer_Async().
+  * @retval uint32_t DRIVERState_t of function
+  */
+static uint32_t runConnectToServer(ASYNCOperation_t *operation)
+{
+	return GSM_ConnectToServer(operation->handler, operation->timeout, *(const ConnectSrvrInputStruct_t*)operation->argument[0]);
+}
 
-	/* Send message to server */
-	DRIVER_GSM_Write(gsmHandler->gsm, msgToSend, msgSize);
+/**
+  * @brief Run GSM_BringUp() in async task.
+  * @param operation    Operation prepared by GSM_BringUp_Async().
+  * @retval uint32_t DRIVERState_t of function
+  */
+static uint32_t runBringUp(ASYNCOperation_t *operation)
+{
+	return GSM_BringUp(operation->handler, (GSMBringUp_t*)operation->argument[0]);
+}
 
-	/* Read response from gsm  and set response for user */
-	switch(waitUntil(gsmHandler->gsm, buffer, &size, 6000, (const uint8_t*)"OK")){
-	case DRIVER_TIMEOUT:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_TIMEOUT;
-	case DRIVER_ERROR:
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_ERROR;
-	case DRIVER_OK:
-		DRIVER_CONSOLE_Put(gsmHandler->console, (const uint8_t*)"\r\n Data sent to server!\r\n");
-		DRIVER_GSM_Flush(gsmHandler->gsm);
-		return DRIVER_OK;
-	}
-	return DRIVER_OK;
+/**
+  * @brief Send data to server without waiting, see GSM_SendToServer().
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param timeout      Timeout period for console.
+  * @param message      Message, it must live until operation is done.
+  * @param operation    Completion handle, result is DRIVERState_t.
+  * @retval DRIVERState_t DRIVER_OK when operation is queued
+  */
+DRIVERState_t GSM_SendToServer_Async(gsmHandler_t *gsmHandler, uint32_t timeout, uint8_t *message, ASYNCOperation_t *operation)
+{
+	return ASYNC_Start(operation, runSendToServer, gsmHandler, timeout, message, NULL);
 }
 
+/**
+  * @brief Send or store message without waiting, see GSM_SendStoreMsg().
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param timeout      Timeout period for console.
+  * @param inputStruct  Input arguments, they must live until operation is done.
+  * @param outputStruct Output of function, it must live until operation is done.
+  * @param operation    Completion handle, result is DRIVERState_t.
+  * @retval DRIVERState_t DRIVER_OK when operation is queued
+  */
+DRIVERState_t GSM_SendStoreMsg_Async(gsmHandler_t *gsmHandler, uint32_t timeout, const SendOrStoreInputStruct_t *inputStruct,
+									 OutputStruct_t *outputStruct, ASYNCOperation_t *operation)
+{
+	if(inputStruct == NULL) return DRIVER_ERROR;
+
+	return ASYNC_Start(operation, runSendStoreMsg, gsmHandler, timeout, inputStruct, outputStruct);
+}
 
 /**
-  * @brief Establish TCP Client connection with specified server.
+  * @brief Connect to server without waiting, see GSM_ConnectToServer().
   * @param gsmHandler   GSM handle that contains everything about gsm module.
   * @param timeout      Timeout period for console.
-  * @retval DRIVERState_t status
+  * @param inputStruct  Server, it must live until operation is done.
+  * @param operation    Completion handle, result is DRIVERState_t.
+  * @retval DRIVERState_t DRIVER_OK when operation is queued
   */
-DRIVERState_t EstablishTCPClientConnection(gsmHandler_t *gsmHandler, uint32_t timeout)
+DRIVERState_t GSM_ConnectToServer_Async(gsmHandler_t *gsmHandler, uint32_t timeout, const ConnectSrvrInputStruct_t *inputStruct,
+										ASYNCOperation_t *operation)
 {
-	/* Checking if user send correct gsm and console */
-	if(gsmHandler->gsm == NULL && gsmHandler->console == NULL )
-	{
-		DRIVER_CONSOLE_Put(gsmHandler->console,(const uint8_t*)"\r\n Error: incorrect console and gsm module!\r\n");
-		return DRIVER_ERROR;
-	}
-	DRIVER_GSM_Flush(gsmHandler->gsm);
+	if(inputStruct == NULL) return DRIVER_ERROR;
 
-	/* Set mobile network, active pdp context, connect to server and set sending format of TCPIP protocol */
-	if(GSM_NetworkRegistered(gsmHandler) == DRIVER_OK)
-	{
-	  if(GSM_ActivePDPContext(gsmHandler,timeout,(const uint8_t*)"1\r") == DRIVER_OK)
-	  {
-			/* Set input structure */
-			ConnectSrvrInputStruct_t inputStruct;
+	return ASYNC_Start(operation, runConnectToServer, gsmHandler, timeout, inputStruct, NULL);
+}
 
-			inputStruct.connectType = '1';
-			inputStruct.ipAddr = (uint8_t*)"5.196.95.208";
-			inputStruct.port = (uint8_t*)"1883";
-			if(GSM_ConnectToServer(gsmHandler,timeout,inputStruct) == DRIVER_OK)
-			{
-				if(GSM_SetSendingIPFormat(gsmHandler,timeout,'1') == DRIVER_OK)
-					return DRIVER_OK;
-				else
-					return DRIVER_ERROR;
-			}
-		  else return DRIVER_ERROR;
-	  }
-	  else return DRIVER_ERROR;
-	}
-	else return DRIVER_ERROR;
+/**
+  * @brief Run state machine of bring up without waiting, see GSM_BringUp().
+  * @param gsmHandler   GSM handle that contains everything about gsm module.
+  * @param bringUp      GSM bring up handle, prepared with GSM_BringUpStart(), it must live until operation is done.
+  * @param operation    Completion handle, result is DRIVERState_t.
+  * @retval DRIVERState_t DRIVER_OK when operation is queued
+  */
+DRIVERState_t GSM_BringUp_Async(gsmHandler_t *gsmHandler, GSMBringUp_t *bringUp, ASYNCOperation_t *operation)
+{
+	if(bringUp == NULL) return DRIVER_ERROR;
 
+	return ASYNC_Start(operation, runBringUp, gsmHandler, 0, bringUp, NULL);
 }
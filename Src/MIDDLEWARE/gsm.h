@@ -17,10 +17,52 @@
 #include <stdlib.h>
 #include <time.h>
 #include <mqtt.h>
+#include <arena.h>
+#include <pool.h>
+#include <at.h>
+#include <at_parse.h>
+#include <sms_pdu.h>
+#include <async.h>
+#include "event_groups.h"
 
 #define MAX_SOCKET_NUMBER 16
+/* Size of buffer (taken from arena) for short answers */
+#define GSM_RESPONSE_SIZE 100
+/* Size of buffer (taken from arena) for answers that list messages or PDP contexts */
+#define GSM_LONG_RESPONSE_SIZE 1000
+/* Size of buffer (taken from arena) for list of messages, it holds only few lines, answer is
+ * given to parser line by line */
+#define GSM_LIST_RESPONSE_SIZE 512
+/* Size of buffer (taken from arena) for answer to sending or storing of message */
+#define GSM_SMS_RESPONSE_SIZE 500
+/* Size of blocks (taken from pool) for at commands, long at commands and sms commands with text */
+#define GSM_COMMAND_SIZE POOL_AT_BLOCK_SIZE
+#define GSM_LONG_COMMAND_SIZE 200
+#define GSM_SMS_COMMAND_SIZE 200
+/* Country code that is added to national numbers of messages */
+#define GSM_COUNTRY_CODE "+381"
 #define PORT_NON 65535
 #define CONTEXT_NON 255
+/* Size of name of operator that is kept in network structure */
+#define GSM_OPERATOR_SIZE 17
+/* Bits of cached state of modem (event group of gsm handle), tasks wait for them with GSM_WaitState() */
+#define GSM_STATE_REGISTERED 0x01U		/* Registered to network (+CREG: 1 or 5)						*/
+#define GSM_STATE_ATTACHED 0x02U		/* Attached to GPRS service (+CGREG: 1 or 5, at+cgatt=1)		*/
+#define GSM_STATE_APN 0x04U				/* Access point name is set (IP START and later states)		*/
+#define GSM_STATE_PDP_ACTIVE 0x08U		/* PDP context is active (IP GPRSACT and later, at+cgact=1)	*/
+#define GSM_STATE_IP 0x10U				/* Local IP address is assigned (IP STATUS and later states)	*/
+#define GSM_STATE_CONNECTED 0x20U		/* Connection with server is open (CONNECT OK)				*/
+#define GSM_STATE_REPORTING 0x40U		/* Gsm sends +CREG: with area and cell when they change (at+creg=2)	*/
+#define GSM_STATE_HEX_FORMAT 0x80U		/* Data to server is sent in hexadecimal format (at+cipsendhex=1)	*/
+#define GSM_STATE_GPRS_REPORTING 0x100U	/* Gsm sends +CGREG: with area and cell when they change (at+cgreg=2)	*/
+/* Bits that follow state of IP connection and active PDP contexts */
+#define GSM_STATE_CONNECTION (GSM_STATE_APN | GSM_STATE_PDP_ACTIVE | GSM_STATE_IP | GSM_STATE_CONNECTED)
+/* Bits of modem that can send to server */
+#define GSM_STATE_ONLINE (GSM_STATE_REGISTERED | GSM_STATE_ATTACHED | GSM_STATE_CONNECTED)
+/* Number of queues that get registration events (GSM_RegistrationSubscribe()) */
+#define GSM_REG_SUBSCRIBERS 4
+/* Longest chain of commands from table that is sent by at engine without return to caller */
+#define GSM_CHAIN_LENGTH 3
 /**
   * @brief  GSM ECHO Status structures definition
   */
@@ -100,8 +142,54 @@ typedef struct __Network_t
 
 	uint8_t IPaddress[16];						/*!< Network IP address								*/
 
+	uint32_t address;							/*!< Network IP address as number (+CIFSR), 0 if none	*/
+
+	ATRegistration_t registration;				/*!< Registration to network (+CREG)				*/
+
+	ATRegistration_t gprsRegistration;			/*!< Registration to GPRS service (+CGREG)			*/
+
+	ATSignal_t signal;							/*!< Signal quality (+CSQ)							*/
+
+	ATIpState_t ipState;						/*!< State of IP connection (STATE: of at+cipstatus)	*/
+
+	uint32_t definedContexts;					/*!< Bit of every setted PDP context (+CGDCONT)		*/
+
+	uint32_t activeContexts;					/*!< Bit of every active PDP context (+CGACT)		*/
+
+	uint8_t operatorName[GSM_OPERATOR_SIZE];	/*!< Name of operator (+COPS), "" if not known		*/
+
 }Network_t;
 
+/**
+  * @brief  GSM registration domain definition
+  */
+typedef enum
+{
+	GSM_REG_NETWORK		= 0x00,			/*!< Registration to network (+CREG)				*/
+	GSM_REG_GPRS		= 0x01,			/*!< Registration to GPRS service (+CGREG)			*/
+	GSM_REG_NUMBER		= 0x02			/*!< Number of domains								*/
+} GSMRegDomain_t;
+
+/**
+  * @brief  GSM registration event Structure definition, sent to subscribed queues when state,
+  *         area or cell of registration changes
+  */
+typedef struct __GSMRegEvent_t
+{
+	GSMRegDomain_t domain;						/*!< Network or GPRS service							*/
+
+	ATRegState_t state;							/*!< New registration state							*/
+
+	bool registered;							/*!< Registered (home network or roaming)			*/
+
+	uint16_t area;								/*!< Location area code, last known one				*/
+
+	uint16_t cell;								/*!< Cell id, last known one						*/
+
+	uint32_t time;								/*!< Time of change (in miliseconds)				*/
+
+}GSMRegEvent_t;
+
 /**
   * @brief  GSM handle Structure definition
   */
@@ -121,6 +209,24 @@ typedef struct __gsmHandler_t
 
 	Network_t network;							/*!< Network structure 								*/
 
+	ATUrcSubscriber_t urc;						/*!< Subscriber of unsolicited lines (new sms, CLOSED,
+													 +PDP: DEACT, +CREG:)							*/
+
+	uint32_t newMsgCount;						/*!< Number of "+CMTI:" lines (new messages)		*/
+
+	EventGroupHandle_t state;					/*!< Cached state of modem (GSM_STATE_* bits), kept by
+													 answers and unsolicited lines					*/
+
+	QueueHandle_t regQueue[GSM_REG_SUBSCRIBERS];	/*!< Queues of GSMRegEvent_t that get registration events	*/
+
+	uint32_t regSubscribers;					/*!< Number of subscribed queues					*/
+
+	GSMRegEvent_t regLast[GSM_REG_NUMBER];		/*!< Last registration of every domain				*/
+
+	uint32_t regEventCount;						/*!< Number of registration events					*/
+
+	uint32_t regDropCount;						/*!< Events that didn't fit in queue of subscriber	*/
+
 }gsmHandler_t;
 
 /**
@@ -150,25 +256,6 @@ typedef struct
 
 }ListMsgInputStruct_t;
 
-/**
-  * @brief  GSM LIST MESSAGE OUTPUT Structure definition
-  */
-typedef struct
-{
-	uint32_t index[20];				/*!< Index's of listed messages														*/
-
-	uint8_t *typeOfMsg[20];			/*!< Type of message (received read,received unread,sotred sent, stored unsent) 	*/
-
-	uint8_t *number[20];			/*!< Telephone number for specified message											*/
-
-	uint8_t *timeReceived[20];		/*!< Time when message was received													*/
-
-	uint8_t *message[20];			/*!< Message																		*/
-
-	uint32_t *msgNoStruct;			/*!< Number of message received 													*/
-
-}ListMsgOutputStruct_t;
-
 
 /**
   * @brief  GSM READ MESSAGE INPUT Structure definition
@@ -194,6 +281,51 @@ typedef struct
 
 }ReadMsgOutputStruct_t;
 
+/**
+  * @brief  GSM SMS RECORD Structure definition, one record fills one block of sms pool
+  */
+typedef struct
+{
+	uint8_t typeOfMsg[16];		/*!< Type of message (received read,received unread,sotred sent, stored unsent)		*/
+
+	uint8_t number[32];			/*!< Telephone number for specified message												*/
+
+	uint8_t timeReceived[32];	/*!< Time when message was received														*/
+
+	uint8_t message[176];		/*!< Message																			*/
+
+}GSMSmsRecord_t;
+
+/**
+  * @brief  GSM SMS LIST Structure definition, iterator of GSM_ListMsg() that gets messages one by
+  *         one while gsm lists them, so memory doesn't depend on number of stored messages
+  */
+typedef struct __GSMSmsList_t
+{
+	void (*Message)(struct __GSMSmsList_t *list);	/*!< Called in at task for every message, record is
+														 valid only during call, it must not send
+														 at commands										*/
+
+	void *context;					/*!< Argument of Message, not used by gsm								*/
+
+	uint32_t index;					/*!< Index of message in storage										*/
+
+	GSMSmsRecord_t record;			/*!< Message, lines of text are joined with '\n'						*/
+
+	uint32_t count;					/*!< Number of listed messages											*/
+
+	uint32_t truncatedCount;		/*!< Messages whose text didn't fit in record							*/
+
+	uint32_t length;				/*!< Number of characters of text of message							*/
+
+	bool pending;					/*!< Header of message came, message isn't given yet					*/
+
+	bool truncated;					/*!< Text of message didn't fit in record								*/
+
+	bool newline;					/*!< Next part of answer starts new line								*/
+
+}GSMSmsList_t;
+
 /**
   * @brief  GSM DELETE MESSAGE INPUT Structure definition
   */
@@ -270,15 +402,147 @@ typedef struct
 
 }OutputStruct_t;
 
+/**
+  * @brief  GSM COMMAND identifiers, index of command in table of gsm commands (gsm.c)
+  */
+typedef enum
+{
+	GSM_CMD_ECHO			= 0x00,		/*!< Set echo mode (ate)							*/
+	GSM_CMD_MSG_FORMAT		= 0x01,		/*!< Set message format (at+cmgf)					*/
+	GSM_CMD_SET_STORAGE		= 0x02,		/*!< Set message storages (at+cpms)					*/
+	GSM_CMD_TEST_STORAGE	= 0x03,		/*!< Test message storages (at+cpms=?)				*/
+	GSM_CMD_LIST_TEXT		= 0x04,		/*!< List messages in text mode (at+cmgl)			*/
+	GSM_CMD_LIST_PDU		= 0x05,		/*!< List messages in pdu mode (at+cmgl)			*/
+	GSM_CMD_READ			= 0x06,		/*!< Read message (at+cmgr)							*/
+	GSM_CMD_DELETE			= 0x07,		/*!< Delete message(s) (at+cmgd)					*/
+	GSM_CMD_NETWORK_ON		= 0x08,		/*!< Turn on registration reports (at+creg=2)		*/
+	GSM_CMD_NETWORK_OFF		= 0x09,		/*!< Turn off network registration (at+creg=0)		*/
+	GSM_CMD_NETWORK_CHECK	= 0x0A,		/*!< Check network registration (at+creg?)			*/
+	GSM_CMD_SET_APN			= 0x0B,		/*!< Set access point name (at+cstt)				*/
+	GSM_CMD_CHECK_APN		= 0x0C,		/*!< Check access point name (at+cstt?)				*/
+	GSM_CMD_GPRS			= 0x0D,		/*!< Bring up wireless connection (at+ciicr)		*/
+	GSM_CMD_LOCAL_IP		= 0x0E,		/*!< Get local IP address (at+cifsr)				*/
+	GSM_CMD_ATTACH			= 0x0F,		/*!< Attach to GPRS service (at+cgatt=1)			*/
+	GSM_CMD_DETACH			= 0x10,		/*!< Detach from GPRS service (at+cgatt=0)			*/
+	GSM_CMD_SET_PDP			= 0x11,		/*!< Set PDP context (at+cgdcont)					*/
+	GSM_CMD_CHECK_PDP		= 0x12,		/*!< Show setted PDP contexts (at+cgdcont?)			*/
+	GSM_CMD_ACTIVE_PDP		= 0x13,		/*!< Show active PDP contexts (at+cgact?)			*/
+	GSM_CMD_PDP_IP			= 0x14,		/*!< Show addresses of PDP contexts (at+cgpaddr)	*/
+	GSM_CMD_PDP_ON			= 0x15,		/*!< Activate PDP context (at+cgact=1)				*/
+	GSM_CMD_PDP_OFF			= 0x16,		/*!< Deactivate PDP context (at+cgact=0)			*/
+	GSM_CMD_SHUT			= 0x17,		/*!< Deactivate GPRS PDP context (at+cipshut)		*/
+	GSM_CMD_AUTO_TIMER		= 0x18,		/*!< Set auto sending timer (at+cipats)				*/
+	GSM_CMD_SEND_FORMAT		= 0x19,		/*!< Set sending format (at+cipsendhex)				*/
+	GSM_CMD_CONNECT			= 0x1A,		/*!< Connect to server (at+cipstart)				*/
+	GSM_CMD_CLOSE			= 0x1B,		/*!< Disconnect from server (at+cipclose)			*/
+	GSM_CMD_STATUS			= 0x1C,		/*!< Check connection (at+cipstatus)				*/
+	GSM_CMD_GPRS_CHECK		= 0x1D,		/*!< Check GPRS registration (at+cgreg?)			*/
+	GSM_CMD_SIGNAL			= 0x1E,		/*!< Signal quality (at+csq)						*/
+	GSM_CMD_OPERATOR		= 0x1F,		/*!< Selected operator (at+cops?)					*/
+	GSM_CMD_BRINGUP			= 0x20,		/*!< Registration reports, hexadecimal format and
+											 registration in one line (at+creg=2;+cgreg=2;+cipsendhex=1;+creg?)	*/
+	GSM_CMD_GPRS_REPORT		= 0x21,		/*!< Turn on GPRS registration reports (at+cgreg=2)	*/
+	GSM_CMD_NUMBER			= 0x22		/*!< Number of commands in table					*/
+} GSMCommandId_t;
+
+/**
+  * @brief  GSM COMMAND Structure definition, one entry of table of gsm commands
+  */
+typedef struct __GSMCommand_t
+{
+	const char *name;					/*!< Short name of command for statistics							*/
+
+	const char *format;					/*!< Template of command, arguments are formatted in it as in printf	*/
+
+	const char *expect;					/*!< Final result code of success, NULL to collect answer until timeout	*/
+
+	uint32_t timeout;					/*!< Time for answer (in miliseconds), bound of learned timeout		*/
+
+	ATTimeoutClass_t timeoutClass;		/*!< Class whose timeout is learned, AT_TIMEOUT_FIXED for none		*/
+
+	uint32_t responseSize;				/*!< Size of buffer for answer, taken from arena of calling task	*/
+
+	const char *show;					/*!< Start of part of answer that is written to console, NULL for none	*/
+
+	DRIVERState_t (*Parse)(gsmHandler_t *gsmHandler, uint8_t *answer, uint32_t length, void *output);
+										/*!< Parser of answer, called after success, NULL for none			*/
+
+	const char *done;					/*!< Written to console after success, NULL for none				*/
+
+	void (*Line)(ATCommand_t *command, const uint8_t *text, uint32_t size);
+										/*!< Parser of lines of answer while it comes (context of command is
+											 output), NULL to parse whole answer							*/
+
+}GSMCommand_t;
+
+/**
+  * @brief  GSM COMMAND STATISTICS Structure definition
+  */
+typedef struct
+{
+	uint32_t count;						/*!< Number of executions of command		*/
+
+	uint32_t errorCount;				/*!< Number of error answers				*/
+
+	uint32_t timeoutCount;				/*!< Number of answers without final code	*/
+
+	uint32_t maxTime;					/*!< Longest execution (in miliseconds)		*/
+
+	uint32_t skipCount;					/*!< Number of calls that didn't send command,
+											 because cached state was already reached	*/
+
+}GSMCommandStats_t;
+
+/**
+  * @brief  GSM BRING UP state definition, steps from cold boot to open connection with server
+  */
+typedef enum
+{
+	GSM_BRINGUP_CONFIG		= 0x00,		/*!< Registration reports and hexadecimal format (one line)	*/
+	GSM_BRINGUP_REGISTER	= 0x01,		/*!< Wait for registration to network						*/
+	GSM_BRINGUP_CONNECT		= 0x02,		/*!< PDP context and connection to server (one chain)		*/
+	GSM_BRINGUP_ONLINE		= 0x03,		/*!< Connection with server is open							*/
+	GSM_BRINGUP_FAILED		= 0x04		/*!< Step failed or time expired							*/
+} GSMBringUpState_t;
+
+/**
+  * @brief  GSM BRING UP Structure definition, state machine of EstablishTCPClientConnection()
+  */
+typedef struct __GSMBringUp_t
+{
+	GSMBringUpState_t state;			/*!< Step that runs next							*/
+
+	const uint8_t *PDP;					/*!< PDP context that is activated, ends with '\r'	*/
+
+	ConnectSrvrInputStruct_t server;	/*!< Server to which connection is opened			*/
+
+	uint32_t timeout;					/*!< Time for whole bring up (in miliseconds)		*/
+
+	uint32_t startTime;					/*!< Time when bring up started						*/
+
+	uint32_t stepTime[GSM_BRINGUP_ONLINE];	/*!< Time spent in every step (in miliseconds)	*/
+
+	uint32_t commandCount;				/*!< Number of at commands sent to gsm				*/
+
+	bool separate;						/*!< Gsm refused command line with several commands,
+											 they are sent one by one						*/
+
+}GSMBringUp_t;
+
 /* Initialization function *******************************************************************************************/
 DRIVERState_t GSM_Init(gsmHandler_t *handler, gsmConfig_t *config);
 
+/* Table of gsm commands *********************************************************************************************/
+DRIVERState_t GSM_Execute(gsmHandler_t *gsmHandler, GSMCommandId_t id, void *output, ...);
+const GSMCommand_t *GSM_GetCommand(GSMCommandId_t id);
+const GSMCommandStats_t *GSM_GetCommandStats(GSMCommandId_t id);
+
 /* IO operation functions ********************************************************************************************/
 DRIVERState_t GSM_SetEcho(gsmHandler_t *gsmHandler, uint32_t timeout, GSMEcho_t echoOnOFF, OutputStruct_t *outputStruct);
 DRIVERState_t GSM_MsgFormat(gsmHandler_t *gsmHandler, uint32_t timeout, GSMMsgFormat_t format, OutputStruct_t *outputStruct);
 DRIVERState_t GSM_SetMsgStorage(gsmHandler_t *gsmHandler, uint32_t timeout,const SetMsgStrgInputStruct_t inputStruct,OutputStruct_t *outputStruct);
 DRIVERState_t GSM_TestMsgStorage(gsmHandler_t *gsmHandler, uint32_t timeout);
-DRIVERState_t GSM_ListMsg(gsmHandler_t *gsmHandler, uint32_t timeout, const ListMsgInputStruct_t inputStruct, ListMsgOutputStruct_t *outputStruct);
+DRIVERState_t GSM_ListMsg(gsmHandler_t *gsmHandler, uint32_t timeout, const ListMsgInputStruct_t inputStruct, GSMSmsList_t *list);
 DRIVERState_t GSM_ReadMsg(gsmHandler_t *gsmHandler, uint32_t timeout,const ReadMsgInputStruct_t inputStruct, ReadMsgOutputStruct_t *outputStruct);
 DRIVERState_t GSM_DeleteMsg(gsmHandler_t *gsmHandler, uint32_t timeout, DeleteMsgInputStruct_t inputStruct, OutputStruct_t *outputStruct);
 DRIVERState_t GSM_SendStoreMsg(gsmHandler_t *gsmHandler, uint32_t timeout,const SendOrStoreInputStruct_t inputStruct,OutputStruct_t *outputStruct);
@@ -287,6 +551,14 @@ DRIVERState_t GSM_SendStoreMsg(gsmHandler_t *gsmHandler, uint32_t timeout,const
 DRIVERState_t GSM_NetworkRegistered(gsmHandler_t *gsmHandler);
 DRIVERState_t GSM_NetworkDeregistered(gsmHandler_t *gsmHandler);
 DRIVERState_t GSM_CheckNetworkRegistered(gsmHandler_t *gsmHandler);
+DRIVERState_t GSM_CheckGPRSRegistered(gsmHandler_t *gsmHandler);
+DRIVERState_t GSM_GetSignalQuality(gsmHandler_t *gsmHandler);
+DRIVERState_t GSM_GetOperator(gsmHandler_t *gsmHandler);
+
+/* Cached state of modem */
+uint32_t GSM_GetState(gsmHandler_t *gsmHandler);
+DRIVERState_t GSM_WaitState(gsmHandler_t *gsmHandler, uint32_t bits, uint32_t timeout);
+DRIVERState_t GSM_RegistrationSubscribe(gsmHandler_t *gsmHandler, QueueHandle_t queue);
 
 /* PDP - Packet Data Protocol, APN - Access Point Name */
 /* Functions for GPRS support */
@@ -313,6 +585,17 @@ DRIVERState_t GSM_CheckConnection(gsmHandler_t *gsmHandler);
 DRIVERState_t GSM_SendToServer(gsmHandler_t *gsmHandler, uint32_t timeout, uint8_t *message);
 
 DRIVERState_t EstablishTCPClientConnection(gsmHandler_t *gsmHandler, uint32_t timeout);
+void GSM_BringUpStart(GSMBringUp_t *bringUp, const uint8_t *PDP, ConnectSrvrInputStruct_t server, uint32_t timeout);
+DRIVERState_t GSM_BringUpStep(gsmHandler_t *gsmHandler, GSMBringUp_t *bringUp);
+DRIVERState_t GSM_BringUp(gsmHandler_t *gsmHandler, GSMBringUp_t *bringUp);
+
+/* Asynchronous operation functions, caller doesn't wait (async.c) ***************************************************/
+DRIVERState_t GSM_SendToServer_Async(gsmHandler_t *gsmHandler, uint32_t timeout, uint8_t *message, ASYNCOperation_t *operation);
+DRIVERState_t GSM_SendStoreMsg_Async(gsmHandler_t *gsmHandler, uint32_t timeout, const SendOrStoreInputStruct_t *inputStruct,
+									 OutputStruct_t *outputStruct, ASYNCOperation_t *operation);
+DRIVERState_t GSM_ConnectToServer_Async(gsmHandler_t *gsmHandler, uint32_t timeout, const ConnectSrvrInputStruct_t *inputStruct,
+										ASYNCOperation_t *operation);
+DRIVERState_t GSM_BringUp_Async(gsmHandler_t *gsmHandler, GSMBringUp_t *bringUp, ASYNCOperation_t *operation);
 
 DRIVERState_t onlyPutNumber(DRIVERConsoleHandler_t *console, uint8_t *buffer, uint32_t *size, uint32_t bufSize, uint32_t timeout);
 
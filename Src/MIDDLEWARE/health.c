@@ -0,0 +1,365 @@
+/**
+  ********************************************************************************************
+  * @file    health.c
+  * @author  Valentina Denic
+  * @brief   MIDDLEWARE for health monitor of the system.
+  *          This file provides firmware functions to manage the following
+  *          functionalities of the health monitor.
+  *           + Initialization function that starts health task
+  *           + Periodic sampling of stack, heap, pool and arena watermarks
+  *           + Alarms when watermark crosses threshold
+  *           + Formatting and publishing of summary
+  *
+  @verbatim
+ ==============================================================================================
+                        ##### How to use this driver #####
+ ==============================================================================================
+  [..]
+    Health task has the lowest priority above idle task, so it doesn't disturb other tasks.
+    Every HEALTH_SAMPLE_PERIOD it takes free stack of every task, minimum ever free heap and
+    high water marks of pools and arena. When watermark crosses its threshold for the first
+    time, warning is written on console at once. After every sample health task checks if
+    summary should be published and hands publish to async task (MQTT_Publish_Async()), so it
+    never waits for gsm or broker and telemetry reaches broker also when nobody uses console
+    and demo task is busy with long command. Health task also saves learned
+    timeouts of at commands in flash (AT_TIMEOUT_Process()), because it can wait for erase.
+    The health driver can be used as follows:
+
+    (#) Change thresholds and periods in health.h or define them before it is included
+    (#) Declare a HEALTHHandler_t handle structure and initialize it with HEALTH_Init()
+        before scheduler is started, with console, mqtt and arena that is watched
+    (#) Initialize async task (ASYNC_Init()), summary is published when period expires
+        or new alarm is raised and only while broker connection is open
+    (#) Write last sample in buffer with HEALTH_Format() function, either as table for
+        console or as compact line that is published
+    (#) Publish summary at once with HEALTH_Publish() function
+  @endverbatim
+  *
+  *********************************************************************************************
+  */
+
+/* Includes ----------------------------------------------------------------------------------*/
+#include <health.h>
+#include <at_timeout.h>
+
+/* States of tasks filled by FreeRTOS, used only from health task */
+static TaskStatus_t healthStatus[HEALTH_MAX_TASKS];
+
+/* Warning written on console from health task */
+static uint8_t healthWarning[HEALTH_MAX_TASKS * 40U + 200U];
+
+/* Summary published to broker by async task, it is written only when previous publish is done */
+static uint8_t healthReport[HEALTH_REPORT_SIZE];
+
+/* Names of size classes of pools */
+static const char *healthPoolName[POOL_CLASS_NUMBER] = {"at", "sms", "packet"};
+
+/**
+  * @brief Take watermarks of all tasks, heap, pools and arena and raise alarms.
+  * @param handler      HEALTH handle.
+  * @retval uint32_t alarm bits that were raised in this sample
+  */
+static uint32_t sampleWatermarks(HEALTHHandler_t *handler)
+{
+	uint32_t alarms = 0;
+
+	UBaseType_t taskNumber = uxTaskGetSystemState(healthStatus, HEALTH_MAX_TASKS, NULL);
+
+	uint32_t minFreeHeap = xPortGetMinimumEverFreeHeapSize();
+	if(minFreeHeap <= HEALTH_HEAP_THRESHOLD) alarms |= HEALTH_ALARM_HEAP;
+
+	/* Handle is read by other tasks, so it is changed while scheduler is suspended */
+	vTaskSuspendAll();
+
+	for(UBaseType_t i = 0; i < taskNumber; i++)
+	{
+		strncpy(handler->tasks[i].name, healthStatus[i].pcTaskName, configMAX_TASK_NAME_LEN - 1);
+		handler->tasks[i].name[configMAX_TASK_NAME_LEN - 1] = '\0';
+		handler->tasks[i].stackHighWater = healthStatus[i].usStackHighWaterMark;
+
+		if(healthStatus[i].usStackHighWaterMark <= HEALTH_STACK_THRESHOLD) alarms |= HEALTH_ALARM_STACK;
+	}
+	handler->taskNumber = taskNumber;
+
+	handler->minFreeHeap = minFreeHeap;
+
+	handler->poolFailCount = 0;
+	for(uint32_t i = 0; i < POOL_CLASS_NUMBER; i++)
+	{
+		POOLHandler_t *pool = POOL_GetHandler((POOLClass_t)i);
+
+		handler->poolUsage[i] = (pool->highWater * 100U) / pool->blockNumber;
+		handler->poolFailCount += pool->failCount;
+
+		if(handler->poolUsage[i] >= HEALTH_POOL_THRESHOLD || pool->failCount != 0) alarms |= HEALTH_ALARM_POOL;
+	}
+
+	if(handler->arenaHandler != NULL)
+	{
+		handler->arenaUsage = (handler->arenaHandler->highWater * 100U) / handler->arenaHandler->size;
+
+		if(handler->arenaUsage >= HEALTH_ARENA_THRESHOLD || handler->arenaHandler->failCount != 0) alarms |= HEALTH_ALARM_ARENA;
+	}
+
+	handler->sampleCount++;
+
+	/* Watermarks never go back, so alarm stays raised once it is set */
+	uint32_t newAlarms = alarms & ~handler->alarms;
+	handler->alarms |= alarms;
+	if(newAlarms != 0) handler->publishPending = 1;
+
+	xTaskResumeAll();
+
+	return newAlarms;
+}
+
+/**
+  * @brief Write warning on console for alarms that were just raised.
+  * @param handler      HEALTH handle.
+  * @param newAlarms    Alarm bits that were raised in last sample.
+  * @retval void
+  */
+static void writeWarning(HEALTHHandler_t *handler, uint32_t newAlarms)
+{
+	uint32_t size = sizeof(healthWarning);
+	uint32_t length = 0;
+	int written = 0;
+
+	/* Only health task writes handle, so it is read here without suspending scheduler */
+	length = snprintf((char*)healthWarning, size, "\r\nHealth warning!\r\n");
+
+	for(uint32_t i = 0; (newAlarms & HEALTH_ALARM_STACK) && i < handler->taskNumber; i++)
+	{
+		if(handler->tasks[i].stackHighWater > HEALTH_STACK_THRESHOLD) continue;
+
+		written = snprintf((char*)healthWarning + length, size - length, "Stack of %s: %lu words free\r\n",
+				handler->tasks[i].name, (unsigned long)handler->tasks[i].stackHighWater);
+		if(written < 0 || (length + written) >= size) break;
+		length += written;
+	}
+
+	if((newAlarms & HEALTH_ALARM_HEAP) && length < size)
+	{
+		written = snprintf((char*)healthWarning + length, size - length, "Minimum free heap: %lu bytes\r\n",
+				(unsigned long)handler->minFreeHeap);
+		if(written > 0) length += written;
+	}
+
+	if((newAlarms & HEALTH_ALARM_POOL) && length < size)
+	{
+		written = snprintf((char*)healthWarning + length, size - length, "Pool high water: at %lu%% sms %lu%% packet %lu%%, failed %lu\r\n",
+				(unsigned long)handler->poolUsage[POOL_CLASS_AT], (unsigned long)handler->poolUsage[POOL_CLASS_SMS],
+				(unsigned long)handler->poolUsage[POOL_CLASS_PACKET], (unsigned long)handler->poolFailCount);
+		if(written > 0) length += written;
+	}
+
+	if((newAlarms & HEALTH_ALARM_ARENA) && length < size)
+	{
+		snprintf((char*)healthWarning + length, size - length, "Arena high water: %lu%%\r\n",
+				(unsigned long)handler->arenaUsage);
+	}
+
+	/* Previous warning is transmitted long before next sample, so buffer can be reused */
+	DRIVER_CONSOLE_Put(handler->consoleHandler, healthWarning);
+}
+
+/**
+  * @brief Called in async task when publish of summary is done.
+  * @param operation    Publish operation of health handle.
+  * @retval void
+  */
+static void publishDone(ASYNCOperation_t *operation)
+{
+	HEALTHHandler_t *handler = operation->context;
+
+	if(operation->result == MQTT_OK) handler->publishPending = 0;
+}
+
+/**
+  * @brief Hand publish of summary to async task when publish period expires or new alarm is raised.
+  * @param handler      HEALTH handle.
+  * @retval void
+  */
+static void publishSummary(HEALTHHandler_t *handler)
+{
+	TickType_t elapsed = xTaskGetTickCount() - handler->lastPublish;
+
+	/* Alarm is published at once, failed attempt is repeated after one sample period */
+	if(elapsed < pdMS_TO_TICKS(HEALTH_PUBLISH_PERIOD) &&
+	   (handler->publishPending == 0 || elapsed < pdMS_TO_TICKS(HEALTH_SAMPLE_PERIOD)))
+		return;
+
+	/* Previous summary still waits for async task or it is being sent */
+	ASYNCOperation_t *operation = &handler->publishOperation;
+	if(operation->state == ASYNC_PENDING || operation->state == ASYNC_RUNNING) return;
+
+	handler->lastPublish = xTaskGetTickCount();
+
+	if(handler->mqttHandler->connectionState != MQTT_CONNECTED) return;
+
+	/* Summary is one line without '\r', it would end message */
+	HEALTH_Format(handler, HEALTH_FORMAT_COMPACT, healthReport, sizeof(healthReport));
+
+	operation->Complete = publishDone;
+	operation->context 	= handler;
+	MQTT_Publish_Async(handler->mqttHandler, HEALTH_PUBLISH_TIMEOUT, (const uint8_t*)HEALTH_TOPIC, healthReport,
+					   operation);
+}
+
+/**
+  * @brief Task for periodic sampling of watermarks.
+  */
+static void HealthTask(void* pvParameters)
+{
+	HEALTHHandler_t *handler = pvParameters;
+	TickType_t lastWake = xTaskGetTickCount();
+
+	for(;;){
+
+		uint32_t newAlarms = sampleWatermarks(handler);
+
+		if(newAlarms != 0) writeWarning(handler, newAlarms);
+
+		publishSummary(handler);
+
+		/* Learned timeouts of at commands are saved here, erase of flash doesn't stall other tasks */
+		AT_TIMEOUT_Process();
+
+		vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(HEALTH_SAMPLE_PERIOD));
+	}
+}
+
+/**
+  * @brief Initialize health handle and create health task.
+  * @param handler      HEALTH handle.
+  * @param config       Configuration handle.
+  * @retval HEALTHState_t status
+  */
+HEALTHState_t HEALTH_Init(HEALTHHandler_t *handler, HEALTHConfig_t *config)
+{
+	if(handler == NULL) return HEALTH_ERROR;
+
+	memset(handler, 0, sizeof(HEALTHHandler_t));
+
+	/* Check the configuration handle allocation */
+	if(config == NULL || config->consoleHandler == NULL || config->mqttHandler == NULL)
+	{
+		handler->initState = HEALTH_NO_INIT;
+		return HEALTH_ERROR;
+	}
+
+	handler->consoleHandler 	= config->consoleHandler;
+
+	handler->mqttHandler 		= config->mqttHandler;
+
+	handler->arenaHandler 		= config->arenaHandler;
+
+	handler->lastPublish 		= 0;
+
+	if(xTaskCreate(HealthTask, "HealthTask", HEALTH_TASK_STACK, handler, HEALTH_TASK_PRIORITY, NULL) != pdPASS)
+	{
+		handler->initState = HEALTH_NO_INIT;
+		return HEALTH_ERROR;
+	}
+
+	handler->initState 			= HEALTH_INIT;
+
+	return HEALTH_OK;
+}
+
+/**
+  * @brief Write last sample in buffer.
+  * @param handler      HEALTH handle.
+  * @param format       Table for console or one comma separated line for broker.
+  * @param buffer       Buffer for summary, HEALTH_REPORT_SIZE bytes is enough for all tasks.
+  * @param size         Size of buffer.
+  * @retval uint32_t number of written characters without null character
+  */
+uint32_t HEALTH_Format(HEALTHHandler_t *handler, HEALTHFormat_t format, uint8_t *buffer, uint32_t size)
+{
+	HEALTHHandler_t sample;
+	uint32_t length = 0;
+	int written = 0;
+
+	if(handler == NULL || buffer == NULL || size == 0) return 0;
+
+	/* Copy of handle, so health task can't change sample while it is written */
+	vTaskSuspendAll();
+	sample = *handler;
+	xTaskResumeAll();
+
+	if(format == HEALTH_FORMAT_TABLE)
+		written = snprintf((char*)buffer, size,
+				"\r\nSample %lu, alarms 0x%02lx\r\n"
+				"Minimum free heap: %lu bytes\r\n"
+				"Pool high water: %s %lu%% %s %lu%% %s %lu%%, failed %lu\r\n"
+				"Arena high water: %lu%%\r\n"
+				"%-16s %10s\r\n",
+				(unsigned long)sample.sampleCount, (unsigned long)sample.alarms,
+				(unsigned long)sample.minFreeHeap,
+				healthPoolName[POOL_CLASS_AT], (unsigned long)sample.poolUsage[POOL_CLASS_AT],
+				healthPoolName[POOL_CLASS_SMS], (unsigned long)sample.poolUsage[POOL_CLASS_SMS],
+				healthPoolName[POOL_CLASS_PACKET], (unsigned long)sample.poolUsage[POOL_CLASS_PACKET],
+				(unsigned long)sample.poolFailCount,
+				(unsigned long)sample.arenaUsage,
+				"Task", "Free stack");
+	else
+		written = snprintf((char*)buffer, size, "health,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu",
+				(unsigned long)sample.sampleCount, (unsigned long)sample.alarms,
+				(unsigned long)sample.minFreeHeap,
+				(unsigned long)sample.poolUsage[POOL_CLASS_AT], (unsigned long)sample.poolUsage[POOL_CLASS_SMS],
+				(unsigned long)sample.poolUsage[POOL_CLASS_PACKET], (unsigned long)sample.poolFailCount,
+				(unsigned long)sample.arenaUsage);
+
+	for(uint32_t i = 0; written > 0 && (length + written) < size; i++)
+	{
+		length += written;
+		if(i == sample.taskNumber) break;
+
+		HEALTHTask_t *task = &sample.tasks[i];
+		if(format == HEALTH_FORMAT_TABLE)
+			written = snprintf((char*)buffer + length, size - length, "%-16s %10lu%s\r\n",
+					task->name, (unsigned long)task->stackHighWater,
+					task->stackHighWater <= HEALTH_STACK_THRESHOLD ? " !" : "");
+		else
+			written = snprintf((char*)buffer + length, size - length, ",%s:%lu",
+					task->name, (unsigned long)task->stackHighWater);
+	}
+
+	/* Last part didn't fit, buffer ends after last complete part */
+	buffer[length] = '\0';
+
+	return length;
+}
+
+/**
+  * @brief Publish summary of last sample to HEALTH_TOPIC.
+  * @param handler      HEALTH handle.
+  * @param timeout      Timeout for response from gsm.
+  * @retval HEALTHState_t status
+  */
+HEALTHState_t HEALTH_Publish(HEALTHHandler_t *handler, uint32_t timeout)
+{
+	if(handler == NULL || handler->initState != HEALTH_INIT) return HEALTH_ERROR;
+
+	handler->lastPublish = xTaskGetTickCount();
+
+	if(handler->mqttHandler->connectionState != MQTT_CONNECTED) return HEALTH_ERROR;
+
+	/* Summary is taken from arena of calling task, buffer of health task can be in async task */
+	ARENAHandler_t *arena 	= ARENA_Current();
+	ARENAMark_t scope 		= ARENA_Mark(arena);
+	uint8_t *report 		= ARENA_Alloc(arena, HEALTH_REPORT_SIZE);
+	if(report == NULL) return HEALTH_ERROR;
+
+	/* Summary is one line without '\r', it would end message */
+	HEALTH_Format(handler, HEALTH_FORMAT_COMPACT, report, HEALTH_REPORT_SIZE);
+
+	MQTTState_t status = MQTT_Publish(handler->mqttHandler, timeout, (const uint8_t*)HEALTH_TOPIC, report);
+	ARENA_Release(arena, scope);
+	if(status != MQTT_OK) return HEALTH_ERROR;
+
+	handler->publishPending = 0;
+
+	return HEALTH_OK;
+}
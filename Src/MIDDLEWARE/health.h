@@ -0,0 +1,176 @@
+/**
+  ***************************************************************************************************
+  * @file    health.h
+  * @author  Valentina Denic
+  * @brief   This file contains all the functions prototypes for the health monitor
+  *          (stack, heap, pool and arena watermarks with alarms).
+  ***************************************************************************************************
+  */
+
+#ifndef MIDDLEWARE_HEALTH_H_
+#define MIDDLEWARE_HEALTH_H_
+
+#include <driver_console.h>
+#include <mqtt.h>
+#include <pool.h>
+#include <arena.h>
+#include <stdio.h>
+
+/* Period of sampling watermarks in health task (in miliseconds) */
+#ifndef HEALTH_SAMPLE_PERIOD
+#define HEALTH_SAMPLE_PERIOD		5000U
+#endif
+
+/* Period of publishing summary to broker (in miliseconds) */
+#ifndef HEALTH_PUBLISH_PERIOD
+#define HEALTH_PUBLISH_PERIOD		60000U
+#endif
+
+/* Time for answer of broker to summary that health task publishes (in miliseconds) */
+#ifndef HEALTH_PUBLISH_TIMEOUT
+#define HEALTH_PUBLISH_TIMEOUT		30000U
+#endif
+
+/* Alarm when free stack of any task falls to this number of words */
+#ifndef HEALTH_STACK_THRESHOLD
+#define HEALTH_STACK_THRESHOLD		64U
+#endif
+
+/* Alarm when minimum ever free heap falls to this number of bytes */
+#ifndef HEALTH_HEAP_THRESHOLD
+#define HEALTH_HEAP_THRESHOLD		1024U
+#endif
+
+/* Alarm when high water mark of any pool reaches this percent of its blocks */
+#ifndef HEALTH_POOL_THRESHOLD
+#define HEALTH_POOL_THRESHOLD		90U
+#endif
+
+/* Alarm when high water mark of arena reaches this percent of its budget */
+#ifndef HEALTH_ARENA_THRESHOLD
+#define HEALTH_ARENA_THRESHOLD		90U
+#endif
+
+/* Topic on which summary is published */
+#ifndef HEALTH_TOPIC
+#define HEALTH_TOPIC				"gsm/health"
+#endif
+
+/* Largest number of tasks that are watched */
+#define HEALTH_MAX_TASKS			16U
+
+/* Stack of health task in words and its priority, it runs only when all other tasks wait,
+ * stack holds copy of handle that is formatted for publish */
+#define HEALTH_TASK_STACK			512U
+#define HEALTH_TASK_PRIORITY		1U
+
+/* Size of buffer that holds formatted summary, it must fit in one mqtt message */
+#define HEALTH_REPORT_SIZE			(HEALTH_MAX_TASKS * 40U + 200U)
+
+/**
+  * @brief  HEALTH Status structures definition
+  */
+typedef enum
+{
+	HEALTH_OK     	= 0x00,				/*!< Health status ok		 */
+	HEALTH_ERROR	= 0x01				/*!< Health status error	 */
+} HEALTHState_t;
+
+/**
+  * @brief  HEALTH INIT Status structures definition
+  */
+typedef enum
+{
+	HEALTH_INIT		= 0x00,				/*!< Health initialization status initialization ok		 */
+	HEALTH_NO_INIT	= 0x01				/*!< Health initialization status no initialization 	 */
+} HEALTHInit_t;
+
+/**
+  * @brief  HEALTH alarm bits definition
+  */
+typedef enum
+{
+	HEALTH_ALARM_STACK	= 0x01,			/*!< Free stack of some task is below threshold				 */
+	HEALTH_ALARM_HEAP	= 0x02,			/*!< Minimum ever free heap is below threshold				 */
+	HEALTH_ALARM_POOL	= 0x04,			/*!< Some pool is almost full or allocation from it failed	 */
+	HEALTH_ALARM_ARENA	= 0x08			/*!< Arena is almost full or allocation from it failed		 */
+} HEALTHAlarm_t;
+
+/**
+  * @brief  HEALTH report format definition
+  */
+typedef enum
+{
+	HEALTH_FORMAT_TABLE		= 0x00,		/*!< Table for reading on console							 */
+	HEALTH_FORMAT_COMPACT	= 0x01		/*!< One comma separated line, published to broker			 */
+} HEALTHFormat_t;
+
+/**
+  * @brief  HEALTH watermark of one task
+  */
+typedef struct
+{
+	char name[configMAX_TASK_NAME_LEN];		/*!< Name of task											 */
+
+	uint32_t stackHighWater;				/*!< Smallest free stack since task was created (in words)	 */
+
+}HEALTHTask_t;
+
+/**
+  * @brief  HEALTH handle Structure definition
+  */
+typedef struct __HEALTHHandler_t
+{
+	HEALTHInit_t initState;						/*!< Initial state parameter								 */
+
+	DRIVERConsoleHandler_t *consoleHandler;		/*!< Console on which alarms are written					 */
+
+	MQTTHandler_t *mqttHandler;					/*!< Mqtt handle used for publishing						 */
+
+	ARENAHandler_t *arenaHandler;				/*!< Arena that is watched, can be NULL						 */
+
+	HEALTHTask_t tasks[HEALTH_MAX_TASKS];		/*!< Watermarks of tasks from last sample					 */
+
+	uint32_t taskNumber;						/*!< Number of valid entries in tasks						 */
+
+	uint32_t minFreeHeap;						/*!< Minimum ever free heap in bytes						 */
+
+	uint32_t poolUsage[POOL_CLASS_NUMBER];		/*!< High water mark of every pool in percent of blocks		 */
+
+	uint32_t poolFailCount;						/*!< Failed allocations from all pools						 */
+
+	uint32_t arenaUsage;						/*!< High water mark of arena in percent of budget			 */
+
+	uint32_t sampleCount;						/*!< Number of samples taken								 */
+
+	volatile uint32_t alarms;					/*!< Alarm bits (HEALTHAlarm_t) raised since start			 */
+
+	volatile uint32_t publishPending;			/*!< New alarm is raised and it wasn't published yet		 */
+
+	TickType_t lastPublish;						/*!< Tick of last attempt to publish						 */
+
+	ASYNCOperation_t publishOperation;			/*!< Periodic publish, health task hands it to async task	 */
+
+}HEALTHHandler_t;
+
+/**
+  * @brief  HEALTH configuration Structure definition
+  */
+typedef struct __HEALTHConfig_t
+{
+	DRIVERConsoleHandler_t *consoleHandler;		/*!< Console handle structure			 */
+
+	MQTTHandler_t *mqttHandler;					/*!< Mqtt handle structure				 */
+
+	ARENAHandler_t *arenaHandler;				/*!< Arena handle structure, can be NULL */
+
+}HEALTHConfig_t;
+
+/* Initialization operation functions ****************************************************************/
+HEALTHState_t HEALTH_Init(HEALTHHandler_t *handler, HEALTHConfig_t *config);
+
+/* IO operation functions ****************************************************************************/
+uint32_t HEALTH_Format(HEALTHHandler_t *handler, HEALTHFormat_t format, uint8_t *buffer, uint32_t size);
+HEALTHState_t HEALTH_Publish(HEALTHHandler_t *handler, uint32_t timeout);
+
+#endif /* MIDDLEWARE_HEALTH_H_ */
@@ -0,0 +1,369 @@
+/**
+  ********************************************************************************************
+  * @file    link.c
+  * @author  Valentina Denic
+  * @brief   MIDDLEWARE for connection manager.
+  *          This file provides firmware functions to manage the following
+  *          functionalities of the connection with broker.
+  *           + Lowest broken layer from cached state of modem
+  *           + Recovery that resumes from that layer
+  *           + Exponential backoff with jitter between attempts
+  *           + Link task that sleeps on registration events
+  *           + Time to recover for every broken layer
+  *
+  @verbatim
+ ==============================================================================================
+                        ##### How to use this driver #####
+ ==============================================================================================
+  [..]
+    Connection with broker has layers: registration to network, attach to GPRS service,
+    PDP context, TCP connection with server and mqtt session. When connection drops,
+    only the layers from the lowest broken one up are repaired, so lost TCP connection
+    costs at+cipstart and CONNECT packet instead of whole bring up. Lowest broken layer
+    is read from cached state of modem (GSM_GetState()), which answers and unsolicited
+    lines (+CREG:, CLOSED, +PDP: DEACT) keep, so finding it sends nothing to gsm. After
+    every repair layer is read again, because repair of lower layer can bring up higher
+    ones too. PDP context and connection are repaired by state machine of bring up, which
+    sends only commands whose state isn't reached. Session is always broken when
+    connection is broken. Failed attempt waits LINK_BACKOFF_MIN, doubled after every
+    failure up to LINK_BACKOFF_MAX, with LINK_JITTER percents of random jitter seeded
+    from unique ID of microcontroller, so devices that lost the same cell don't come
+    back at the same moment. Time from finding outage to recovered connection is kept
+    for lowest broken layer of outage. Manager runs in its own link task, which sleeps on
+    queue of registration events of gsm (+CREG: and +CGREG: reports), so lost registration
+    starts recovery as soon as report comes, and event that comes while outage is recovered
+    ends backoff, so next attempt starts as soon as network comes back instead of after
+    delay. Without events task wakes every LINK_POLL_PERIOD and when backoff expires.
+    The connection manager can be used as follows:
+
+    (#) Declare a LINKHandler_t handle structure and initialize it with LINK_Init()
+        with gsm and mqtt handles, PDP context, server and arena of link task, before
+        scheduler is started
+    (#) Start keeping connection up with LINK_Start() function and stop with LINK_Stop(),
+        link task repairs broken layers, other tasks don't wait for it
+    (#) Report operation that failed on connection that looked up with LINK_Fault()
+        function (eg. publish without answer), cached state that missed drop is then
+        read from gsm again
+    (#) Read lowest broken layer with LINK_Check() function
+  @endverbatim
+  *
+  *********************************************************************************************
+  */
+
+/* Includes ----------------------------------------------------------------------------------*/
+#include <link.h>
+
+/* Names of layers for console */
+static const char *linkName[LINK_LAYER_UP + 1] = {"registration", "attach", "pdp", "socket", "session", "up"};
+
+/* Link task declaration */
+void LinkTask(void* pvParameters);
+
+/**
+  * @brief Delay before next attempt, exponential with random jitter.
+  * @param handler      LINK handle.
+  * @retval uint32_t delay (in miliseconds)
+  */
+static uint32_t backoff(LINKHandler_t *handler)
+{
+	uint32_t delay = LINK_BACKOFF_MAX;
+
+	if(handler->attempt <= 16U && (LINK_BACKOFF_MIN << (handler->attempt - 1U)) < LINK_BACKOFF_MAX)
+		delay = LINK_BACKOFF_MIN << (handler->attempt - 1U);
+
+	/* Xorshift generator, its state is never zero */
+	handler->random ^= handler->random << 13;
+	handler->random ^= handler->random >> 17;
+	handler->random ^= handler->random << 5;
+
+	uint32_t spread = delay / 100U * LINK_JITTER;
+	return delay - spread + handler->random % (2U * spread + 1U);
+}
+
+/**
+  * @brief End outage and keep its time to recover.
+  * @param handler      LINK handle.
+  * @retval void
+  */
+static void recovered(LINKHandler_t *handler)
+{
+	LINKStats_t *stats = &handler->stats[handler->brokenLayer];
+	uint32_t time = TIME_GetTick() - handler->downTime;
+
+	stats->recoverCount++;
+	stats->lastTime = time;
+	stats->totalTime += time;
+	if(time > stats->maxTime) stats->maxTime = time;
+
+	handler->down 		= false;
+	handler->attempt 	= 0;
+}
+
+/**
+  * @brief Repair one layer, layers below it are up.
+  * @param handler      LINK handle.
+  * @param layer        Lowest broken layer.
+  * @retval DRIVERState_t status
+  */
+static DRIVERState_t repairLayer(LINKHandler_t *handler, LINKLayer_t layer)
+{
+	gsmHandler_t *gsmHandler = handler->gsmHandler;
+	GSMBringUp_t bringUp;
+
+	switch(layer){
+	case LINK_LAYER_REGISTRATION:
+		/* Gsm registers by itself, +CREG: report wakes task that waits for it */
+		if(GSM_NetworkRegistered(gsmHandler) != DRIVER_OK || GSM_CheckNetworkRegistered(gsmHandler) != DRIVER_OK)
+			return DRIVER_ERROR;
+		return GSM_WaitState(gsmHandler, GSM_STATE_REGISTERED, LINK_REGISTER_TIMEOUT);
+	case LINK_LAYER_ATTACH:
+		return GSM_AttachToGPRSService(gsmHandler);
+	case LINK_LAYER_PDP:
+	case LINK_LAYER_SOCKET:
+		/* Steps whose state is reached are skipped, at+cgact=1 and at+cipstart are one chain */
+		GSM_BringUpStart(&bringUp, handler->PDP, handler->server, LINK_CONNECT_TIMEOUT);
+		return GSM_BringUp(gsmHandler, &bringUp);
+	case LINK_LAYER_SESSION:
+		return MQTT_Connect(handler->mqttHandler) == MQTT_OK ? DRIVER_OK : DRIVER_ERROR;
+	default:
+		return DRIVER_OK;
+	}
+}
+
+/**
+  * @brief Initialize connection manager, it doesn't keep connection until LINK_Start().
+  * @param handler      LINK handle.
+  * @param config       Configuration handle.
+  * @retval DRIVERState_t status
+  */
+DRIVERState_t LINK_Init(LINKHandler_t *handler, LINKConfig_t *config)
+{
+	if(handler == NULL) return DRIVER_ERROR;
+
+	memset(handler, 0, sizeof(LINKHandler_t));
+
+	/* Check the configuration handle allocation */
+	if(config == NULL || config->gsmHandler == NULL || config->mqttHandler == NULL || config->PDP == NULL ||
+	   config->arenaHandler == NULL)
+	{
+		handler->initState = LINK_NO_INIT;
+		return DRIVER_ERROR;
+	}
+
+	handler->gsmHandler 	= config->gsmHandler;
+
+	handler->mqttHandler 	= config->mqttHandler;
+
+	handler->PDP 			= config->PDP;
+
+	handler->server 		= config->server;
+
+	handler->arenaHandler 	= config->arenaHandler;
+
+	/* Every device has its own sequence of jitter */
+	handler->random 		= (HAL_GetUIDw0() ^ HAL_GetUIDw1() ^ HAL_GetUIDw2()) | 1U;
+
+	/* Change of registration wakes recovery */
+	handler->events 		= xQueueCreate( LINK_EVENT_QUEUE_LENGTH, sizeof(GSMRegEvent_t) );
+	if(handler->events == NULL || GSM_RegistrationSubscribe(handler->gsmHandler, handler->events) != DRIVER_OK)
+	{
+		handler->initState = LINK_NO_INIT;
+		return DRIVER_ERROR;
+	}
+
+	if(xTaskCreate(LinkTask, "LinkTask", LINK_TASK_STACK, (void *) handler, LINK_TASK_PRIORITY, &handler->task) != pdPASS)
+	{
+		handler->initState = LINK_NO_INIT;
+		return DRIVER_ERROR;
+	}
+
+	handler->initState 		= LINK_INIT;
+
+	return DRIVER_OK;
+}
+
+/**
+  * @brief Start keeping connection up, first attempt is made at once.
+  * @param handler      LINK handle.
+  * @retval void
+  */
+void LINK_Start(LINKHandler_t *handler)
+{
+	handler->down 		= false;
+	handler->attempt 	= 0;
+	handler->enabled 	= true;
+}
+
+/**
+  * @brief Stop keeping connection up, outage that wasn't recovered isn't counted.
+  * @param handler      LINK handle.
+  * @retval void
+  */
+void LINK_Stop(LINKHandler_t *handler)
+{
+	handler->enabled 	= false;
+	handler->down 		= false;
+}
+
+/**
+  * @brief Lowest broken layer from cached state of modem, nothing is sent to gsm.
+  * @param handler      LINK handle.
+  * @retval LINKLayer_t LINK_LAYER_UP when connection with broker is up
+  */
+LINKLayer_t LINK_Check(LINKHandler_t *handler)
+{
+	uint32_t state = GSM_GetState(handler->gsmHandler);
+
+	if((state & GSM_STATE_REGISTERED) == 0) return LINK_LAYER_REGISTRATION;
+
+	/* Active context means attach also when gsm doesn't report +CGREG: */
+	if((state & (GSM_STATE_ATTACHED | GSM_STATE_PDP_ACTIVE)) == 0) return LINK_LAYER_ATTACH;
+	if((state & GSM_STATE_PDP_ACTIVE) == 0) return LINK_LAYER_PDP;
+	if((state & GSM_STATE_CONNECTED) == 0) return LINK_LAYER_SOCKET;
+	if(handler->mqttHandler->connectionState != MQTT_CONNECTED) return LINK_LAYER_SESSION;
+
+	return LINK_LAYER_UP;
+}
+
+/**
+  * @brief Keep connection up, repair broken layers when backoff expired.
+  * @param handler      LINK handle.
+  * @param event        Registration event came since last call.
+  * @retval DRIVERState_t DRIVER_OK when connection is up, DRIVER_TIMEOUT while backoff runs,
+  *         result of failed repair otherwise
+  */
+static DRIVERState_t process(LINKHandler_t *handler, bool event)
+{
+	if(!handler->enabled) return DRIVER_OK;
+
+	/* User of connection saw failure, cached state of connection could miss it */
+	if(handler->verify)
+	{
+		handler->verify = false;
+		GSM_CheckConnection(handler->gsmHandler);
+	}
+
+	LINKLayer_t layer = LINK_Check(handler);
+
+	if(layer == LINK_LAYER_UP)
+	{
+		/* Connection came back without manager (eg. user connected from console) */
+		if(handler->down) recovered(handler);
+		return DRIVER_OK;
+	}
+
+	/* Broker forgets session when connection is lost */
+	if(layer < LINK_LAYER_SESSION) handler->mqttHandler->connectionState = MQTT_DISCONNECTED;
+
+	if(!handler->down)
+	{
+		handler->down 			= true;
+		handler->brokenLayer 	= layer;
+		handler->downTime 		= TIME_GetTick();
+		handler->nextAttempt 	= handler->downTime;
+		handler->stats[layer].downCount++;
+	}
+	else if(event && (int32_t)(TIME_GetTick() - handler->nextAttempt) < 0)
+	{
+		/* Network came back or moved, waiting for rest of backoff would only delay recovery */
+		handler->nextAttempt 	= TIME_GetTick();
+		handler->attempt 		= 0;
+		handler->wakeCount++;
+	}
+
+	if((int32_t)(TIME_GetTick() - handler->nextAttempt) < 0) return DRIVER_TIMEOUT;
+
+	/* Resume from the lowest broken layer, layer that is repaired must be up after it */
+	DRIVERState_t state = DRIVER_OK;
+	while(layer != LINK_LAYER_UP)
+	{
+		state = repairLayer(handler, layer);
+
+		LINKLayer_t next = LINK_Check(handler);
+		if(state == DRIVER_OK && next <= layer) state = DRIVER_ERROR;
+		if(state != DRIVER_OK)
+		{
+			handler->stats[layer].failCount++;
+			break;
+		}
+		layer = next;
+	}
+
+	if(state == DRIVER_OK)
+	{
+		recovered(handler);
+		return DRIVER_OK;
+	}
+
+	handler->attempt++;
+	handler->nextAttempt = TIME_GetTick() + backoff(handler);
+	return state;
+}
+
+/**
+  * @brief Time that link task sleeps if no registration event comes.
+  * @param handler      LINK handle.
+  * @retval uint32_t time (in miliseconds)
+  */
+static uint32_t sleepTime(LINKHandler_t *handler)
+{
+	if(handler->enabled && handler->down)
+	{
+		int32_t left = (int32_t)(handler->nextAttempt - TIME_GetTick());
+		if(left <= 0) return 0;
+		if((uint32_t)left < LINK_POLL_PERIOD) return left;
+	}
+
+	return LINK_POLL_PERIOD;
+}
+
+/**
+  * @brief Report failure of operation on connection that looked up.
+  * @param handler      LINK handle.
+  * @param layer        LINK_LAYER_SESSION when broker didn't answer, lower layer when gsm
+  *                     reported error or didn't answer.
+  * @retval void
+  */
+void LINK_Fault(LINKHandler_t *handler, LINKLayer_t layer)
+{
+	if(handler == NULL || handler->initState != LINK_INIT) return;
+
+	if(layer >= LINK_LAYER_SESSION) handler->mqttHandler->connectionState = MQTT_DISCONNECTED;
+	else handler->verify = true;
+}
+
+/**
+  * @brief Name of layer.
+  * @param layer        Layer.
+  * @retval const char* name
+  */
+const char *LINK_Name(LINKLayer_t layer)
+{
+	return layer <= LINK_LAYER_UP ? linkName[layer] : "";
+}
+
+/**
+  * @brief Task that keeps connection up, it sleeps on registration events
+  */
+void LinkTask(void* pvParameters)
+{
+	LINKHandler_t *handler = pvParameters;
+
+	/* Gsm and mqtt functions called from this task take their buffers from its arena */
+	ARENA_Bind(handler->arenaHandler);
+
+	for(;;)
+	{
+		/* Events are read also while manager is stopped, so queue never keeps old ones */
+		bool event = false;
+		TickType_t wait = pdMS_TO_TICKS(sleepTime(handler));
+		while(xQueueReceive(handler->events, &handler->lastEvent, wait) == pdTRUE)
+		{
+			handler->eventCount++;
+			event = true;
+			wait = 0;
+		}
+
+		process(handler, event);
+	}
+}
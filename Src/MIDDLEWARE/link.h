@@ -0,0 +1,175 @@
+/**
+  ***************************************************************************************************
+  * @file    link.h
+  * @author  Valentina Denic
+  * @brief   This file contains all the functions prototypes for the connection manager
+  *          (recovery of connection with broker from the lowest broken layer).
+  ***************************************************************************************************
+  */
+
+#ifndef MIDDLEWARE_LINK_H_
+#define MIDDLEWARE_LINK_H_
+
+#include <gsm.h>
+#include <mqtt.h>
+#include <time.h>
+
+/* Delay before second attempt of recovery (in miliseconds), it doubles after every failed attempt */
+#ifndef LINK_BACKOFF_MIN
+#define LINK_BACKOFF_MIN			2000U
+#endif
+
+/* Longest delay between two attempts of recovery (in miliseconds) */
+#ifndef LINK_BACKOFF_MAX
+#define LINK_BACKOFF_MAX			120000U
+#endif
+
+/* Jitter of delay (in percents of it, both directions), devices that lost the same cell don't
+ * come back at the same moment */
+#ifndef LINK_JITTER
+#define LINK_JITTER					25U
+#endif
+
+/* Time for registration to network in one attempt (in miliseconds) */
+#ifndef LINK_REGISTER_TIMEOUT
+#define LINK_REGISTER_TIMEOUT		30000U
+#endif
+
+/* Time for PDP context and connection to server in one attempt (in miliseconds) */
+#ifndef LINK_CONNECT_TIMEOUT
+#define LINK_CONNECT_TIMEOUT		30000U
+#endif
+
+/* Number of registration events that wait for connection manager */
+#ifndef LINK_EVENT_QUEUE_LENGTH
+#define LINK_EVENT_QUEUE_LENGTH		4U
+#endif
+
+/* Longest sleep of link task (in miliseconds), drops without registration event (CLOSED,
+ * +PDP: DEACT, failed publish) are found at least this often */
+#ifndef LINK_POLL_PERIOD
+#define LINK_POLL_PERIOD			1000U
+#endif
+
+/* Stack of link task in words and its priority, it is below at task */
+#define LINK_TASK_STACK				768U
+#define LINK_TASK_PRIORITY			2U
+
+/**
+  * @brief  LINK INIT Status structures definition
+  */
+typedef enum
+{
+	LINK_INIT		= 0x00,				/*!< Link initialization status initialization ok		 */
+	LINK_NO_INIT	= 0x01				/*!< Link initialization status no initialization		 */
+} LINKInit_t;
+
+/**
+  * @brief  LINK layer definition, layers of connection with broker from the lowest one
+  */
+typedef enum
+{
+	LINK_LAYER_REGISTRATION	= 0x00,		/*!< Registration to network (+CREG)						 */
+	LINK_LAYER_ATTACH		= 0x01,		/*!< Attach to GPRS service (+CGREG, at+cgatt)				 */
+	LINK_LAYER_PDP			= 0x02,		/*!< Active PDP context (at+cgact)							 */
+	LINK_LAYER_SOCKET		= 0x03,		/*!< TCP connection with server (at+cipstart)				 */
+	LINK_LAYER_SESSION		= 0x04,		/*!< Mqtt session with broker (CONNECT packet)				 */
+	LINK_LAYER_UP			= 0x05		/*!< All layers are up, also number of layers				 */
+} LINKLayer_t;
+
+/**
+  * @brief  LINK layer statistics Structure definition, outages whose lowest broken layer was this one
+  */
+typedef struct __LINKStats_t
+{
+	uint32_t downCount;							/*!< Number of outages							 */
+
+	uint32_t recoverCount;						/*!< Number of outages that were recovered		 */
+
+	uint32_t failCount;							/*!< Attempts in which repair of layer failed	 */
+
+	uint32_t lastTime;							/*!< Last time to recover (in miliseconds)		 */
+
+	uint32_t maxTime;							/*!< Longest time to recover (in miliseconds)	 */
+
+	uint32_t totalTime;							/*!< Sum of times to recover (in miliseconds)	 */
+
+}LINKStats_t;
+
+/**
+  * @brief  LINK handle Structure definition
+  */
+typedef struct __LINKHandler_t
+{
+	LINKInit_t initState;						/*!< Initial state parameter								 */
+
+	gsmHandler_t *gsmHandler;					/*!< Gsm whose cached state is read							 */
+
+	MQTTHandler_t *mqttHandler;					/*!< Mqtt session that is kept								 */
+
+	const uint8_t *PDP;							/*!< PDP context that is activated, ends with '\r'			 */
+
+	ConnectSrvrInputStruct_t server;			/*!< Server (broker) to which connection is opened			 */
+
+	bool enabled;								/*!< Manager keeps connection up, set by LINK_Start()		 */
+
+	bool down;									/*!< Outage is being recovered								 */
+
+	bool verify;								/*!< Cached state of connection is read from gsm again		 */
+
+	LINKLayer_t brokenLayer;					/*!< Lowest broken layer when outage started				 */
+
+	uint32_t downTime;							/*!< Time when outage was found (in miliseconds)			 */
+
+	uint32_t attempt;							/*!< Number of failed attempts in this outage				 */
+
+	uint32_t nextAttempt;						/*!< Time of next attempt (in miliseconds)					 */
+
+	uint32_t random;							/*!< State of generator of jitter							 */
+
+	LINKStats_t stats[LINK_LAYER_UP];			/*!< Time to recover for every lowest broken layer			 */
+
+	QueueHandle_t events;						/*!< Registration events of gsm (GSMRegEvent_t)				 */
+
+	uint32_t eventCount;						/*!< Number of registration events							 */
+
+	uint32_t wakeCount;							/*!< Attempts started by event before backoff expired		 */
+
+	GSMRegEvent_t lastEvent;					/*!< Last registration event								 */
+
+	TaskHandle_t task;							/*!< Handle of link task									 */
+
+	ARENAHandler_t *arenaHandler;				/*!< Arena of link task, answers of repairs					 */
+
+}LINKHandler_t;
+
+/**
+  * @brief  LINK configuration Structure definition
+  */
+typedef struct __LINKConfig_t
+{
+	gsmHandler_t *gsmHandler;					/*!< Gsm handle structure					 */
+
+	MQTTHandler_t *mqttHandler;					/*!< Mqtt handle structure					 */
+
+	const uint8_t *PDP;							/*!< PDP context, ends with '\r'			 */
+
+	ConnectSrvrInputStruct_t server;			/*!< Server (broker)						 */
+
+	ARENAHandler_t *arenaHandler;				/*!< Initialized arena that link task binds	 */
+
+}LINKConfig_t;
+
+/* Initialization operation functions ****************************************************************/
+DRIVERState_t LINK_Init(LINKHandler_t *handler, LINKConfig_t *config);
+
+/* IO operation functions ****************************************************************************/
+void LINK_Start(LINKHandler_t *handler);
+void LINK_Stop(LINKHandler_t *handler);
+void LINK_Fault(LINKHandler_t *handler, LINKLayer_t layer);
+
+/* State functions ***********************************************************************************/
+LINKLayer_t LINK_Check(LINKHandler_t *handler);
+const char *LINK_Name(LINKLayer_t layer);
+
+#endif /* MIDDLEWARE_LINK_H_ */
@@ -30,6 +30,8 @@
     (#) Subscribe to the specified topic on broker with  MQTT_Subscribe() function
     (#) Ping server with PINGREQ Packet. The Server MUST send a PINGRESP Packet in response
      to a PINGREQ Packet. This is implemented using MQTT_PingReq() function.
+    (#) Connect, publish, subscribe and ping without waiting with *_Async variants
+     (MQTT_Publish_Async()...), caller polls or waits for completion handle (async.c).
 
   @endverbatim
   *
@@ -38,94 +40,42 @@
 
 /* Includes ---------------------------------------------------------------------------------------*/
 #include <mqtt.h>
+#include <driver_memory.h>
 
 
-/* Function to reverse arr[] from start to end */
 /**
-  * @brief Function which reverse elements in array.
-  * @param array    Array which elemnts will be reversed.
-  * @param start    Index of first element in array that will be inverted.
-  * @param end      Index of last element in array that will be inverted.
-  * @retval void
+  * @brief Function that writes bytes into packet as hexadecimal characters, every byte followed by space.
+  * @param packet    Packet in text format.
+  * @param data      Bytes to write.
+  * @param len       Number of bytes.
+  * @retval uint32_t Number of characters written in packet.
   */
-void rverseArray(uint8_t array[], int start, int end)
+HOT_FUNC static uint32_t putHex(uint8_t *packet, const uint8_t *data, uint32_t len)
 {
-    uint8_t temp;
-    while (start < end)
-    {
-        temp = array[start];
-        array[start] = array[end];
-        array[end] = temp;
-        start++;
-        end--;
-    }
+	static const uint8_t hexDigit[] = "0123456789abcdef";
+	uint32_t n = 0;
+
+	for(uint32_t i = 0; i < len; i++)
+	{
+		packet[n++] = hexDigit[data[i] >> 4];
+		packet[n++] = hexDigit[data[i] & 0x0F];
+		packet[n++] = ' ';
+	}
+
+	return n;
 }
 
 /**
-  * @brief Function for converting decimal number into hexadecimal.
-  * @param array    Array in which convertion will be stored.
-  * @param num    	Number that will be converted.
-  * @retval uint32_t Number of elements in array.
+  * @brief Function that writes two byte length (MSB first) into packet.
+  * @param packet    Packet in text format.
+  * @param len       Length to write.
+  * @retval uint32_t Number of characters written in packet.
   */
-uint32_t convDecToHexchar(uint8_t *array, uint32_t *num)
+HOT_FUNC static uint32_t putLength16(uint8_t *packet, uint32_t len)
 {
-	uint8_t i = 0;
-	uint8_t weight = 16;
-	uint8_t rest = *num % weight;
-	uint8_t result = *num / weight;
+	uint8_t bytes[2] = {(uint8_t)(len >> 8), (uint8_t)len};
 
-	/* Determine the number  and store in buffer */
-	while(1)
-	{
-		switch(rest){
-			case 10:
-				array[i] = 'a';
-				break;
-			case 11:
-				array[i] = 'b';
-				break;
-			case 12:
-				array[i] = 'c';
-				break;
-			case 13:
-				array[i] = 'd';
-				break;
-			case 14:
-				array[i] = 'e';
-				break;
-			case 15:
-				array[i] = 'f';
-				break;
-			default:
-				array[i] = rest + '0';
-				break;
-		}
-		if(result == 0)
-		{
-			i++;
-			break;
-		}
-		rest = result % weight;
-		result /= weight;
-		i++;
-	}
-
-	/* When number is less than f(15), then first 4 bits will
-	 * be zeros(MSB bits), and second 4 bits will be that number */
-	if(*num <= 15)
-	{
-		array[i++] = '0';
-	}
-	/* When number is greater than 255, we have to use 2 bytes for
-	 * representation of that number, but if number is less than
-	 * 4095 we dont use MSB bits of 2nd byte, yet we set zeros
-	 * for that bits */
-	if(*num >= 256 && *num <= 4095)
-	{
-		array[i++] = '0';
-	}
-
-	return i/2;
+	return putHex(packet, bytes, sizeof(bytes));
 }
 
 /**
@@ -134,7 +84,7 @@ uint32_t convDecToHexchar(uint8_t *array, uint32_t *num)
   * @param byteNo    Number of bytes in remaining length (number of elements in parameter array).
   * @retval void
   */
-void addCB(uint32_t *array, uint8_t byteNo)
+HOT_FUNC void addCB(uint32_t *array, uint8_t byteNo)
 {
 	if(byteNo == 1) return;
 
@@ -160,7 +110,7 @@ void addCB(uint32_t *array, uint8_t byteNo)
   * @param num    	Number that will be converted.
   * @retval uint32_t Number of elements in array.
   */
-uint32_t convDecToBase128(uint32_t *array, uint32_t *num)
+HOT_FUNC uint32_t convDecToBase128(uint32_t *array, uint32_t *num)
 {
 	uint32_t i = 0;
 	uint32_t weight = 128;
@@ -178,6 +128,69 @@ uint32_t convDecToBase128(uint32_t *array, uint32_t *num)
 	return i + 1;
 }
 
+/**
+  * @brief Function that writes remaining length of fixed header into packet.
+  * @param packet    Packet in text format.
+  * @param len       Remaining length in decimal format.
+  * @retval uint32_t Number of characters written in packet.
+  */
+HOT_FUNC static uint32_t putRemainingLength(uint8_t *packet, uint32_t len)
+{
+	uint32_t remainLen128[4] = {0};
+	uint8_t remainLenBytes[4];
+
+	uint8_t byteNo = convDecToBase128(remainLen128, &len);
+	addCB(remainLen128, byteNo);
+	for(uint8_t i = 0; i < byteNo; i++)
+	{
+		remainLenBytes[i] = (uint8_t)remainLen128[i];
+	}
+
+	return putHex(packet, remainLenBytes, byteNo);
+}
+
+/**
+  * @brief Send packet to broker over opened TCPIP connection.
+  * @param handler	   	Handle that contains everything about mqtt protocol (which gsm will be used and which console).
+  * @param buffer       Buffer for answer from gsm.
+  * @param bufferSize   Size of buffer for answer.
+  * @param packet       Packet in hexadecimal text format ended with "1a".
+  * @param packetSize   Number of characters in packet.
+  * @param promptTimeout Time for prompt '>' after "at+cipsend" (in miliseconds).
+  * @param packetTimeout Time for answer after packet (in miliseconds).
+  * @param expect       Answer that ends sending of packet successfully.
+  * @param priority     Queue of at engine, keep alive goes before waiting publishes.
+  * @retval MQTTState_t status
+  */
+static MQTTState_t sendPacket(MQTTHandler_t *handler, uint8_t *buffer, uint32_t bufferSize, const uint8_t *packet,
+							  uint32_t packetSize, uint32_t promptTimeout, uint32_t packetTimeout, const uint8_t *expect,
+							  ATPriority_t priority)
+{
+	/* Packet follows prompt in same chain, so nothing else is sent to gsm between them. Answer
+	 * outside of vocabulary of result codes comes from broker, not only from gsm */
+	ATCommand_t data = {.command = packet, .commandSize = packetSize, .expect = expect, .timeout = packetTimeout,
+						.timeoutClass = AT_MATCH_Code(expect) != AT_RESULT_NONE ? AT_TIMEOUT_SEND : AT_TIMEOUT_BROKER,
+						.response = buffer, .responseSize = bufferSize};
+	ATCommand_t send = {.command = (const uint8_t*)"at+cipsend\r", .commandSize = sizeof("at+cipsend\r") - 1,
+						.expect = (const uint8_t*)">", .timeout = promptTimeout, .timeoutClass = AT_TIMEOUT_PROMPT,
+						.response = buffer, .responseSize = bufferSize, .priority = priority, .next = &data};
+
+	DRIVER_TRACE(TRACE_MQTT_SEND, strtoul((const char*)packet, NULL, 16), packetSize);
+
+	/* Check response from gsm */
+	switch(AT_Execute(&send)){
+	case DRIVER_TIMEOUT:
+		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
+		return MQTT_TIMEOUT;
+	case DRIVER_ERROR:
+		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
+		return MQTT_ERROR;
+	default:
+		break;
+	}
+	return MQTT_OK;
+}
+
 /**
   * @brief Set hexadecimal format of sending packets to broker.
   * @param handler      MQTT handle.
@@ -187,45 +200,18 @@ MQTTState_t MQTT_SetHexFormat(MQTTHandler_t *handler)
 {
 	uint8_t buffer[100];
 
-	/* Reset buffer and his size */
-	memset(buffer,0,sizeof(buffer));
 	uint32_t size = 0;
 
-	/* Send command to send data to server */
-	DRIVER_GSM_Write(handler->gsmHandler, (const uint8_t*)"at+cipsendhex=1\r", sizeof("at+cipsendhex=1\r"));
-
-	/* Read response from gsm  and set response for user */
-	/* Take current time and check if timeout occured */
-	uint32_t tickstart = TIME_GetTick();
-	uint8_t errorOkTimeout = 2;
-	while(TIME_GetTick() - tickstart < 3000)
-	{
-		DRIVER_GSM_Read(handler->gsmHandler, buffer, &size);
-
-		/* Badly received response from gsm */
-		if(strstr((const char*)buffer,(const char*)"ERROR") != NULL)
-		{
-			errorOkTimeout = 1;
-			break;
-		}
-		else if(strstr((const char*)buffer,(const char*)"OK") != NULL)
-		{
-			errorOkTimeout = 0;
-			/* Successfully received response from gsm */
-			break;
-		}
-	}
-
 	/* Check response from gsm */
-	switch(errorOkTimeout){
-	case 2:
+	switch(AT_Command((const uint8_t*)"at+cipsendhex=1\r", sizeof("at+cipsendhex=1\r") - 1, buffer, sizeof(buffer), &size,
+					  3000, (const uint8_t*)"OK")){
+	case DRIVER_TIMEOUT:
 		return MQTT_TIMEOUT;
-	case 1:
+	case DRIVER_ERROR:
 		return MQTT_ERROR;
-	case 0:
+	default:
 		return MQTT_OK;
 	}
-	return MQTT_OK;
 }
 
 /**
@@ -249,6 +235,8 @@ MQTTState_t MQTT_Init(MQTTHandler_t *handler, MQTTConfig_t *config)
 
 	handler->initState 			= MQTT_INIT;
 
+	handler->connectionState 	= MQTT_DISCONNECTED;
+
 	handler->mqttPacket.variableHeader.packetID = 0;
 
 	handler->mqttPacket.payload.topicLen = 0;
@@ -266,101 +254,34 @@ MQTTState_t MQTT_Init(MQTTHandler_t *handler, MQTTConfig_t *config)
   */
 MQTTState_t MQTT_Connect(MQTTHandler_t *handler)
 {
-	/* Buffer for reading message */
-	uint8_t buffer[500] = {0};
-
-	/* How many characters were received */
-	uint32_t size = 0;
-
 	/* Checking if user send correct gsm and console */
 	if(handler->gsmHandler == NULL && handler->consoleHandler == NULL )
 	{
 		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\n Error: incorrect console and gsm modul!\r\n");
 		return DRIVER_ERROR;
 	}
-	DRIVER_GSM_Flush(handler->gsmHandler);
 
-	/* Send command to send data to server */
-	DRIVER_GSM_Write(handler->gsmHandler, (const uint8_t*)"at+cipsend\r", sizeof("at+cipsend\r"));
-
-	/* Read response from gsm  and set response for user */
-	/* Take current time and check if timeout occured */
-	uint32_t tickstart = TIME_GetTick();
-	uint8_t errorOkTimeout = 2;
-	while(TIME_GetTick() - tickstart < 10000)
+	/* Answer from gsm is taken from arena of calling task */
+	ARENAHandler_t *arena 	= ARENA_Current();
+	ARENAMark_t scope 		= ARENA_Mark(arena);
+	uint8_t *buffer 		= ARENA_Alloc(arena, MQTT_RESPONSE_SIZE);
+	if(buffer == NULL)
 	{
-		DRIVER_GSM_Read(handler->gsmHandler, buffer, &size);
-
-		/* Badly received response from gsm */
-		if(strstr((const char*)buffer,(const char*)"ERROR") != NULL)
-		{
-			errorOkTimeout = 1;
-			break;
-		}
-		else if(strstr((const char*)buffer,(const char*)">") != NULL)
-		{
-			errorOkTimeout = 0;
-			/* Successfully received response from gsm */
-			break;
-		}
-	}
-
-	/* Check response from gsm */
-	switch(errorOkTimeout){
-	case 2:
-		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(handler->gsmHandler);
-		return MQTT_TIMEOUT;
-	case 1:
-		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(handler->gsmHandler);
+		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\n Error: not enough scratch memory for answer!\r\n");
 		return MQTT_ERROR;
-	case 0:
-		break;
 	}
 
-	/* Send command to send data to server */
-	DRIVER_GSM_Write(handler->gsmHandler, (const uint8_t*)"10 0c 00 04 4d 51 54 54 04 02 0f 00 00 00 1a",
-			sizeof("10 0c 00 04 4d 51 54 54 04 02 0f 00 00 00 1a"));
-
-	/* Read response from gsm  and set response for user */
-	/* Take current time and check if timeout occured */
-	tickstart = TIME_GetTick();
-	errorOkTimeout = 2;
-	while(TIME_GetTick() - tickstart < 3000)
+	/* Send CONNECT packet to broker */
+	MQTTState_t status = sendPacket(handler, buffer, MQTT_RESPONSE_SIZE, (const uint8_t*)"10 0c 00 04 4d 51 54 54 04 02 0f 00 00 00 1a",
+									sizeof("10 0c 00 04 4d 51 54 54 04 02 0f 00 00 00 1a") - 1, 10000, 3000, (const uint8_t*)"SEND OK",
+									AT_PRIORITY_CONTROL);
+	if(status == MQTT_OK)
 	{
-		DRIVER_GSM_Read(handler->gsmHandler, buffer, &size);
-
-		/* Badly received response from gsm */
-		if(strstr((const char*)buffer,(const char*)"ERROR") != NULL)
-		{
-			errorOkTimeout = 1;
-			break;
-		}
-		else if(strstr((const char*)buffer,(const char*)"OK") != NULL)
-		{
-			errorOkTimeout = 0;
-			/* Successfully received response from gsm */
-			break;
-		}
-	}
-
-	/* Check response from gsm */
-	switch(errorOkTimeout){
-	case 2:
-		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(handler->gsmHandler);
-		return MQTT_TIMEOUT;
-	case 1:
-		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(handler->gsmHandler);
-		return MQTT_ERROR;
-	case 0:
+		handler->connectionState = MQTT_CONNECTED;
 		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nSuccessfully connected to broker! \r\n");
-		DRIVER_GSM_Flush(handler->gsmHandler);
-		return MQTT_OK;
 	}
-	return MQTT_OK;
+	ARENA_Release(arena, scope);
+	return status;
 }
 
 /**
@@ -370,104 +291,37 @@ MQTTState_t MQTT_Connect(MQTTHandler_t *handler)
   */
 MQTTState_t MQTT_Disconnect(MQTTHandler_t *handler)
 {
-	/* Buffer for reading message */
-	uint8_t buffer[500] = {0};
-
-	/* How many characters were received */
-	uint32_t size = 0;
-
 	/* Checking if user send correct gsm and console */
 	if(handler->gsmHandler == NULL && handler->consoleHandler == NULL )
 	{
 		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\n Error: incorrect console and gsm modul!\r\n");
 		return DRIVER_ERROR;
 	}
-	DRIVER_GSM_Flush(handler->gsmHandler);
-
-	/* Send command to send data to server */
-	DRIVER_GSM_Write(handler->gsmHandler, (const uint8_t*)"at+cipsend\r", sizeof("at+cipsend\r"));
 
-	/* Read response from gsm  and set response for user */
-	/* Take current time and check if timeout occured */
-	uint32_t tickstart = TIME_GetTick();
-	uint8_t errorOkTimeout = 2;
-	while(TIME_GetTick() - tickstart < 10000)
+	/* Answer from gsm is taken from arena of calling task */
+	ARENAHandler_t *arena 	= ARENA_Current();
+	ARENAMark_t scope 		= ARENA_Mark(arena);
+	uint8_t *buffer 		= ARENA_Alloc(arena, MQTT_RESPONSE_SIZE);
+	if(buffer == NULL)
 	{
-		DRIVER_GSM_Read(handler->gsmHandler, buffer, &size);
-
-		/* Badly received response from gsm */
-		if(strstr((const char*)buffer,(const char*)"ERROR") != NULL)
-		{
-			errorOkTimeout = 1;
-			break;
-		}
-		else if(strstr((const char*)buffer,(const char*)">") != NULL)
-		{
-			errorOkTimeout = 0;
-			/* Successfully received response from gsm */
-			break;
-		}
-	}
-
-	/* Check response from gsm */
-	switch(errorOkTimeout){
-	case 2:
-		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(handler->gsmHandler);
-		return MQTT_TIMEOUT;
-	case 1:
-		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(handler->gsmHandler);
+		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\n Error: not enough scratch memory for answer!\r\n");
 		return MQTT_ERROR;
-	case 0:
-		break;
 	}
 
-	/* Send command to send data to server */
-	DRIVER_GSM_Write(handler->gsmHandler, (const uint8_t*)"e0 00 1a", sizeof("e0 00 1a"));
-
-	/* Read response from gsm  and set response for user */
-	/* Take current time and check if timeout occured */
-	tickstart = TIME_GetTick();
-	errorOkTimeout = 2;
-	while(TIME_GetTick() - tickstart < 3000)
+	/* Send DISCONNECT packet to broker */
+	MQTTState_t status = sendPacket(handler, buffer, MQTT_RESPONSE_SIZE, (const uint8_t*)"e0 00 1a", sizeof("e0 00 1a") - 1,
+									10000, 3000, (const uint8_t*)"SEND OK", AT_PRIORITY_CONTROL);
+	if(status == MQTT_OK)
 	{
-		DRIVER_GSM_Read(handler->gsmHandler, buffer, &size);
-
-		/* Badly received response from gsm */
-		if(strstr((const char*)buffer,(const char*)"ERROR") != NULL)
-		{
-			errorOkTimeout = 1;
-			break;
-		}
-		else if(strstr((const char*)buffer,(const char*)"OK") != NULL)
-		{
-			errorOkTimeout = 0;
-			/* Successfully received response from gsm */
-			break;
-		}
-	}
-
-	/* Check response from gsm */
-	switch(errorOkTimeout){
-	case 2:
-		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(handler->gsmHandler);
-		return MQTT_TIMEOUT;
-	case 1:
-		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(handler->gsmHandler);
-		return MQTT_ERROR;
-	case 0:
 		if(handler->mqttPacket.variableHeader.packetID != 0) handler->mqttPacket.variableHeader.packetID--;
 		else handler->mqttPacket.variableHeader.packetID = 0;
 		handler->mqttPacket.payload.topicLen = 0;
 		memset(handler->mqttPacket.payload.topicName,0,sizeof(handler->mqttPacket.payload.topicName));
+		handler->connectionState = MQTT_DISCONNECTED;
 		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nSuccessfully disconnected from broker! \r\n");
-		DRIVER_GSM_Flush(handler->gsmHandler);
-		return MQTT_OK;
 	}
-	return MQTT_OK;
+	ARENA_Release(arena, scope);
+	return status;
 }
 
 /**
@@ -480,12 +334,6 @@ MQTTState_t MQTT_Disconnect(MQTTHandler_t *handler)
   */
 MQTTState_t MQTT_Publish(MQTTHandler_t *handler, uint32_t timeout,const uint8_t *topicName, const uint8_t *message){
 
-	/* Buffer for reading message */
-	uint8_t buffer[2000] = {0};
-
-	/* How many characters were received */
-	uint32_t size = 0;
-
 	if(topicName == NULL || message == NULL)
 	{
 		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\n Error: incorrect input arguments! Please try again with correct arguments!\r\n");
@@ -497,255 +345,67 @@ MQTTState_t MQTT_Publish(MQTTHandler_t *handler, uint32_t timeout,const uint8_t
 		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\n Error: incorrect console and gsm modul!\r\n");
 		return DRIVER_ERROR;
 	}
-	DRIVER_GSM_Flush(handler->gsmHandler);
-
-	/** Set topic **/
 
-	uint32_t topic[2000] 	= {0};
-	uint8_t topicHex[2000] 	= {0};
-	uint8_t topicLen[10] 	= {0};
-	uint8_t topicHexByteNo 	= 0;
 	uint32_t topicLenDec	= strlen((const char*)topicName); // length of topic in decimal number
-	uint32_t i 				= 0;
-	uint32_t indexHexTopic	= 0;
+	uint32_t msgLenDec 		= strlen((const char*)message);
 
 	if(strchr((char*)topicName,'\r') != NULL )
 	{	/* Length of topic characters without '\r' */
 		topicLenDec--;
 	}
-
-	/* Convert ASCII code to integer value */
-	for(; i != topicLenDec; i++)
-	{
-		topic[i] = topicName[i] - '\0';
-	}
-
-	i = 0;
-	for(;i != topicLenDec; i++)
-	{
-		topicHexByteNo = convDecToHexchar(topicHex + indexHexTopic, &topic[i]);
-
-        /* reverse order of characters in array */
-        rverseArray(topicHex + indexHexTopic, 0, topicHexByteNo);
-        indexHexTopic += 2;
-        topicHex[indexHexTopic++] = ' ';
-	}
-
-	/* Convert size from integer type to characters, base 16 */
-    uint8_t topicByteNo = convDecToHexchar(topicLen, &topicLenDec);
-
-    /* reverse order of characters in array */
-    rverseArray(topicLen, 0, topicByteNo*2 - 1);
-
-    /* Set message to publish */
-
-	uint32_t msg[2000] 		= {0};
-	uint8_t msgHex[2000] 	= {0};
-	uint8_t msgLen[10] 		= {0};
-	uint8_t msgHexByteNo 	= 0;
-    uint32_t msgLenDec 		= strlen((const char*)message);
-	uint32_t indexHexMsg	= 0;
-	i 						= 0;
-
 	if(strchr((char*)message,'\r') != NULL )
 	{	/* Length of message characters without '\r' */
 		msgLenDec--;
 	}
-
-	/* Convert ASCII code to integer value */
-	for(; i != msgLenDec; i++)
+	if(topicLenDec > MQTT_TOPIC_MAX_SIZE || msgLenDec > MQTT_MESSAGE_MAX_SIZE)
 	{
-		msg[i] = message[i] - '\0';
+		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\n Error: topic or message is too long!\r\n");
+		return MQTT_ERROR;
 	}
 
-	i = 0;
-	for(;i != msgLenDec; i++)
+	/* Packet is taken from packet pool, answer from gsm from arena of calling task */
+	ARENAHandler_t *arena 	= ARENA_Current();
+	ARENAMark_t scope 		= ARENA_Mark(arena);
+	uint8_t *msgToSend 		= POOL_Alloc(MQTT_HEX_PACKET_SIZE(topicLenDec + msgLenDec));
+	uint8_t *buffer 		= ARENA_Alloc(arena, MQTT_RESPONSE_SIZE);
+	if(msgToSend == NULL || buffer == NULL)
 	{
-		msgHexByteNo = convDecToHexchar(msgHex + indexHexMsg, &msg[i]);
-
-        /* reverse order of characters in array */
-        rverseArray(msgHex + indexHexMsg, 0, msgHexByteNo);
-        indexHexMsg += 2;
-        msgHex[indexHexMsg++] = ' ';
+		POOL_Free(msgToSend);
+		ARENA_Release(arena, scope);
+		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\n Error: not enough scratch memory for packet!\r\n");
+		return MQTT_ERROR;
 	}
 
-	/* Convert size from integer type to characters, base 16 */
-    uint8_t msgByteNo = convDecToHexchar(msgLen,&msgLenDec);
-
-    /* reverse order of characters in array */
-    rverseArray(msgLen, 0, msgByteNo*2 - 1);
-
-    /* Set remaining length */
-    uint32_t remainLen128[10] = {0};
-    uint32_t remainLenDec = topicLenDec + msgLenDec + 2; /* need to be added plus 2 if we are using length of message when we are sending */
-
-    uint8_t byteNo = convDecToBase128(remainLen128, &remainLenDec);
-    addCB(remainLen128, byteNo);
-    uint8_t index128 = 0;
-    uint8_t index16 = 0;
-    uint8_t n = 0;
-    uint8_t remainLen16[20];
-    memset(remainLen16,0,sizeof(remainLen16));
-    for(; index128 != byteNo; index128++)
-    {
-    	n = convDecToHexchar(remainLen16 + index16,&remainLen128[index128]);
-        /* reverse order of characters in array */
-        rverseArray(remainLen16 + index16, 0, n);
-    	index16 += 2;
-    	remainLen16[index16++] = ' ';
-    }
-
-    /* Set message to send to server */
-	uint8_t msgToSend[4000];
-	uint32_t msgSize = 0;
-	memset(msgToSend,0,sizeof(msgToSend));
-
 	/* Set control field */
-	strcat((char*)msgToSend,(const char*)"30 ");
-	msgSize += 3;
+	uint32_t msgSize 	= 0;
+	uint8_t controlField = 0x30;
+	msgSize += putHex(msgToSend + msgSize, &controlField, 1);
 
 	/* Set remaining length */
-	strcat((char*)msgToSend,(const char*)remainLen16);
-	msgSize += index16;
+	msgSize += putRemainingLength(msgToSend + msgSize, topicLenDec + msgLenDec + 2); /* plus 2 for length of topic */
 
-	/* Set topic length */
-	if(topicByteNo == 1)
-	{
-		msgToSend[msgSize++] = '0';
-		msgToSend[msgSize++] = '0';
-		msgToSend[msgSize++] = ' ';
-		strcat((char*)msgToSend,(const char*)topicLen);
-		msgSize += 2;
-	}
-	if(topicByteNo == 2)
-	{
-		msgToSend[msgSize++] = topicLen[0];
-		msgToSend[msgSize++] = topicLen[1];
-		msgToSend[msgSize++] = ' ';
-		msgToSend[msgSize++] = topicLen[2];
-		msgToSend[msgSize++] = topicLen[3];
-	}
-
-	msgToSend[msgSize++] = ' ';
-
-	/* Set topic name */
-	strcat((char*)msgToSend,(const char*)topicHex);
-	msgSize += indexHexTopic;
-
-//	/* Set message length */
-//	if(msgByteNo == 1)
-//	{
-//		msgToSend[msgSize++] = '0';
-//		msgToSend[msgSize++] = '0';
-//		msgToSend[msgSize++] = ' ';
-//		strcat((char*)msgToSend,(const char*)msgLen);
-//		msgSize += 2;
-//		msgToSend[msgSize++] = ' ';
-//	}
-//	if(msgByteNo == 2)
-//	{
-//		msgToSend[msgSize++] = msgLen[0];
-//		msgToSend[msgSize++] = msgLen[1];
-//		msgToSend[msgSize++] = ' ';
-//		msgToSend[msgSize++] = msgLen[2];
-//		msgToSend[msgSize++] = msgLen[3];
-//		msgToSend[msgSize++] = ' ';
-//	}
+	/* Set topic length and topic name */
+	msgSize += putLength16(msgToSend + msgSize, topicLenDec);
+	msgSize += putHex(msgToSend + msgSize, topicName, topicLenDec);
 
 	/* Set message */
-	strcat((char*)msgToSend,(const char*)msgHex);
-	msgSize += indexHexMsg;
+	msgSize += putHex(msgToSend + msgSize, message, msgLenDec);
 
 	msgToSend[msgSize++] = '1';
 	msgToSend[msgSize++] = 'a';
 
-	/******   SEND COMMAND FOR TCP/IP SENDING DATA   *****/
-	/* Send command to send data to server */
-	DRIVER_GSM_Write(handler->gsmHandler, (const uint8_t*)"at+cipsend\r", sizeof("at+cipsend\r"));
-
-	/* Read response from gsm  and set response for user */
-	/* Take current time and check if timeout occured */
-	uint32_t tickstart = TIME_GetTick();
-	uint8_t errorOkTimeout = 2;
-	while(TIME_GetTick() - tickstart < 3000)
-	{
-		DRIVER_GSM_Read(handler->gsmHandler, buffer, &size);
-
-		/* Badly received response from gsm */
-		if(strstr((const char*)buffer,(const char*)"ERROR") != NULL)
-		{
-			errorOkTimeout = 1;
-			break;
-		}
-		else if(strstr((const char*)buffer,(const char*)">") != NULL)
-		{
-			errorOkTimeout = 0;
-			/* Successfully received response from gsm */
-			break;
-		}
-	}
-
-	/* Check response from gsm */
-	switch(errorOkTimeout){
-	case 2:
-		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(handler->gsmHandler);
-		return MQTT_TIMEOUT;
-	case 1:
-		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(handler->gsmHandler);
-		return MQTT_ERROR;
-	case 0:
-		break;
-	}
-
-	/******    SEND PUBLISH COMMAND      ********/
-	/* Reset buffer and his size */
-	memset(buffer,0,sizeof(buffer));
-	size = 0;
-
 	/* Publish message on the topic to server */
-	DRIVER_GSM_Write(handler->gsmHandler, msgToSend, msgSize);
 	// 30 13 00 03 67 73 6d 00 05 48 45 4c 4c 4f 1a - -t "gsm" -m "HELLO" -- test!
-
-	/* Read response from gsm  and set response for user */
-	/* Take current time and check if timeout occured */
-	tickstart = TIME_GetTick();
-	errorOkTimeout = 2;
-	while(TIME_GetTick() - tickstart < 10000)
+	MQTTState_t status = sendPacket(handler, buffer, MQTT_RESPONSE_SIZE, msgToSend, msgSize, 3000, 10000,
+									(const uint8_t*)"SEND OK", AT_PRIORITY_BULK);
+	if(status == MQTT_OK)
 	{
-		DRIVER_GSM_Read(handler->gsmHandler, buffer, &size);
-
-		/* Badly received response from gsm */
-		if(strstr((const char*)buffer,(const char*)"ERROR") != NULL)
-		{
-			errorOkTimeout = 1;
-			break;
-		}
-		else if(strstr((const char*)buffer,(const char*)"OK") != NULL)
-		{
-			errorOkTimeout = 0;
-			/* Successfully received response from gsm */
-			break;
+		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nMessage published on the specified topic! \r\n");
 		}
-	}
 
-	/* Check response from gsm */
-	switch(errorOkTimeout){
-	case 2:
-		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(handler->gsmHandler);
-		return MQTT_TIMEOUT;
-	case 1:
-		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(handler->gsmHandler);
-		return MQTT_ERROR;
-	case 0:
-		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nMessage published on the specified topic! \r\n");
-		DRIVER_GSM_Flush(handler->gsmHandler);
-		return MQTT_OK;
-	}
-	return MQTT_OK;
+	POOL_Free(msgToSend);
+	ARENA_Release(arena, scope);
+	return status;
 
 }
 
@@ -758,251 +418,81 @@ MQTTState_t MQTT_Publish(MQTTHandler_t *handler, uint32_t timeout,const uint8_t
   */
 MQTTState_t MQTT_Subscribe(MQTTHandler_t *handler, uint32_t timeout, uint8_t *topicName)
 {
-	/* Buffer for reading message */
-	uint8_t buffer[2000] = {0};
-
-	/* How many characters were received */
-	uint32_t size = 0;
-
 	/* Checking if user send correct gsm and console */
 	if(handler->gsmHandler == NULL && handler->consoleHandler == NULL )
 	{
 		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\n Error: incorrect console and gsm modul!\r\n");
 		return DRIVER_ERROR;
 	}
-	DRIVER_GSM_Flush(handler->gsmHandler);
 
-	uint8_t topicASCII[2000] = {0};
-	uint32_t topic[2000] 	= {0};
-	uint8_t topicHex[3000] 	= {0};
-	uint8_t topicLen[10] 	= {0};
-	uint8_t topicHexByteNo 	= 0;
 	uint32_t topicLenDec	= strlen((const char*)topicName); // length of topic in decimal number
-	uint32_t i 				= 0;
-	uint32_t indexHexTopic	= 0;
 
 	if(strchr((char*)topicName,'\r') != NULL )
 	{	/* Length of topic characters without '\r' */
 		topicLenDec--;
 	}
-
-	/* Convert ASCII code to integer value */
-	for(; i != topicLenDec; i++)
+	if(topicLenDec > MQTT_TOPIC_MAX_SIZE)
 	{
-		topic[i] = topicName[i] - '\0';
-		topicASCII[i] = topicName[i];
+		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\n Error: topic is too long!\r\n");
+		return MQTT_ERROR;
 	}
 
-	i = 0;
-	for(;i != topicLenDec; i++)
+	/* Packet is taken from packet pool, answer from gsm from arena of calling task */
+	ARENAHandler_t *arena 	= ARENA_Current();
+	ARENAMark_t scope 		= ARENA_Mark(arena);
+	uint8_t *msgToSend 		= POOL_Alloc(MQTT_HEX_PACKET_SIZE(topicLenDec));
+	uint8_t *buffer 		= ARENA_Alloc(arena, MQTT_RESPONSE_SIZE);
+	if(msgToSend == NULL || buffer == NULL)
 	{
-		topicHexByteNo = convDecToHexchar(topicHex + indexHexTopic, &topic[i]);
-
-        /* reverse order of characters in array */
-        rverseArray(topicHex + indexHexTopic, 0, topicHexByteNo);
-        indexHexTopic += 2;
-        topicHex[indexHexTopic++] = ' ';
+		POOL_Free(msgToSend);
+		ARENA_Release(arena, scope);
+		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\n Error: not enough scratch memory for packet!\r\n");
+		return MQTT_ERROR;
 	}
 
-	/* Convert size from integer type to characters, base 16 */
-    uint8_t topicByteNo = convDecToHexchar(topicLen, &topicLenDec);
-
-    /* reverse order of characters in array */
-    rverseArray(topicLen, 0, topicByteNo*2 - 1);
-
-    /* Convert packetID from decimal to hexadecimal format */
 	handler->mqttPacket.variableHeader.packetID++;
-	uint8_t packeIDHex[10] 		= {0};
-
-	/* Convert size from integer type to characters, base 16 */
-    uint8_t PacketIDHexByteNo = convDecToHexchar(packeIDHex, &handler->mqttPacket.variableHeader.packetID);
-
-    /* reverse order of characters in array */
-    rverseArray(packeIDHex, 0, PacketIDHexByteNo*2 - 1);
-
-    /* Set remaining length */
-    uint32_t remainLen128[10] = {0};
-    uint32_t remainLenDec = topicLenDec + 2 + 2 + 1; // first 2 is for packet ID number of bytes and 2nd 2 is for length of topic, plus 1 is for requested  QoS byte
-
-    uint8_t byteNo = convDecToBase128(remainLen128, &remainLenDec);
-    addCB(remainLen128, byteNo);
-    uint8_t index128 = 0;
-    uint8_t index16 = 0;
-    uint8_t n = 0;
-    uint8_t remainLen16[20];
-    memset(remainLen16,0,sizeof(remainLen16));
-    for(; index128 != byteNo; index128++)
-    {
-    	n = convDecToHexchar(remainLen16 + index16,&remainLen128[index128]);
-        /* reverse order of characters in array */
-        rverseArray(remainLen16 + index16, 0, n);
-    	index16 += 2;
-    	remainLen16[index16++] = ' ';
-    }
-
-    /* Set message to send to server */
-	uint8_t msgToSend[1000];
-	uint32_t msgSize = 0;
-	memset(msgToSend,0,sizeof(msgToSend));
 
 	/* Set control field */
-	strcat((char*)msgToSend,(const char*)"82 ");
-	msgSize += 3;
+	uint32_t msgSize 	= 0;
+	uint8_t controlField = 0x82;
+	msgSize += putHex(msgToSend + msgSize, &controlField, 1);
 
 	/* Set remaining length */
-	strcat((char*)msgToSend,(const char*)remainLen16);
-	msgSize += index16;
+	msgSize += putRemainingLength(msgToSend + msgSize, topicLenDec + 2 + 2 + 1); // first 2 is for packet ID number of bytes and 2nd 2 is for length of topic, plus 1 is for requested  QoS byte
 
 	/* Set packet ID */
-	if(PacketIDHexByteNo == 1)
-	{
-		msgToSend[msgSize++] = '0';
-		msgToSend[msgSize++] = '0';
-		msgToSend[msgSize++] = ' ';
-		strcat((char*)msgToSend,(const char*)packeIDHex);
-		msgSize += 2;
-	}
-	if(PacketIDHexByteNo == 2)
-	{
-		msgToSend[msgSize++] = packeIDHex[0];
-		msgToSend[msgSize++] = packeIDHex[1];
-		msgToSend[msgSize++] = ' ';
-		msgToSend[msgSize++] = packeIDHex[2];
-		msgToSend[msgSize++] = packeIDHex[3];
-	}
-
-	msgToSend[msgSize++] = ' ';
-
-	/* Set topic length */
-	if(topicByteNo == 1)
-	{
-		msgToSend[msgSize++] = '0';
-		msgToSend[msgSize++] = '0';
-		msgToSend[msgSize++] = ' ';
-		strcat((char*)msgToSend,(const char*)topicLen);
-		msgSize += 2;
-	}
-	if(topicByteNo == 2)
-	{
-		msgToSend[msgSize++] = topicLen[0];
-		msgToSend[msgSize++] = topicLen[1];
-		msgToSend[msgSize++] = ' ';
-		msgToSend[msgSize++] = topicLen[2];
-		msgToSend[msgSize++] = topicLen[3];
-	}
+	msgSize += putLength16(msgToSend + msgSize, handler->mqttPacket.variableHeader.packetID);
 
-	msgToSend[msgSize++] = ' ';
-
-	/* Set topic name */
-	strcat((char*)msgToSend,(const char*)topicHex);
-	msgSize += indexHexTopic;
+	/* Set topic length and topic name */
+	msgSize += putLength16(msgToSend + msgSize, topicLenDec);
+	msgSize += putHex(msgToSend + msgSize, topicName, topicLenDec);
 
 	/* Set requested QoS byte */
-	strcat((char*)msgToSend,(const char*)"00 ");
-	msgSize += 3;
+	uint8_t requestedQoS = QoS_0;
+	msgSize += putHex(msgToSend + msgSize, &requestedQoS, 1);
 
 	msgToSend[msgSize++] = '1';
 	msgToSend[msgSize++] = 'a';
 
-	/* Reset buffer and his size */
-	memset(buffer,0,sizeof(buffer));
-	size = 0;
-
-	/******   SEND COMMAND FOR TCP/IP SENDING DATA   *****/
-	/* Send command to send data to server */
-	DRIVER_GSM_Write(handler->gsmHandler, (const uint8_t*)"at+cipsend\r", sizeof("at+cipsend\r"));
-
-	/* Read response from gsm  and set response for user */
-	/* Take current time and check if timeout occured */
-	uint32_t tickstart = TIME_GetTick();
-	uint8_t errorOkTimeout = 2;
-	while(TIME_GetTick() - tickstart < 3000)
+	MQTTState_t status = sendPacket(handler, buffer, MQTT_RESPONSE_SIZE, msgToSend, msgSize, 3000, 10000,
+									(const uint8_t*)"SEND OK", AT_PRIORITY_CONTROL);
+	if(status == MQTT_OK)
 	{
-		DRIVER_GSM_Read(handler->gsmHandler, buffer, &size);
-
-		/* Badly received response from gsm */
-		if(strstr((const char*)buffer,(const char*)"ERROR") != NULL)
-		{
-			errorOkTimeout = 1;
-			break;
-		}
-		else if(strstr((const char*)buffer,(const char*)">") != NULL)
-		{
-			errorOkTimeout = 0;
-			/* Successfully received response from gsm */
-			break;
+		memcpy(handler->mqttPacket.payload.topicName, topicName, topicLenDec);
+		handler->mqttPacket.payload.topicName[topicLenDec] = '\0';
+		handler->mqttPacket.payload.topicLen = topicLenDec;
+		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nSubscribed successfully on the specified topic! \r\n");
 		}
-	}
-
-	/* Check response from gsm */
-	switch(errorOkTimeout){
-	case 2:
-		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(handler->gsmHandler);
-		return MQTT_TIMEOUT;
-	case 1:
-		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(handler->gsmHandler);
-		return MQTT_ERROR;
-	case 0:
-		break;
-	}
-
-	/******    SEND PUBLISH COMMAND      ********/
-	/* Reset buffer and his size */
-	memset(buffer,0,sizeof(buffer));
-	size = 0;
-
-	/* Publish message on the topic to server */
-	DRIVER_GSM_Write(handler->gsmHandler, msgToSend, msgSize);
-	// 30 13 00 03 67 73 6d 00 05 48 45 4c 4c 4f 1a - -t "gsm" -m "HELLO" -- test!
-
-	/* Read response from gsm  and set response for user */
-	/* Take current time and check if timeout occured */
-	tickstart = TIME_GetTick();
-	errorOkTimeout = 2;
-	while(TIME_GetTick() - tickstart < 10000)
+	else
 	{
-		DRIVER_GSM_Read(handler->gsmHandler, buffer, &size);
-
-		/* Badly received response from gsm */
-		if(strstr((const char*)buffer,(const char*)"ERROR") != NULL)
-		{
-			errorOkTimeout = 1;
-			break;
-		}
-		else if(strstr((const char*)buffer,(const char*)"OK") != NULL)
-		{
-			errorOkTimeout = 0;
-			/* Successfully received response from gsm */
-			break;
-		}
-	}
-
-	/* Check response from gsm */
-	switch(errorOkTimeout){
-	case 2:
-		handler->mqttPacket.variableHeader.packetID = 0;
-		handler->mqttPacket.payload.topicLen = 0;
-		memset(handler->mqttPacket.payload.topicName,0,sizeof(handler->mqttPacket.payload.topicName));
-		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(handler->gsmHandler);
-		return MQTT_TIMEOUT;
-	case 1:
 		handler->mqttPacket.variableHeader.packetID = 0;
 		handler->mqttPacket.payload.topicLen = 0;
-		memset(handler->mqttPacket.payload.topicName,0,sizeof(handler->mqttPacket.payload.topicName));
-		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(handler->gsmHandler);
-		return MQTT_ERROR;
-	case 0:
-		strcpy((char*)handler->mqttPacket.payload.topicName,(const char*)topicASCII);
-		handler->mqttPacket.payload.topicLen = topicLenDec;
-		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nSubscribed successfully on the specified topic! \r\n");
-		DRIVER_GSM_Flush(handler->gsmHandler);
-		return MQTT_OK;
+		handler->mqttPacket.payload.topicName[0] = '\0';
 	}
-	return MQTT_OK;
+
+	POOL_Free(msgToSend);
+	ARENA_Release(arena, scope);
+	return status;
 
 }
 
@@ -1014,105 +504,123 @@ MQTTState_t MQTT_Subscribe(MQTTHandler_t *handler, uint32_t timeout, uint8_t *to
   */
 MQTTState_t MQTT_PingReq(MQTTHandler_t *handler, uint32_t timeout)
 {
-	/* Buffer for reading message */
-	uint8_t buffer[500] = {0};
-
-	/* How many characters were received */
-	uint32_t size = 0;
-
 	/* Checking if user send correct gsm and console */
 	if(handler->gsmHandler == NULL && handler->consoleHandler == NULL )
 	{
 		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\n Error: incorrect console and gsm modul!\r\n");
 		return DRIVER_ERROR;
 	}
-	DRIVER_GSM_Flush(handler->gsmHandler);
-
-	/* Send command to send data to server */
-	DRIVER_GSM_Write(handler->gsmHandler, (const uint8_t*)"at+cipsend\r", sizeof("at+cipsend\r"));
 
-	/* Read response from gsm  and set response for user */
-	/* Take current time and check if timeout occured */
-	uint32_t tickstart = TIME_GetTick();
-	uint8_t errorOkTimeout = 2;
-	while(TIME_GetTick() - tickstart < timeout)
+	/* Answer from gsm is taken from arena of calling task */
+	ARENAHandler_t *arena 	= ARENA_Current();
+	ARENAMark_t scope 		= ARENA_Mark(arena);
+	uint8_t *buffer 		= ARENA_Alloc(arena, MQTT_RESPONSE_SIZE);
+	if(buffer == NULL)
 	{
-		DRIVER_GSM_Read(handler->gsmHandler, buffer, &size);
-
-		/* Badly received response from gsm */
-		if(strstr((const char*)buffer,(const char*)"ERROR") != NULL)
-		{
-			errorOkTimeout = 1;
-			break;
-		}
-		else if(strstr((const char*)buffer,(const char*)">") != NULL)
-		{
-			errorOkTimeout = 0;
-			/* Successfully received response from gsm */
-			break;
-		}
+		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\n Error: not enough scratch memory for answer!\r\n");
+		return MQTT_ERROR;
 	}
 
-	/* Check response from gsm */
-	switch(errorOkTimeout){
-	case 2:
-		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(handler->gsmHandler);
-		return MQTT_TIMEOUT;
-	case 1:
-		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(handler->gsmHandler);
-		return MQTT_ERROR;
-	case 0:
-		break;
+	/* Send PINGReq to broker, wait for 208 UTF-8 character that respresent PINGResponse, answer from broker */
+	MQTTState_t status = sendPacket(handler, buffer, MQTT_RESPONSE_SIZE, (const uint8_t*)"c0 00 1a", sizeof("c0 00 1a") - 1,
+									timeout, 10000, (const uint8_t*)"\xd0", AT_PRIORITY_KEEPALIVE);
+	if(status == MQTT_OK)
+	{
+		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nSuccessfully connected to broker! \r\n");
 	}
+	ARENA_Release(arena, scope);
+	return status;
+}
 
-	/* Reset buffer and his size */
-	memset(buffer,0,sizeof(buffer));
-	size = 0;
+/**
+  * @brief Run MQTT_Connect() in async task.
+  * @param operation    Operation prepared by MQTT_Connect_Async().
+  * @retval uint32_t MQTTState_t of function
+  */
+static uint32_t runConnect(ASYNCOperation_t *operation)
+{
+	return MQTT_Connect(operation->handler);
+}
 
-	/* Send PINGReq to broker */
-	DRIVER_GSM_Write(handler->gsmHandler, (const uint8_t*)"c0 00 1a",
-			sizeof("c0 00 1a"));
+/**
+  * @brief Run MQTT_Publish() in async task.
+  * @param operation    Operation prepared by MQTT_Publish_Async().
+  * @retval uint32_t MQTTState_t of function
+  */
+static uint32_t runPublish(ASYNCOperation_t *operation)
+{
+	return MQTT_Publish(operation->handler, operation->timeout, operation->argument[0], operation->argument[1]);
+}
 
-	/* Read response from gsm  and set response for user */
-	/* Take current time and check if timeout occured */
-	tickstart = TIME_GetTick();
-	errorOkTimeout = 2;
-	while(TIME_GetTick() - tickstart < 10000)
-	{
-		DRIVER_GSM_Read(handler->gsmHandler, buffer, &size);
+/**
+  * @brief Run MQTT_Subscribe() in async task.
+  * @param operation    Operation prepared by MQTT_Subscribe_Async().
+  * @retval uint32_t MQTTState_t of function
+  */
+static uint32_t runSubscribe(ASYNCOperation_t *operation)
+{
+	return MQTT_Subscribe(operation->handler, operation->timeout, (uint8_t*)operation->argument[0]);
+}
 
-		/* Badly received response from gsm */
-		if(strstr((const char*)buffer,(const char*)"ERROR") != NULL)
-		{
-			errorOkTimeout = 1;
-			break;
-		}
-		/* Wait for 208 UTF-8 character that respresent PINGResponse, answer from broker */
-		else if(strchr((const char*)buffer,208) != NULL)
-		{
-			errorOkTimeout = 0;
-			/* Successfully received response from gsm */
-			break;
-		}
-	}
+/**
+  * @brief Run MQTT_PingReq() in async task.
+  * @param operation    Operation prepared by MQTT_PingReq_Async().
+  * @retval uint32_t MQTTState_t of function
+  */
+static uint32_t runPingReq(ASYNCOperation_t *operation)
+{
+	return MQTT_PingReq(operation->handler, operation->timeout);
+}
 
-	/* Check response from gsm */
-	switch(errorOkTimeout){
-	case 2:
-		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-		DRIVER_GSM_Flush(handler->gsmHandler);
-		return MQTT_TIMEOUT;
-	case 1:
-		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nError received from gsm! Try again or restart system! \r\n");
-		DRIVER_GSM_Flush(handler->gsmHandler);
-		return MQTT_ERROR;
-	case 0:
-		DRIVER_CONSOLE_Put(handler->consoleHandler,(const uint8_t*)"\r\nSuccessfully connected to broker! \r\n");
-		DRIVER_GSM_Flush(handler->gsmHandler);
-		return MQTT_OK;
-	}
-	return MQTT_OK;
+/**
+  * @brief Connect to broker without waiting, see MQTT_Connect().
+  * @param handler	   	Handle that contains everything about mqtt protocol (which gsm will be used and which console).
+  * @param operation    Completion handle, result is MQTTState_t.
+  * @retval MQTTState_t MQTT_OK when operation is queued
+  */
+MQTTState_t MQTT_Connect_Async(MQTTHandler_t *handler, ASYNCOperation_t *operation)
+{
+	return ASYNC_Start(operation, runConnect, handler, 0, NULL, NULL) == DRIVER_OK ? MQTT_OK : MQTT_ERROR;
+}
+
+/**
+  * @brief Publish message without waiting, see MQTT_Publish().
+  * @param handler	   	Handle that contains everything about mqtt protocol (which gsm will be used and which console).
+  * @param timeout      Timeout period for console.
+  * @param topicName    Name of topic, it must live until operation is done.
+  * @param message      Message, it must live until operation is done.
+  * @param operation    Completion handle, result is MQTTState_t.
+  * @retval MQTTState_t MQTT_OK when operation is queued
+  */
+MQTTState_t MQTT_Publish_Async(MQTTHandler_t *handler, uint32_t timeout, const uint8_t *topicName, const uint8_t *message,
+							   ASYNCOperation_t *operation)
+{
+	if(topicName == NULL || message == NULL) return MQTT_ERROR;
+
+	return ASYNC_Start(operation, runPublish, handler, timeout, topicName, message) == DRIVER_OK ? MQTT_OK : MQTT_ERROR;
+}
+
+/**
+  * @brief Subscribe to topic without waiting, see MQTT_Subscribe().
+  * @param handler	   	Handle that contains everything about mqtt protocol (which gsm will be used and which console).
+  * @param timeout      Timeout period for console.
+  * @param topicName    Name of topic, it must live until operation is done.
+  * @param operation    Completion handle, result is MQTTState_t.
+  * @retval MQTTState_t MQTT_OK when operation is queued
+  */
+MQTTState_t MQTT_Subscribe_Async(MQTTHandler_t *handler, uint32_t timeout, uint8_t *topicName, ASYNCOperation_t *operation)
+{
+	return ASYNC_Start(operation, runSubscribe, handler, timeout, topicName, NULL) == DRIVER_OK ? MQTT_OK : MQTT_ERROR;
+}
 
+/**
+  * @brief Ping broker without waiting, see MQTT_PingReq().
+  * @param handler	   	Handle that contains everything about mqtt protocol (which gsm will be used and which console).
+  * @param timeout      Time for prompt after "at+cipsend" (in miliseconds).
+  * @param operation    Completion handle, result is MQTTState_t.
+  * @retval MQTTState_t MQTT_OK when operation is queued
+  */
+MQTTState_t MQTT_PingReq_Async(MQTTHandler_t *handler, uint32_t timeout, ASYNCOperation_t *operation)
+{
+	return ASYNC_Start(operation, runPingReq, handler, timeout, NULL, NULL) == DRIVER_OK ? MQTT_OK : MQTT_ERROR;
 }
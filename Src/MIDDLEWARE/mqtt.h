@@ -16,12 +16,32 @@
 #include <driver_console.h>
 #include <driver_common.h>
 #include <driver_gsm.h>
+#include <at.h>
+#include <async.h>
+#include <arena.h>
+#include <pool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 #include <stdint.h>
 
+/* Largest topic and message that can be published or subscribed to (in characters) */
+#define MQTT_TOPIC_MAX_SIZE				1000U
+#define MQTT_MESSAGE_MAX_SIZE			1000U
+
+/* Size of buffer for answer from gsm while sending packet */
+#define MQTT_RESPONSE_SIZE				2000U
+
+/* Every byte of packet is sent as two hexadecimal characters and space, fixed header,
+ * lengths and packet ID take less than 16 bytes, plus "1a" at the end */
+#define MQTT_HEX_PACKET_SIZE(len)		(((len) + 16U) * 3U + 2U)
+
+/* Largest packet is taken from packet pool, so it must fit in one block */
+#if MQTT_HEX_PACKET_SIZE(MQTT_TOPIC_MAX_SIZE + MQTT_MESSAGE_MAX_SIZE) > POOL_PACKET_BLOCK_SIZE
+#error "MQTT packet doesn't fit in block of packet pool"
+#endif
+
 /* Currently not using this defines */
 #define M_HEX 0x4d
 #define Q_HEX 0x51
@@ -51,6 +71,15 @@ typedef enum
   MQTT_NO_INIT	= 0x01					/*!< MQTT initialization status no initialization 		 */
 } MQTTInit_t;
 
+/**
+  * @brief  MQTT broker connection state definition
+  */
+typedef enum
+{
+  MQTT_DISCONNECTED	= 0x00,				/*!< Connect packet was not accepted by broker or disconnect was sent	 */
+  MQTT_CONNECTED	= 0x01				/*!< Broker accepted connect packet									 */
+} MQTTConnection_t;
+
 /**
   * @brief  MQTT PACKET COMMAND TYPE Status structures definition
   */
@@ -279,6 +308,7 @@ typedef struct __MQTTHandler_t
 	DRIVERConsoleHandler_t 	*consoleHandler;
 	MQTTPacket_t 			mqttPacket;
 	MQTTInit_t 				initState;
+	MQTTConnection_t 		connectionState;
 
 } MQTTHandler_t;
 
@@ -303,4 +333,11 @@ MQTTState_t MQTT_Publish(MQTTHandler_t *handler, uint32_t timeout,const uint8_t
 MQTTState_t MQTT_Unsubscribe(MQTTHandler_t *handler, uint32_t timeout);
 MQTTState_t MQTT_PingReq(MQTTHandler_t *handler, uint32_t timeout);
 
+/* Asynchronous operation functions, caller doesn't wait (async.c) *************************************************************************/
+MQTTState_t MQTT_Connect_Async(MQTTHandler_t *handler, ASYNCOperation_t *operation);
+MQTTState_t MQTT_Publish_Async(MQTTHandler_t *handler, uint32_t timeout, const uint8_t *topicName, const uint8_t *message,
+							   ASYNCOperation_t *operation);
+MQTTState_t MQTT_Subscribe_Async(MQTTHandler_t *handler, uint32_t timeout, uint8_t *topicName, ASYNCOperation_t *operation);
+MQTTState_t MQTT_PingReq_Async(MQTTHandler_t *handler, uint32_t timeout, ASYNCOperation_t *operation);
+
 #endif /* MIDDLEWARE_MQTT_H_ */
@@ -0,0 +1,188 @@
+/**
+  ********************************************************************************************
+  * @file    pool.c
+  * @author  Valentina Denic
+  * @brief   MIDDLEWARE for fixed block memory pools.
+  *          This file provides firmware functions to manage the following
+  *          functionalities of the block pools.
+  *           + Initialization function
+  *           + Allocation of block from the smallest fitting size class
+  *           + Return of block to its pool
+  *           + Usage statistics of every size class
+  *
+  @verbatim
+ ==============================================================================================
+                        ##### How to use this driver #####
+ ==============================================================================================
+  [..]
+    AT command, SMS record and MQTT packet buffers have known upper size, so they are
+    taken from pools of equal blocks instead of heap. Every size class keeps list of
+    free blocks, taking and returning block is done in constant time and memory can
+    not fragment. Pools can be used from tasks and from interrupts whose priority is
+    not above configMAX_SYSCALL_INTERRUPT_PRIORITY.
+    The pool driver can be used as follows:
+
+    (#) Initialize all pools once with POOL_Init() function, before scheduler is started
+    (#) Take block with POOL_Alloc() (memory is not zeroed) or POOL_Calloc()
+        (memory is zeroed), block comes from smallest class that fits requested size
+    (#) Give block back with POOL_Free() function
+    (#) Read usage, high water mark and failure counter of size class from handle
+        returned by POOL_GetHandler() function
+  @endverbatim
+  *
+  *********************************************************************************************
+  */
+
+/* Includes ----------------------------------------------------------------------------------*/
+#include <pool.h>
+
+/* Storage of size classes */
+static uint8_t poolATStorage[POOL_AT_BLOCK_SIZE * POOL_AT_BLOCK_NUMBER] __attribute__((aligned(POOL_ALIGNMENT)));
+static uint8_t poolSMSStorage[POOL_SMS_BLOCK_SIZE * POOL_SMS_BLOCK_NUMBER] __attribute__((aligned(POOL_ALIGNMENT)));
+static uint8_t poolPacketStorage[POOL_PACKET_BLOCK_SIZE * POOL_PACKET_BLOCK_NUMBER] __attribute__((aligned(POOL_ALIGNMENT)));
+
+/* Handles of size classes, ordered from smallest to largest block */
+static POOLHandler_t poolHandlers[POOL_CLASS_NUMBER] =
+{
+	{POOL_NO_INIT, poolATStorage, POOL_AT_BLOCK_SIZE, POOL_AT_BLOCK_NUMBER, NULL, 0, 0, 0},
+	{POOL_NO_INIT, poolSMSStorage, POOL_SMS_BLOCK_SIZE, POOL_SMS_BLOCK_NUMBER, NULL, 0, 0, 0},
+	{POOL_NO_INIT, poolPacketStorage, POOL_PACKET_BLOCK_SIZE, POOL_PACKET_BLOCK_NUMBER, NULL, 0, 0, 0}
+};
+
+/**
+  * @brief Initialize all size classes, every block is put in free list of its class.
+  * @param void
+  * @retval POOLState_t status
+  */
+POOLState_t POOL_Init(void)
+{
+	for(uint32_t i = 0; i < POOL_CLASS_NUMBER; i++)
+	{
+		POOLHandler_t *handler = &poolHandlers[i];
+
+		/* Block must hold free list link and keep next block aligned */
+		if(handler->blockSize < sizeof(POOLBlock_t) || (handler->blockSize % POOL_ALIGNMENT) != 0)
+		{
+			handler->initState = POOL_NO_INIT;
+			return POOL_ERROR;
+		}
+
+		handler->freeList = NULL;
+
+		/* Link blocks from last to first so first block is taken first */
+		for(uint32_t j = handler->blockNumber; j > 0; j--)
+		{
+			POOLBlock_t *block = (POOLBlock_t*)(handler->storage + (j - 1) * handler->blockSize);
+			block->next = handler->freeList;
+			handler->freeList = block;
+		}
+
+		handler->used 		= 0;
+
+		handler->highWater 	= 0;
+
+		handler->failCount 	= 0;
+
+		handler->initState 	= POOL_INIT;
+	}
+
+	return POOL_OK;
+}
+
+/**
+  * @brief Take block from the smallest size class that fits, content of block is not initialized.
+  * @param size         Number of bytes.
+  * @retval void* start of block or NULL when size is too big or fitting pool is empty
+  */
+void *POOL_Alloc(uint32_t size)
+{
+	POOLHandler_t *handler = NULL;
+
+	for(uint32_t i = 0; i < POOL_CLASS_NUMBER; i++)
+	{
+		if(size <= poolHandlers[i].blockSize)
+		{
+			handler = &poolHandlers[i];
+			break;
+		}
+	}
+
+	if(handler == NULL || handler->initState != POOL_INIT) return NULL;
+
+	UBaseType_t savedState = taskENTER_CRITICAL_FROM_ISR();
+
+	POOLBlock_t *block = handler->freeList;
+
+	if(block == NULL)
+	{
+		handler->failCount++;
+	}
+	else
+	{
+		handler->freeList = block->next;
+		handler->used++;
+
+		if(handler->used > handler->highWater) handler->highWater = handler->used;
+	}
+
+	taskEXIT_CRITICAL_FROM_ISR(savedState);
+
+	return block;
+}
+
+/**
+  * @brief Take zero initialized block from the smallest size class that fits.
+  * @param size         Number of bytes.
+  * @retval void* start of block or NULL when size is too big or fitting pool is empty
+  */
+void *POOL_Calloc(uint32_t size)
+{
+	void *block = POOL_Alloc(size);
+
+	if(block != NULL) memset(block, 0, size);
+
+	return block;
+}
+
+/**
+  * @brief Give block back to the pool it was taken from.
+  * @param block        Block returned from POOL_Alloc() or POOL_Calloc(), NULL is ignored.
+  * @retval void
+  */
+void POOL_Free(void *block)
+{
+	if(block == NULL) return;
+
+	for(uint32_t i = 0; i < POOL_CLASS_NUMBER; i++)
+	{
+		POOLHandler_t *handler = &poolHandlers[i];
+		uint8_t *address = (uint8_t*)block;
+
+		if(address < handler->storage || address >= handler->storage + handler->blockSize * handler->blockNumber) continue;
+
+		/* Pointer inside block is not accepted, it would corrupt free list */
+		if((uint32_t)(address - handler->storage) % handler->blockSize != 0) return;
+
+		UBaseType_t savedState = taskENTER_CRITICAL_FROM_ISR();
+
+		((POOLBlock_t*)block)->next = handler->freeList;
+		handler->freeList = (POOLBlock_t*)block;
+		handler->used--;
+
+		taskEXIT_CRITICAL_FROM_ISR(savedState);
+
+		return;
+	}
+}
+
+/**
+  * @brief Get handle of size class, used to read usage statistics.
+  * @param poolClass    Size class.
+  * @retval POOLHandler_t* pool handle or NULL for wrong class
+  */
+POOLHandler_t *POOL_GetHandler(POOLClass_t poolClass)
+{
+	if(poolClass >= POOL_CLASS_NUMBER) return NULL;
+
+	return &poolHandlers[poolClass];
+}
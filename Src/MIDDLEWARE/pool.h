@@ -0,0 +1,108 @@
+/**
+  ***************************************************************************************************
+  * @file    pool.h
+  * @author  Valentina Denic
+  * @brief   This file contains all the functions prototypes for the fixed block memory
+  *          pools (AT command, SMS record and MQTT packet buffers).
+  ***************************************************************************************************
+  */
+
+#ifndef MIDDLEWARE_POOL_H_
+#define MIDDLEWARE_POOL_H_
+
+#include <driver_common.h>
+
+/* Every block starts on this boundary */
+#define POOL_ALIGNMENT				8U
+
+/* Size classes, block size in bytes and number of blocks of every class */
+#ifndef POOL_AT_BLOCK_SIZE
+#define POOL_AT_BLOCK_SIZE			64U
+#endif
+#ifndef POOL_AT_BLOCK_NUMBER
+#define POOL_AT_BLOCK_NUMBER		16U
+#endif
+#ifndef POOL_SMS_BLOCK_SIZE
+#define POOL_SMS_BLOCK_SIZE			256U
+#endif
+#ifndef POOL_SMS_BLOCK_NUMBER
+#define POOL_SMS_BLOCK_NUMBER		24U
+#endif
+#ifndef POOL_PACKET_BLOCK_SIZE
+#define POOL_PACKET_BLOCK_SIZE		6144U
+#endif
+#ifndef POOL_PACKET_BLOCK_NUMBER
+#define POOL_PACKET_BLOCK_NUMBER	2U
+#endif
+
+/**
+  * @brief  POOL INIT Status structures definition
+  */
+typedef enum
+{
+  POOL_INIT			= 0x00,				/*!< Pool initialization status initialization ok		 */
+  POOL_NO_INIT		= 0x01				/*!< Pool initialization status no initialization		 */
+} POOLInit_t;
+
+/**
+  * @brief  POOL Status structures definition
+  */
+typedef enum
+{
+	POOL_OK     	= 0x00,				/*!< Pool status ok		 */
+	POOL_ERROR	    = 0x01				/*!< Pool status error		 */
+} POOLState_t;
+
+/**
+  * @brief  POOL size classes definition, ordered from smallest to largest block
+  */
+typedef enum
+{
+	POOL_CLASS_AT		= 0x00,			/*!< Blocks for AT commands				 */
+	POOL_CLASS_SMS		= 0x01,			/*!< Blocks for SMS records				 */
+	POOL_CLASS_PACKET	= 0x02,			/*!< Blocks for MQTT packets			 */
+	POOL_CLASS_NUMBER	= 0x03			/*!< Number of size classes				 */
+} POOLClass_t;
+
+/**
+  * @brief  POOL free block, link is kept inside the block itself
+  */
+typedef struct __POOLBlock_t
+{
+	struct __POOLBlock_t *next;				/*!< Next free block or NULL		 */
+
+}POOLBlock_t;
+
+/**
+  * @brief  POOL handle Structure definition, one handle per size class
+  */
+typedef struct __POOLHandler_t
+{
+	POOLInit_t initState;					/*!< Initial state parameter						 */
+
+	uint8_t *storage;						/*!< Start of memory divided in blocks				 */
+
+	uint32_t blockSize;						/*!< Size of one block in bytes					 */
+
+	uint32_t blockNumber;					/*!< Number of blocks in pool						 */
+
+	POOLBlock_t *freeList;					/*!< First free block								 */
+
+	uint32_t used;							/*!< Number of blocks currently taken				 */
+
+	uint32_t highWater;						/*!< Largest number of blocks taken at once		 */
+
+	uint32_t failCount;						/*!< Number of allocations refused, pool was empty	 */
+
+}POOLHandler_t;
+
+/* Initialization operation functions ****************************************************************/
+POOLState_t POOL_Init(void);
+
+/* IO operation functions ****************************************************************************/
+void *POOL_Alloc(uint32_t size);
+void *POOL_Calloc(uint32_t size);
+void POOL_Free(void *block);
+POOLHandler_t *POOL_GetHandler(POOLClass_t poolClass);
+
+#endif /* MIDDLEWARE_POOL_H_ */
@@ -0,0 +1,203 @@
+/**
+  ********************************************************************************************
+  * @file    runtime.c
+  * @author  Valentina Denic
+  * @brief   MIDDLEWARE for run time statistics of tasks.
+  *          This file provides firmware functions to manage the following
+  *          functionalities of the run time statistics.
+  *           + Initialization of high resolution counter for FreeRTOS
+  *           + Sampling cpu usage, stack high water mark, state and priority of tasks
+  *           + Formatting statistics for console or for host tools
+  *
+  @verbatim
+ ==============================================================================================
+                        ##### How to use this driver #####
+ ==============================================================================================
+  [..]
+    FreeRTOS counts time spent in every task with counter from portGET_RUN_TIME_COUNTER_VALUE().
+    That counter is made from DWT cycle counter of the core, which is much faster than
+    tick of the system, so even tasks that run for a few microseconds are visible.
+    The run time driver can be used as follows:
+
+    (#) Map portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() to RUNTIME_CounterInit() and
+        portGET_RUN_TIME_COUNTER_VALUE() to RUNTIME_GetCounter() in FreeRTOSConfig.h
+    (#) Call RUNTIME_GetCounter() from tick hook, so wrap of cycle counter is never missed
+    (#) Declare a RUNTIMEHandler_t handle structure and initialize it with RUNTIME_Init()
+    (#) Take statistics with RUNTIME_Sample() function, cpu usage is computed for time
+        passed from previous sample
+    (#) Write statistics in buffer with RUNTIME_Format() function, either as table for
+        console or as comma separated lines for host tools
+  @endverbatim
+  *
+  *********************************************************************************************
+  */
+
+/* Includes ----------------------------------------------------------------------------------*/
+#include <runtime.h>
+
+/* Cycle counter extended to 64 bits and its last read value */
+static uint64_t runtimeCycles;
+static uint32_t runtimeLastCycles;
+
+/**
+  * @brief Initialize run time handle.
+  * @param handler      RUNTIME handle.
+  * @retval RUNTIMEState_t status
+  */
+RUNTIMEState_t RUNTIME_Init(RUNTIMEHandler_t *handler)
+{
+	if(handler == NULL) return RUNTIME_ERROR;
+
+	memset(handler, 0, sizeof(RUNTIMEHandler_t));
+
+	return RUNTIME_OK;
+}
+
+/**
+  * @brief Start DWT cycle counter, called by FreeRTOS when scheduler is started.
+  * @param void
+  * @retval void
+  */
+void RUNTIME_CounterInit(void)
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->LAR = 0xC5ACCE55;					/* Unlock DWT registers on Cortex-M7 */
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	runtimeCycles 		= 0;
+	runtimeLastCycles 	= 0;
+}
+
+/**
+  * @brief Get value of run time counter, can be called from tasks and interrupts.
+  * @param void
+  * @retval uint32_t run time counter
+  */
+uint32_t RUNTIME_GetCounter(void)
+{
+	UBaseType_t savedState = taskENTER_CRITICAL_FROM_ISR();
+
+	uint32_t cycles = DWT->CYCCNT;
+	runtimeCycles += (uint32_t)(cycles - runtimeLastCycles);
+	runtimeLastCycles = cycles;
+	uint32_t counter = (uint32_t)(runtimeCycles >> RUNTIME_COUNTER_SHIFT);
+
+	taskEXIT_CRITICAL_FROM_ISR(savedState);
+
+	return counter;
+}
+
+/**
+  * @brief Take statistics of all tasks, cpu usage is computed for time since previous sample.
+  * @param handler      RUNTIME handle.
+  * @retval RUNTIMEState_t status
+  */
+RUNTIMEState_t RUNTIME_Sample(RUNTIMEHandler_t *handler)
+{
+	TaskStatus_t status[RUNTIME_MAX_TASKS];
+	uint32_t cpuUsage[RUNTIME_MAX_TASKS];
+	uint32_t totalRunTime = 0;
+
+	if(handler == NULL) return RUNTIME_ERROR;
+
+	UBaseType_t taskNumber = uxTaskGetSystemState(status, RUNTIME_MAX_TASKS, &totalRunTime);
+	if(taskNumber == 0) return RUNTIME_ERROR;
+
+	uint32_t window = totalRunTime - handler->totalRunTime;
+
+	for(UBaseType_t i = 0; i < taskNumber; i++)
+	{
+		/* Run time of task at previous sample, task that didn't exist then starts from zero */
+		uint32_t previousRunTime = 0;
+		for(UBaseType_t j = 0; j < handler->taskNumber; j++)
+		{
+			if(handler->tasks[j].status.xTaskNumber == status[i].xTaskNumber)
+			{
+				previousRunTime = handler->tasks[j].status.ulRunTimeCounter;
+				break;
+			}
+		}
+
+		uint32_t taskWindow = status[i].ulRunTimeCounter - previousRunTime;
+		cpuUsage[i] = window == 0 ? 0 : (uint32_t)(((uint64_t)taskWindow * 10000U) / window);
+	}
+
+	/* Previous sample is written over only after all tasks are compared with it */
+	for(UBaseType_t i = 0; i < taskNumber; i++)
+	{
+		handler->tasks[i].status 	= status[i];
+		handler->tasks[i].cpuUsage 	= cpuUsage[i];
+	}
+
+	handler->taskNumber 	= taskNumber;
+	handler->totalRunTime 	= totalRunTime;
+	handler->windowRunTime 	= window;
+
+	return RUNTIME_OK;
+}
+
+/**
+  * @brief Get name of task state.
+  * @param state        State of task.
+  * @retval const char* name of state
+  */
+static const char *stateName(eTaskState state)
+{
+	switch(state){
+	case eRunning:		return "Running";
+	case eReady:		return "Ready";
+	case eBlocked:		return "Blocked";
+	case eSuspended:	return "Suspended";
+	case eDeleted:		return "Deleted";
+	default:			return "Invalid";
+	}
+}
+
+/**
+  * @brief Write statistics from last sample in buffer.
+  * @param handler      RUNTIME handle.
+  * @param format       Table for console or comma separated lines for host tools.
+  * @param buffer       Buffer for statistics, RUNTIME_REPORT_SIZE bytes is enough for all tasks.
+  * @param size         Size of buffer.
+  * @retval uint32_t number of written characters without null character
+  */
+uint32_t RUNTIME_Format(RUNTIMEHandler_t *handler, RUNTIMEFormat_t format, uint8_t *buffer, uint32_t size)
+{
+	uint32_t length = 0;
+	int written = 0;
+
+	if(handler == NULL || buffer == NULL || size == 0) return 0;
+
+	if(format == RUNTIME_FORMAT_TABLE)
+		written = snprintf((char*)buffer, size, "\r\n%-16s %7s %6s %-10s %4s\r\n", "Task", "CPU%", "Stack", "State", "Prio");
+	else
+		written = snprintf((char*)buffer, size, "top,window,%lu\r\n", (unsigned long)handler->windowRunTime);
+
+	for(UBaseType_t i = 0; written > 0 && (length + written) < size; i++)
+	{
+		length += written;
+		if(i == handler->taskNumber) break;
+
+		RUNTIMETask_t *task = &handler->tasks[i];
+		if(format == RUNTIME_FORMAT_TABLE)
+			written = snprintf((char*)buffer + length, size - length, "%-16s %4lu.%02lu %6lu %-10s %4lu\r\n",
+					task->status.pcTaskName,
+					(unsigned long)(task->cpuUsage / 100U), (unsigned long)(task->cpuUsage % 100U),
+					(unsigned long)task->status.usStackHighWaterMark,
+					stateName(task->status.eCurrentState),
+					(unsigned long)task->status.uxCurrentPriority);
+		else
+			written = snprintf((char*)buffer + length, size - length, "top,%s,%lu.%02lu,%lu,%s,%lu\r\n",
+					task->status.pcTaskName,
+					(unsigned long)(task->cpuUsage / 100U), (unsigned long)(task->cpuUsage % 100U),
+					(unsigned long)task->status.usStackHighWaterMark,
+					stateName(task->status.eCurrentState),
+					(unsigned long)task->status.uxCurrentPriority);
+	}
+
+	/* Last line didn't fit, buffer ends after last complete line */
+	buffer[length] = '\0';
+
+	return length;
+}
@@ -0,0 +1,82 @@
+/**
+  ***************************************************************************************************
+  * @file    runtime.h
+  * @author  Valentina Denic
+  * @brief   This file contains all the functions prototypes for the run time statistics
+  *          of tasks (cpu usage, stack high water mark, state and priority).
+  ***************************************************************************************************
+  */
+
+#ifndef MIDDLEWARE_RUNTIME_H_
+#define MIDDLEWARE_RUNTIME_H_
+
+#include <driver_common.h>
+#include <stdio.h>
+
+/* Run time counter is cycle counter divided by 2^RUNTIME_COUNTER_SHIFT, at 400MHz it
+ * counts with 1.5625MHz and 32 bit value wraps after about 45 minutes */
+#define RUNTIME_COUNTER_SHIFT		8U
+
+/* Largest number of tasks that can be shown */
+#define RUNTIME_MAX_TASKS			16U
+
+/* Period of refreshing top view on console (in miliseconds) */
+#define RUNTIME_REFRESH_PERIOD		2000U
+
+/* Size of buffer that holds formatted statistics of all tasks */
+#define RUNTIME_REPORT_SIZE			(RUNTIME_MAX_TASKS * 64U + 128U)
+
+/**
+  * @brief  RUNTIME Status structures definition
+  */
+typedef enum
+{
+	RUNTIME_OK     	= 0x00,				/*!< Run time status ok		 */
+	RUNTIME_ERROR	= 0x01				/*!< Run time status error	 */
+} RUNTIMEState_t;
+
+/**
+  * @brief  RUNTIME report format definition
+  */
+typedef enum
+{
+	RUNTIME_FORMAT_TABLE	= 0x00,		/*!< Table for reading on console						 */
+	RUNTIME_FORMAT_MACHINE	= 0x01		/*!< One comma separated line per task, for host tools	 */
+} RUNTIMEFormat_t;
+
+/**
+  * @brief  RUNTIME statistics of one task in last sampling window
+  */
+typedef struct
+{
+	TaskStatus_t status;					/*!< State, priority, stack high water mark and run time of task	 */
+
+	uint32_t cpuUsage;						/*!< Cpu usage in window in hundredths of percent					 */
+
+}RUNTIMETask_t;
+
+/**
+  * @brief  RUNTIME handle Structure definition
+  */
+typedef struct __RUNTIMEHandler_t
+{
+	RUNTIMETask_t tasks[RUNTIME_MAX_TASKS];		/*!< Statistics of tasks from last sample					 */
+
+	UBaseType_t taskNumber;						/*!< Number of valid entries in tasks						 */
+
+	uint32_t totalRunTime;						/*!< Run time counter at last sample						 */
+
+	uint32_t windowRunTime;						/*!< Length of last sampling window in run time counts	 */
+
+}RUNTIMEHandler_t;
+
+/* Initialization operation functions ****************************************************************/
+RUNTIMEState_t RUNTIME_Init(RUNTIMEHandler_t *handler);
+void RUNTIME_CounterInit(void);
+
+/* IO operation functions ****************************************************************************/
+uint32_t RUNTIME_GetCounter(void);
+RUNTIMEState_t RUNTIME_Sample(RUNTIMEHandler_t *handler);
+uint32_t RUNTIME_Format(RUNTIMEHandler_t *handler, RUNTIMEFormat_t format, uint8_t *buffer, uint32_t size);
+
+#endif /* MIDDLEWARE_RUNTIME_H_ */
@@ -0,0 +1,732 @@
+/**
+  ********************************************************************************************
+  * @file    sms_pdu.c
+  * @author  Valentina Denic
+  * @brief   MIDDLEWARE for sms in pdu mode.
+  *          This file provides firmware functions to manage the following
+  *          functionalities of the sms in pdu mode.
+  *           + Packing and unpacking of GSM 7 bit alphabet, eight septets at once
+  *           + Conversion of GSM 7 bit alphabet and UCS2 from and to UTF-8
+  *           + Encoder of SMS-SUBMIT
+  *           + Decoder of SMS-DELIVER and SMS-SUBMIT (stored messages)
+  *
+  @verbatim
+ ==============================================================================================
+                        ##### How to use this driver #####
+ ==============================================================================================
+  [..]
+    In pdu mode (at+cmgf=0) gsm module sends and lists messages as they are sent through
+    network, in hexadecimal. Text in GSM 7 bit default alphabet is packed, eight septets in
+    seven octets, so one message has 160 characters in 140 octets. Eight septets are joined
+    in one 56 bit word and written as seven octets (unpacking reads seven octets and takes
+    eight septets out of word), so packing doesn't shift and mask every septet alone, only
+    the rest of text that doesn't fill whole word is packed bit by bit. Text outside of GSM
+    alphabet is sent in UCS2 (70 characters), data in 8 bit coding (140 octets). Text of
+    decoded message is always UTF-8 (data of 8 bit coding in hexadecimal), so it is written
+    to console and published to broker the same as text mode message. Functions don't use
+    heap and only few hundred bytes of stack, so they can be called from at task while gsm
+    lists messages.
+    The sms pdu can be used as follows:
+
+    (#) Fill SMSPduSubmit_t with number, text and coding (SMS_PDU_AUTO chooses 7 bit when
+        it can) and encode it with SMS_PDU_EncodeSubmit(), length of TPDU is argument of
+        at+cmgs=<length> or at+cmgw=<length>, hexadecimal pdu with <CTRL-Z> is sent after
+        prompt
+    (#) Decode pdu line of +CMGR: or +CMGL: answer with SMS_PDU_Decode(), user data header
+        of part of long message is skipped
+    (#) Pack and unpack septets alone with SMS_PDU_Pack7() and SMS_PDU_Unpack7()
+  @endverbatim
+  *
+  *********************************************************************************************
+  */
+
+/* Includes ----------------------------------------------------------------------------------*/
+#include <sms_pdu.h>
+
+/* Escape to extension table of GSM alphabet */
+#define SMS_PDU_ESCAPE				0x1BU
+
+/* Character that replaces character that can't be converted */
+#define SMS_PDU_UNKNOWN				'?'
+
+/* GSM 7 bit default alphabet, unicode of every septet (escape is shown as space) */
+static const uint16_t gsmAlphabet[128] =
+{
+	0x0040, 0x00A3, 0x0024, 0x00A5, 0x00E8, 0x00E9, 0x00F9, 0x00EC, 0x00F2, 0x00C7, 0x000A, 0x00D8, 0x00F8, 0x000D, 0x00C5, 0x00E5,
+	0x0394, 0x005F, 0x03A6, 0x0393, 0x039B, 0x03A9, 0x03A0, 0x03A8, 0x03A3, 0x0398, 0x039E, 0x00A0, 0x00C6, 0x00E6, 0x00DF, 0x00C9,
+	0x0020, 0x0021, 0x0022, 0x0023, 0x00A4, 0x0025, 0x0026, 0x0027, 0x0028, 0x0029, 0x002A, 0x002B, 0x002C, 0x002D, 0x002E, 0x002F,
+	0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037, 0x0038, 0x0039, 0x003A, 0x003B, 0x003C, 0x003D, 0x003E, 0x003F,
+	0x00A1, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047, 0x0048, 0x0049, 0x004A, 0x004B, 0x004C, 0x004D, 0x004E, 0x004F,
+	0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057, 0x0058, 0x0059, 0x005A, 0x00C4, 0x00D6, 0x00D1, 0x00DC, 0x00A7,
+	0x00BF, 0x0061, 0x0062, 0x0063, 0x0064, 0x0065, 0x0066, 0x0067, 0x0068, 0x0069, 0x006A, 0x006B, 0x006C, 0x006D, 0x006E, 0x006F,
+	0x0070, 0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077, 0x0078, 0x0079, 0x007A, 0x00E4, 0x00F6, 0x00F1, 0x00FC, 0x00E0
+};
+
+/* Extension table of GSM alphabet, septet after escape and its unicode */
+static const uint16_t gsmExtension[][2] =
+{
+	{0x0A, 0x000C}, {0x14, 0x005E}, {0x28, 0x007B}, {0x29, 0x007D}, {0x2F, 0x005C},
+	{0x3C, 0x005B}, {0x3D, 0x007E}, {0x3E, 0x005D}, {0x40, 0x007C}, {0x65, 0x20AC}
+};
+
+#define SMS_PDU_EXTENSIONS			(sizeof(gsmExtension) / sizeof(gsmExtension[0]))
+
+/* Digits of addresses and of hexadecimal pdu */
+static const char hexDigits[] = "0123456789ABCDEF";
+static const char addressDigits[] = "0123456789*#abc";
+
+/**
+  * @brief Pack septets of GSM alphabet in octets.
+  * @param septets      Septets, only lower 7 bits are used.
+  * @param count        Number of septets.
+  * @param octets       Packed septets, (count * 7 + 7) / 8 octets.
+  * @retval uint32_t number of octets
+  */
+uint32_t SMS_PDU_Pack7(const uint8_t *septets, uint32_t count, uint8_t *octets)
+{
+	uint32_t septet = 0;
+	uint32_t octet = 0;
+
+	/* Eight septets fill seven octets, they are joined in one word */
+	for(; septet + 8U <= count; septet += 8U)
+	{
+		uint64_t word = 0;
+		for(uint32_t i = 0; i < 8U; i++) word |= (uint64_t)(septets[septet + i] & 0x7FU) << (7U * i);
+		for(uint32_t i = 0; i < 7U; i++) octets[octet++] = (uint8_t)(word >> (8U * i));
+	}
+
+	/* Rest of septets is packed bit by bit, last octet is filled with zeros */
+	uint32_t bits = 0;
+	uint32_t word = 0;
+	for(; septet < count; septet++)
+	{
+		word |= (uint32_t)(septets[septet] & 0x7FU) << bits;
+		bits += 7U;
+		if(bits >= 8U)
+		{
+			octets[octet++] = (uint8_t)word;
+			word >>= 8;
+			bits -= 8U;
+		}
+	}
+	if(bits > 0) octets[octet++] = (uint8_t)word;
+
+	return octet;
+}
+
+/**
+  * @brief Unpack septets of GSM alphabet from octets.
+  * @param octets       Packed septets.
+  * @param count        Number of septets.
+  * @param septets      Unpacked septets.
+  * @param shift        Fill bits before first septet (after user data header).
+  * @retval uint32_t number of octets that were read
+  */
+uint32_t SMS_PDU_Unpack7(const uint8_t *octets, uint32_t count, uint8_t *septets, uint32_t shift)
+{
+	uint32_t septet = 0;
+	uint32_t octet = 0;
+	uint32_t bits = 0;
+	uint32_t word = 0;
+
+	/* Seven octets are read in one word and give eight septets */
+	if(shift == 0)
+	{
+		for(; septet + 8U <= count; septet += 8U)
+		{
+			uint64_t block = 0;
+			for(uint32_t i = 0; i < 7U; i++) block |= (uint64_t)octets[octet++] << (8U * i);
+			for(uint32_t i = 0; i < 8U; i++) septets[septet + i] = (uint8_t)(block >> (7U * i)) & 0x7FU;
+		}
+	}
+	else if(count > 0)
+	{
+		word = octets[octet++] >> (shift & 7U);
+		bits = 8U - (shift & 7U);
+	}
+
+	/* Rest of septets is read bit by bit, octet is read only when its bits are needed */
+	for(; septet < count; septet++)
+	{
+		if(bits < 7U)
+		{
+			word |= (uint32_t)octets[octet++] << bits;
+			bits += 8U;
+		}
+		septets[septet] = (uint8_t)(word & 0x7FU);
+		word >>= 7;
+		bits -= 7U;
+	}
+
+	return octet;
+}
+
+/**
+  * @brief Read one character of UTF-8 text.
+  * @param text         Text.
+  * @param length       Number of characters of text.
+  * @param position     Position of character, moved after it.
+  * @retval uint32_t unicode, SMS_PDU_UNKNOWN for wrong sequence
+  */
+static uint32_t readUtf8(const uint8_t *text, uint32_t length, uint32_t *position)
+{
+	uint8_t first = text[(*position)++];
+	uint32_t code;
+	uint32_t more;
+
+	if(first < 0x80U) return first;
+	else if((first & 0xE0U) == 0xC0U) { code = first & 0x1FU; more = 1; }
+	else if((first & 0xF0U) == 0xE0U) { code = first & 0x0FU; more = 2; }
+	else if((first & 0xF8U) == 0xF0U) { code = first & 0x07U; more = 3; }
+	else return SMS_PDU_UNKNOWN;
+
+	for(; more > 0; more--)
+	{
+		if(*position >= length || (text[*position] & 0xC0U) != 0x80U) return SMS_PDU_UNKNOWN;
+		code = (code << 6) | (text[(*position)++] & 0x3FU);
+	}
+
+	return code;
+}
+
+/**
+  * @brief Write one character as UTF-8, text always ends with '\0'.
+  * @param code         Unicode.
+  * @param text         Text.
+  * @param size         Size of text.
+  * @param length       Number of characters of text, moved after character.
+  * @retval bool false if character doesn't fit, nothing is written then
+  */
+static bool writeUtf8(uint32_t code, uint8_t *text, uint32_t size, uint32_t *length)
+{
+	uint32_t bytes = code < 0x80U ? 1U : code < 0x800U ? 2U : code < 0x10000U ? 3U : 4U;
+
+	if(*length + bytes >= size) return false;
+
+	switch(bytes){
+	case 1:
+		text[(*length)++] = (uint8_t)code;
+		break;
+	case 2:
+		text[(*length)++] = (uint8_t)(0xC0U | (code >> 6));
+		text[(*length)++] = (uint8_t)(0x80U | (code & 0x3FU));
+		break;
+	case 3:
+		text[(*length)++] = (uint8_t)(0xE0U | (code >> 12));
+		text[(*length)++] = (uint8_t)(0x80U | ((code >> 6) & 0x3FU));
+		text[(*length)++] = (uint8_t)(0x80U | (code & 0x3FU));
+		break;
+	default:
+		text[(*length)++] = (uint8_t)(0xF0U | (code >> 18));
+		text[(*length)++] = (uint8_t)(0x80U | ((code >> 12) & 0x3FU));
+		text[(*length)++] = (uint8_t)(0x80U | ((code >> 6) & 0x3FU));
+		text[(*length)++] = (uint8_t)(0x80U | (code & 0x3FU));
+		break;
+	}
+	text[*length] = '\0';
+
+	return true;
+}
+
+/**
+  * @brief Septets of character in GSM alphabet.
+  * @param code         Unicode.
+  * @param septet       One septet, or escape and septet of extension table.
+  * @retval uint32_t number of septets, 0 if character isn't in alphabet
+  */
+static uint32_t toGsm(uint32_t code, uint8_t *septet)
+{
+	/* Most of ASCII has the same position in GSM alphabet */
+	if(code < 128U && gsmAlphabet[code] == code)
+	{
+		septet[0] = (uint8_t)code;
+		return 1;
+	}
+
+	for(uint32_t i = 0; i < 128U; i++)
+	{
+		if(gsmAlphabet[i] == code && i != SMS_PDU_ESCAPE)
+		{
+			septet[0] = (uint8_t)i;
+			return 1;
+		}
+	}
+
+	for(uint32_t i = 0; i < SMS_PDU_EXTENSIONS; i++)
+	{
+		if(gsmExtension[i][1] == code)
+		{
+			septet[0] = SMS_PDU_ESCAPE;
+			septet[1] = (uint8_t)gsmExtension[i][0];
+			return 2;
+		}
+	}
+
+	return 0;
+}
+
+/**
+  * @brief Convert UTF-8 text in septets of GSM alphabet.
+  * @param text         Text.
+  * @param length       Number of characters of text.
+  * @param septets      Septets, SMS_PDU_MAX_SEPTETS.
+  * @param count        Number of septets.
+  * @param exact        Every character is in alphabet, otherwise it is replaced with '?'.
+  * @retval bool false if text is longer than one message
+  */
+static bool toSeptets(const uint8_t *text, uint32_t length, uint8_t *septets, uint32_t *count, bool *exact)
+{
+	uint32_t position = 0;
+
+	*count = 0;
+	*exact = true;
+	while(position < length)
+	{
+		uint8_t septet[2];
+		uint32_t size = toGsm(readUtf8(text, length, &position), septet);
+		if(size == 0)
+		{
+			*exact = false;
+			septet[0] = SMS_PDU_UNKNOWN;
+			size = 1;
+		}
+
+		if(*count + size > SMS_PDU_MAX_SEPTETS) return false;
+		for(uint32_t i = 0; i < size; i++) septets[(*count)++] = septet[i];
+	}
+
+	return true;
+}
+
+/**
+  * @brief Convert UTF-8 text in UCS2 (UTF-16 big endian).
+  * @param text         Text.
+  * @param length       Number of characters of text.
+  * @param octets       UCS2, SMS_PDU_USER_DATA octets.
+  * @param count        Number of octets.
+  * @retval bool false if text is longer than one message
+  */
+static bool toUcs2(const uint8_t *text, uint32_t length, uint8_t *octets, uint32_t *count)
+{
+	uint32_t position = 0;
+
+	*count = 0;
+	while(position < length)
+	{
+		uint32_t code = readUtf8(text, length, &position);
+		uint16_t unit[2] = {(uint16_t)code, 0};
+		uint32_t units = 1;
+
+		/* Character outside of basic plane is surrogate pair */
+		if(code >= 0x10000U)
+		{
+			code -= 0x10000U;
+			unit[0] = (uint16_t)(0xD800U | (code >> 10));
+			unit[1] = (uint16_t)(0xDC00U | (code & 0x3FFU));
+			units = 2;
+		}
+
+		if(*count + 2U * units > SMS_PDU_USER_DATA) return false;
+		for(uint32_t i = 0; i < units; i++)
+		{
+			octets[(*count)++] = (uint8_t)(unit[i] >> 8);
+			octets[(*count)++] = (uint8_t)unit[i];
+		}
+	}
+
+	return true;
+}
+
+/**
+  * @brief Write address in swapped semi-octets.
+  * @param number       Number, '+' for international format, ends with '\0' or '\r'.
+  * @param pdu          Pdu.
+  * @param length       Number of octets of pdu, moved after address.
+  * @retval bool false if number is empty, too long or has other characters
+  */
+static bool encodeAddress(const uint8_t *number, uint8_t *pdu, uint32_t *length)
+{
+	uint32_t start = *length;
+	uint32_t digits = 0;
+
+	pdu[start + 1U] = 0x81U;
+	if(*number == '+')
+	{
+		pdu[start + 1U] = 0x91U;
+		number++;
+	}
+
+	for(; number[digits] != '\0' && number[digits] != '\r'; digits++)
+	{
+		uint8_t nibble;
+
+		if(digits >= 20U) return false;
+		if(number[digits] >= '0' && number[digits] <= '9') nibble = number[digits] - '0';
+		else if(number[digits] == '*') nibble = 0x0AU;
+		else if(number[digits] == '#') nibble = 0x0BU;
+		else return false;
+
+		/* First digit is in lower half of octet, odd number of digits ends with 0xF */
+		uint8_t *octet = &pdu[start + 2U + digits / 2U];
+		if((digits & 1U) == 0) *octet = 0xF0U | nibble;
+		else *octet = (*octet & 0x0FU) | (nibble << 4);
+	}
+
+	if(digits == 0) return false;
+
+	pdu[start] = (uint8_t)digits;
+	*length = start + 2U + (digits + 1U) / 2U;
+
+	return true;
+}
+
+/**
+  * @brief Encode message as SMS-SUBMIT pdu in hexadecimal.
+  * @param submit       Message.
+  * @param hex          Pdu in hexadecimal with default service centre ("00") at its start,
+  *                     ends with '\0'.
+  * @param size         Size of hex (SMS_PDU_HEX_SIZE is enough).
+  * @param tpduLength   Number of octets of pdu without service centre, argument of
+  *                     at+cmgs=<length> and at+cmgw=<length>.
+  * @retval DRIVERState_t DRIVER_ERROR if number is wrong or text is longer than one message
+  */
+DRIVERState_t SMS_PDU_EncodeSubmit(const SMSPduSubmit_t *submit, uint8_t *hex, uint32_t size, uint32_t *tpduLength)
+{
+	uint8_t pdu[SMS_PDU_MAX_OCTETS];
+	uint8_t septets[SMS_PDU_MAX_SEPTETS];
+	uint32_t length = 0;
+	uint32_t count = 0;
+
+	if(submit == NULL || submit->number == NULL || hex == NULL || (submit->text == NULL && submit->length != 0))
+		return DRIVER_ERROR;
+
+	/* Service centre of SIM card, SMS-SUBMIT without validity period, reference is given by gsm */
+	pdu[length++] = 0x00;
+	pdu[length++] = 0x01;
+	pdu[length++] = 0x00;
+
+	if(!encodeAddress(submit->number, pdu, &length)) return DRIVER_ERROR;
+
+	/* Protocol identifier of plain message */
+	pdu[length++] = 0x00;
+
+	/* Text that fits in GSM alphabet is sent in it, otherwise in UCS2 */
+	SMSPduCoding_t coding = submit->coding;
+	if(coding == SMS_PDU_AUTO || coding == SMS_PDU_7BIT)
+	{
+		bool exact;
+		bool fits = toSeptets(submit->text, submit->length, septets, &count, &exact);
+		if(coding == SMS_PDU_AUTO) coding = exact ? SMS_PDU_7BIT : SMS_PDU_UCS2;
+		if(coding == SMS_PDU_7BIT && !fits) return DRIVER_ERROR;
+	}
+	pdu[length++] = (uint8_t)coding;
+
+	/* Length of user data is in septets for 7 bit alphabet, in octets otherwise */
+	switch(coding){
+	case SMS_PDU_7BIT:
+		pdu[length++] = (uint8_t)count;
+		length += SMS_PDU_Pack7(septets, count, pdu + length);
+		break;
+	case SMS_PDU_UCS2:
+		if(!toUcs2(submit->text, submit->length, pdu + length + 1U, &count)) return DRIVER_ERROR;
+		pdu[length++] = (uint8_t)count;
+		length += count;
+		break;
+	case SMS_PDU_8BIT:
+		if(submit->length > SMS_PDU_USER_DATA) return DRIVER_ERROR;
+		pdu[length++] = (uint8_t)submit->length;
+		memcpy(pdu + length, submit->text, submit->length);
+		length += submit->length;
+		break;
+	default:
+		return DRIVER_ERROR;
+	}
+
+	if(size < 2U * length + 1U) return DRIVER_ERROR;
+
+	for(uint32_t i = 0; i < length; i++)
+	{
+		hex[2U * i] 		= hexDigits[pdu[i] >> 4];
+		hex[2U * i + 1U] 	= hexDigits[pdu[i] & 0x0FU];
+	}
+	hex[2U * length] = '\0';
+
+	if(tpduLength != NULL) *tpduLength = length - 1U;
+
+	return DRIVER_OK;
+}
+
+/**
+  * @brief Value of hexadecimal digit.
+  * @param digit        Digit.
+  * @retval int32_t value, -1 if character isn't hexadecimal digit
+  */
+static int32_t hexValue(uint8_t digit)
+{
+	if(digit >= '0' && digit <= '9') return digit - '0';
+	if(digit >= 'A' && digit <= 'F') return digit - 'A' + 10;
+	if(digit >= 'a' && digit <= 'f') return digit - 'a' + 10;
+	return -1;
+}
+
+/**
+  * @brief Alphabet of user data from data coding scheme.
+  * @param dcs          Data coding scheme.
+  * @retval SMSPduCoding_t coding, 8 bit for reserved and compressed data
+  */
+static SMSPduCoding_t codingOf(uint8_t dcs)
+{
+	/* General data coding, also with automatic deletion */
+	if((dcs & 0x80U) == 0)
+	{
+		if((dcs & 0x20U) != 0) return SMS_PDU_8BIT;
+		switch(dcs & 0x0CU){
+		case 0x00: return SMS_PDU_7BIT;
+		case 0x08: return SMS_PDU_UCS2;
+		default: return SMS_PDU_8BIT;
+		}
+	}
+
+	/* Message waiting indication groups and data coding/message class group */
+	switch(dcs & 0xF0U){
+	case 0xC0:
+	case 0xD0:
+		return SMS_PDU_7BIT;
+	case 0xE0:
+		return SMS_PDU_UCS2;
+	case 0xF0:
+		return (dcs & 0x04U) != 0 ? SMS_PDU_8BIT : SMS_PDU_7BIT;
+	default:
+		return SMS_PDU_8BIT;
+	}
+}
+
+/**
+  * @brief Convert septets of GSM alphabet in UTF-8.
+  * @param septets      Septets.
+  * @param count        Number of septets.
+  * @param escape       Last septet of previous part was escape, kept for next part.
+  * @param text         Text, ends with '\0'.
+  * @param size         Size of text.
+  * @param length       Number of characters of text.
+  * @retval bool false if text didn't fit
+  */
+static bool fromSeptets(const uint8_t *septets, uint32_t count, bool *escape, uint8_t *text, uint32_t size, uint32_t *length)
+{
+	for(uint32_t i = 0; i < count; i++)
+	{
+		uint32_t code = gsmAlphabet[septets[i]];
+
+		if(*escape)
+		{
+			/* Unknown character of extension table is shown as character of basic table */
+			*escape = false;
+			for(uint32_t j = 0; j < SMS_PDU_EXTENSIONS; j++)
+				if(gsmExtension[j][0] == septets[i]) code = gsmExtension[j][1];
+		}
+		else if(septets[i] == SMS_PDU_ESCAPE)
+		{
+			*escape = true;
+			continue;
+		}
+
+		if(!writeUtf8(code, text, size, length)) return false;
+	}
+
+	return true;
+}
+
+/**
+  * @brief Read address from swapped semi-octets.
+  * @param octets       Semi-octets of address.
+  * @param digits       Number of digits (useful semi-octets).
+  * @param type         Type of address.
+  * @param number       Number, '+' for international format, ends with '\0'.
+  * @retval void
+  */
+static void decodeAddress(const uint8_t *octets, uint32_t digits, uint8_t type, uint8_t *number)
+{
+	uint32_t length = 0;
+
+	number[0] = '\0';
+
+	/* Alphanumeric sender (eg. name of operator) is in 7 bit alphabet */
+	if((type & 0x70U) == 0x50U)
+	{
+		uint8_t septets[11];
+		uint32_t count = digits * 4U / 7U;
+		bool escape = false;
+
+		if(count > sizeof(septets)) count = sizeof(septets);
+		SMS_PDU_Unpack7(octets, count, septets, 0);
+		fromSeptets(septets, count, &escape, number, SMS_PDU_NUMBER_SIZE, &length);
+		return;
+	}
+
+	if((type & 0x70U) == 0x10U) number[length++] = '+';
+	for(uint32_t i = 0; i < digits && length < SMS_PDU_NUMBER_SIZE - 1U; i++)
+	{
+		uint8_t nibble = (i & 1U) != 0 ? octets[i / 2U] >> 4 : octets[i / 2U] & 0x0FU;
+		if(nibble == 0x0FU) break;
+		number[length++] = addressDigits[nibble];
+	}
+	number[length] = '\0';
+}
+
+/**
+  * @brief Read time stamp of service centre as text mode writes it ("yy/MM/dd,hh:mm:ss+zz",
+  *        zone in quarters of hour).
+  * @param octets       Seven octets of time stamp.
+  * @param time         Time stamp, ends with '\0'.
+  * @retval void
+  */
+static void decodeTime(const uint8_t *octets, uint8_t *time)
+{
+	static const char separator[] = "//,::";
+	uint32_t length = 0;
+
+	for(uint32_t i = 0; i < 6U; i++)
+	{
+		time[length++] = '0' + (octets[i] & 0x0FU);
+		time[length++] = '0' + (octets[i] >> 4);
+		if(i < 5U) time[length++] = separator[i];
+	}
+
+	time[length++] = (octets[6] & 0x08U) != 0 ? '-' : '+';
+	time[length++] = '0' + (octets[6] & 0x07U);
+	time[length++] = '0' + (octets[6] >> 4);
+	time[length] = '\0';
+}
+
+/**
+  * @brief Decode SMS-DELIVER or SMS-SUBMIT pdu in hexadecimal (line of +CMGR: or +CMGL: answer).
+  * @param hex          Pdu in hexadecimal with address of service centre at its start.
+  * @param length       Number of characters of hex.
+  * @param message      Decoded message.
+  * @param text         Text of message in UTF-8, data of 8 bit coding in hexadecimal, ends
+  *                     with '\0', it is cut when it doesn't fit.
+  * @param size         Size of text.
+  * @retval DRIVERState_t DRIVER_ERROR if pdu is damaged or of other type (status report)
+  */
+DRIVERState_t SMS_PDU_Decode(const uint8_t *hex, uint32_t length, SMSPduMessage_t *message, uint8_t *text, uint32_t size)
+{
+	uint8_t pdu[SMS_PDU_MAX_OCTETS];
+	uint32_t count = length / 2U;
+	uint32_t position = 0;
+
+	if(hex == NULL || message == NULL || text == NULL || size == 0) return DRIVER_ERROR;
+
+	memset(message, 0, sizeof(SMSPduMessage_t));
+	text[0] = '\0';
+
+	if(count == 0 || count > SMS_PDU_MAX_OCTETS || (length & 1U) != 0) return DRIVER_ERROR;
+	for(uint32_t i = 0; i < count; i++)
+	{
+		int32_t high = hexValue(hex[2U * i]);
+		int32_t low = hexValue(hex[2U * i + 1U]);
+		if(high < 0 || low < 0) return DRIVER_ERROR;
+		pdu[i] = (uint8_t)((high << 4) | low);
+	}
+
+	/* Address of service centre is skipped */
+	position = 1U + pdu[0];
+	if(position >= count) return DRIVER_ERROR;
+
+	uint8_t first = pdu[position++];
+	if((first & 0x03U) > SMS_PDU_SUBMIT) return DRIVER_ERROR;
+	message->type = (SMSPduType_t)(first & 0x03U);
+
+	/* Message reference of SMS-SUBMIT */
+	if(message->type == SMS_PDU_SUBMIT) position++;
+
+	/* Originating or destination address */
+	if(position + 2U > count) return DRIVER_ERROR;
+	uint32_t digits = pdu[position];
+	uint8_t type = pdu[position + 1U];
+	if(digits > 2U * (SMS_PDU_NUMBER_SIZE - 2U) || position + 2U + (digits + 1U) / 2U > count) return DRIVER_ERROR;
+	decodeAddress(pdu + position + 2U, digits, type, message->number);
+	position += 2U + (digits + 1U) / 2U;
+
+	/* Protocol identifier and data coding scheme */
+	if(position + 2U > count) return DRIVER_ERROR;
+	message->coding = codingOf(pdu[position + 1U]);
+	position += 2U;
+
+	/* Time stamp of SMS-DELIVER, validity period (none, relative or absolute) of SMS-SUBMIT */
+	if(message->type == SMS_PDU_DELIVER)
+	{
+		if(position + 7U > count) return DRIVER_ERROR;
+		decodeTime(pdu + position, message->time);
+		position += 7U;
+	}
+	else if(((first >> 3) & 0x03U) == 0x02U) position += 1U;
+	else if(((first >> 3) & 0x03U) != 0x00U) position += 7U;
+
+	if(position >= count) return DRIVER_ERROR;
+	uint32_t userLength = pdu[position++];
+	uint32_t octets = message->coding == SMS_PDU_7BIT ? (userLength * 7U + 7U) / 8U : userLength;
+	if(octets > SMS_PDU_USER_DATA || position + octets > count) return DRIVER_ERROR;
+	const uint8_t *userData = pdu + position;
+
+	/* User data header (eg. part of long message) is skipped */
+	uint32_t skip = 0;
+	if((first & 0x40U) != 0 && octets > 0)
+	{
+		message->header = true;
+		skip = userData[0] + 1U;
+		if(skip > octets) return DRIVER_ERROR;
+	}
+
+	bool fits = true;
+	switch(message->coding){
+	case SMS_PDU_7BIT:
+	{
+		/* Text starts at septet boundary after header, eight septets are unpacked at once */
+		uint32_t start = (skip * 8U + 6U) / 7U;
+		uint32_t bit = start * 7U;
+		bool escape = false;
+		for(uint32_t septet = start; septet < userLength && fits; septet += 8U)
+		{
+			uint8_t part[8];
+			uint32_t number = userLength - septet < 8U ? userLength - septet : 8U;
+			SMS_PDU_Unpack7(userData + bit / 8U, number, part, bit % 8U);
+			fits = fromSeptets(part, number, &escape, text, size, &message->length);
+			bit += 56U;
+		}
+		break;
+	}
+	case SMS_PDU_UCS2:
+		for(uint32_t i = skip; i + 1U < octets && fits; i += 2U)
+		{
+			uint32_t code = ((uint32_t)userData[i] << 8) | userData[i + 1U];
+
+			/* Surrogate pair is one character */
+			if(code >= 0xD800U && code <= 0xDBFFU && i + 3U < octets)
+			{
+				uint32_t low = ((uint32_t)userData[i + 2U] << 8) | userData[i + 3U];
+				if(low >= 0xDC00U && low <= 0xDFFFU)
+				{
+					code = 0x10000U + ((code - 0xD800U) << 10) + (low - 0xDC00U);
+					i += 2U;
+				}
+			}
+			if(code >= 0xD800U && code <= 0xDFFFU) code = SMS_PDU_UNKNOWN;
+
+			fits = writeUtf8(code, text, size, &message->length);
+		}
+		break;
+	default:
+		for(uint32_t i = skip; i < octets && fits; i++)
+		{
+			fits = message->length + 2U < size;
+			if(!fits) break;
+			text[message->length++] = hexDigits[userData[i] >> 4];
+			text[message->length++] = hexDigits[userData[i] & 0x0FU];
+			text[message->length] = '\0';
+		}
+		break;
+	}
+	message->truncated = !fits;
+
+	return DRIVER_OK;
+}
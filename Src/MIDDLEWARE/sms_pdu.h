@@ -0,0 +1,99 @@
+/**
+  ***************************************************************************************************
+  * @file    sms_pdu.h
+  * @author  Valentina Denic
+  * @brief   This file contains all the functions prototypes for the sms in pdu mode (encoder of
+  *          SMS-SUBMIT and decoder of SMS-DELIVER and SMS-SUBMIT).
+  ***************************************************************************************************
+  */
+
+#ifndef MIDDLEWARE_SMS_PDU_H_
+#define MIDDLEWARE_SMS_PDU_H_
+
+#include <driver_common.h>
+
+/* Longest pdu with address of service centre (in octets) */
+#define SMS_PDU_MAX_OCTETS			176U
+
+/* Size of buffer for pdu in hexadecimal with '\0' (or <CTRL-Z>) at its end */
+#define SMS_PDU_HEX_SIZE			(2U * SMS_PDU_MAX_OCTETS + 2U)
+
+/* Longest user data of one message (in octets), 160 septets of 7 bit alphabet */
+#define SMS_PDU_USER_DATA			140U
+#define SMS_PDU_MAX_SEPTETS			160U
+
+/* Size of telephone number with '+' and '\0' */
+#define SMS_PDU_NUMBER_SIZE			24U
+
+/* Size of time stamp "yy/MM/dd,hh:mm:ss+zz" with '\0' */
+#define SMS_PDU_TIME_SIZE			24U
+
+/**
+  * @brief  SMS PDU coding definition, alphabet of user data (bits of data coding scheme)
+  */
+typedef enum
+{
+	SMS_PDU_7BIT		= 0x00,			/*!< GSM 7 bit default alphabet, 160 characters		 */
+	SMS_PDU_8BIT		= 0x04,			/*!< 8 bit data, 140 octets							 */
+	SMS_PDU_UCS2		= 0x08,			/*!< UCS2 (UTF-16), 70 characters						 */
+	SMS_PDU_AUTO		= 0xFF			/*!< 7 bit when every character of text is in GSM
+											 alphabet, UCS2 otherwise (only for encoder)		 */
+} SMSPduCoding_t;
+
+/**
+  * @brief  SMS PDU type definition (message type indicator)
+  */
+typedef enum
+{
+	SMS_PDU_DELIVER		= 0x00,			/*!< Received message								 */
+	SMS_PDU_SUBMIT		= 0x01			/*!< Message to send, stored messages are in this type */
+} SMSPduType_t;
+
+/**
+  * @brief  SMS PDU SUBMIT Structure definition, message that is encoded
+  */
+typedef struct __SMSPduSubmit_t
+{
+	const uint8_t *number;						/*!< Destination, '+' for international format,
+													 ends with '\0' or '\r'						 */
+
+	const uint8_t *text;						/*!< Text in UTF-8, data for SMS_PDU_8BIT		 */
+
+	uint32_t length;							/*!< Number of characters (octets) of text		 */
+
+	SMSPduCoding_t coding;						/*!< Coding of user data						 */
+
+}SMSPduSubmit_t;
+
+/**
+  * @brief  SMS PDU MESSAGE Structure definition, decoded message
+  */
+typedef struct __SMSPduMessage_t
+{
+	SMSPduType_t type;							/*!< Received or stored message to send			 */
+
+	SMSPduCoding_t coding;						/*!< Coding of user data						 */
+
+	uint8_t number[SMS_PDU_NUMBER_SIZE];		/*!< Originating or destination address			 */
+
+	uint8_t time[SMS_PDU_TIME_SIZE];			/*!< Time stamp of service centre, empty for
+													 SMS-SUBMIT									 */
+
+	bool header;								/*!< User data header (part of long message) was
+													 skipped									 */
+
+	uint32_t length;							/*!< Number of characters written to text		 */
+
+	bool truncated;								/*!< Text didn't fit in buffer					 */
+
+}SMSPduMessage_t;
+
+/* Packing functions *********************************************************************************/
+uint32_t SMS_PDU_Pack7(const uint8_t *septets, uint32_t count, uint8_t *octets);
+uint32_t SMS_PDU_Unpack7(const uint8_t *octets, uint32_t count, uint8_t *septets, uint32_t shift);
+
+/* Encoder and decoder functions *********************************************************************/
+DRIVERState_t SMS_PDU_EncodeSubmit(const SMSPduSubmit_t *submit, uint8_t *hex, uint32_t size, uint32_t *tpduLength);
+DRIVERState_t SMS_PDU_Decode(const uint8_t *hex, uint32_t length, SMSPduMessage_t *message, uint8_t *text, uint32_t size);
+
+#endif /* MIDDLEWARE_SMS_PDU_H_ */
@@ -13,29 +13,44 @@
 /* Private includes ----------------------------------------------------------*/
 #include <driver_console.h>
 #include <gsm.h>
+#include <at.h>
 #include <time.h>
 #include <mqtt.h>
 #include <mqtt_client.h>
+#include <arena.h>
+#include <pool.h>
+#include <runtime.h>
+#include <driver_trace.h>
+#include <driver_clock.h>
+#include <driver_memory.h>
+#include <driver_io.h>
+#include <health.h>
+#include <driver_store.h>
+#include <async.h>
+#include <link.h>
 
 #include "FreeRTOS.h"
 #include "task.h"
 
 
 /* receving buffer for console */
-uint8_t rxbufferConsole[2000];
+uint8_t rxbufferConsole[2000] DRIVER_DMA_BUFFER;
 
 /* transmiting buffer for console */
-uint8_t txbufferConsole[2000];
+uint8_t txbufferConsole[2000] DRIVER_DMA_BUFFER;
 
 /* buffer in main task that are receiving message from console with get function */
 uint8_t bufferConsole[2000] = {0};
 
 /* Buffer for receiving characters from gsm in uart interrupt routine */
-uint8_t rxBufferGsm[2000];
+uint8_t rxBufferGsm[2000] DRIVER_DMA_BUFFER;
 
 /* buffer in main task that are receiving message from gsm with get function */
 uint8_t bufferGsm[2000] = {0};
 
+/* FreeRTOS heap, stacks of tasks are taken from it, so they are kept in DTCM */
+uint8_t ucHeap[configTOTAL_HEAP_SIZE] HOT_BSS;
+
 /* Variable that are containing size of message stored in buffers for gsm and console */
 uint32_t size = 0;
 uint32_t sizeGsm = 0;
@@ -43,6 +58,53 @@ uint32_t sizeGsm = 0;
 /* Variable for waiting user's input */
 uint32_t timeout = 30000;
 
+/* Size of console and gsm buffers that demo task takes from its arena */
+#define DEMO_BUFFER_SIZE	1000
+
+/* Size of synthetic answer of at+cmgl for benchmark of result code search */
+#define DEMO_BENCH_ANSWER_SIZE	4096
+
+/* Number of times that 160 septets are packed in benchmark of pdu packing */
+#define DEMO_PDU_ROUNDS			100
+
+/* Stack of demo task in words, big buffers are in arena of the task */
+#define DEMO_TASK_STACK		1024
+
+/* Scratch memory of demo task, it is emptied before every command */
+ARENA_STORAGE(demoArenaStorage, ARENA_DEMO_TASK_BUDGET);
+
+/* Topic on which statistics of tasks are published */
+#define DEMO_TOP_TOPIC		"gsm/top"
+
+/* Number of unsolicited lines that wait for demo task and period of checking them while it
+ * waits for command (in miliseconds) */
+#define DEMO_URC_QUEUE_LENGTH	4
+#define DEMO_URC_POLL_PERIOD	1000
+
+/* Topic of asynchronous publish and period of samples that demo task takes while it runs (in miliseconds) */
+#define DEMO_ASYNC_TOPIC		"gsm/async"
+#define DEMO_SAMPLE_PERIOD		10
+
+/* Topic on which latency histograms of at commands are published */
+#define DEMO_LATENCY_TOPIC		"gsm/latency"
+
+/* Time for answer of at command that user typed (in miliseconds) */
+#define DEMO_AT_TIMEOUT			10000
+
+/* Scratch memory of async task, answers of gsm for operations that it runs */
+ARENA_STORAGE(asyncArenaStorage, ARENA_ASYNC_TASK_BUDGET);
+
+/* Scratch memory of link task, answers of gsm for repairs of connection */
+ARENA_STORAGE(linkArenaStorage, ARENA_LINK_TASK_BUDGET);
+
+/* Listed messages that are published together, one message per line */
+typedef struct
+{
+	uint8_t *text;							/* Messages, DEMO_BUFFER_SIZE characters	*/
+	uint32_t length;						/* Number of characters of messages			*/
+	uint32_t dropCount;						/* Messages that didn't fit in text			*/
+}DemoSmsPublish_t;
+
 
 /* Private variables -------------------------------------------------------------*/
 
@@ -62,6 +124,24 @@ MQTTHandler_t 			mqtt;				/* Mqtt handle						*/
 MQTTConfig_t 			mqttConfig;			/* Mqtt config						*/
 MQTTClientHandler_t 	mqttCient;			/* Mqtt client handle				*/
 MQTTClientConfig_t 		mqttClientConfig;	/* Mqtt client config				*/
+RUNTIMEHandler_t 		runtime;			/* Run time statistics of tasks		*/
+ARENAHandler_t 			demoArena;			/* Arena of demo task				*/
+ARENAConfig_t 			demoArenaConfig;	/* Arena of demo task config		*/
+HEALTHHandler_t 		health;				/* Health monitor handle			*/
+HEALTHConfig_t 			healthConfig;		/* Health monitor config			*/
+DRIVERClockHandler_t 	sysClock;			/* Clock profile handle				*/
+DRIVERClockConfig_t 	sysClockConfig;		/* Clock profile config				*/
+ATHandler_t 			at;					/* At engine handle					*/
+ATConfig_t 				atConfig;			/* At engine config					*/
+ATUrcSubscriber_t 		demoUrc;			/* Unsolicited lines for console	*/
+ARENAHandler_t 			asyncArena;			/* Arena of async task				*/
+ARENAConfig_t 			asyncArenaConfig;	/* Arena of async task config		*/
+ASYNCHandler_t 			async;				/* Async operations handle			*/
+ASYNCConfig_t 			asyncConfig;		/* Async operations config			*/
+LINKHandler_t 			linkManager;		/* Connection manager handle		*/
+LINKConfig_t 			linkConfig;			/* Connection manager config		*/
+ARENAHandler_t 			linkArena;			/* Arena of link task				*/
+ARENAConfig_t 			linkArenaConfig;	/* Arena of link task config		*/
 
 
 /* Private function prototypes ---------------------------------------------------*/
@@ -73,6 +153,7 @@ DRIVERState_t MX_USART3_UART_Init(void);
 DRIVERState_t MX_USART6_UART_Init(void);
 
 void DemoTask(void* pvParameters);
+static void DemoListMessage(GSMSmsList_t *list);
 
 /* Write and read char function we are not using 'cause we have implementation
  *  of console with tasks */
@@ -90,6 +171,60 @@ void WriteChar(uint8_t Char)
 	return;
 }
 
+/* Listed message is written to console and added to text for broker, it is called in at task
+ * (small stack), so it only copies parts of record */
+static void DemoListMessage(GSMSmsList_t *list)
+{
+	DemoSmsPublish_t *publish = list->context;
+	GSMSmsRecord_t *record = &list->record;
+
+	/* Index of message in decimal */
+	uint8_t index[11];
+	uint32_t start = sizeof(index) - 1;
+	uint32_t value = list->index;
+	index[start] = '\0';
+	do
+	{
+		index[--start] = '0' + value % 10;
+		value /= 10;
+	}while(value != 0);
+
+	DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n+CMGL: ");
+	DRIVER_CONSOLE_Put(&console, index + start);
+	DRIVER_CONSOLE_Put(&console,(const uint8_t*)" ");
+	DRIVER_CONSOLE_Put(&console, record->typeOfMsg);
+	DRIVER_CONSOLE_Put(&console,(const uint8_t*)" ");
+	DRIVER_CONSOLE_Put(&console, record->number);
+	DRIVER_CONSOLE_Put(&console,(const uint8_t*)" ");
+	DRIVER_CONSOLE_Put(&console, record->timeReceived);
+	DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n");
+	DRIVER_CONSOLE_Put(&console, record->message);
+	DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n");
+
+	if(publish == NULL) return;
+
+	/* Message is added whole or not at all */
+	const uint8_t *part[] = {index + start, (const uint8_t*)" ", record->typeOfMsg, (const uint8_t*)" ", record->number,
+							 (const uint8_t*)" ", record->timeReceived, (const uint8_t*)(record->timeReceived[0] != '\0' ? " " : ""),
+							 record->message, (const uint8_t*)"\r\n"};
+	uint32_t length = 0;
+	for(uint32_t i = 0; i < sizeof(part) / sizeof(part[0]); i++) length += strlen((const char*)part[i]);
+
+	if(publish->length + length >= DEMO_BUFFER_SIZE)
+	{
+		publish->dropCount++;
+		return;
+	}
+
+	for(uint32_t i = 0; i < sizeof(part) / sizeof(part[0]); i++)
+	{
+		uint32_t size = strlen((const char*)part[i]);
+		memcpy(publish->text + publish->length, part[i], size);
+		publish->length += size;
+	}
+	publish->text[publish->length] = '\0';
+}
+
 /**
   * @brief  The application entry point.
   * @retval int
@@ -115,8 +250,14 @@ int main(void)
   /* Set the lowest priority for systick timer */
   HAL_NVIC_SetPriority(SysTick_IRQn, 15 ,0U);
 
+  /* Set MPU region for uart buffers and enable caches, before buffers are used */
+  if(DRIVER_MEMORY_Init() != DRIVER_OK )
+  {
+	  HAL_GPIO_WritePin(GPIOB,GPIO_PIN_0,GPIO_PIN_SET);
+  }
+
   /* Create demo task */
-  xTaskCreate(DemoTask,"DemoTask", 10000,NULL,2,NULL);
+  xTaskCreate(DemoTask,"DemoTask", DEMO_TASK_STACK,NULL,2,NULL);
 
   /* Set console config handle */
   consoleConfig.rxBuffer 	= rxbufferConsole;
@@ -147,11 +288,43 @@ int main(void)
   mqttConfig.gsmHandler 	= &gsm;
   mqttConfig.consoleHandler = &console;
 
+  /* Set demo task arena config handle */
+  demoArenaConfig.storage 	= demoArenaStorage;
+  demoArenaConfig.size 		= sizeof(demoArenaStorage);
+
+  /* Set async task arena and async operations config handle */
+  asyncArenaConfig.storage 	= asyncArenaStorage;
+  asyncArenaConfig.size 	= sizeof(asyncArenaStorage);
+  asyncConfig.arenaHandler 	= &asyncArena;
+
+  /* Set connection manager config handle, the same broker as establish tcpip */
+  linkConfig.gsmHandler 			= &gsmHandler;
+  linkConfig.mqttHandler 			= &mqtt;
+  linkConfig.PDP 					= (const uint8_t*)"1\r";
+  linkConfig.server.connectType 	= '1';
+  linkConfig.server.ipAddr 		= (uint8_t*)"5.196.95.208";
+  linkConfig.server.port 			= (uint8_t*)"1883";
+  linkArenaConfig.storage 			= linkArenaStorage;
+  linkArenaConfig.size 				= sizeof(linkArenaStorage);
+  linkConfig.arenaHandler 			= &linkArena;
+
   /* Set mqtt client config handle */
   mqttClientConfig.gsm	 	= &gsm;
   mqttClientConfig.console 	= &console;
   mqttClientConfig.mqtt		= &mqtt;
 
+  /* Set health monitor config handle */
+  healthConfig.consoleHandler 	= &console;
+  healthConfig.mqttHandler 		= &mqtt;
+  healthConfig.arenaHandler 	= &demoArena;
+
+  /* Set clock profile config handle, uarts and timer keep their rates in every profile */
+  sysClockConfig.profile 		= CLOCK_PROFILE_LOW_POWER;
+  sysClockConfig.uartBase[0] 	= &huart3;
+  sysClockConfig.uartBase[1] 	= &huart6;
+  sysClockConfig.timerBase 		= &htim6;
+  sysClockConfig.timerFrequency = 1000;
+
   /* Initialize console  */
   if(DRIVER_CONSOLE_Init(&console, &consoleConfig) != DRIVER_OK )
   {
@@ -170,30 +343,104 @@ int main(void)
 	  HAL_GPIO_WritePin(GPIOB,GPIO_PIN_0,GPIO_PIN_SET);
   }
 
+  /* Initialize clock profile, after uarts and timer are initialized  */
+  if(DRIVER_CLOCK_Init(&sysClock, &sysClockConfig) != DRIVER_OK )
+  {
+	  HAL_GPIO_WritePin(GPIOB,GPIO_PIN_0,GPIO_PIN_SET);
+  }
+
+  /* Initialize at engine that sends commands of all tasks to gsm */
+  atConfig.gsm = &gsm;
+  if(AT_Init(&at, &atConfig) != DRIVER_OK )
+  {
+	  HAL_GPIO_WritePin(GPIOB,GPIO_PIN_0,GPIO_PIN_SET);
+  }
+
   /* Initialize gsm handler in middleware layer */
   if(GSM_Init(&gsmHandler, &gsmCofig) != DRIVER_OK )
   {
 	  HAL_GPIO_WritePin(GPIOB,GPIO_PIN_0,GPIO_PIN_SET);
   }
 
+  /* Unsolicited lines are written to console by demo task  */
+  demoUrc.mask = AT_URC_MASK(AT_URC_NEW_SMS) | AT_URC_MASK(AT_URC_CLOSED) | AT_URC_MASK(AT_URC_PDP_DEACT) |
+                 AT_URC_MASK(AT_URC_CREG) | AT_URC_MASK(AT_URC_CGREG) | AT_URC_MASK(AT_URC_RING);
+  demoUrc.queue = xQueueCreate(DEMO_URC_QUEUE_LENGTH, sizeof(ATUrcEvent_t));
+  if(demoUrc.queue == NULL || AT_URC_Subscribe(&demoUrc) != DRIVER_OK )
+  {
+	  HAL_GPIO_WritePin(GPIOB,GPIO_PIN_0,GPIO_PIN_SET);
+  }
+
   /* Initialize mqtt protocol  */
   if(MQTT_Init(&mqtt, &mqttConfig) != MQTT_OK )
   {
 	  HAL_GPIO_WritePin(GPIOB,GPIO_PIN_0,GPIO_PIN_SET);
   }
 
+  /* Initialize block pools for at command, sms record and mqtt packet buffers  */
+  if(POOL_Init() != POOL_OK )
+  {
+	  HAL_GPIO_WritePin(GPIOB,GPIO_PIN_0,GPIO_PIN_SET);
+  }
+
+  /* Initialize arena of demo task  */
+  if(ARENA_Init(&demoArena, &demoArenaConfig) != ARENA_OK )
+  {
+	  HAL_GPIO_WritePin(GPIOB,GPIO_PIN_0,GPIO_PIN_SET);
+  }
+
+  /* Initialize async task that runs gsm and mqtt operations while their callers do other work  */
+  if(ARENA_Init(&asyncArena, &asyncArenaConfig) != ARENA_OK || ASYNC_Init(&async, &asyncConfig) != DRIVER_OK )
+  {
+	  HAL_GPIO_WritePin(GPIOB,GPIO_PIN_0,GPIO_PIN_SET);
+  }
+
+  /* Initialize connection manager and its task, it keeps connection only after "link on"  */
+  if(ARENA_Init(&linkArena, &linkArenaConfig) != ARENA_OK || LINK_Init(&linkManager, &linkConfig) != DRIVER_OK )
+  {
+	  HAL_GPIO_WritePin(GPIOB,GPIO_PIN_0,GPIO_PIN_SET);
+  }
+
   /* Initialize mqtt client interface  */
   if(MQTT_CLIENT_Init(&mqttCient, &mqttClientConfig) != MQTT_CLIENT_OK )
   {
 	  HAL_GPIO_WritePin(GPIOB,GPIO_PIN_0,GPIO_PIN_SET);
   }
 
+  /* Initialize run time statistics of tasks  */
+  if(RUNTIME_Init(&runtime) != RUNTIME_OK )
+  {
+	  HAL_GPIO_WritePin(GPIOB,GPIO_PIN_0,GPIO_PIN_SET);
+  }
+
+  /* Initialize health monitor, its task samples watermarks also when console is not attached  */
+  if(HEALTH_Init(&health, &healthConfig) != HEALTH_OK )
+  {
+	  HAL_GPIO_WritePin(GPIOB,GPIO_PIN_0,GPIO_PIN_SET);
+  }
+
+  /* Names of queues that are shown in trace dump */
+  vQueueAddToRegistry(console.ConsoleQueueTransmit, "ConsoleTx");
+  vQueueAddToRegistry(console.ConsoleQueueReceive, "ConsoleRx");
+  vQueueAddToRegistry(gsm.GsmQueueTransmit, "GsmTx");
+  vQueueAddToRegistry(mqttCient.mqttClientQueue, "MqttClient");
+  vQueueAddToRegistry(at.queue[AT_PRIORITY_CONTROL], "AtControl");
+  vQueueAddToRegistry(at.queue[AT_PRIORITY_KEEPALIVE], "AtKeepAlive");
+  vQueueAddToRegistry(at.queue[AT_PRIORITY_BULK], "AtBulk");
+  vQueueAddToRegistry(demoUrc.queue, "DemoUrc");
+  vQueueAddToRegistry(async.queue, "Async");
+  vQueueAddToRegistry(linkManager.events, "LinkEvents");
+
+  /* Initialize event trace, recording starts immediately */
+  DRIVER_TRACE_Init();
+
   /* Start timer for counting time */
   HAL_TIM_Base_Start_IT(&htim6);
 
-  /* Set priority of interrupt routines */
+  /* Set priority of interrupt routines, uart interrupts notify io task, so they can't be above
+     configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY */
   HAL_NVIC_SetPriority(USART3_IRQn,6,0);
-  HAL_NVIC_SetPriority(USART6_IRQn,2,0);
+  HAL_NVIC_SetPriority(USART6_IRQn,5,0);
   HAL_NVIC_SetPriority(TIM6_DAC_IRQn,8,0);
   HAL_NVIC_EnableIRQ(USART6_IRQn);
   HAL_NVIC_EnableIRQ(USART3_IRQn);
@@ -214,6 +461,9 @@ int main(void)
 }
 void DemoTask(void* pvParameters){
 
+	  /* Middleware called from this task takes its buffers from demo arena */
+	  ARENA_Bind(&demoArena);
+
 	  /* Write main menu when we turn on/reset microcontroller  */
 	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Aviable commands:\r\n");
 	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"set echo - set echo on or off!\r\n");
@@ -226,8 +476,7 @@ void DemoTask(void* pvParameters){
 	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"send message - send message from storage or directly!\r\n");
 	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"store message - store message in storage!\r\n");
 	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Commands to directly comunicate with gsm modul:\r\n");
-	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"read - read buffer for receving characters from gsm\r\n");
-	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"flush - set buffer for receiving characters from gsm to initial state\r\n");
+	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"read - show unsolicited lines from gsm that came since last command\r\n");
 	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"send cmd - send command directly to gsm modul \r\n");
 	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Commands for network and TCPIP connection:\r\n");
 	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"turn on mobile network - network registration to mobile station\r\n");
@@ -260,19 +509,50 @@ void DemoTask(void* pvParameters){
 	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"establish tcpip - does 4 commands: turn on mobile network, active pdp, connect to server and set packet format of TCPIP connection\r\n");
 	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Command that implement mqtt client:\r\n");
 	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"mqtt client set - set state of mqtt client(either can be CLOSE or LISTEN)\r\n");
+	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Commands for diagnostics:\r\n");
+	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"top - cpu usage, stack high water mark, state and priority of tasks, refreshed until enter is pressed\r\n");
+	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"top raw - one snapshot of task statistics as comma separated lines for host tools\r\n");
+	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"publish top - publish snapshot of task statistics to topic " DEMO_TOP_TOPIC " on broker\r\n");
+	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"trace dump - write recorded events (convert them on host with Tools/trace2timeline.py)\r\n");
+	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"trace on/trace off/trace clear - continue, pause or restart recording of events\r\n");
+	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"health - last sample of free stack of tasks, minimum free heap and pool and arena usage\r\n");
+	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"publish health - publish health summary to topic " HEALTH_TOPIC " on broker (it is also published periodically)\r\n");
+	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"clock - running clock profile, clocks and number of profile switches\r\n");
+	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"clock low power/clock balanced/clock full speed - set base clock profile (64MHz HSI, 200MHz or 480/400MHz PLL)\r\n");
+	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"io stats - show wakeups of io task, cost of gsm reads in core cycles, unsolicited lines and waits for gsm\r\n");
+	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"at bench - cycles of searching result code in long answer, strstr of whole answer against matcher\r\n");
+	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"pdu bench - cycles of packing 7 bit text septet by septet against word at a time, pdu round trip\r\n");
+	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"gsm stats - show executions, errors, timeouts, longest time and skipped calls of every gsm command\r\n");
+	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"network info - read registration, signal quality and operator and show them with last IP address and contexts\r\n");
+	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"wait online - wait until gsm is registered, attached to GPRS service and connected to server\r\n");
+	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"timeouts - show learned timeouts and latency of every class of at commands\r\n");
+	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"timeouts save - save learned timeouts in flash now\r\n");
+	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"latency - show commands, errors, timeouts and latency histogram of every class of at commands\r\n");
+	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"latency clear/publish latency - start new measurement or publish histograms to topic " DEMO_LATENCY_TOPIC "\r\n");
+	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"bringup bench - close connection and compare time of sequential and pipelined bring up\r\n");
+	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"publish async - publish uptime to topic " DEMO_ASYNC_TOPIC " in async task while demo task keeps sampling\r\n");
+	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"link on/link off - keep connection with broker up, broken layers are repaired with backoff\r\n");
+	  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"link stats - lowest broken layer, outages and time to recover of every layer\r\n");
 	  for(;;){
 
+		  /* Buffers of previous command are not needed anymore */
+		  ARENA_Reset(&demoArena);
+
 		  /* Waiting user's input from cosole */
 		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nWaiting input command...\r\n");
-		  DRIVER_CONSOLE_Get(&console, bufferConsole, &size, portMAX_DELAY);
-
-		  /* Finding user's command and activating that command in the next part of the code */
-		  if(strstr((const char*)bufferConsole,(const char*)"flush\r") != NULL)
+		  while(DRIVER_CONSOLE_Get(&console, bufferConsole, &size, DEMO_URC_POLL_PERIOD) == DRIVER_TIMEOUT)
 		  {
-			  DRIVER_GSM_Flush(&gsm);
-			  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nFlushed\r\n");
+			  /* Unsolicited lines that came while waiting */
+			  ATUrcEvent_t event;
+			  while(xQueueReceive(demoUrc.queue, &event, 0) == pdTRUE)
+			  {
+				  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nUnsolicited: ");
+				  DRIVER_CONSOLE_Put(&console, event.text);
+			  }
 		  }
-		  else if(strstr((const char*)bufferConsole,(const char*)"set echo\r") != NULL)
+
+		  /* Finding user's command and activating that command in the next part of the code */
+		  if(strstr((const char*)bufferConsole,(const char*)"set echo\r") != NULL)
 		  {
 				DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nSetting echo ...\r\n");
 
@@ -303,19 +583,16 @@ void DemoTask(void* pvParameters){
 					switch(onlyPutNumber(&console, buffer, &size, sizeof(buffer), timeout)){
 					case DRIVER_TIMEOUT:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for input has expired! Please try again comand! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_ERROR:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Not enough space for receiving characters from gsm! Increase size of buffer! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_OK:
 						if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end function */
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Returning to waiting command... \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						}
@@ -334,7 +611,6 @@ void DemoTask(void* pvParameters){
 						if(incorrectInput == 2)
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Error, failed input attempt! Please try again command! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						}
@@ -388,19 +664,16 @@ void DemoTask(void* pvParameters){
 					switch(onlyPutNumber(&console, buffer, &size, sizeof(buffer), timeout)){
 					case DRIVER_TIMEOUT:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for input has expired! Please try again comand! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_ERROR:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Not enough space for receiving characters from gsm! Increase size of buffer! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 		  			case DRIVER_OK:
 		  				if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end function */
 		  				{
 		  					DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Returning to waiting command... \r\n");
-		  					DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 		  				}
@@ -419,7 +692,6 @@ void DemoTask(void* pvParameters){
 						if(incorrectInput == 2)
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Error, failed input attempt! Please try again command! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						}
@@ -465,7 +737,7 @@ void DemoTask(void* pvParameters){
 		  		uint32_t size = 0;
 
 		  		/* Set buffer for storing answer from gsm */
-		  		uint8_t gsmRsp[1000] = {0};
+		  		uint8_t *gsmRsp = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
 
 		  		/* Set input structure */
 		  		SetMsgStrgInputStruct_t inputStruct =
@@ -491,19 +763,16 @@ void DemoTask(void* pvParameters){
 					switch(onlyPutNumber(&console, buffer, &size, sizeof(buffer), timeout)){
 					case DRIVER_TIMEOUT:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for input has expired! Please try again comand! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_ERROR:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Not enough space for receiving characters from gsm! Increase size of buffer! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 		  			case DRIVER_OK:
 		  				if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end function */
 		  				{
 		  					DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Returning to waiting command... \r\n");
-		  					DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 		  				}
@@ -522,7 +791,6 @@ void DemoTask(void* pvParameters){
 						if(incorrectInput == 2)
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Error, failed input attempt! Please try again command! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						}
@@ -556,19 +824,16 @@ void DemoTask(void* pvParameters){
 						switch(onlyPutNumber(&console, buffer, &size, sizeof(buffer), timeout)){
 						case DRIVER_TIMEOUT:
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for input has expired! Please try again comand! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						case DRIVER_ERROR:
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Not enough space for receiving characters from gsm! Increase size of buffer! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						case DRIVER_OK:
 							if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end function */
 							{
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Returning to waiting command... \r\n");
-								DRIVER_GSM_Flush(&gsm);
 								breakFlag = 1;
 								break;
 							}
@@ -587,7 +852,6 @@ void DemoTask(void* pvParameters){
 							if(incorrectInput == 2)
 							{
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Error, failed input attempt! Please try again command! \r\n");
-								DRIVER_GSM_Flush(&gsm);
 								breakFlag = 1;
 								break;
 							}
@@ -620,19 +884,16 @@ void DemoTask(void* pvParameters){
 							switch(onlyPutNumber(&console, buffer, &size, sizeof(buffer), timeout)){
 							case DRIVER_TIMEOUT:
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for input has expired! Please try again comand! \r\n");
-								DRIVER_GSM_Flush(&gsm);
 								breakFlag = 1;
 								break;
 							case DRIVER_ERROR:
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Not enough space for receiving characters from gsm! Increase size of buffer! \r\n");
-								DRIVER_GSM_Flush(&gsm);
 								breakFlag = 1;
 								break;
 							case DRIVER_OK:
 								if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end function */
 								{
 									DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Returning to waiting command... \r\n");
-									DRIVER_GSM_Flush(&gsm);
 									breakFlag = 1;
 									break;
 								}
@@ -651,7 +912,6 @@ void DemoTask(void* pvParameters){
 								if(incorrectInput == 2)
 								{
 									DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Error, failed input attempt! Please try again command! \r\n");
-									DRIVER_GSM_Flush(&gsm);
 									breakFlag = 1;
 									break;
 								}
@@ -696,101 +956,12 @@ void DemoTask(void* pvParameters){
 
 				/* First variable is for pdu format, second is for text format*/
 				ListMsgInputStruct_t inputStruct;
-				ListMsgOutputStruct_t outputStruct;
-
-				/* output of function for list messages function */
-				uint32_t indexofMsg[20] = {0};
-
-				uint8_t msg0[100] = {0};
-				uint8_t msg1[100] = {0};
-				uint8_t msg2[100] = {0};
-				uint8_t msg3[100] = {0};
-				uint8_t msg4[100] = {0};
-				uint8_t msg5[100] = {0};
-				uint8_t msg6[100] = {0};
-				uint8_t msg7[100] = {0};
-				uint8_t msg8[100] = {0};
-				uint8_t msg9[100] = {0};
-				uint8_t msg10[100] = {0};
-				uint8_t msg11[100] = {0};
-				uint8_t msg12[100] = {0};
-				uint8_t msg13[100] = {0};
-				uint8_t msg14[100] = {0};
-				uint8_t msg15[100] = {0};
-				uint8_t msg16[100] = {0};
-				uint8_t msg17[100] = {0};
-				uint8_t msg18[100] = {0};
-				uint8_t msg19[100] = {0};
-				uint8_t *message[20] = { msg0, msg1, msg2, msg3, msg4, msg5, msg6, msg7, msg8, msg9, msg10, msg11, msg12, msg13, msg14, msg15, msg16, msg17, msg18, msg19};
-
-				uint8_t no0[100] = {0};
-				uint8_t no1[100] = {0};
-				uint8_t no2[100] = {0};
-				uint8_t no3[100] = {0};
-				uint8_t no4[100] = {0};
-				uint8_t no5[100] = {0};
-				uint8_t no6[100] = {0};
-				uint8_t no7[100] = {0};
-				uint8_t no8[100] = {0};
-				uint8_t no9[100] = {0};
-				uint8_t no10[100] = {0};
-				uint8_t no11[100] = {0};
-				uint8_t no12[100] = {0};
-				uint8_t no13[100] = {0};
-				uint8_t no14[100] = {0};
-				uint8_t no15[100] = {0};
-				uint8_t no16[100] = {0};
-				uint8_t no17[100] = {0};
-				uint8_t no18[100] = {0};
-				uint8_t no19[100] = {0};
-				uint8_t *number[20] = { no0, no1, no2, no3, no4, no5, no6, no7, no8, no9, no10, no11, no12, no13, no14, no15, no16, no17, no18, no19};
-
-				uint8_t tpy0[100] = {0};
-				uint8_t tpy1[100] = {0};
-				uint8_t tpy2[100] = {0};
-				uint8_t tpy3[100] = {0};
-				uint8_t tpy4[100] = {0};
-				uint8_t tpy5[100] = {0};
-				uint8_t tpy6[100] = {0};
-				uint8_t tpy7[100] = {0};
-				uint8_t tpy8[100] = {0};
-				uint8_t tpy9[100] = {0};
-				uint8_t tpy10[100] = {0};
-				uint8_t tpy11[100] = {0};
-				uint8_t tpy12[100] = {0};
-				uint8_t tpy13[100] = {0};
-				uint8_t tpy14[100] = {0};
-				uint8_t tpy15[100] = {0};
-				uint8_t tpy16[100] = {0};
-				uint8_t tpy17[100] = {0};
-				uint8_t tpy18[100] = {0};
-				uint8_t tpy19[100] = {0};
-				uint8_t *typeOfMsg[20] = { tpy0, tpy1, tpy2, tpy3, tpy4, tpy5, tpy6, tpy7, tpy8, tpy9, tpy10, tpy11, tpy12, tpy13, tpy14, tpy15, tpy16, tpy17, tpy18, tpy19};
-
-				uint8_t time0[100] = {0};
-				uint8_t time1[100] = {0};
-				uint8_t time2[100] = {0};
-				uint8_t time3[100] = {0};
-				uint8_t time4[100] = {0};
-				uint8_t time5[100] = {0};
-				uint8_t time6[100] = {0};
-				uint8_t time7[100] = {0};
-				uint8_t time8[100] = {0};
-				uint8_t time9[100] = {0};
-				uint8_t time10[100] = {0};
-				uint8_t time11[100] = {0};
-				uint8_t time12[100] = {0};
-				uint8_t time13[100] = {0};
-				uint8_t time14[100] = {0};
-				uint8_t time15[100] = {0};
-				uint8_t time16[100] = {0};
-				uint8_t time17[100] = {0};
-				uint8_t time18[100] = {0};
-				uint8_t time19[100] = {0};
-				uint8_t *timeReceived[20] = { time0, time1, time2, time3, time4, time5, time6, time7, time8, time9, time10, time11, time12, time13, time14, time15, time16, time17, time18, time19};
-
-				uint32_t msgNo = 0;
-				outputStruct.msgNoStruct = &msgNo;
+
+				/* Messages are given one by one while gsm lists them, only text for broker is kept */
+				DemoSmsPublish_t publish = {.text = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE)};
+				GSMSmsList_t *list = ARENA_Calloc(&demoArena, sizeof(GSMSmsList_t));
+				list->Message = DemoListMessage;
+				list->context = &publish;
 				/* input of function */
 				char typeOfMsgChar = 0;
 				uint8_t typeOfMsgStr[11] = {0};
@@ -800,31 +971,6 @@ void DemoTask(void* pvParameters){
 				inputStruct.sizeOfTypeOfMsgStr = 0;
 				memset(inputStruct.typeOfMsgStr,0,sizeof(inputStruct.typeOfMsgStr));
 
-				/* set output structure */
-				outputStruct.msgNoStruct = 0;
-
-				for ( uint8_t i = 0; i < sizeof(outputStruct.index); i++)
-				{
-					outputStruct.index[i] = indexofMsg[i]; /* assign the address of integer. */
-				}
-				for ( uint8_t i = 0; i <  sizeof(outputStruct.number); i++)
-				{
-					outputStruct.number[i] = number[i]; /* assign the address of integer. */
-				}
-				for ( uint8_t i = 0; i <  sizeof(outputStruct.timeReceived); i++)
-				{
-					outputStruct.timeReceived[i] = timeReceived[i]; /* assign the address of integer. */
-				}
-				for ( uint8_t i = 0; i <  20; i++)
-				{
-					outputStruct.typeOfMsg[i] = typeOfMsg[i]; /* assign the address of integer. */
-				}
-				for ( uint8_t i = 0; i < 20; i++)
-				{
-					outputStruct.message[i] = message[i]; /* assign the address of integer. */
-
-				}
-
 				/* Request to user */
 				DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Which type of message would you like to list?\r\n");
 				DRIVER_CONSOLE_Put(&console,(const uint8_t*)" 1 Received unread message\r\n 2 Received read message\r\n");
@@ -841,19 +987,16 @@ void DemoTask(void* pvParameters){
 					switch(onlyPutNumber(&console, buffer, &size, sizeof(buffer), timeout)){
 					case DRIVER_TIMEOUT:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for input has expired! Please try again comand! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_ERROR:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Not enough space for receiving characters from gsm! Increase size of buffer! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_OK:
 						if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end function */
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Returning to waiting command... \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						}
@@ -875,7 +1018,6 @@ void DemoTask(void* pvParameters){
 						if(incorrectInput == 2)
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Error, failed input attempt! Please try again command! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						}
@@ -899,7 +1041,7 @@ void DemoTask(void* pvParameters){
 
 					inputStruct.typeOfMsgChar = typeOfMsgChar;
 
-					GSM_ListMsg(&gsmHandler, 10000,inputStruct, &outputStruct);
+					GSM_ListMsg(&gsmHandler, 10000,inputStruct, list);
 
 					/* Set buffer and his size to zero */
 					memset(buffer,0,sizeof(buffer));
@@ -916,19 +1058,16 @@ void DemoTask(void* pvParameters){
 						switch(onlyPutNumber(&console, buffer, &size, sizeof(buffer), timeout)){
 						case DRIVER_TIMEOUT:
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for input has expired! Please try again comand! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						case DRIVER_ERROR:
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Not enough space for receiving characters from gsm! Increase size of buffer! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						case DRIVER_OK:
 							if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end function */
 							{
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Returning to waiting command... \r\n");
-								DRIVER_GSM_Flush(&gsm);
 								breakFlag = 1;
 								break;
 							}
@@ -946,7 +1085,6 @@ void DemoTask(void* pvParameters){
 							if(incorrectInput == 2)
 							{
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Error, failed input attempt! Please try again command! \r\n");
-								DRIVER_GSM_Flush(&gsm);
 								breakFlag = 1;
 								break;
 							}
@@ -965,36 +1103,12 @@ void DemoTask(void* pvParameters){
 					{
 						if(*buffer == '1')
 						{
-							uint8_t msgtoSend[1000] = {0};
-							uint32_t msgSize = 0;
-							for(uint32_t i = 0;i < *outputStruct.msgNoStruct;i++)
-							{
-								if(outputStruct.index[i] >= 10)
-								{
-									uint32_t mod = outputStruct.index[i] / 10;
-									uint32_t rest =  outputStruct.index[i] % 10;
-									msgtoSend[msgSize] = mod + '0';
-									msgtoSend[msgSize + 1] = rest + '0';
-								}
-								else
-									msgtoSend[msgSize] = outputStruct.index[i] + '0';
-								strcat((char*)msgtoSend," ");
-								strcat((char*)msgtoSend,(const char*)outputStruct.typeOfMsg[i]);
-								strcat((char*)msgtoSend," ");
-								strcat((char*)msgtoSend,(const char*)outputStruct.number[i]);
-								strcat((char*)msgtoSend," ");
-								if(outputStruct.timeReceived[i][2] != 0)
-								{
-									strcat((char*)msgtoSend,(const char*)outputStruct.timeReceived[i]);
-									strcat((char*)msgtoSend," ");
-								}
-								strcat((char*)msgtoSend,(const char*)outputStruct.message[i]);
-								strcat((char*)msgtoSend,"\r\n");
-								msgSize = strlen((const char*)msgtoSend);
-							}
+							uint8_t *msgtoSend = publish.text;
+							if(publish.dropCount != 0)
+								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Not all messages fit in one publish, first ones are sent!\r\n");
 
 							/* topic that will be sent to gsm */
-							uint8_t topic[1000] = {0};
+							uint8_t *topic = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
 
 							memset(buffer,0,sizeof(buffer));
 							size = 0;
@@ -1007,19 +1121,16 @@ void DemoTask(void* pvParameters){
 							switch(DRIVER_CONSOLE_Get(&console, buffer, &size, timeout)){
 							case DRIVER_TIMEOUT:
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-								DRIVER_GSM_Flush(&gsm);
 								breakFlag = 1;
 								break;
 							case DRIVER_ERROR:
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError received, not enough space for receiving characters! Please update your buffer! \r\n");
-								DRIVER_GSM_Flush(&gsm);
 								breakFlag = 1;
 								break;
 							case DRIVER_OK:
 								if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end sending message */
 								{
 									DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Leaving command... \r\nMessage unsent!\r\n");
-									DRIVER_GSM_Flush(&gsm);
 									breakFlag = 1;
 								}
 								else
@@ -1033,6 +1144,7 @@ void DemoTask(void* pvParameters){
 						}
 					}
 				}
+
 		  }
 		  else if(strstr((const char*)bufferConsole,(const char*)"read message\r") != NULL)
 		  {
@@ -1047,18 +1159,17 @@ void DemoTask(void* pvParameters){
 				/* How many characters are received from gsm-it's importent to be zero initialize */
 				uint32_t size = 0;
 
-				uint8_t typeOfMsg[15] = {0};
-				uint8_t number[25] = {0};
-				uint8_t timeReceived[25] = {0};
-				uint8_t message[100] = {0};
+				/* Readed message is kept in sms record taken from pool */
+				GSMSmsRecord_t *record = POOL_Calloc(sizeof(GSMSmsRecord_t));
+				if(record == NULL) record = ARENA_Calloc(&demoArena, sizeof(GSMSmsRecord_t));
 				/* First variable is for pdu format, second is for text format*/
 				ReadMsgInputStruct_t inputStruct = {.msgIndex = {0}};
 				ReadMsgOutputStruct_t outputStruct =
 				{
-						.typeOfMsg = typeOfMsg,
-						.number = number,
-						.timeReceived = timeReceived,
-						.message = message
+						.typeOfMsg = record->typeOfMsg,
+						.number = record->number,
+						.timeReceived = record->timeReceived,
+						.message = record->message
 				};
 
 
@@ -1075,19 +1186,16 @@ void DemoTask(void* pvParameters){
 					switch(onlyPutNumber(&console, buffer, &size, sizeof(buffer), timeout)){
 					case DRIVER_TIMEOUT:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for input has expired! Please try again comand! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_ERROR:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Not enough space for receiving characters from gsm! Increase size of buffer! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_OK:
 						if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end function */
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Returning to waiting command... \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						}
@@ -1105,7 +1213,6 @@ void DemoTask(void* pvParameters){
 						if(incorrectInput == 2)
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Error, failed input attempt! Please try again command! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						}
@@ -1142,19 +1249,16 @@ void DemoTask(void* pvParameters){
 						switch(onlyPutNumber(&console, buffer, &size, sizeof(buffer), timeout)){
 						case DRIVER_TIMEOUT:
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for input has expired! Please try again comand! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						case DRIVER_ERROR:
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Not enough space for receiving characters from gsm! Increase size of buffer! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						case DRIVER_OK:
 							if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end function */
 							{
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Returning to waiting command... \r\n");
-								DRIVER_GSM_Flush(&gsm);
 								breakFlag = 1;
 								break;
 							}
@@ -1172,7 +1276,6 @@ void DemoTask(void* pvParameters){
 							if(incorrectInput == 2)
 							{
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Error, failed input attempt! Please try again command! \r\n");
-								DRIVER_GSM_Flush(&gsm);
 								breakFlag = 1;
 								break;
 							}
@@ -1191,7 +1294,7 @@ void DemoTask(void* pvParameters){
 					{
 						if(*buffer == '1')
 						{
-							uint8_t msgtoSend[1000] = {0};
+							uint8_t *msgtoSend = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
 
 							if(inputStruct.msgIndex[1] != '\r')
 							{
@@ -1216,7 +1319,7 @@ void DemoTask(void* pvParameters){
 							strcat((char*)msgtoSend,"\r\n");
 
 							/* topic that will be sent to gsm */
-							uint8_t topic[1000] = {0};
+							uint8_t *topic = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
 
 							memset(buffer,0,sizeof(buffer));
 							size = 0;
@@ -1229,19 +1332,16 @@ void DemoTask(void* pvParameters){
 							switch(DRIVER_CONSOLE_Get(&console, buffer, &size, timeout)){
 							case DRIVER_TIMEOUT:
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-								DRIVER_GSM_Flush(&gsm);
 								breakFlag = 1;
 								break;
 							case DRIVER_ERROR:
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError received, not enough space for receiving characters! Please update your buffer! \r\n");
-								DRIVER_GSM_Flush(&gsm);
 								breakFlag = 1;
 								break;
 							case DRIVER_OK:
 								if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end sending message */
 								{
 									DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Leaving command... \r\nMessage unsent!\r\n");
-									DRIVER_GSM_Flush(&gsm);
 									breakFlag = 1;
 								}
 								else
@@ -1255,6 +1355,8 @@ void DemoTask(void* pvParameters){
 						}
 					}
 				}
+
+				POOL_Free(record);
 		  }
 		  else if(strstr((const char*)bufferConsole,(const char*)"delete message\r") != NULL)
 		  {
@@ -1288,19 +1390,16 @@ void DemoTask(void* pvParameters){
 					switch(onlyPutNumber(&console, buffer, &size, sizeof(buffer), timeout)){
 					case DRIVER_TIMEOUT:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for input has expired! Please try again comand! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_ERROR:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Not enough space for receiving characters from gsm! Increase size of buffer! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_OK:
 						if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end function */
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Returning to waiting command... \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						}
@@ -1318,7 +1417,6 @@ void DemoTask(void* pvParameters){
 						if(incorrectInput == 2)
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Error, failed input attempt! Please try again command! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						}
@@ -1353,19 +1451,16 @@ void DemoTask(void* pvParameters){
 						switch(onlyPutNumber(&console, buffer, &size, sizeof(buffer), timeout)){
 						case DRIVER_TIMEOUT:
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for input has expired! Please try again comand! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						case DRIVER_ERROR:
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Not enough space for receiving characters from gsm! Increase size of buffer! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						case DRIVER_OK:
 							if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end function */
 							{
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Returning to waiting command... \r\n");
-								DRIVER_GSM_Flush(&gsm);
 								breakFlag = 1;
 								break;
 							}
@@ -1383,7 +1478,6 @@ void DemoTask(void* pvParameters){
 							if(incorrectInput == 2)
 							{
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Error, failed input attempt! Please try again command! \r\n");
-								DRIVER_GSM_Flush(&gsm);
 								breakFlag = 1;
 								break;
 							}
@@ -1415,19 +1509,16 @@ void DemoTask(void* pvParameters){
 						switch(onlyPutNumber(&console, buffer, &size, sizeof(buffer), timeout)){
 						case DRIVER_TIMEOUT:
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for input has expired! Please try again comand! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						case DRIVER_ERROR:
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Not enough space for receiving characters from gsm! Increase size of buffer! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						case DRIVER_OK:
 							if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end function */
 							{
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Returning to waiting command... \r\n");
-								DRIVER_GSM_Flush(&gsm);
 								breakFlag = 1;
 								break;
 							}
@@ -1445,7 +1536,6 @@ void DemoTask(void* pvParameters){
 							if(incorrectInput == 2)
 							{
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Error, failed input attempt! Please try again command! \r\n");
-								DRIVER_GSM_Flush(&gsm);
 								breakFlag = 1;
 								break;
 							}
@@ -1481,7 +1571,7 @@ void DemoTask(void* pvParameters){
 		  		DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nSending message...\r\n");
 
 				/* Buffer for putting answer from gsm */
-				uint8_t buffer[1000] = {0};
+				uint8_t *buffer = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
 
 				/* Flag that indicates when error in receiving from console occured */
 				uint8_t breakFlag = 0;
@@ -1502,7 +1592,7 @@ void DemoTask(void* pvParameters){
 				uint8_t number[100] = {0};
 
 				/* Message that will be sent to gsm */
-				uint8_t message[1000] = {0};
+				uint8_t *message = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
 
 				/* Set input structure */
 				SendOrStoreInputStruct_t inputStruct =
@@ -1528,22 +1618,19 @@ void DemoTask(void* pvParameters){
 				while(incorrectInput != 3)
 				{
 					/* function that request from user only number for answer */
-					switch(onlyPutNumber(&console, buffer, &size, sizeof(buffer), timeout)){
+					switch(onlyPutNumber(&console, buffer, &size, DEMO_BUFFER_SIZE, timeout)){
 					case DRIVER_TIMEOUT:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for input has expired! Please try again comand! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_ERROR:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Not enough space for receiving characters from gsm! Increase size of buffer! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_OK:
 						if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end function */
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Returning to waiting command... \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						}
@@ -1561,7 +1648,6 @@ void DemoTask(void* pvParameters){
 						if(incorrectInput == 2)
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Error, failed input attempt! Please try again command! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						}
@@ -1569,7 +1655,7 @@ void DemoTask(void* pvParameters){
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Enter number 1 or 2!\r\n ");
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)">>");
-							memset(buffer,0,sizeof(buffer));
+							memset(buffer,0,DEMO_BUFFER_SIZE);
 							size = 0;
 							incorrectInput++;
 						}
@@ -1584,7 +1670,7 @@ void DemoTask(void* pvParameters){
 					DRIVER_CONSOLE_Put(&console,(const uint8_t*)"1 Send from storage\r\n2 Send directly\r\n");
 
 					/* set buffer and his size to zero */
-					memset(buffer,0,sizeof(buffer));
+					memset(buffer,0,DEMO_BUFFER_SIZE);
 					size = 0;
 
 					/* Response from user */
@@ -1592,22 +1678,19 @@ void DemoTask(void* pvParameters){
 					while(incorrectInput != 3)
 					{
 						/* function that request from user only number for answer */
-						switch(onlyPutNumber(&console, buffer, &size, sizeof(buffer), timeout)){
+						switch(onlyPutNumber(&console, buffer, &size, DEMO_BUFFER_SIZE, timeout)){
 						case DRIVER_TIMEOUT:
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for input has expired! Please try again comand! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						case DRIVER_ERROR:
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Not enough space for receiving characters from gsm! Increase size of buffer! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						case DRIVER_OK:
 							if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end function */
 							{
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Returning to waiting command... \r\n");
-								DRIVER_GSM_Flush(&gsm);
 								breakFlag = 1;
 								break;
 							}
@@ -1625,7 +1708,6 @@ void DemoTask(void* pvParameters){
 							if(incorrectInput == 2)
 							{
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Error, failed input attempt! Please try again command! \r\n");
-								DRIVER_GSM_Flush(&gsm);
 								breakFlag = 1;
 								break;
 							}
@@ -1633,7 +1715,7 @@ void DemoTask(void* pvParameters){
 							{
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Enter number 1 or 2!\r\n ");
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)">>");
-								memset(buffer,0,sizeof(buffer));
+								memset(buffer,0,DEMO_BUFFER_SIZE);
 								size = 0;
 								incorrectInput++;
 							}
@@ -1648,7 +1730,7 @@ void DemoTask(void* pvParameters){
 					DRIVER_CONSOLE_Put(&console,(const uint8_t*)">>");
 
 					/* set buffer and his size to zero */
-					memset(buffer,0,sizeof(buffer));
+					memset(buffer,0,DEMO_BUFFER_SIZE);
 					size = 0;
 
 					/* Response from user */
@@ -1656,22 +1738,19 @@ void DemoTask(void* pvParameters){
 					while(incorrectInput != 3)
 					{
 						/* function that request from user only number for answer */
-						switch(onlyPutNumber(&console, buffer, &size, sizeof(buffer), timeout)){
+						switch(onlyPutNumber(&console, buffer, &size, DEMO_BUFFER_SIZE, timeout)){
 						case DRIVER_TIMEOUT:
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for input has expired! Please try again comand! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						case DRIVER_ERROR:
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Not enough space for receiving characters from gsm! Increase size of buffer! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						case DRIVER_OK:
 							if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end function */
 							{
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Returning to waiting command... \r\n");
-								DRIVER_GSM_Flush(&gsm);
 								breakFlag = 1;
 								break;
 							}
@@ -1689,7 +1768,6 @@ void DemoTask(void* pvParameters){
 							if(incorrectInput == 2)
 							{
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Error, failed input attempt! Please try again command! \r\n");
-								DRIVER_GSM_Flush(&gsm);
 								breakFlag = 1;
 								break;
 							}
@@ -1697,7 +1775,7 @@ void DemoTask(void* pvParameters){
 							{
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Enter any number except zero(0)!\r\n ");
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)">>");
-								memset(buffer,0,sizeof(buffer));
+								memset(buffer,0,DEMO_BUFFER_SIZE);
 								size = 0;
 								incorrectInput++;
 							}
@@ -1706,7 +1784,7 @@ void DemoTask(void* pvParameters){
 				}
 
 				/* set buffer and his size to zero */
-				memset(buffer,0,sizeof(buffer));
+				memset(buffer,0,DEMO_BUFFER_SIZE);
 				size = 0;
 
 				/* Request to user */
@@ -1721,12 +1799,10 @@ void DemoTask(void* pvParameters){
 					switch(DRIVER_CONSOLE_Get(&console, buffer, &size, timeout)){
 					case DRIVER_TIMEOUT:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for input has expired! Please try again comand! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_ERROR:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Not enough space for receiving characters from gsm! Increase size of buffer! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_OK:
@@ -1751,7 +1827,6 @@ void DemoTask(void* pvParameters){
 								if(incorrectInput == 2)
 								{
 									DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Error, failed input attempt! Please try again command! \r\n");
-									DRIVER_GSM_Flush(&gsm);
 									breakFlag = 1;
 									break;
 								}
@@ -1767,7 +1842,7 @@ void DemoTask(void* pvParameters){
 					else
 					{
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)">>");
-						memset(buffer,0,sizeof(buffer));
+						memset(buffer,0,DEMO_BUFFER_SIZE);
 						size = 0;
 					}
 				}
@@ -1775,7 +1850,7 @@ void DemoTask(void* pvParameters){
 				if(storeOrSendDirectFlag != '1')
 				{
 					/* Reset buffer and his size */
-					memset(buffer,0,sizeof(buffer));
+					memset(buffer,0,DEMO_BUFFER_SIZE);
 					size = 0;
 
 					/* Request to user */
@@ -1786,19 +1861,16 @@ void DemoTask(void* pvParameters){
 					switch(DRIVER_CONSOLE_Get(&console, buffer, &size, timeout)){
 					case DRIVER_TIMEOUT:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_ERROR:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError received, not enough space for receiving characters! Please update your buffer! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_OK:
 						if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end sending message */
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Leaving command... \r\nMessage unsent!\r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						}
@@ -1812,7 +1884,7 @@ void DemoTask(void* pvParameters){
 					inputStruct.sendOrStoreFlag = sendOrStoreFlag;
 					inputStruct.storeOrSendDirectFlag = storeOrSendDirectFlag;
 					/* set buffer and his size to zero */
-					memset(buffer,0,sizeof(buffer));
+					memset(buffer,0,DEMO_BUFFER_SIZE);
 					size = 0;
 					outputStruct.gsmRsp = buffer;
 
@@ -1865,7 +1937,7 @@ void DemoTask(void* pvParameters){
 		  		DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nSetting PDP...\r\n");
 
 				/* Buffer for putting answer from gsm */
-				uint8_t buffer[1000] = {0};
+				uint8_t *buffer = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
 
 				/* Flag that indicates when error in receiving from console occured */
 				uint8_t breakFlag = 0;
@@ -1898,22 +1970,19 @@ void DemoTask(void* pvParameters){
 				while(incorrectInput != 3)
 				{
 					/* function that request from user only number for answer */
-					switch(onlyPutNumber(&console, buffer, &size, sizeof(buffer), timeout)){
+					switch(onlyPutNumber(&console, buffer, &size, DEMO_BUFFER_SIZE, timeout)){
 					case DRIVER_TIMEOUT:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for input has expired! Please try again comand! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_ERROR:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Not enough space for receiving characters from gsm! Increase size of buffer! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_OK:
 						if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end function */
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Returning to waiting command... \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						}
@@ -1940,7 +2009,6 @@ void DemoTask(void* pvParameters){
 						if(incorrectInput == 2)
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Error, failed input attempt! Please try again command! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						}
@@ -1948,7 +2016,7 @@ void DemoTask(void* pvParameters){
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Enter number from 1 to 16!\r\n ");
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)">>");
-							memset(buffer,0,sizeof(buffer));
+							memset(buffer,0,DEMO_BUFFER_SIZE);
 							size = 0;
 							incorrectInput++;
 						}
@@ -1965,22 +2033,19 @@ void DemoTask(void* pvParameters){
 				while(incorrectInput != 3)
 				{
 					/* function that request from user only number for answer */
-					switch(onlyPutNumber(&console, buffer, &size, sizeof(buffer), timeout)){
+					switch(onlyPutNumber(&console, buffer, &size, DEMO_BUFFER_SIZE, timeout)){
 					case DRIVER_TIMEOUT:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for input has expired! Please try again comand! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_ERROR:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Not enough space for receiving characters from gsm! Increase size of buffer! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_OK:
 						if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end function */
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Returning to waiting command... \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						}
@@ -2002,7 +2067,6 @@ void DemoTask(void* pvParameters){
 						if(incorrectInput == 2)
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Error, failed input attempt! Please try again command! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						}
@@ -2010,7 +2074,7 @@ void DemoTask(void* pvParameters){
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Enter number from 1 to 16!\r\n ");
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)">>");
-							memset(buffer,0,sizeof(buffer));
+							memset(buffer,0,DEMO_BUFFER_SIZE);
 							size = 0;
 							incorrectInput++;
 						}
@@ -2035,7 +2099,6 @@ void DemoTask(void* pvParameters){
 					if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end function */
 					{
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Returning to waiting command... \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					}
@@ -2071,7 +2134,7 @@ void DemoTask(void* pvParameters){
 		  		DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nActivating PDP...\r\n");
 
 				/* Buffer for putting answer from gsm */
-				uint8_t buffer[1000] = {0};
+				uint8_t *buffer = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
 
 				/* Flag that indicates when error in receiving from console occured */
 				uint8_t breakFlag = 0;
@@ -2096,22 +2159,19 @@ void DemoTask(void* pvParameters){
 				while(incorrectInput != 3)
 				{
 					/* function that request from user only number for answer */
-					switch(onlyPutNumber(&console, buffer, &size, sizeof(buffer), timeout)){
+					switch(onlyPutNumber(&console, buffer, &size, DEMO_BUFFER_SIZE, timeout)){
 					case DRIVER_TIMEOUT:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for input has expired! Please try again comand! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_ERROR:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Not enough space for receiving characters from gsm! Increase size of buffer! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_OK:
 						if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end function */
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Returning to waiting command... \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						}
@@ -2138,7 +2198,6 @@ void DemoTask(void* pvParameters){
 						if(incorrectInput == 2)
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Error, failed input attempt! Please try again command! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						}
@@ -2146,7 +2205,7 @@ void DemoTask(void* pvParameters){
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Enter number from 1 to 16!\r\n ");
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)">>");
-							memset(buffer,0,sizeof(buffer));
+							memset(buffer,0,DEMO_BUFFER_SIZE);
 							size = 0;
 							incorrectInput++;
 						}
@@ -2167,7 +2226,7 @@ void DemoTask(void* pvParameters){
 		  {
 		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nDeactivating PDP...\r\n");
 					/* Buffer for putting answer from gsm */
-					uint8_t buffer[1000] = {0};
+					uint8_t *buffer = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
 
 					/* Flag that indicates when error in receiving from console occured */
 					uint8_t breakFlag = 0;
@@ -2192,22 +2251,19 @@ void DemoTask(void* pvParameters){
 					while(incorrectInput != 3)
 					{
 						/* function that request from user only number for answer */
-						switch(onlyPutNumber(&console, buffer, &size, sizeof(buffer), timeout)){
+						switch(onlyPutNumber(&console, buffer, &size, DEMO_BUFFER_SIZE, timeout)){
 						case DRIVER_TIMEOUT:
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for input has expired! Please try again comand! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						case DRIVER_ERROR:
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Not enough space for receiving characters from gsm! Increase size of buffer! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						case DRIVER_OK:
 							if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end function */
 							{
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Returning to waiting command... \r\n");
-								DRIVER_GSM_Flush(&gsm);
 								breakFlag = 1;
 								break;
 							}
@@ -2234,7 +2290,6 @@ void DemoTask(void* pvParameters){
 							if(incorrectInput == 2)
 							{
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Error, failed input attempt! Please try again command! \r\n");
-								DRIVER_GSM_Flush(&gsm);
 								breakFlag = 1;
 								break;
 							}
@@ -2242,7 +2297,7 @@ void DemoTask(void* pvParameters){
 							{
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Enter number from 1 to 16!\r\n ");
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)">>");
-								memset(buffer,0,sizeof(buffer));
+								memset(buffer,0,DEMO_BUFFER_SIZE);
 								size = 0;
 								incorrectInput++;
 							}
@@ -2285,19 +2340,16 @@ void DemoTask(void* pvParameters){
 					switch(onlyPutNumber(&console, buffer, &size, sizeof(buffer), timeout)){
 					case DRIVER_TIMEOUT:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for input has expired! Please try again comand! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_ERROR:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Not enough space for receiving characters from gsm! Increase size of buffer! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_OK:
 						if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end function */
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Returning to waiting command... \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						}
@@ -2316,7 +2368,6 @@ void DemoTask(void* pvParameters){
 						if(incorrectInput == 2)
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Error, failed input attempt! Please try again command! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						}
@@ -2350,19 +2401,16 @@ void DemoTask(void* pvParameters){
 						switch(onlyPutNumber(&console, buffer, &size, sizeof(buffer), timeout)){
 						case DRIVER_TIMEOUT:
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for input has expired! Please try again comand! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						case DRIVER_ERROR:
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Not enough space for receiving characters from gsm! Increase size of buffer! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						case DRIVER_OK:
 							if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end function */
 							{
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Returning to waiting command... \r\n");
-								DRIVER_GSM_Flush(&gsm);
 								breakFlag = 1;
 								break;
 							}
@@ -2397,7 +2445,6 @@ void DemoTask(void* pvParameters){
 							if(incorrectInput == 2)
 							{
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Error, failed input attempt! Please try again command! \r\n");
-								DRIVER_GSM_Flush(&gsm);
 								breakFlag = 1;
 								break;
 							}
@@ -2449,19 +2496,16 @@ void DemoTask(void* pvParameters){
 						switch(onlyPutNumber(&console, buffer, &size, sizeof(buffer), timeout)){
 						case DRIVER_TIMEOUT:
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for input has expired! Please try again comand! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						case DRIVER_ERROR:
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Not enough space for receiving characters from gsm! Increase size of buffer! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						case DRIVER_OK:
 							if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end function */
 							{
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Returning to waiting command... \r\n");
-								DRIVER_GSM_Flush(&gsm);
 								breakFlag = 1;
 								break;
 							}
@@ -2480,7 +2524,6 @@ void DemoTask(void* pvParameters){
 							if(incorrectInput == 2)
 							{
 								DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Error, failed input attempt! Please try again command! \r\n");
-								DRIVER_GSM_Flush(&gsm);
 								breakFlag = 1;
 								break;
 							}
@@ -2541,19 +2584,16 @@ void DemoTask(void* pvParameters){
 					switch(onlyPutNumber(&console, buffer, &size, sizeof(buffer), timeout)){
 					case DRIVER_TIMEOUT:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for input has expired! Please try again comand! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_ERROR:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Not enough space for receiving characters from gsm! Increase size of buffer! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_OK:
 						if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end function */
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Returning to waiting command... \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						}
@@ -2572,7 +2612,6 @@ void DemoTask(void* pvParameters){
 						if(incorrectInput == 2)
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Error, failed input attempt! Please try again command! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						}
@@ -2603,19 +2642,16 @@ void DemoTask(void* pvParameters){
 					switch(DRIVER_CONSOLE_Get(&console, buffer, &size, timeout)){
 					case DRIVER_TIMEOUT:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for input has expired! Please try again comand! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_ERROR:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Not enough space for receiving characters from gsm! Increase size of buffer! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_OK:
 						if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end function */
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Returning to waiting command... \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 						}
 						break;
@@ -2635,7 +2671,6 @@ void DemoTask(void* pvParameters){
 								if(incorrectInput == 2)
 								{
 									DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Error, failed input attempt! Please try again command! \r\n");
-									DRIVER_GSM_Flush(&gsm);
 									breakFlag = 1;
 								}
 								else
@@ -2689,7 +2724,6 @@ void DemoTask(void* pvParameters){
 					if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end function */
 					{
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Returning to waiting command... \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 					}
 					else
@@ -2723,7 +2757,7 @@ void DemoTask(void* pvParameters){
 		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nSending data to server...\r\n");
 
 					/* Buffer for putting answer from gsm */
-					uint8_t buffer[1000] = {0};
+					uint8_t *buffer = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
 
 					/* Flag that indicates when error in receiving from console occured */
 					uint8_t breakFlag = 0;
@@ -2732,7 +2766,7 @@ void DemoTask(void* pvParameters){
 					uint32_t size = 0;
 
 					/* Message that will be sent to gsm */
-					uint8_t message[1000] = {0};
+					uint8_t *message = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
 
 					/* Request to user */
 					DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Enter message to send: \r\n ");
@@ -2742,19 +2776,16 @@ void DemoTask(void* pvParameters){
 					switch(DRIVER_CONSOLE_Get(&console, buffer, &size, timeout)){
 					case DRIVER_TIMEOUT:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_ERROR:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError received, not enough space for receiving characters! Please update your buffer! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_OK:
 						if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end sending message */
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Leaving command... \r\nMessage unsent!\r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						}
@@ -2789,7 +2820,7 @@ void DemoTask(void* pvParameters){
 			  	DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nPublishing message to the topic...\r\n");
 
 				/* Buffer for putting answer from gsm */
-				uint8_t buffer[1000] = {0};
+				uint8_t *buffer = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
 
 				/* Flag that indicates when error in receiving from console occured */
 				uint8_t breakFlag = 0;
@@ -2798,10 +2829,10 @@ void DemoTask(void* pvParameters){
 				uint32_t size = 0;
 
 				/* topic that will be sent to gsm */
-				uint8_t topic[1000] = {0};
+				uint8_t *topic = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
 
 				/* Message that will be sent to gsm */
-				uint8_t message[1000] = {0};
+				uint8_t *message = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
 
 				/* Request to user */
 				DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Enter topic name: \r\n ");
@@ -2811,19 +2842,16 @@ void DemoTask(void* pvParameters){
 				switch(DRIVER_CONSOLE_Get(&console, buffer, &size, timeout)){
 				case DRIVER_TIMEOUT:
 					DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-					DRIVER_GSM_Flush(&gsm);
 					breakFlag = 1;
 					break;
 				case DRIVER_ERROR:
 					DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError received, not enough space for receiving characters! Please update your buffer! \r\n");
-					DRIVER_GSM_Flush(&gsm);
 					breakFlag = 1;
 					break;
 				case DRIVER_OK:
 					if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end sending message */
 					{
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Leaving command... \r\nMessage unsent!\r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 					}
 					else
@@ -2834,7 +2862,7 @@ void DemoTask(void* pvParameters){
 				}
 
 				/* Reset buffer and his size */
-				memset(buffer,0,sizeof(buffer));
+				memset(buffer,0,DEMO_BUFFER_SIZE);
 				size = 0;
 
 				/* Request to user */
@@ -2845,19 +2873,16 @@ void DemoTask(void* pvParameters){
 				switch(DRIVER_CONSOLE_Get(&console, buffer, &size, timeout)){
 				case DRIVER_TIMEOUT:
 					DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-					DRIVER_GSM_Flush(&gsm);
 					breakFlag = 1;
 					break;
 				case DRIVER_ERROR:
 					DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError received, not enough space for receiving characters! Please update your buffer! \r\n");
-					DRIVER_GSM_Flush(&gsm);
 					breakFlag = 1;
 					break;
 				case DRIVER_OK:
 					if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end sending message */
 					{
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Leaving command... \r\nMessage unsent!\r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 					}
 					else
@@ -2878,7 +2903,7 @@ void DemoTask(void* pvParameters){
 			  	DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nSubscribing to the topic...\r\n");
 
 				/* Buffer for putting answer from gsm */
-				uint8_t buffer[1000] = {0};
+				uint8_t *buffer = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
 
 				/* Flag that indicates when error in receiving from console occured */
 				uint8_t breakFlag = 0;
@@ -2887,7 +2912,7 @@ void DemoTask(void* pvParameters){
 				uint32_t size = 0;
 
 				/* Message that will be sent to gsm */
-				uint8_t topic[1000] = {0};
+				uint8_t *topic = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
 
 			  	/* Request to user */
 			  	DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Enter topic name: \r\n ");
@@ -2897,19 +2922,16 @@ void DemoTask(void* pvParameters){
 			  	switch(DRIVER_CONSOLE_Get(&console, buffer, &size, timeout)){
 			  	case DRIVER_TIMEOUT:
 			  		DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
-			  		DRIVER_GSM_Flush(&gsm);
 					breakFlag = 1;
 					break;
 			  	case DRIVER_ERROR:
 			  		DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError received, not enough space for receiving characters! Please update your buffer! \r\n");
-			  		DRIVER_GSM_Flush(&gsm);
 					breakFlag = 1;
 					break;
 			  	case DRIVER_OK:
 			  		if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end sending message */
 			  		{
 			  			DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Leaving command... \r\nMessage unsent!\r\n");
-			  			DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 					}
 			  		else
@@ -2942,7 +2964,7 @@ void DemoTask(void* pvParameters){
 			  	DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nSettig mqtt client state...\r\n");
 
 				/* Buffer for putting answer from gsm */
-				uint8_t buffer[1000] = {0};
+				uint8_t *buffer = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
 
 				/* Flag that indicates when error in receiving from console occured */
 				uint8_t breakFlag = 0;
@@ -2961,22 +2983,19 @@ void DemoTask(void* pvParameters){
 				while(incorrectInput != 3)
 				{
 					/* function that request from user only number for answer */
-					switch(onlyPutNumber(&console, buffer, &size, sizeof(buffer), timeout)){
+					switch(onlyPutNumber(&console, buffer, &size, DEMO_BUFFER_SIZE, timeout)){
 					case DRIVER_TIMEOUT:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for input has expired! Please try again comand! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_ERROR:
 						DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Not enough space for receiving characters from gsm! Increase size of buffer! \r\n");
-						DRIVER_GSM_Flush(&gsm);
 						breakFlag = 1;
 						break;
 					case DRIVER_OK:
 						if(strstr((char*)buffer,(const char*)"\e") != NULL) /* if escape code <ESC> occurs end function */
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Returning to waiting command... \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						}
@@ -2995,7 +3014,6 @@ void DemoTask(void* pvParameters){
 						if(incorrectInput == 2)
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Error, failed input attempt! Please try again command! \r\n");
-							DRIVER_GSM_Flush(&gsm);
 							breakFlag = 1;
 							break;
 						}
@@ -3003,7 +3021,7 @@ void DemoTask(void* pvParameters){
 						{
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Enter number 1 or 2!\r\n ");
 							DRIVER_CONSOLE_Put(&console,(const uint8_t*)">>");
-							memset(buffer,0,sizeof(buffer));
+							memset(buffer,0,DEMO_BUFFER_SIZE);
 							size = 0;
 							incorrectInput++;
 						}
@@ -3014,6 +3032,519 @@ void DemoTask(void* pvParameters){
 					MQTT_CLIENT_SetState(&mqttCient,state);
 				}
 		  }
+		  else if(strstr((const char*)bufferConsole,(const char*)"publish top\r") != NULL)
+		  {
+				/* Buffer for statistics of tasks */
+				uint8_t *report = ARENA_Calloc(&demoArena, MQTT_MESSAGE_MAX_SIZE + 1);
+
+				RUNTIME_Sample(&runtime);
+				RUNTIME_Format(&runtime, RUNTIME_FORMAT_MACHINE, report, MQTT_MESSAGE_MAX_SIZE + 1);
+
+				/* Lines are separated only with '\n', '\r' would end message */
+				uint32_t j = 0;
+				for(uint32_t i = 0; report[i] != '\0'; i++)
+				{
+					if(report[i] != '\r') report[j++] = report[i];
+				}
+				report[j] = '\0';
+
+				MQTT_Publish(&mqtt, timeout, (const uint8_t*)DEMO_TOP_TOPIC, report);
+		  }
+		  else if(strstr((const char*)bufferConsole,(const char*)"top raw\r") != NULL)
+		  {
+				/* Buffer for statistics of tasks */
+				uint8_t *report = ARENA_Calloc(&demoArena, RUNTIME_REPORT_SIZE);
+
+				RUNTIME_Sample(&runtime);
+				RUNTIME_Format(&runtime, RUNTIME_FORMAT_MACHINE, report, RUNTIME_REPORT_SIZE);
+				DRIVER_CONSOLE_Put(&console, report);
+		  }
+		  else if(strstr((const char*)bufferConsole,(const char*)"top\r") != NULL)
+		  {
+				/* Buffer for statistics of tasks */
+				uint8_t *report = ARENA_Calloc(&demoArena, RUNTIME_REPORT_SIZE);
+
+				/* Buffer for key that stops refreshing */
+				uint8_t *buffer = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
+				uint32_t size = 0;
+
+				DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nPress enter to leave top view\r\n");
+
+				/* Refresh statistics until user sends anything */
+				do
+				{
+					RUNTIME_Sample(&runtime);
+					RUNTIME_Format(&runtime, RUNTIME_FORMAT_TABLE, report, RUNTIME_REPORT_SIZE);
+					DRIVER_CONSOLE_Put(&console, report);
+				}while(DRIVER_CONSOLE_Get(&console, buffer, &size, RUNTIME_REFRESH_PERIOD) == DRIVER_TIMEOUT);
+		  }
+		  else if(strstr((const char*)bufferConsole,(const char*)"trace dump\r") != NULL)
+		  {
+				/* Buffer for lines of trace */
+				uint8_t *lines = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
+				uint32_t position = 0;
+
+				/* Writing to console is traced too, so recording is paused during dump */
+				DRIVER_TRACE_Stop();
+				while(DRIVER_TRACE_Dump(&position, lines, DEMO_BUFFER_SIZE) != 0)
+				{
+					DRIVER_CONSOLE_Put(&console, lines);
+				}
+				DRIVER_TRACE_Start();
+		  }
+		  else if(strstr((const char*)bufferConsole,(const char*)"trace on\r") != NULL)
+		  {
+			  DRIVER_TRACE_Start();
+			  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nTrace recording is ON!\r\n");
+		  }
+		  else if(strstr((const char*)bufferConsole,(const char*)"trace off\r") != NULL)
+		  {
+			  DRIVER_TRACE_Stop();
+			  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nTrace recording is OFF!\r\n");
+		  }
+		  else if(strstr((const char*)bufferConsole,(const char*)"trace clear\r") != NULL)
+		  {
+			  DRIVER_TRACE_Init();
+			  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nTrace is cleared and recording is ON!\r\n");
+		  }
+		  else if(strstr((const char*)bufferConsole,(const char*)"publish health\r") != NULL)
+		  {
+				if(mqtt.connectionState != MQTT_CONNECTED)
+				{
+					DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Connect to broker before publishing health summary!\r\n");
+				}
+				else
+				{
+					HEALTH_Publish(&health, timeout);
+				}
+		  }
+		  else if(strstr((const char*)bufferConsole,(const char*)"health\r") != NULL)
+		  {
+				/* Buffer for health summary */
+				uint8_t *report = ARENA_Calloc(&demoArena, HEALTH_REPORT_SIZE);
+
+				HEALTH_Format(&health, HEALTH_FORMAT_TABLE, report, HEALTH_REPORT_SIZE);
+				DRIVER_CONSOLE_Put(&console, report);
+		  }
+		  else if(strstr((const char*)bufferConsole,(const char*)"clock low power\r") != NULL ||
+				  strstr((const char*)bufferConsole,(const char*)"clock balanced\r") != NULL ||
+				  strstr((const char*)bufferConsole,(const char*)"clock full speed\r") != NULL)
+		  {
+				DRIVERClockProfile_t profile = CLOCK_PROFILE_LOW_POWER;
+
+				if(strstr((const char*)bufferConsole,(const char*)"clock balanced\r") != NULL) profile = CLOCK_PROFILE_BALANCED;
+				else if(strstr((const char*)bufferConsole,(const char*)"clock full speed\r") != NULL) profile = CLOCK_PROFILE_FULL_SPEED;
+
+				if(DRIVER_CLOCK_SetProfile(&sysClock, profile) != DRIVER_OK)
+				{
+					DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Clock profile is not set!\r\n");
+				}
+				else
+				{
+					DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nClock profile is set!\r\n");
+				}
+		  }
+		  else if(strstr((const char*)bufferConsole,(const char*)"clock\r") != NULL)
+		  {
+				/* Buffer for clock report */
+				uint8_t *report = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
+
+				snprintf((char*)report, DEMO_BUFFER_SIZE,
+						"\r\nProfile: %s (base %s, bursts %lu)\r\nSystem clock: %lu Hz, bus clock: %lu Hz\r\n"
+						"Switches: low power %lu, balanced %lu, full speed %lu, failed %lu\r\n",
+						DRIVER_CLOCK_GetProfileName(DRIVER_CLOCK_GetProfile(&sysClock)),
+						DRIVER_CLOCK_GetProfileName(sysClock.baseProfile), (unsigned long)sysClock.burstCount,
+						(unsigned long)sysClock.sysclk, (unsigned long)sysClock.hclk,
+						(unsigned long)sysClock.switchCount[CLOCK_PROFILE_LOW_POWER],
+						(unsigned long)sysClock.switchCount[CLOCK_PROFILE_BALANCED],
+						(unsigned long)sysClock.switchCount[CLOCK_PROFILE_FULL_SPEED],
+						(unsigned long)sysClock.failCount);
+				DRIVER_CONSOLE_Put(&console, report);
+		  }
+		  else if(strstr((const char*)bufferConsole,(const char*)"io stats\r") != NULL)
+		  {
+				/* Buffer for io report */
+				uint8_t *report = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
+
+				snprintf((char*)report, DEMO_BUFFER_SIZE,
+						"\r\nIo task wakeups: %lu\r\nGsm reads: %lu, average %lu cycles, longest %lu cycles\r\n"
+						"At commands: %lu, errors %lu, timeouts %lu, at task wakeups %lu\r\n"
+						"Unsolicited lines: %lu, dropped for demo %lu\r\n",
+						(unsigned long)DRIVER_IO_GetWakeCount(), (unsigned long)gsm.readCount,
+						(unsigned long)(gsm.readCount != 0 ? gsm.readCycles / gsm.readCount : 0),
+						(unsigned long)gsm.readMaxCycles, (unsigned long)at.commandCount,
+						(unsigned long)at.errorCount, (unsigned long)at.timeoutCount, (unsigned long)at.wakeCount,
+						(unsigned long)at.urcCount, (unsigned long)demoUrc.dropCount);
+				DRIVER_CONSOLE_Put(&console, report);
+
+				/* Time that chains waited for gsm, for every priority */
+				static const char *priorityName[AT_PRIORITY_NUMBER] = {"control", "keep alive", "bulk"};
+				for(uint32_t priority = 0; priority < AT_PRIORITY_NUMBER; priority++)
+				{
+					ATWaitStats_t *wait = &at.wait[priority];
+					snprintf((char*)report, DEMO_BUFFER_SIZE, "Wait of %s: %lu chains, average %lu ms, longest %lu ms\r\n",
+							priorityName[priority], (unsigned long)wait->count,
+							(unsigned long)(wait->count != 0 ? wait->totalTime / wait->count : 0),
+							(unsigned long)wait->maxTime);
+					DRIVER_CONSOLE_Put(&console, report);
+				}
+		  }
+		  else if(strstr((const char*)bufferConsole,(const char*)"at bench\r") != NULL)
+		  {
+				/* Synthetic answer of at+cmgl, lines of records and "OK" at the end */
+				uint8_t *answer = ARENA_Calloc(&demoArena, DEMO_BENCH_ANSWER_SIZE);
+				uint8_t *report = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
+				uint32_t length = 0;
+				for(uint32_t i = 1; length + 200 < DEMO_BENCH_ANSWER_SIZE; i++)
+				{
+					length += snprintf((char*)answer + length, DEMO_BENCH_ANSWER_SIZE - length,
+							"\r\n+CMGL: %lu,\"REC READ\",\"+381641234567\",\"\",\"21/03/14,10:15:00+04\"\r\nTemperature %lu, humidity 45\r\n",
+							(unsigned long)i, (unsigned long)(20 + i % 10));
+				}
+				length += snprintf((char*)answer + length, DEMO_BENCH_ANSWER_SIZE - length, "\r\nOK\r\n");
+
+				/* Other tasks don't run while cycles are counted */
+				vTaskSuspendAll();
+
+				/* Every character is received alone, whole answer is searched again after it (as waitUntil() did) */
+				uint32_t found = 0;
+				uint32_t start = DWT->CYCCNT;
+				for(uint32_t i = 1; i <= length && found == 0; i++)
+				{
+					uint8_t next = answer[i];
+					answer[i] = '\0';
+					if(strstr((const char*)answer, "ERROR") != NULL || strstr((const char*)answer, "OK") != NULL) found = i;
+					answer[i] = next;
+				}
+				uint32_t strstrCycles = DWT->CYCCNT - start;
+
+				/* Every character is received alone and given to matcher once */
+				ATMatcher_t matcher;
+				AT_MATCH_Start(&matcher, NULL);
+				uint32_t matched = 0;
+				uint32_t used = 0;
+				start = DWT->CYCCNT;
+				for(uint32_t i = 0; i < length && matched == 0; i += used)
+				{
+					if(AT_MATCH_Feed(&matcher, answer + i, 1, &used) == AT_RESULT_OK) matched = i + used;
+				}
+				uint32_t matchCycles = DWT->CYCCNT - start;
+
+				xTaskResumeAll();
+
+				snprintf((char*)report, DEMO_BUFFER_SIZE,
+						"\r\nAnswer of %lu characters, code found after %lu (strstr) and %lu (matcher) characters\r\n"
+						"strstr: %lu cycles, %lu per character\r\nmatcher: %lu cycles, %lu per character\r\n",
+						(unsigned long)length, (unsigned long)found, (unsigned long)matched,
+						(unsigned long)strstrCycles, (unsigned long)(strstrCycles / length),
+						(unsigned long)matchCycles, (unsigned long)(matchCycles / length));
+				DRIVER_CONSOLE_Put(&console, report);
+		  }
+		  else if(strstr((const char*)bufferConsole,(const char*)"pdu bench\r") != NULL)
+		  {
+				uint8_t *report = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
+				uint8_t septets[SMS_PDU_MAX_SEPTETS];
+				uint8_t unpacked[SMS_PDU_MAX_SEPTETS];
+				uint8_t octets[SMS_PDU_USER_DATA];
+				for(uint32_t i = 0; i < SMS_PDU_MAX_SEPTETS; i++) septets[i] = (uint8_t)((i * 37U + 11U) & 0x7FU);
+
+				/* Other tasks don't run while cycles are counted */
+				vTaskSuspendAll();
+
+				/* Every septet is shifted and masked alone */
+				uint32_t start = DWT->CYCCNT;
+				for(uint32_t round = 0; round < DEMO_PDU_ROUNDS; round++)
+				{
+					memset(octets, 0, sizeof(octets));
+					for(uint32_t i = 0; i < SMS_PDU_MAX_SEPTETS; i++)
+					{
+						uint32_t bit = i * 7U;
+						octets[bit / 8U] |= (uint8_t)(septets[i] << (bit % 8U));
+						if(bit % 8U > 1U) octets[bit / 8U + 1U] |= (uint8_t)(septets[i] >> (8U - bit % 8U));
+					}
+				}
+				uint32_t septetCycles = DWT->CYCCNT - start;
+
+				/* Eight septets in one word */
+				start = DWT->CYCCNT;
+				for(uint32_t round = 0; round < DEMO_PDU_ROUNDS; round++) SMS_PDU_Pack7(septets, SMS_PDU_MAX_SEPTETS, octets);
+				uint32_t packCycles = DWT->CYCCNT - start;
+
+				start = DWT->CYCCNT;
+				for(uint32_t round = 0; round < DEMO_PDU_ROUNDS; round++) SMS_PDU_Unpack7(octets, SMS_PDU_MAX_SEPTETS, unpacked, 0);
+				uint32_t unpackCycles = DWT->CYCCNT - start;
+
+				xTaskResumeAll();
+
+				/* Text with characters of extension table goes through encoder and decoder */
+				const char *text = "Temperature 21 C, humidity 45% [ok] {sensor} 5\xE2\x82\xAC";
+				SMSPduSubmit_t submit = {.number = (const uint8_t*)"+381641234567", .text = (const uint8_t*)text,
+										 .length = strlen(text), .coding = SMS_PDU_AUTO};
+				uint8_t *pdu = ARENA_Calloc(&demoArena, SMS_PDU_HEX_SIZE);
+				uint8_t *decoded = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
+				SMSPduMessage_t message;
+				uint32_t pduLength = 0;
+				bool roundTrip = SMS_PDU_EncodeSubmit(&submit, pdu, SMS_PDU_HEX_SIZE, &pduLength) == DRIVER_OK &&
+								 SMS_PDU_Decode(pdu, strlen((const char*)pdu), &message, decoded, DEMO_BUFFER_SIZE) == DRIVER_OK &&
+								 strcmp((const char*)decoded, text) == 0 && strcmp((const char*)message.number, "+381641234567") == 0;
+
+				uint32_t count = DEMO_PDU_ROUNDS * SMS_PDU_MAX_SEPTETS;
+				snprintf((char*)report, DEMO_BUFFER_SIZE,
+						"\r\n%u rounds of %u septets\r\nseptet by septet: %lu cycles, %lu per septet\r\n"
+						"word at a time: pack %lu cycles, %lu per septet, unpack %lu cycles, %lu per septet\r\n"
+						"unpacked septets %s, pdu round trip %s (%lu octets)\r\n",
+						(unsigned)DEMO_PDU_ROUNDS, (unsigned)SMS_PDU_MAX_SEPTETS,
+						(unsigned long)septetCycles, (unsigned long)(septetCycles / count),
+						(unsigned long)packCycles, (unsigned long)(packCycles / count),
+						(unsigned long)unpackCycles, (unsigned long)(unpackCycles / count),
+						memcmp(septets, unpacked, sizeof(septets)) == 0 ? "match" : "differ", roundTrip ? "ok" : "failed",
+						(unsigned long)pduLength);
+				DRIVER_CONSOLE_Put(&console, report);
+		  }
+		  else if(strstr((const char*)bufferConsole,(const char*)"gsm stats\r") != NULL)
+		  {
+				/* Buffer for one line of report */
+				uint8_t *report = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
+
+				snprintf((char*)report, DEMO_BUFFER_SIZE, "\r\nNew messages: %lu\r\n", (unsigned long)gsmHandler.newMsgCount);
+				DRIVER_CONSOLE_Put(&console, report);
+				DRIVER_CONSOLE_Put(&console,(const uint8_t*)"Command: executions, errors, timeouts, longest time (ms), skipped\r\n");
+				for(GSMCommandId_t id = GSM_CMD_ECHO; id < GSM_CMD_NUMBER; id++)
+				{
+					const GSMCommandStats_t *stats = GSM_GetCommandStats(id);
+
+					/* Only commands that were sent or skipped */
+					if(stats->count == 0 && stats->skipCount == 0) continue;
+
+					snprintf((char*)report, DEMO_BUFFER_SIZE, "%s: %lu, %lu, %lu, %lu, %lu\r\n", GSM_GetCommand(id)->name,
+							(unsigned long)stats->count, (unsigned long)stats->errorCount,
+							(unsigned long)stats->timeoutCount, (unsigned long)stats->maxTime,
+							(unsigned long)stats->skipCount);
+					DRIVER_CONSOLE_Put(&console, report);
+				}
+		  }
+		  else if(strstr((const char*)bufferConsole,(const char*)"network info\r") != NULL)
+		  {
+				/* Buffer for network report */
+				uint8_t *report = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
+				Network_t *network = &gsmHandler.network;
+
+				/* Every query fills typed values in network structure */
+				GSM_CheckNetworkRegistered(&gsmHandler);
+				GSM_CheckGPRSRegistered(&gsmHandler);
+				GSM_GetSignalQuality(&gsmHandler);
+				GSM_GetOperator(&gsmHandler);
+
+				snprintf((char*)report, DEMO_BUFFER_SIZE,
+						"\r\nRegistration: %u (gprs %u), area %04X, cell %04X\r\n"
+						"Signal: rssi %u, %d dBm, ber %u\r\nOperator: %s\r\n"
+						"IP address: %s, connection state %u, setted contexts %08lX, active contexts %08lX\r\n",
+						(unsigned)network->registration.state, (unsigned)network->gprsRegistration.state,
+						(unsigned)network->registration.area, (unsigned)network->registration.cell,
+						(unsigned)network->signal.rssi, (int)network->signal.dbm, (unsigned)network->signal.ber,
+						network->operatorName, network->IPaddress, (unsigned)network->ipState,
+						(unsigned long)network->definedContexts, (unsigned long)network->activeContexts);
+				DRIVER_CONSOLE_Put(&console, report);
+
+				uint32_t state = GSM_GetState(&gsmHandler);
+				snprintf((char*)report, DEMO_BUFFER_SIZE, "State: %s%s%s%s%s%s%s%s\r\n",
+						(state & GSM_STATE_REGISTERED) ? "registered " : "", (state & GSM_STATE_ATTACHED) ? "attached " : "",
+						(state & GSM_STATE_APN) ? "apn " : "", (state & GSM_STATE_PDP_ACTIVE) ? "pdp " : "",
+						(state & GSM_STATE_IP) ? "ip " : "", (state & GSM_STATE_CONNECTED) ? "connected " : "",
+						(state & GSM_STATE_REPORTING) ? "reporting " : "", (state & GSM_STATE_GPRS_REPORTING) ? "gprs reporting" : "");
+				DRIVER_CONSOLE_Put(&console, report);
+		  }
+		  else if(strstr((const char*)bufferConsole,(const char*)"wait online\r") != NULL)
+		  {
+				DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nWaiting for registration, GPRS service and connection with server...\r\n");
+
+				/* Cached state is kept by answers and unsolicited lines, nothing is sent to gsm */
+				if(GSM_WaitState(&gsmHandler, GSM_STATE_ONLINE, timeout) == DRIVER_OK)
+					DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nGsm is online!\r\n");
+				else
+					DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Gsm isn't online!\r\n");
+		  }
+		  else if(strstr((const char*)bufferConsole,(const char*)"timeouts\r") != NULL)
+		  {
+				/* Buffer for one line of report */
+				uint8_t *report = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
+
+				DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nClass: answers, learned timeout (ms), median, 99th percentile\r\n");
+				for(ATTimeoutClass_t timeoutClass = AT_TIMEOUT_LOCAL; timeoutClass < AT_TIMEOUT_NUMBER; timeoutClass++)
+				{
+					/* Timeout 0 means that bounds from command tables are used */
+					snprintf((char*)report, DEMO_BUFFER_SIZE, "%s: %lu, %lu, %lu, %lu\r\n", AT_TIMEOUT_Name(timeoutClass),
+							(unsigned long)AT_TIMEOUT_Samples(timeoutClass), (unsigned long)AT_TIMEOUT_Learned(timeoutClass),
+							(unsigned long)AT_TIMEOUT_Percentile(timeoutClass, 50),
+							(unsigned long)AT_TIMEOUT_Percentile(timeoutClass, 99));
+					DRIVER_CONSOLE_Put(&console, report);
+				}
+				snprintf((char*)report, DEMO_BUFFER_SIZE, "Saved %lu times, %lu bytes of store free\r\n",
+						(unsigned long)AT_TIMEOUT_SaveCount(), (unsigned long)DRIVER_STORE_GetFree());
+				DRIVER_CONSOLE_Put(&console, report);
+		  }
+		  else if(strstr((const char*)bufferConsole,(const char*)"timeouts save\r") != NULL)
+		  {
+				if(AT_TIMEOUT_Save() == DRIVER_OK)
+					DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nLearned timeouts are saved!\r\n");
+				else
+					DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Learned timeouts aren't saved!\r\n");
+		  }
+		  else if(strstr((const char*)bufferConsole,(const char*)"publish latency\r") != NULL)
+		  {
+				/* Buffer for one class, message is one line without '\r' */
+				uint8_t *report = ARENA_Calloc(&demoArena, MQTT_MESSAGE_MAX_SIZE + 1);
+				uint32_t published = 0;
+
+				/* Lines are tagged with operator, so histograms of operators can be compared */
+				if(gsmHandler.network.operatorName[0] == '\0') GSM_GetOperator(&gsmHandler);
+
+				for(ATTimeoutClass_t timeoutClass = AT_TIMEOUT_FIXED; timeoutClass < AT_TIMEOUT_NUMBER; timeoutClass++)
+				{
+					ATLatency_t latency;
+					AT_LATENCY_Get(timeoutClass, &latency);
+					if(latency.count == 0) continue;
+
+					uint32_t length = snprintf((char*)report, MQTT_MESSAGE_MAX_SIZE + 1, "latency,%s,", gsmHandler.network.operatorName);
+					AT_LATENCY_Format(timeoutClass, AT_LATENCY_FORMAT_MACHINE, report + length, MQTT_MESSAGE_MAX_SIZE + 1 - length);
+					if(MQTT_Publish(&mqtt, timeout, (const uint8_t*)DEMO_LATENCY_TOPIC, report) != MQTT_OK) break;
+					published++;
+				}
+
+				snprintf((char*)report, MQTT_MESSAGE_MAX_SIZE + 1, "\r\nPublished latency of %lu classes\r\n", (unsigned long)published);
+				DRIVER_CONSOLE_Put(&console, report);
+		  }
+		  else if(strstr((const char*)bufferConsole,(const char*)"latency clear\r") != NULL)
+		  {
+				AT_LATENCY_Reset();
+				DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nLatency statistics are cleared!\r\n");
+		  }
+		  else if(strstr((const char*)bufferConsole,(const char*)"latency\r") != NULL)
+		  {
+				/* Buffer for one class */
+				uint8_t *report = ARENA_Calloc(&demoArena, AT_LATENCY_REPORT_SIZE);
+
+				snprintf((char*)report, AT_LATENCY_REPORT_SIZE, "\r\n%-8s %8s %6s %8s %8s %6s %6s %6s %8s\r\n        buckets <upper edge ms:answers\r\n",
+						"Class", "Commands", "Errors", "Timeouts", "Answers", "Avg", "P50", "P99", "Max ms");
+				DRIVER_CONSOLE_Put(&console, report);
+				for(ATTimeoutClass_t timeoutClass = AT_TIMEOUT_FIXED; timeoutClass < AT_TIMEOUT_NUMBER; timeoutClass++)
+				{
+					AT_LATENCY_Format(timeoutClass, AT_LATENCY_FORMAT_TABLE, report, AT_LATENCY_REPORT_SIZE);
+					DRIVER_CONSOLE_Put(&console, report);
+				}
+		  }
+		  else if(strstr((const char*)bufferConsole,(const char*)"bringup bench\r") != NULL)
+		  {
+				/* Buffer for one line of report */
+				uint8_t *report = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
+				ATHandler_t *at = AT_GetHandler();
+				ConnectSrvrInputStruct_t server = {.connectType = '1', .ipAddr = (uint8_t*)"5.196.95.208", .port = (uint8_t*)"1883"};
+				GSMBringUp_t bringUp;
+
+				GSM_BringUpStart(&bringUp, (const uint8_t*)"1\r", server, timeout);
+				for(uint32_t run = 0; run < 2; run++)
+				{
+					/* Before every run gsm is as after power on: no connection, no registration
+					 * reports and decimal format, only registration to network stays */
+					GSM_DeactiveGPRSPDPContext(&gsmHandler);
+					GSM_NetworkDeregistered(&gsmHandler);
+					GSM_SetSendingIPFormat(&gsmHandler, timeout, '0');
+
+					uint32_t commands = at->commandCount;
+					uint32_t tickstart = TIME_GetTick();
+					DRIVERState_t state;
+
+					if(run == 0)
+					{
+						/* Old sequence, every command waits for previous one and for its console output */
+						state = GSM_NetworkRegistered(&gsmHandler);
+						if(state == DRIVER_OK) state = GSM_ActivePDPContext(&gsmHandler, timeout, (const uint8_t*)"1\r");
+						if(state == DRIVER_OK) state = GSM_ConnectToServer(&gsmHandler, timeout, server);
+						if(state == DRIVER_OK) state = GSM_SetSendingIPFormat(&gsmHandler, timeout, '1');
+					}
+					else
+					{
+						GSM_BringUpStart(&bringUp, (const uint8_t*)"1\r", server, timeout);
+						state = GSM_BringUp(&gsmHandler, &bringUp);
+					}
+
+					snprintf((char*)report, DEMO_BUFFER_SIZE, "\r\n%s: %s in %lu ms, %lu at commands\r\n",
+							run == 0 ? "Sequential" : "State machine", state == DRIVER_OK ? "connected" : "failed",
+							(unsigned long)(TIME_GetTick() - tickstart), (unsigned long)(at->commandCount - commands));
+					DRIVER_CONSOLE_Put(&console, report);
+				}
+
+				snprintf((char*)report, DEMO_BUFFER_SIZE, "Steps: config %lu ms, register %lu ms, connect %lu ms%s\r\n",
+						(unsigned long)bringUp.stepTime[GSM_BRINGUP_CONFIG], (unsigned long)bringUp.stepTime[GSM_BRINGUP_REGISTER],
+						(unsigned long)bringUp.stepTime[GSM_BRINGUP_CONNECT],
+						bringUp.separate ? ", gsm refused one command line" : "");
+				DRIVER_CONSOLE_Put(&console, report);
+		  }
+		  else if(strstr((const char*)bufferConsole,(const char*)"publish async\r") != NULL)
+		  {
+				/* Operation and its message live in this branch until operation is done */
+				ASYNCOperation_t publish = {0};
+				uint8_t *report = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
+				uint32_t tickstart = TIME_GetTick();
+				uint32_t samples = 0;
+
+				snprintf((char*)report, DEMO_BUFFER_SIZE, "uptime %lu ms", (unsigned long)tickstart);
+				if(MQTT_Publish_Async(&mqtt, timeout, (const uint8_t*)DEMO_ASYNC_TOPIC, report, &publish) != MQTT_OK)
+				{
+					DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError: async task can't take publish!\r\n");
+				}
+				else
+				{
+					/* Demo task keeps sampling while async task publishes */
+					while(!ASYNC_Poll(&publish))
+					{
+						samples++;
+						vTaskDelay(pdMS_TO_TICKS(DEMO_SAMPLE_PERIOD));
+					}
+
+					snprintf((char*)report, DEMO_BUFFER_SIZE, "\r\nAsync publish %s after %lu ms, demo task took %lu samples meanwhile\r\n",
+							publish.result == MQTT_OK ? "done" : "failed", (unsigned long)(publish.doneTime - publish.submitTime),
+							(unsigned long)samples);
+					DRIVER_CONSOLE_Put(&console, report);
+				}
+		  }
+		  else if(strstr((const char*)bufferConsole,(const char*)"link on\r") != NULL)
+		  {
+				LINK_Start(&linkManager);
+				DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nConnection with broker is kept up while demo task waits for commands\r\n");
+		  }
+		  else if(strstr((const char*)bufferConsole,(const char*)"link off\r") != NULL)
+		  {
+				LINK_Stop(&linkManager);
+				DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nConnection with broker is not kept up anymore\r\n");
+		  }
+		  else if(strstr((const char*)bufferConsole,(const char*)"link stats\r") != NULL)
+		  {
+				uint8_t *report = ARENA_Calloc(&demoArena, DEMO_BUFFER_SIZE);
+
+				snprintf((char*)report, DEMO_BUFFER_SIZE, "\r\nConnection manager %s, lowest broken layer: %s%s\r\n",
+						linkManager.enabled ? "on" : "off", LINK_Name(LINK_Check(&linkManager)), linkManager.down ? " (recovering)" : "");
+				DRIVER_CONSOLE_Put(&console, report);
+
+				/* Last change of registration that gsm reported */
+				GSMRegEvent_t *event = &linkManager.lastEvent;
+				snprintf((char*)report, DEMO_BUFFER_SIZE, "Registration events %lu (lost %lu), backoffs ended by event %lu, last: %s %u, area %04X, cell %04X\r\n",
+						(unsigned long)linkManager.eventCount, (unsigned long)gsmHandler.regDropCount, (unsigned long)linkManager.wakeCount,
+						event->domain == GSM_REG_GPRS ? "gprs" : "network", (unsigned)event->state, (unsigned)event->area, (unsigned)event->cell);
+				DRIVER_CONSOLE_Put(&console, report);
+
+				/* Outages are counted for their lowest broken layer */
+				for(uint32_t layer = 0; layer < LINK_LAYER_UP; layer++)
+				{
+					LINKStats_t *stats = &linkManager.stats[layer];
+					snprintf((char*)report, DEMO_BUFFER_SIZE, "%-12s outages %lu, recovered %lu, failed attempts %lu, time to recover last %lu ms, average %lu ms, longest %lu ms\r\n",
+							LINK_Name((LINKLayer_t)layer), (unsigned long)stats->downCount, (unsigned long)stats->recoverCount,
+							(unsigned long)stats->failCount, (unsigned long)stats->lastTime,
+							(unsigned long)(stats->recoverCount != 0 ? stats->totalTime / stats->recoverCount : 0),
+							(unsigned long)stats->maxTime);
+					DRIVER_CONSOLE_Put(&console, report);
+				}
+		  }
 		  else if(strstr((const char*)bufferConsole,(const char*)"main menu\r") != NULL ||
 				  strstr((const char*)bufferConsole,(const char*)"help\r") != NULL)
 		  {
@@ -3028,8 +3559,7 @@ void DemoTask(void* pvParameters){
 		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"send message - send message from storage or directly!\r\n");
 		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"store message - store message in storage!\r\n");
 		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Commands to directly comunicate with gsm modul:\r\n");
-		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"read - read buffer for receving characters from gsm\r\n");
-		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"flush - set buffer for receiving characters from gsm to initial state\r\n");
+		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"read - show unsolicited lines from gsm that came since last command\r\n");
 		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"send cmd - send command directly to gsm modul \r\n");
 		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Commands for network and TCPIP connection:\r\n");
 		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"turn on mobile network - network registration to mobile station\r\n");
@@ -3062,43 +3592,55 @@ void DemoTask(void* pvParameters){
 		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"establish tcpip - does 4 commands: turn on mobile network, active pdp, connect to server and set packet format of TCPIP connection\r\n");
 		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Command that implement mqtt client:\r\n");
 		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"mqtt client set - set state of mqtt client(either can be CLOSE or LISTEN)\r\n");
+		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\n Commands for diagnostics:\r\n");
+		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"top - cpu usage, stack high water mark, state and priority of tasks, refreshed until enter is pressed\r\n");
+		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"top raw - one snapshot of task statistics as comma separated lines for host tools\r\n");
+		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"publish top - publish snapshot of task statistics to topic " DEMO_TOP_TOPIC " on broker\r\n");
+		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"trace dump - write recorded events (convert them on host with Tools/trace2timeline.py)\r\n");
+		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"trace on/trace off/trace clear - continue, pause or restart recording of events\r\n");
+		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"health - last sample of free stack of tasks, minimum free heap and pool and arena usage\r\n");
+		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"publish health - publish health summary to topic " HEALTH_TOPIC " on broker (it is also published periodically)\r\n");
+		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"clock - running clock profile, clocks and number of profile switches\r\n");
+		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"clock low power/clock balanced/clock full speed - set base clock profile (64MHz HSI, 200MHz or 480/400MHz PLL)\r\n");
+		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"io stats - show wakeups of io task, cost of gsm reads in core cycles, unsolicited lines and waits for gsm\r\n");
+		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"at bench - cycles of searching result code in long answer, strstr of whole answer against matcher\r\n");
+		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"pdu bench - cycles of packing 7 bit text septet by septet against word at a time, pdu round trip\r\n");
+		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"gsm stats - show executions, errors, timeouts, longest time and skipped calls of every gsm command\r\n");
+		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"network info - read registration, signal quality and operator and show them with last IP address and contexts\r\n");
+		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"wait online - wait until gsm is registered, attached to GPRS service and connected to server\r\n");
+		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"timeouts - show learned timeouts and latency of every class of at commands\r\n");
+		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"timeouts save - save learned timeouts in flash now\r\n");
+		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"latency - show commands, errors, timeouts and latency histogram of every class of at commands\r\n");
+		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"latency clear/publish latency - start new measurement or publish histograms to topic " DEMO_LATENCY_TOPIC "\r\n");
+		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"bringup bench - close connection and compare time of sequential and pipelined bring up\r\n");
+		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"publish async - publish uptime to topic " DEMO_ASYNC_TOPIC " in async task while demo task keeps sampling\r\n");
+		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"link on/link off - keep connection with broker up, broken layers are repaired with backoff\r\n");
+		  		  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"link stats - lowest broken layer, outages and time to recover of every layer\r\n");
 		  }
 		  else if(strstr((const char*)bufferConsole,(const char*)"read\r") != NULL)
 		  {
-			  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nReading ...\r\n");
-			  DRIVER_GSM_Read(&gsm, bufferGsm , &sizeGsm);
-			  if(sizeGsm == 0)
-			  {
-				  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nBuffer empty\r\n");
-			  }
-			  else
+			  /* Gsm ring belongs to at task, unsolicited lines are the ones that router gave to demo task */
+			  ATUrcEvent_t event;
+			  uint32_t count = 0;
+			  while(xQueueReceive(demoUrc.queue, &event, 0) == pdTRUE)
 			  {
-				  uint8_t *startMsg = (uint8_t *)strstr((char*)bufferGsm,(const char*)mqtt.mqttPacket.payload.topicName);
-				  if(startMsg != NULL)
-				  {
-					  startMsg = startMsg + mqtt.mqttPacket.payload.topicLen;
-					  DRIVER_CONSOLE_Put(&console, startMsg);
-				  }
-				  else
-					  DRIVER_CONSOLE_Put(&console, bufferGsm);
-				  DRIVER_CONSOLE_Put(&console, (const uint8_t*)"\r\n");
+				  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nUnsolicited: ");
+				  DRIVER_CONSOLE_Put(&console, event.text);
+				  count++;
 			  }
-			  sizeGsm = 0;
+			  if(count == 0) DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nNo unsolicited lines\r\n");
 		  }
 		  else if(strstr((const char*)bufferConsole,(const char*)"at") != NULL || strstr((const char*)bufferConsole,(const char*)"AT") != NULL)
 		  {
-			  strcpy((char*)bufferGsm,(const char*)bufferConsole);
-			  DRIVER_GSM_Write(&gsm, bufferGsm, size);
-			  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"Command sent to gsm!\r\n");
-//			  DRIVER_GSM_Read(&gsm, bufferGsm , &sizeGsm);
-//			  if(sizeGsm != 0)
-//			  {
-//				  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nResponse from gsm:\r\n");
-//				  DRIVER_CONSOLE_Put(&console, (const uint8_t*)"\r\n");
-//				  DRIVER_CONSOLE_Put(&console, bufferGsm);
-//				  DRIVER_CONSOLE_Put(&console, (const uint8_t*)"\r\n");
-//			  }
-//			  sizeGsm = 0;
+			  /* Command of user waits in control queue of at engine like every other command */
+			  DRIVERState_t state = AT_Command(bufferConsole, size, bufferGsm, sizeof(bufferGsm), &sizeGsm,
+											   DEMO_AT_TIMEOUT, (const uint8_t*)"OK");
+			  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nResponse from gsm:\r\n");
+			  if(sizeGsm != 0) DRIVER_CONSOLE_Put(&console, bufferGsm);
+			  if(state == DRIVER_TIMEOUT)
+				  DRIVER_CONSOLE_Put(&console,(const uint8_t*)"\r\nError! Time for receiving response from gsm has expired! Please try again command! \r\n");
+			  DRIVER_CONSOLE_Put(&console, (const uint8_t*)"\r\n");
+			  sizeGsm = 0;
 		  }
 		  else
 		  {
@@ -3154,7 +3696,8 @@ void SystemClock_Config(void)
   RCC_ClkInitStruct.APB2CLKDivider = RCC_APB2_DIV1;
   RCC_ClkInitStruct.APB4CLKDivider = RCC_APB4_DIV1;
 
-  if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_0) != HAL_OK)
+  /* Voltage scale 3 needs 1 wait state for bus clock above 45MHz */
+  if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_1) != HAL_OK)
   {
     Error_Handler();
   }
@@ -3354,6 +3897,15 @@ static void MX_GPIO_Init(void)
 
 /* USER CODE BEGIN 4 */
 
+/**
+  * @brief  FreeRTOS tick hook, reads run time counter every tick so wrap of cycle counter is never missed.
+  * @retval None
+  */
+void vApplicationTickHook(void)
+{
+	RUNTIME_GetCounter();
+}
+
 /* USER CODE END 4 */
 
 /**
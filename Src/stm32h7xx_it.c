@@ -23,6 +23,8 @@
 #include "stm32h7xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include <driver_trace.h>
+#include <driver_memory.h>
 extern UART_HandleTypeDef huart3;
 extern UART_HandleTypeDef huart6;
 extern TIM_HandleTypeDef htim6;
@@ -145,27 +147,27 @@ void DebugMon_Handler(void)
 /**
   * @brief This function handles USART6 global interrupt.
   */
-void USART6_IRQHandler(void)
+HOT_FUNC void USART6_IRQHandler(void)
 {
   /* USER CODE BEGIN USART6_IRQn 0 */
-
+  DRIVER_TRACE(TRACE_UART_ISR_ENTER, 6, 0);
   /* USER CODE END USART6_IRQn 0 */
   HAL_UART_IRQHandler(&huart6);
   /* USER CODE BEGIN USART6_IRQn 1 */
-
+  DRIVER_TRACE(TRACE_UART_ISR_EXIT, 6, 0);
   /* USER CODE END USART6_IRQn 1 */
 }
 /**
   * @brief This function handles USART6 global interrupt.
   */
-void USART3_IRQHandler(void)
+HOT_FUNC void USART3_IRQHandler(void)
 {
   /* USER CODE BEGIN USART6_IRQn 0 */
-
+  DRIVER_TRACE(TRACE_UART_ISR_ENTER, 3, 0);
   /* USER CODE END USART6_IRQn 0 */
   HAL_UART_IRQHandler(&huart3);
   /* USER CODE BEGIN USART6_IRQn 1 */
-
+  DRIVER_TRACE(TRACE_UART_ISR_EXIT, 3, 0);
   /* USER CODE END USART6_IRQn 1 */
 }
 
@@ -0,0 +1,137 @@
+/**
+  ********************************************************************************************
+  * @file    bench_at_match.c
+  * @author  Valentina Denic
+  * @brief   Host benchmark of matching of final result codes (MIDDLEWARE/at_match.c).
+  *          This file measures the following functionalities of the matcher.
+  *           + Search of whole answer with strstr() after every received character
+  *           + Incremental automaton that reads every character once (AT_MATCH_Feed())
+  *
+  @verbatim
+ ==============================================================================================
+                        ##### How to run benchmark #####
+ ==============================================================================================
+  [..]
+    Run "make -C Tests bench", program builds the same answer of at+cmgl as console
+    command "at bench" on target (lines of records and "OK" at the end), gives it to both
+    ways character by character BENCH_ROUNDS times and writes time per answer and per
+    character. Matcher finds "OK" on '\r' after it, one character after strstr(), which
+    would take "OK" in middle of line too.
+  @endverbatim
+  *
+  *********************************************************************************************
+  */
+
+/* Includes ----------------------------------------------------------------------------------*/
+#include <at_match.h>
+#include <stdio.h>
+#include <time.h>
+
+/* Number of times that answer is matched */
+#define BENCH_ROUNDS				200U
+
+/* Size of synthetic answer, the same as DEMO_BENCH_ANSWER_SIZE in main.c */
+#define BENCH_ANSWER_SIZE			4096U
+
+/* Result of every round is kept, so compiler doesn't remove loops */
+static volatile uint32_t sink;
+
+/**
+  * @brief Time of monotonic clock.
+  * @param void
+  * @retval double time (in nanoseconds)
+  */
+static double now(void)
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (double)time.tv_sec * 1e9 + (double)time.tv_nsec;
+}
+
+/**
+  * @brief Search whole answer after every character, the way answers were waited for before matcher.
+  * @param answer       Answer, it is terminated after every character while it is searched.
+  * @param length       Number of characters of answer.
+  * @retval uint32_t number of characters read when code was found, 0 if not found
+  */
+static uint32_t searchStrstr(uint8_t *answer, uint32_t length)
+{
+	for(uint32_t i = 1; i <= length; i++)
+	{
+		uint8_t next = answer[i];
+		answer[i] = '\0';
+		bool found = strstr((const char*)answer, "ERROR") != NULL || strstr((const char*)answer, "OK") != NULL;
+		answer[i] = next;
+		if(found) return i;
+	}
+	return 0;
+}
+
+/**
+  * @brief Give answer to matcher character by character.
+  * @param answer       Answer.
+  * @param length       Number of characters of answer.
+  * @retval uint32_t number of characters read when code was found, 0 if not found
+  */
+static uint32_t searchMatcher(const uint8_t *answer, uint32_t length)
+{
+	ATMatcher_t matcher;
+	uint32_t used = 0;
+
+	AT_MATCH_Start(&matcher, NULL);
+	for(uint32_t i = 0; i < length; i += used)
+	{
+		if(AT_MATCH_Feed(&matcher, answer + i, 1, &used) == AT_RESULT_OK) return i + used;
+	}
+	return 0;
+}
+
+int main(void)
+{
+	static uint8_t answer[BENCH_ANSWER_SIZE];
+	uint32_t length = 0;
+
+	if(AT_MATCH_Init() != DRIVER_OK)
+	{
+		printf("automaton can't be built\n");
+		return 1;
+	}
+
+	/* Synthetic answer of at+cmgl, lines of records and "OK" at the end */
+	for(uint32_t i = 1; length + 200 < BENCH_ANSWER_SIZE; i++)
+	{
+		length += snprintf((char*)answer + length, BENCH_ANSWER_SIZE - length,
+				"\r\n+CMGL: %lu,\"REC READ\",\"+381641234567\",\"\",\"21/03/14,10:15:00+04\"\r\nTemperature %lu, humidity 45\r\n",
+				(unsigned long)i, (unsigned long)(20 + i % 10));
+	}
+	length += snprintf((char*)answer + length, BENCH_ANSWER_SIZE - length, "\r\nOK\r\n");
+
+	uint32_t found = 0;
+	double start = now();
+	for(uint32_t round = 0; round < BENCH_ROUNDS; round++)
+	{
+		found = searchStrstr(answer, length);
+		sink = found;
+	}
+	double strstrTime = now() - start;
+
+	uint32_t matched = 0;
+	start = now();
+	for(uint32_t round = 0; round < BENCH_ROUNDS; round++)
+	{
+		matched = searchMatcher(answer, length);
+		sink = matched;
+	}
+	double matchTime = now() - start;
+
+	printf("%u rounds of answer of %lu characters, code found after %lu (strstr) and %lu (matcher) characters\n",
+		   BENCH_ROUNDS, (unsigned long)length, (unsigned long)found, (unsigned long)matched);
+	printf("strstr:  %10.1f ns per answer, %6.2f ns per character\n", strstrTime / BENCH_ROUNDS,
+		   strstrTime / BENCH_ROUNDS / length);
+	printf("matcher: %10.1f ns per answer, %6.2f ns per character\n", matchTime / BENCH_ROUNDS,
+		   matchTime / BENCH_ROUNDS / length);
+	printf("matcher is %.1f times faster\n", strstrTime / matchTime);
+
+	/* Code that is whole line is found on end of line */
+	return found != 0 && matched == found + 1U ? 0 : 1;
+}
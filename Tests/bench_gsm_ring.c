@@ -0,0 +1,219 @@
+/**
+  ********************************************************************************************
+  * @file    bench_gsm_ring.c
+  * @author  Valentina Denic
+  * @brief   Host benchmark of reading of gsm answers from ring buffer (DRIVER/driver_gsm.c).
+  *          This file measures the following functionalities of the gsm driver.
+  *           + Copy of io task (ring to message of queue character by character, then
+  *             message to buffer of reader)
+  *           + Copy of DRIVER_GSM_Read() in reading task (at most two memcpy from ring)
+  *
+  @verbatim
+ ==============================================================================================
+                        ##### How to run benchmark #####
+ ==============================================================================================
+  [..]
+    Run "make -C Tests bench", program writes answers of 16, 64 and 512 characters in ring
+    of the same size as ring of gsm (rxBufferGsm), reads every answer BENCH_ROUNDS times
+    in both ways and writes time per read. Ring is written once, before every read only
+    its pointers are moved (on target uart interrupt writes it). Driver needs HAL and
+    FreeRTOS, so both copies are repeated here on DRIVERCircularBuffer_t, without mutex,
+    queue and task switches that the old way also needed. On target "io stats" console command writes
+    cycles of reads.
+  @endverbatim
+  *
+  *********************************************************************************************
+  */
+
+/* Includes ----------------------------------------------------------------------------------*/
+#include <driver_common.h>
+#include <stdio.h>
+#include <time.h>
+
+/* Number of reads of every answer size */
+#define BENCH_ROUNDS				200000U
+
+/* Size of ring, the same as rxBufferGsm in main.c, and of message of old io task */
+#define BENCH_RING_SIZE				2000U
+
+/* Ring and its pointers, on target they are written by uart interrupt */
+static uint8_t ringBuffer[BENCH_RING_SIZE];
+static DRIVERCircularBuffer_t ring = {ringBuffer, ringBuffer, ringBuffer, ringBuffer + BENCH_RING_SIZE - 1U};
+
+/* Message that old io task sent through queue */
+static uint8_t rxStart[BENCH_RING_SIZE];
+
+/* Result of every round is kept, so compiler doesn't remove loops */
+static volatile uint8_t sink;
+
+/**
+  * @brief Time of monotonic clock.
+  * @param void
+  * @retval double time (in nanoseconds)
+  */
+static double now(void)
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (double)time.tv_sec * 1e9 + (double)time.tv_nsec;
+}
+
+/**
+  * @brief Write characters to ring the way uart interrupt does, write pointer can stay one
+  *        past end of ring.
+  * @param count        Number of characters.
+  * @param first        Value of first character, next ones are incremented.
+  * @retval void
+  */
+static void writeRing(uint32_t count, uint8_t first)
+{
+	for(uint32_t i = 0; i < count; i++)
+	{
+		if(ring.pointerWrite == ring.pointerEnd + 1) ring.pointerWrite = ring.pointerStart;
+		*ring.pointerWrite++ = (uint8_t)(first + i);
+	}
+}
+
+/**
+  * @brief Read answer the old way: io task clears message, copies ring to it character by
+  *        character and reader copies message to its buffer.
+  * @param userBuffer   Buffer of reader.
+  * @retval uint32_t number of characters
+  */
+static uint32_t readQueue(uint8_t *userBuffer)
+{
+	uint32_t size = 0;
+	uint32_t i = 0;
+
+	for(uint32_t j = 0; j != sizeof(rxStart); j++) rxStart[j] = 0;
+
+	uint8_t *write = ring.pointerWrite == ring.pointerEnd + 1 ? ring.pointerStart : ring.pointerWrite;
+	if(write >= ring.pointerRead)
+		size = write - ring.pointerRead;
+	else
+		size = (ring.pointerEnd - ring.pointerRead) + 1 + (write - ring.pointerStart);
+
+	while(ring.pointerRead != write)
+	{
+		rxStart[i++] = *ring.pointerRead;
+		*ring.pointerRead = 0;
+		if(ring.pointerRead != ring.pointerEnd) ring.pointerRead++;
+		else ring.pointerRead = ring.pointerStart;
+	}
+
+	/* Copy of message from queue in DRIVER_GSM_Read() */
+	for(i = 0; i < size; i++) userBuffer[i] = rxStart[i];
+	userBuffer[size] = '\0';
+
+	return size;
+}
+
+/**
+  * @brief Read answer the way DRIVER_GSM_Read() does: copy up to write pointer with at most
+  *        two memcpy.
+  * @param userBuffer   Buffer of reader.
+  * @retval uint32_t number of characters
+  */
+static uint32_t readRing(uint8_t *userBuffer)
+{
+	uint32_t index = 0;
+	uint8_t *write = ring.pointerWrite;
+	uint8_t *read = ring.pointerRead;
+	if(write == ring.pointerEnd + 1) write = ring.pointerStart;
+
+	if(write >= read)
+	{
+		memcpy(&userBuffer[index], read, write - read);
+		index += write - read;
+	}
+	else
+	{
+		/* Answer wraps around end of ring */
+		uint32_t tail = (ring.pointerEnd - read) + 1;
+		memcpy(&userBuffer[index], read, tail);
+		memcpy(&userBuffer[index + tail], ring.pointerStart, write - ring.pointerStart);
+		index += tail + (write - ring.pointerStart);
+	}
+	ring.pointerRead = write;
+	userBuffer[index] = '\0';
+
+	return index;
+}
+
+/**
+  * @brief Read answer of one size BENCH_ROUNDS times, answers follow one another in ring.
+  * @param count        Number of characters of answer.
+  * @param read         Way of reading.
+  * @param userBuffer   Buffer of reader.
+  * @retval double time of all rounds (in nanoseconds)
+  */
+static double run(uint32_t count, uint32_t (*read)(uint8_t *userBuffer), uint8_t *userBuffer)
+{
+	uint32_t position = 0;
+
+	writeRing(BENCH_RING_SIZE, 0);
+
+	double start = now();
+	for(uint32_t round = 0; round < BENCH_ROUNDS; round++)
+	{
+		/* Answer is already in ring, interrupt would only move write pointer after it */
+		ring.pointerRead = ring.pointerStart + position;
+		position += count;
+		if(position >= BENCH_RING_SIZE) position -= BENCH_RING_SIZE;
+		ring.pointerWrite = position == 0 ? ring.pointerEnd + 1 : ring.pointerStart + position;
+
+		sink = (uint8_t)read(userBuffer);
+	}
+	return now() - start;
+}
+
+/**
+  * @brief Check that both ways read the same characters, also answers that wrap around end of ring.
+  * @param count        Number of characters of answer.
+  * @retval bool true if answers are the same
+  */
+static bool sameAnswers(uint32_t count)
+{
+	static uint8_t queueBuffer[BENCH_RING_SIZE + 1];
+	static uint8_t ringCopy[BENCH_RING_SIZE + 1];
+	static uint8_t saved[BENCH_RING_SIZE];
+
+	for(uint32_t round = 0; round < 2U * BENCH_RING_SIZE / count + 2U; round++)
+	{
+		writeRing(count, (uint8_t)round);
+
+		/* Old way zeroes characters that it reads, ring is put back for second way */
+		DRIVERCircularBuffer_t state = ring;
+		memcpy(saved, ringBuffer, sizeof(saved));
+		uint32_t queueSize = readQueue(queueBuffer);
+		ring = state;
+		memcpy(ringBuffer, saved, sizeof(saved));
+		uint32_t ringSize = readRing(ringCopy);
+
+		if(queueSize != count || ringSize != count || memcmp(queueBuffer, ringCopy, count + 1U) != 0) return false;
+	}
+	return true;
+}
+
+int main(void)
+{
+	static const uint32_t sizes[] = {16U, 64U, 512U};
+	static uint8_t userBuffer[BENCH_RING_SIZE + 1];
+	bool same = true;
+
+	printf("%u reads of every size, ring of %u characters\n", BENCH_ROUNDS, BENCH_RING_SIZE);
+	for(uint32_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+	{
+		double queueTime = run(sizes[i], readQueue, userBuffer);
+		double ringTime = run(sizes[i], readRing, userBuffer);
+
+		ring.pointerWrite = ring.pointerRead = ring.pointerStart;
+		same = sameAnswers(sizes[i]) && same;
+
+		printf("%4u characters: io task copy %8.1f ns, ring copy %6.1f ns per read, %.1f times faster\n",
+			   sizes[i], queueTime / BENCH_ROUNDS, ringTime / BENCH_ROUNDS, queueTime / ringTime);
+	}
+	printf("answers %s\n", same ? "match" : "differ");
+
+	return same ? 0 : 1;
+}
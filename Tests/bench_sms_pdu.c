@@ -0,0 +1,126 @@
+/**
+  ********************************************************************************************
+  * @file    bench_sms_pdu.c
+  * @author  Valentina Denic
+  * @brief   Host benchmark of 7 bit packing of sms pdu (MIDDLEWARE/sms_pdu.c).
+  *          This file measures the following functionalities of the sms pdu.
+  *           + Packing septet by septet (shift and mask of every septet alone)
+  *           + Packing and unpacking eight septets in one word
+  *
+  @verbatim
+ ==============================================================================================
+                        ##### How to run benchmark #####
+ ==============================================================================================
+  [..]
+    Run "make -C Tests bench", program packs full message (160 septets) BENCH_ROUNDS
+    times in every way and writes time per message and throughput in septets per
+    microsecond. The same comparison in core cycles runs on target with console command
+    "pdu bench".
+  @endverbatim
+  *
+  *********************************************************************************************
+  */
+
+/* Includes ----------------------------------------------------------------------------------*/
+#include <sms_pdu.h>
+#include <stdio.h>
+#include <time.h>
+
+/* Number of times that 160 septets are packed */
+#define BENCH_ROUNDS				1000000U
+
+/* Result of every round is kept, so compiler doesn't remove loops */
+static volatile uint8_t sink;
+
+/**
+  * @brief Time of monotonic clock.
+  * @param void
+  * @retval double time (in nanoseconds)
+  */
+static double now(void)
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (double)time.tv_sec * 1e9 + (double)time.tv_nsec;
+}
+
+/**
+  * @brief Pack septets one by one, the way packing is done without words.
+  * @param septets      Septets.
+  * @param count        Number of septets.
+  * @param octets       Packed septets.
+  * @retval void
+  */
+static void packSeptets(const uint8_t *septets, uint32_t count, uint8_t *octets)
+{
+	memset(octets, 0, (count * 7U + 7U) / 8U);
+	for(uint32_t i = 0; i < count; i++)
+	{
+		uint32_t bit = i * 7U;
+		octets[bit / 8U] |= (uint8_t)(septets[i] << (bit % 8U));
+		if(bit % 8U > 1U) octets[bit / 8U + 1U] |= (uint8_t)(septets[i] >> (8U - bit % 8U));
+	}
+}
+
+/**
+  * @brief Write time and throughput of one way of packing.
+  * @param name         Name of way.
+  * @param time         Time of all rounds (in nanoseconds).
+  * @retval void
+  */
+static void report(const char *name, double time)
+{
+	double perMessage = time / BENCH_ROUNDS;
+	printf("%-18s %8.1f ns per message, %8.1f septets per us\n", name, perMessage,
+		   SMS_PDU_MAX_SEPTETS * 1e3 / perMessage);
+}
+
+int main(void)
+{
+	uint8_t septets[SMS_PDU_MAX_SEPTETS];
+	uint8_t unpacked[SMS_PDU_MAX_SEPTETS];
+	uint8_t octets[SMS_PDU_USER_DATA];
+	uint8_t reference[SMS_PDU_USER_DATA];
+
+	for(uint32_t i = 0; i < SMS_PDU_MAX_SEPTETS; i++) septets[i] = (uint8_t)((i * 37U + 11U) & 0x7FU);
+
+	double start = now();
+	for(uint32_t round = 0; round < BENCH_ROUNDS; round++)
+	{
+		septets[0] = (uint8_t)(round & 0x7FU);
+		packSeptets(septets, SMS_PDU_MAX_SEPTETS, reference);
+		sink = reference[round % SMS_PDU_USER_DATA];
+	}
+	double septetTime = now() - start;
+
+	start = now();
+	for(uint32_t round = 0; round < BENCH_ROUNDS; round++)
+	{
+		septets[0] = (uint8_t)(round & 0x7FU);
+		SMS_PDU_Pack7(septets, SMS_PDU_MAX_SEPTETS, octets);
+		sink = octets[round % SMS_PDU_USER_DATA];
+	}
+	double packTime = now() - start;
+
+	start = now();
+	for(uint32_t round = 0; round < BENCH_ROUNDS; round++)
+	{
+		octets[0] = (uint8_t)round;
+		SMS_PDU_Unpack7(octets, SMS_PDU_MAX_SEPTETS, unpacked, 0);
+		sink = unpacked[round % SMS_PDU_MAX_SEPTETS];
+	}
+	double unpackTime = now() - start;
+
+	/* Both ways of packing must give the same octets */
+	packSeptets(septets, SMS_PDU_MAX_SEPTETS, reference);
+	SMS_PDU_Pack7(septets, SMS_PDU_MAX_SEPTETS, octets);
+
+	printf("%u rounds of %u septets\n", BENCH_ROUNDS, (unsigned)SMS_PDU_MAX_SEPTETS);
+	report("septet by septet:", septetTime);
+	report("word pack:", packTime);
+	report("word unpack:", unpackTime);
+	printf("word pack is %.2f times faster, octets %s\n", septetTime / packTime,
+		   memcmp(octets, reference, sizeof(octets)) == 0 ? "match" : "differ");
+
+	return memcmp(octets, reference, sizeof(octets)) == 0 ? 0 : 1;
+}
@@ -0,0 +1,43 @@
+/**
+  ******************************************************************************
+  * @file    driver_common.h
+  * @author  Valentina Denic
+  * @brief   Host stand-in for DRIVER/driver_common.h, it has only what
+  *          code built on host (tests and benchmarks) needs, without HAL
+  *          and FreeRTOS.
+  ******************************************************************************
+  */
+
+#ifndef DRIVER_DRIVER_COMMON_H_
+#define DRIVER_DRIVER_COMMON_H_
+
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+
+/**
+  * @brief  DRIVER Status structures definition, the same values as on target
+  */
+typedef enum
+{
+  DRIVER_OK       = 0x00,				/*!< Driver return status ok		 */
+  DRIVER_ERROR    = 0x01,				/*!< Driver return status error		 */
+  DRIVER_TIMEOUT  = 0x02				/*!< Driver return status timeout	 */
+} DRIVERState_t;
+
+/**
+  * @brief  DRIVER circular buffer Structure definition, the same as on target
+  */
+typedef struct __DRIVERCircularBuffer_t
+{
+	 uint8_t* pointerWrite;				/*!< Pointer for writing new characters to buffer		 */
+
+	 uint8_t* pointerRead;				/*!< Pointer for reading new characters to buffer		 */
+
+	 uint8_t* pointerStart;				/*!< Pointer where buffer starts						 */
+
+	 uint8_t* pointerEnd;				/*!< Pointer where buffer ends							 */
+
+}DRIVERCircularBuffer_t;
+
+#endif /* DRIVER_DRIVER_COMMON_H_ */
@@ -0,0 +1,20 @@
+/**
+  ******************************************************************************
+  * @file    driver_memory.h
+  * @author  Valentina Denic
+  * @brief   Host stand-in for DRIVER/driver_memory.h, code that is placed
+  *          in ITCM and DTCM on target stays in normal sections on host.
+  ******************************************************************************
+  */
+
+#ifndef DRIVER_MEMORY_MEMORY_H_
+#define DRIVER_MEMORY_MEMORY_H_
+
+#include <driver_common.h>
+
+/* Hot function stays out of line, as on target */
+#define HOT_FUNC						__attribute__((noinline))
+#define HOT_DATA
+#define HOT_BSS
+
+#endif /* DRIVER_MEMORY_MEMORY_H_ */
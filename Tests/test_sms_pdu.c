@@ -0,0 +1,269 @@
+/**
+  ********************************************************************************************
+  * @file    test_sms_pdu.c
+  * @author  Valentina Denic
+  * @brief   Host unit tests of sms pdu (MIDDLEWARE/sms_pdu.c).
+  *          This file checks the following functionalities of the sms pdu.
+  *           + Packing and unpacking of septets against bit by bit reference, every shift
+  *           + Round trip of encoder and decoder in 7 bit alphabet and UCS2
+  *           + Length of one message (160 septets, 70 UCS2 characters)
+  *           + Decoding of real SMS-DELIVER and of SMS-SUBMIT with user data header
+  *
+  @verbatim
+ ==============================================================================================
+                        ##### How to run tests #####
+ ==============================================================================================
+  [..]
+    Tests are built on host with stand-in of driver_common.h (Tests/stub), sms_pdu.c is
+    compiled as it is on target. Run "make -C Tests test", program writes every failed
+    check and exits with 1 if any check failed.
+  @endverbatim
+  *
+  *********************************************************************************************
+  */
+
+/* Includes ----------------------------------------------------------------------------------*/
+#include <sms_pdu.h>
+#include <stdio.h>
+
+/* Number of checks and failed checks */
+static uint32_t checkCount;
+static uint32_t failCount;
+
+#define CHECK(condition, ...) do { checkCount++; if(!(condition)) { failCount++; \
+		printf("%s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); } } while(0)
+
+/**
+  * @brief Reference packing, every septet is written bit by bit after fill bits.
+  * @param septets      Septets.
+  * @param count        Number of septets.
+  * @param octets       Packed septets, zeroed by caller.
+  * @param shift        Fill bits before first septet.
+  * @retval void
+  */
+static void referencePack(const uint8_t *septets, uint32_t count, uint8_t *octets, uint32_t shift)
+{
+	for(uint32_t i = 0; i < count; i++)
+		for(uint32_t bit = 0; bit < 7U; bit++)
+			if((septets[i] >> bit) & 1U)
+			{
+				uint32_t position = shift + 7U * i + bit;
+				octets[position / 8U] |= (uint8_t)(1U << (position % 8U));
+			}
+}
+
+/**
+  * @brief Pack and unpack every length of one message, unpack after every number of fill bits.
+  * @param void
+  * @retval void
+  */
+static void testPacking(void)
+{
+	uint8_t septets[SMS_PDU_MAX_SEPTETS];
+	uint8_t unpacked[SMS_PDU_MAX_SEPTETS];
+	uint8_t octets[SMS_PDU_USER_DATA + 1U];
+	uint8_t reference[SMS_PDU_USER_DATA + 1U];
+
+	for(uint32_t i = 0; i < SMS_PDU_MAX_SEPTETS; i++) septets[i] = (uint8_t)((i * 37U + 11U) & 0x7FU);
+
+	for(uint32_t count = 0; count <= SMS_PDU_MAX_SEPTETS; count++)
+	{
+		memset(octets, 0xA5, sizeof(octets));
+		memset(reference, 0, sizeof(reference));
+		referencePack(septets, count, reference, 0);
+
+		uint32_t length = SMS_PDU_Pack7(septets, count, octets);
+		CHECK(length == (count * 7U + 7U) / 8U, "pack %u septets gave %u octets", count, length);
+		CHECK(memcmp(octets, reference, length) == 0, "pack %u septets differs from reference", count);
+		CHECK(octets[length] == 0xA5, "pack %u septets wrote past its octets", count);
+
+		for(uint32_t shift = 0; shift < 8U; shift++)
+		{
+			memset(reference, 0, sizeof(reference));
+			referencePack(septets, count, reference, shift);
+			memset(unpacked, 0xFF, sizeof(unpacked));
+
+			uint32_t read = SMS_PDU_Unpack7(reference, count, unpacked, shift);
+			CHECK(read == (shift + count * 7U + 7U) / 8U || count == 0,
+				  "unpack %u septets after %u fill bits read %u octets", count, shift, read);
+			CHECK(memcmp(unpacked, septets, count) == 0, "unpack %u septets after %u fill bits differs", count, shift);
+		}
+	}
+
+	/* Only lower 7 bits of septet are packed */
+	uint8_t high[8] = {0x80, 0xFF, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86};
+	uint8_t low[8];
+	for(uint32_t i = 0; i < 8U; i++) low[i] = high[i] & 0x7FU;
+	uint8_t packedHigh[7], packedLow[7];
+	SMS_PDU_Pack7(high, 8, packedHigh);
+	SMS_PDU_Pack7(low, 8, packedLow);
+	CHECK(memcmp(packedHigh, packedLow, 7) == 0, "bit 7 of septet was packed");
+}
+
+/**
+  * @brief Encode text, decode pdu and compare it.
+  * @param text         UTF-8 text.
+  * @param coding       Coding given to encoder.
+  * @param expected     Coding that decoder must read.
+  * @retval void
+  */
+static void roundTrip(const char *text, SMSPduCoding_t coding, SMSPduCoding_t expected)
+{
+	uint8_t hex[SMS_PDU_HEX_SIZE];
+	uint8_t decoded[4U * SMS_PDU_MAX_SEPTETS + 1U];
+	uint32_t tpduLength = 0;
+	SMSPduMessage_t message;
+	SMSPduSubmit_t submit = {.number = (const uint8_t*)"+381641234567", .text = (const uint8_t*)text,
+							 .length = strlen(text), .coding = coding};
+
+	DRIVERState_t state = SMS_PDU_EncodeSubmit(&submit, hex, sizeof(hex), &tpduLength);
+	CHECK(state == DRIVER_OK, "encode of \"%s\" failed", text);
+	if(state != DRIVER_OK) return;
+
+	/* Pdu starts with empty address of service centre, TPDU is the rest */
+	CHECK(strncmp((const char*)hex, "00", 2) == 0, "pdu of \"%s\" has address of service centre", text);
+	CHECK(strlen((const char*)hex) == 2U * tpduLength + 2U, "TPDU length %u of \"%s\" doesn't match pdu %s",
+		  tpduLength, text, hex);
+
+	state = SMS_PDU_Decode(hex, strlen((const char*)hex), &message, decoded, sizeof(decoded));
+	CHECK(state == DRIVER_OK, "decode of \"%s\" failed, pdu %s", text, hex);
+	if(state != DRIVER_OK) return;
+
+	CHECK(message.type == SMS_PDU_SUBMIT, "type of \"%s\" is %u", text, message.type);
+	CHECK(message.coding == expected, "coding of \"%s\" is %u, not %u", text, message.coding, expected);
+	CHECK(strcmp((const char*)message.number, "+381641234567") == 0, "number of \"%s\" is %s", text, message.number);
+	CHECK(strcmp((const char*)decoded, text) == 0, "\"%s\" came back as \"%s\"", text, decoded);
+	CHECK(message.length == strlen(text), "length of \"%s\" is %u", text, message.length);
+	CHECK(!message.truncated && !message.header, "\"%s\" is truncated or has header", text);
+}
+
+/**
+  * @brief Encoder result for text.
+  * @param text         UTF-8 text.
+  * @param length       Number of characters of text.
+  * @retval DRIVERState_t status of SMS_PDU_EncodeSubmit()
+  */
+static DRIVERState_t encode(const char *text, uint32_t length)
+{
+	uint8_t hex[SMS_PDU_HEX_SIZE];
+	uint32_t tpduLength = 0;
+	SMSPduSubmit_t submit = {.number = (const uint8_t*)"0641234567", .text = (const uint8_t*)text,
+							 .length = length, .coding = SMS_PDU_AUTO};
+
+	return SMS_PDU_EncodeSubmit(&submit, hex, sizeof(hex), &tpduLength);
+}
+
+/**
+  * @brief Round trips of encoder and decoder.
+  * @param void
+  * @retval void
+  */
+static void testRoundTrip(void)
+{
+	/* Basic alphabet and every character of extension table */
+	roundTrip("Temperature 21 C, humidity 45% @ \xC2\xA3$ \xC3\x84\xC3\x96", SMS_PDU_AUTO, SMS_PDU_7BIT);
+	roundTrip("^ { } \\ [ ~ ] | 5\xE2\x82\xAC", SMS_PDU_AUTO, SMS_PDU_7BIT);
+	roundTrip("\xE2\x82\xAC\xE2\x82\xAC\xE2\x82\xAC\xE2\x82\xAC\xE2\x82\xAC\xE2\x82\xAC\xE2\x82\xAC\xE2\x82\xAC",
+			  SMS_PDU_AUTO, SMS_PDU_7BIT);
+	roundTrip("", SMS_PDU_AUTO, SMS_PDU_7BIT);
+
+	/* UCS2 with characters outside of basic plane (surrogate pairs) */
+	roundTrip("\xC4\x86" "ao \xC5\xA1ta radi\xC5\xA1 \xF0\x9F\x98\x80", SMS_PDU_AUTO, SMS_PDU_UCS2);
+	roundTrip("\xF0\x9D\x84\x9E and \xF0\x9F\x98\x80", SMS_PDU_AUTO, SMS_PDU_UCS2);
+	roundTrip("plain text in UCS2", SMS_PDU_UCS2, SMS_PDU_UCS2);
+
+	/* 8 bit data comes back in hexadecimal */
+	uint8_t hex[SMS_PDU_HEX_SIZE];
+	uint8_t decoded[64];
+	uint32_t tpduLength = 0;
+	SMSPduMessage_t message;
+	SMSPduSubmit_t data = {.number = (const uint8_t*)"+381641234567", .text = (const uint8_t*)"\x01\x02\xFF",
+						   .length = 3, .coding = SMS_PDU_8BIT};
+	CHECK(SMS_PDU_EncodeSubmit(&data, hex, sizeof(hex), &tpduLength) == DRIVER_OK, "encode of 8 bit data failed");
+	CHECK(SMS_PDU_Decode(hex, strlen((const char*)hex), &message, decoded, sizeof(decoded)) == DRIVER_OK &&
+		  message.coding == SMS_PDU_8BIT && strcmp((const char*)decoded, "0102FF") == 0,
+		  "8 bit data came back as \"%s\"", decoded);
+}
+
+/**
+  * @brief Length of one message, 160 septets (escape is septet too) and 70 UCS2 characters.
+  * @param void
+  * @retval void
+  */
+static void testBoundary(void)
+{
+	char text[4U * SMS_PDU_MAX_SEPTETS + 1U];
+
+	memset(text, 'a', SMS_PDU_MAX_SEPTETS + 1U);
+	text[SMS_PDU_MAX_SEPTETS] = '\0';
+	roundTrip(text, SMS_PDU_AUTO, SMS_PDU_7BIT);
+	CHECK(encode(text, SMS_PDU_MAX_SEPTETS + 1U) == DRIVER_ERROR, "161 septets were encoded");
+
+	/* Character of extension table takes two septets */
+	strcpy(text + 158, "\xE2\x82\xAC");
+	roundTrip(text, SMS_PDU_AUTO, SMS_PDU_7BIT);
+	strcpy(text + 159, "\xE2\x82\xAC");
+	CHECK(encode(text, strlen(text)) == DRIVER_ERROR, "escape in septet 161 was encoded");
+
+	/* 70 characters of UCS2 fill 140 octets */
+	uint32_t length = 0;
+	for(uint32_t i = 0; i < 70U; i++) length += (uint32_t)sprintf(text + length, "\xC5\xA1");
+	roundTrip(text, SMS_PDU_AUTO, SMS_PDU_UCS2);
+	sprintf(text + length, "\xC5\xA1");
+	CHECK(encode(text, strlen(text)) == DRIVER_ERROR, "71 UCS2 characters were encoded");
+}
+
+/**
+  * @brief Decoding of pdus that were not made by encoder.
+  * @param void
+  * @retval void
+  */
+static void testVectors(void)
+{
+	uint8_t text[200];
+	SMSPduMessage_t message;
+
+	/* SMS-DELIVER from +31641600986 with service centre +31624000000 */
+	const char *deliver = "07911326040000F0040B911346610089F60000208062917314080CC8F71D14969741F977FD07";
+	CHECK(SMS_PDU_Decode((const uint8_t*)deliver, strlen(deliver), &message, text, sizeof(text)) == DRIVER_OK,
+		  "decode of SMS-DELIVER failed");
+	CHECK(message.type == SMS_PDU_DELIVER && message.coding == SMS_PDU_7BIT, "SMS-DELIVER has type %u coding %u",
+		  message.type, message.coding);
+	CHECK(strcmp((const char*)message.number, "+31641600986") == 0, "SMS-DELIVER is from %s", message.number);
+	CHECK(strcmp((const char*)text, "How are you?") == 0, "SMS-DELIVER text is \"%s\"", text);
+
+	/* Time zone octet 08 has sign bit set in its first semi-octet, it is -00 quarters of hour */
+	CHECK(strcmp((const char*)message.time, "02/08/26,19:37:41-00") == 0, "SMS-DELIVER time is %s", message.time);
+
+	/* Stored SMS-SUBMIT, part 1 of 2 of long message: 6 octets of header, 1 fill bit, "hello" */
+	const char *header = "0041000B915121551532F400000C050003CC0201D06536FB0D";
+	CHECK(SMS_PDU_Decode((const uint8_t*)header, strlen(header), &message, text, sizeof(text)) == DRIVER_OK,
+		  "decode of SMS-SUBMIT with header failed");
+	CHECK(message.type == SMS_PDU_SUBMIT && message.header, "SMS-SUBMIT header wasn't found");
+	CHECK(strcmp((const char*)message.number, "+15125551234") == 0, "SMS-SUBMIT is for %s", message.number);
+	CHECK(strcmp((const char*)text, "hello") == 0 && message.length == 5U, "SMS-SUBMIT text is \"%s\"", text);
+
+	/* Text that doesn't fit in buffer is cut and marked */
+	CHECK(SMS_PDU_Decode((const uint8_t*)deliver, strlen(deliver), &message, text, 5) == DRIVER_OK &&
+		  message.truncated && strcmp((const char*)text, "How ") == 0, "short buffer has \"%s\"", text);
+
+	/* Broken pdus */
+	CHECK(SMS_PDU_Decode((const uint8_t*)deliver, strlen(deliver) - 1U, &message, text, sizeof(text)) == DRIVER_ERROR,
+		  "odd number of digits was decoded");
+	CHECK(SMS_PDU_Decode((const uint8_t*)deliver, 40, &message, text, sizeof(text)) == DRIVER_ERROR,
+		  "pdu without user data was decoded");
+	CHECK(SMS_PDU_Decode((const uint8_t*)"07911326040000FG", 16, &message, text, sizeof(text)) == DRIVER_ERROR,
+		  "pdu with wrong digit was decoded");
+}
+
+int main(void)
+{
+	testPacking();
+	testRoundTrip();
+	testBoundary();
+	testVectors();
+
+	printf("sms pdu: %u checks, %u failed\n", checkCount, failCount);
+
+	return failCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+"""
+Report where linker placed code and data of firmware.
+
+ELF file that linker made is read and for every memory of STM32H743 (regions of
+STM32H743ZI_FLASH.ld) used and free bytes are written, then output sections and
+every function and variable in ITCM and DTCM, so it can be checked that code
+declared with HOT_FUNC and data declared with HOT_DATA/HOT_BSS landed there and
+that nothing else did. Sections that are copied by startup code (.itcm_text,
+.dtcm_data, .data) are counted in FLASH too.
+
+Usage (as post build step, or by hand after build):
+    python3 memreport.py Debug/GSM.elf
+    python3 memreport.py Debug/GSM.elf --top 10
+"""
+
+import argparse
+import struct
+import sys
+
+# Same as MEMORY in STM32H743ZI_FLASH.ld
+REGIONS = [
+    ("ITCMRAM", 0x00000020, 64 * 1024 - 32),
+    ("FLASH", 0x08000000, 2048 * 1024),
+    ("DTCMRAM", 0x20000000, 128 * 1024),
+    ("RAM_D1", 0x24000000, 512 * 1024),
+    ("RAM_D2", 0x30000000, 288 * 1024),
+    ("RAM_D3", 0x38000000, 64 * 1024),
+]
+HOT_REGIONS = ("ITCMRAM", "DTCMRAM")
+
+SHT_SYMTAB = 2
+SHT_NOBITS = 8
+SHF_ALLOC = 0x2
+PT_LOAD = 1
+STT_OBJECT = 1
+STT_FUNC = 2
+
+
+def region_of(address):
+    for name, origin, length in REGIONS:
+        if origin <= address < origin + length:
+            return name
+    return None
+
+
+class Elf:
+    """Sections, load segments and symbols of 32 bit little endian ELF."""
+
+    def __init__(self, data):
+        if data[:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1:
+            raise SystemExit("error: input is not 32 bit little endian ELF")
+        self.data = data
+        (_, _, _, _, phoff, shoff, _, _, phentsize, phnum,
+         shentsize, shnum, shstrndx) = struct.unpack_from("<HHIIIIIHHHHHH", data, 16)
+
+        self.segments = []
+        for i in range(phnum):
+            (ptype, _, vaddr, paddr, filesz, _, _, _) = struct.unpack_from("<IIIIIIII", data, phoff + i * phentsize)
+            if ptype == PT_LOAD:
+                self.segments.append((vaddr, paddr, filesz))
+
+        headers = [struct.unpack_from("<IIIIIIIIII", data, shoff + i * shentsize) for i in range(shnum)]
+        names = headers[shstrndx]
+        self.sections = []
+        for (name, stype, flags, addr, offset, size, link, _, _, _) in headers:
+            self.sections.append({
+                "name": self.string(names[4], name),
+                "type": stype, "flags": flags, "addr": addr,
+                "offset": offset, "size": size, "link": link,
+            })
+
+    def string(self, table_offset, index):
+        start = table_offset + index
+        return self.data[start:self.data.index(b"\0", start)].decode("ascii", "replace")
+
+    def load_address(self, section):
+        """Address in FLASH of initial content of section, or None when it isn't copied."""
+        if section["type"] == SHT_NOBITS:
+            return None
+        for vaddr, paddr, filesz in self.segments:
+            if vaddr != paddr and vaddr <= section["addr"] < vaddr + filesz:
+                return paddr + section["addr"] - vaddr
+        return None
+
+    def symbols(self):
+        """Return list of (address, size, kind, name) of functions and variables."""
+        result = []
+        for section in self.sections:
+            if section["type"] != SHT_SYMTAB:
+                continue
+            strings = self.sections[section["link"]]["offset"]
+            for i in range(section["size"] // 16):
+                name, value, size, info, _, _ = struct.unpack_from("<IIIBBH", self.data, section["offset"] + i * 16)
+                kind = info & 0xf
+                if kind not in (STT_FUNC, STT_OBJECT) or size == 0:
+                    continue
+                # Thumb functions have lowest bit of address set
+                address = value & ~1 if kind == STT_FUNC else value
+                result.append((address, size, "func" if kind == STT_FUNC else "data", self.string(strings, name)))
+        return sorted(set(result))
+
+
+def report(elf, top, out):
+    used = {name: 0 for name, _, _ in REGIONS}
+    placed = []
+    for section in elf.sections:
+        if not section["flags"] & SHF_ALLOC or section["size"] == 0:
+            continue
+        region = region_of(section["addr"])
+        if region is None:
+            continue
+        used[region] += section["size"]
+        load = elf.load_address(section)
+        if load is not None and region != "FLASH":
+            used["FLASH"] += section["size"]
+        placed.append((section, region, load))
+
+    out.write("Memory usage:\n")
+    out.write("  %-8s %10s %10s %10s %6s\n" % ("region", "size", "used", "free", "used%"))
+    for name, _, length in REGIONS:
+        out.write("  %-8s %10d %10d %10d %5.1f%%\n" % (name, length, used[name], length - used[name], 100.0 * used[name] / length))
+
+    out.write("\nSections:\n")
+    out.write("  %-20s %-8s %10s %10s %10s\n" % ("section", "region", "address", "size", "load"))
+    for section, region, load in placed:
+        out.write("  %-20s %-8s 0x%08x %10d %10s\n" % (section["name"], region, section["addr"], section["size"],
+                                                      "-" if load is None else "0x%08x" % load))
+
+    symbols = elf.symbols()
+    for region in HOT_REGIONS:
+        out.write("\n%s:\n" % region)
+        inside = [s for s in symbols if region_of(s[0]) == region]
+        if not inside:
+            out.write("  (empty)\n")
+        for address, size, kind, name in inside:
+            out.write("  0x%08x %8d %-4s %s\n" % (address, size, kind, name))
+
+    if top:
+        for region in ("FLASH", "RAM_D1", "RAM_D2"):
+            inside = sorted((s for s in symbols if region_of(s[0]) == region), key=lambda s: -s[1])[:top]
+            out.write("\nLargest in %s:\n" % region)
+            if not inside:
+                out.write("  (empty)\n")
+            for address, size, kind, name in inside:
+                out.write("  0x%08x %8d %-4s %s\n" % (address, size, kind, name))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("elf", help="firmware ELF file")
+    parser.add_argument("--top", type=int, default=0, help="also list N largest symbols in FLASH, RAM_D1 and RAM_D2")
+    args = parser.parse_args()
+
+    with open(args.elf, "rb") as stream:
+        report(Elf(stream.read()), args.top, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+"""
+Convert output of "trace dump" console command to timeline.
+
+Console log is read (every line that doesn't start with "trace," is skipped) and
+events are written in Chrome trace event format (JSON), which can be opened in
+chrome://tracing or https://ui.perfetto.dev.
+
+Usage:
+    python3 trace2timeline.py console.log -o timeline.json
+"""
+
+import argparse
+import json
+import sys
+
+STATUS = {0: "OK", 1: "ERROR", 2: "TIMEOUT"}
+URC = {1: "+CMTI", 2: "CLOSED", 3: "+PDP: DEACT", 4: "+CREG", 5: "+CGREG", 6: "RING", 7: "data"}
+MQTT_TYPE = {0x10: "CONNECT", 0x30: "PUBLISH", 0x82: "SUBSCRIBE", 0xc0: "PINGREQ", 0xe0: "DISCONNECT"}
+
+
+def read_dump(stream):
+    """Return clock of core at oldest record and list of records (cycles, event, arg0, arg1, label)."""
+    clock = None
+    records = []
+    for line in stream:
+        line = line.strip()
+        if not line.startswith("trace,"):
+            continue
+        fields = line.split(",", 5)
+        if fields[1] == "begin":
+            clock = int(fields[2])
+            records = []
+        elif fields[1] == "end":
+            continue
+        elif len(fields) == 6:
+            records.append((int(fields[1]), fields[2], int(fields[3]), int(fields[4]), fields[5]))
+    if clock is None:
+        raise SystemExit("error: no 'trace,begin' line in input")
+    return clock, records
+
+
+def to_timeline(clock, records):
+    """Build list of trace events, 32 bit cycle counter is unwrapped on the way.
+
+    Cycles are converted piece by piece: every clock_change record starts new piece that
+    is counted with new clock (arg0), so records before profile switch keep their times.
+    """
+    events = []
+    wraps = 0
+    previous = None
+    base_cycles = 0      # unwrapped cycles and time (us) where piece with current clock starts
+    base_ts = 0.0
+    task = None          # (start, name) of task that is running
+    modem = None         # (start, name) of at command or data waiting for answer
+
+    def thread(name):
+        return {"pid": 1, "tid": name}
+
+    for cycles, event, arg0, arg1, label in records:
+        if previous is not None and cycles < previous:
+            wraps += 1
+        previous = cycles
+        unwrapped = cycles + (wraps << 32)
+        ts = base_ts + (unwrapped - base_cycles) * 1e6 / clock
+
+        if event == "task_switch":
+            if task is not None:
+                events.append(dict(thread("CPU"), ph="X", name=task[1], ts=task[0], dur=ts - task[0]))
+            task = (ts, label or "task %d" % arg0)
+        elif event in ("uart_isr_enter", "uart_isr_exit"):
+            events.append(dict(thread("USART%d ISR" % arg0), ph="B" if event == "uart_isr_enter" else "E",
+                               name="USART%d" % arg0, ts=ts))
+        elif event in ("queue_send", "queue_receive"):
+            name = label or "queue 0x%08x" % arg0
+            events.append(dict(thread("Queues"), ph="i", s="t", ts=ts,
+                               name="%s %s" % (event.split("_")[1], name), args={"waiting": arg1}))
+        elif event == "at_start":
+            modem = (ts, "at" + label.rstrip("."))
+        elif event == "gsm_data":
+            modem = (ts, "data %d bytes" % arg0)
+        elif event == "at_complete":
+            start, name = modem if modem is not None else (ts, "answer")
+            events.append(dict(thread("Modem"), ph="X", name=name, ts=start, dur=ts - start,
+                               args={"status": STATUS.get(arg0, arg0), "answer size": arg1}))
+            modem = None
+        elif event == "at_urc":
+            events.append(dict(thread("Modem"), ph="i", s="t", ts=ts, name=URC.get(arg0, "urc %d" % arg0),
+                               args={"size": arg1}))
+        elif event == "clock_change":
+            base_cycles, base_ts, clock = unwrapped, ts, arg0
+            events.append(dict(thread("Clock"), ph="i", s="g", ts=ts, name="clock %d MHz" % (arg0 // 1000000),
+                               args={"previous": arg1}))
+        elif event in ("mqtt_send", "mqtt_receive"):
+            name = ("send " + MQTT_TYPE.get(arg0, "0x%02x" % arg0)) if event == "mqtt_send" else "receive PUBLISH"
+            events.append(dict(thread("MQTT"), ph="i", s="t", ts=ts, name=name, args={"arg0": arg0, "arg1": arg1}))
+        else:
+            events.append(dict(thread("Other"), ph="i", s="t", ts=ts, name=event, args={"arg0": arg0, "arg1": arg1}))
+
+    if task is not None and previous is not None:
+        events.append(dict(thread("CPU"), ph="X", name=task[1], ts=task[0], dur=ts - task[0]))
+    return events
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", nargs="?", help="console log with trace dump (default: stdin)")
+    parser.add_argument("-o", "--output", help="output JSON file (default: stdout)")
+    args = parser.parse_args()
+
+    stream = open(args.input, encoding="ascii", errors="replace") if args.input else sys.stdin
+    clock, records = read_dump(stream)
+    timeline = {"traceEvents": to_timeline(clock, records), "displayTimeUnit": "ns"}
+
+    out = open(args.output, "w") if args.output else sys.stdout
+    json.dump(timeline, out, indent=1)
+    if args.output:
+        print("%d records, %d timeline events written to %s" % (len(records), len(timeline["traceEvents"]), args.output))
+
+
+if __name__ == "__main__":
+    main()
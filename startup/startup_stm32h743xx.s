@@ -92,6 +92,51 @@ LoopFillZerobss:
   cmp  r2, r3
   bcc  FillZerobss
 
+/* Copy hot code from flash to ITCM */
+  ldr  r0, =_sitcm_text
+  ldr  r1, =_eitcm_text
+  ldr  r2, =_siitcm_text
+  b  LoopCopyItcm
+
+CopyItcm:
+  ldr  r3, [r2], #4
+  str  r3, [r0], #4
+
+LoopCopyItcm:
+  cmp  r0, r1
+  bcc  CopyItcm
+
+/* Copy hot data initializers from flash to DTCM */
+  ldr  r0, =_sdtcm_data
+  ldr  r1, =_edtcm_data
+  ldr  r2, =_sidtcm_data
+  b  LoopCopyDtcm
+
+CopyDtcm:
+  ldr  r3, [r2], #4
+  str  r3, [r0], #4
+
+LoopCopyDtcm:
+  cmp  r0, r1
+  bcc  CopyDtcm
+
+/* Zero fill hot bss in DTCM */
+  ldr  r2, =_sdtcm_bss
+  ldr  r1, =_edtcm_bss
+  movs  r3, #0
+  b  LoopFillZeroDtcm
+
+FillZeroDtcm:
+  str  r3, [r2], #4
+
+LoopFillZeroDtcm:
+  cmp  r2, r1
+  bcc  FillZeroDtcm
+
+/* Code in ITCM was written as data, it is fetched only after all writes are done */
+  dsb
+  isb
+
 /* Call static constructors */
     bl __libc_init_array
 /* Call the application's entry point.*/